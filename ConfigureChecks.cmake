@@ -14,13 +14,34 @@ CHECK_INCLUDE_FILE(libgen.h HAVE_LIBGEN_H)
 CHECK_INCLUDE_FILE(unistd.h HAVE_UNISTD_H)
 CHECK_INCLUDE_FILE(direct.h HAVE_DIRECT_H)
 CHECK_INCLUDE_FILE(stdint.h HAVE_STDINT_H)
+CHECK_INCLUDE_FILE(sys/wait.h HAVE_SYS_WAIT_H)
+CHECK_INCLUDE_FILE(sys/socket.h HAVE_SYS_SOCKET_H)
+CHECK_INCLUDE_FILE(sys/un.h HAVE_SYS_UN_H)
+CHECK_INCLUDE_FILE(sys/time.h HAVE_SYS_TIME_H)
 
 CHECK_SYMBOL_EXISTS(abort "stdlib.h" HAVE_ABORT)
 
 CHECK_FUNCTION_EXISTS(getcwd HAVE_GETCWD)
+CHECK_FUNCTION_EXISTS(fork HAVE_FORK)
+CHECK_FUNCTION_EXISTS(getpid HAVE_GETPID)
+CHECK_FUNCTION_EXISTS(gettimeofday HAVE_GETTIMEOFDAY)
+CHECK_FUNCTION_EXISTS(fopencookie HAVE_FOPENCOOKIE)
+CHECK_FUNCTION_EXISTS(funopen HAVE_FUNOPEN)
 CHECK_FUNCTION_EXISTS(_stricmp HAVE__STRICMP)
 CHECK_FUNCTION_EXISTS(toascii HAVE_TOASCII)
 
+CHECK_C_SOURCE_COMPILES("static __thread int x; int main(void) { x = 1; return x; }" HAVE___THREAD)
+CHECK_C_SOURCE_COMPILES("static _Thread_local int x; int main(void) { x = 1; return x; }" HAVE__THREAD_LOCAL)
+CHECK_C_SOURCE_COMPILES("static __declspec(thread) int x; int main(void) { x = 1; return x; }" HAVE___DECLSPEC_THREAD)
+
+IF (HAVE___THREAD)
+    SET(YASM_THREAD_LOCAL "__thread")
+ELSEIF (HAVE__THREAD_LOCAL)
+    SET(YASM_THREAD_LOCAL "_Thread_local")
+ELSEIF (HAVE___DECLSPEC_THREAD)
+    SET(YASM_THREAD_LOCAL "__declspec(thread)")
+ENDIF (HAVE___THREAD)
+
 CHECK_LIBRARY_EXISTS(dl dlopen "" HAVE_LIBDL)
 
 IF (HAVE_LIBDL)
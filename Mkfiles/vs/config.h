@@ -106,6 +106,9 @@
 /* Define to 1 if you have the `vsnprintf' function. */
 /* #undef HAVE_VSNPRINTF */
 
+/* Define to the thread-local storage class keyword */
+#define YASM_THREAD_LOCAL __declspec(thread)
+
 /* Define to 1 if you have the `_stricmp' function. */
 #define HAVE__STRICMP 1
 
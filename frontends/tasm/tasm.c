@@ -369,6 +369,7 @@ do_assemble(void)
     /* Finalize parse */
     yasm_object_finalize(object, errwarns);
     check_errors(errwarns, object, linemap);
+    yasm_object_compact(object);
 
     /* Optimize */
     yasm_object_optimize(object, errwarns);
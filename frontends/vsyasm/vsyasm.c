@@ -24,6 +24,10 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+/* Need _GNU_SOURCE to prototype kill() */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 #include <util.h>
 
 #include <ctype.h>
@@ -35,6 +39,15 @@
 #include <libgen.h>
 #endif
 
+#if defined(HAVE_FORK) && defined(HAVE_SYS_WAIT_H)
+#define USE_PARALLEL_JOBS 1
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
 #include "frontends/yasm/yasm-options.h"
 
 #if defined(CMAKE_BUILD) && defined(BUILD_SHARED_LIBS)
@@ -55,6 +68,7 @@ void yasm_init_plugin(void);
 /*@null@*/ /*@only@*/ static char *listext = NULL, *mapext = NULL;
 /*@null@*/ /*@only@*/ static char *machine_name = NULL;
 static int special_options = 0;
+static unsigned long num_jobs = 1;
 /*@null@*/ /*@dependent@*/ static const yasm_arch_module *
     cur_arch_module = NULL;
 /*@null@*/ /*@dependent@*/ static const yasm_parser_module *
@@ -86,6 +100,9 @@ static int check_errors(/*@only@*/ yasm_errwarns *errwarns,
                         /*@only@*/ yasm_arch *arch);
 static void cleanup(void);
 static void free_input_filenames(void);
+#ifdef USE_PARALLEL_JOBS
+static int assemble_parallel(void);
+#endif
 
 /* Forward declarations: cmd line parser handlers */
 static int opt_special_handler(char *cmd, /*@null@*/ char *param, int extra);
@@ -103,6 +120,7 @@ static int opt_objext_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_mapext_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_machine_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_strict_handler(char *cmd, /*@null@*/ char *param, int extra);
+static int opt_jobs_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_warning_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_error_file(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_error_stdout(char *cmd, /*@null@*/ char *param, int extra);
@@ -181,6 +199,8 @@ static opt_option options[] =
       N_("select machine (list with -m help)"), N_("machine") },
     { 0, "force-strict", 0, opt_strict_handler, 0,
       N_("treat all sized operands as if `strict' was used"), NULL },
+    { 'j', "jobs", 1, opt_jobs_handler, 0,
+      N_("assemble up to N files in parallel"), N_("N") },
     { 'w', NULL, 0, opt_warning_handler, 1,
       N_("inhibits warning messages"), NULL },
     { 'W', NULL, 0, opt_warning_handler, 0,
@@ -237,6 +257,9 @@ static opt_option options[] =
     "\n"
     "All options apply to all files.\n"
     "\n"
+    "With -j, files are assembled in parallel, but messages are still\n"
+    "output in command line order.\n"
+    "\n"
     "Report bugs to bug-yasm@tortall.net\n");
 
 /* parsed command line storage until appropriate modules have been loaded */
@@ -437,6 +460,7 @@ do_assemble(const char *in_filename)
     yasm_object_finalize(object, errwarns);
     if (check_errors(errwarns, object, linemap, preproc, arch) == EXIT_FAILURE)
         return EXIT_FAILURE;
+    yasm_object_compact(object);
 
     /* Optimize */
     yasm_object_optimize(object, errwarns);
@@ -708,6 +732,14 @@ main(int argc, char *argv[])
     if (!mapext)
         mapext = yasm__xstrdup("map");
 
+#ifdef USE_PARALLEL_JOBS
+    if (num_jobs > 1 && num_input_files > 1) {
+        int retval = assemble_parallel();
+        cleanup();
+        return retval;
+    }
+#endif
+
     /* Assemble each input file.  Terminate on first error. */
     STAILQ_FOREACH(infile, &input_files, link)
     {
@@ -721,6 +753,199 @@ main(int argc, char *argv[])
 }
 /*@=globstate =unrecog@*/
 
+#ifdef USE_PARALLEL_JOBS
+/* A single input file being assembled by a worker process. */
+typedef struct asm_job {
+    const char *in_filename;
+    /*@null@*/ /*@owned@*/ FILE *diag;  /* captured error/warning output */
+    pid_t pid;
+    int done;
+    int status;
+} asm_job;
+
+/* Start a worker process for job.  The worker's messages go to an anonymous
+ * temporary file so they can be output in order once the job is done.  If
+ * a worker can't be started, the job is assembled in-process instead.
+ */
+static void
+start_job(asm_job *job)
+{
+    FILE *saved_errfile;
+
+    job->diag = tmpfile();
+    if (!job->diag) {
+        print_error(_("could not create temporary file for `%s'"),
+                    job->in_filename);
+        job->done = 1;
+        job->status = EXIT_FAILURE;
+        return;
+    }
+
+    /* Don't let the worker inherit (and output again) buffered data. */
+    fflush(NULL);
+
+    job->pid = fork();
+    if (job->pid == 0) {
+        errfile = job->diag;
+        job->status = do_assemble(job->in_filename);
+        fflush(errfile);
+        _exit(job->status);
+    }
+
+    if (job->pid == -1) {
+        saved_errfile = errfile;
+        errfile = job->diag;
+        job->status = do_assemble(job->in_filename);
+        errfile = saved_errfile;
+        job->done = 1;
+    }
+}
+
+/* Copy the captured messages of job to the error file. */
+static void
+output_job(asm_job *job)
+{
+    char buf[4096];
+    size_t len;
+
+    if (!job->diag)
+        return;
+    rewind(job->diag);
+    while ((len = fread(buf, 1, sizeof(buf), job->diag)) > 0)
+        fwrite(buf, 1, len, errfile);
+    fclose(job->diag);
+    job->diag = NULL;
+}
+
+/* Remove the output file with extension ext in dir that job may have
+ * written.  Any message about the file name goes to the job's own
+ * (discarded) message file.
+ */
+static void
+remove_job_output(asm_job *job, const char *dir, const char *ext)
+{
+    const char *base_filename;
+    char *fn, *path;
+    FILE *saved_errfile = errfile;
+
+    yasm__splitpath(job->in_filename, &base_filename);
+    if (base_filename[0] == '\0')
+        return;
+    if (job->diag)
+        errfile = job->diag;
+    fn = replace_extension(base_filename, ext);
+    errfile = saved_errfile;
+    if (!fn)
+        return;
+    path = yasm__combpath(dir, fn);
+    yasm_xfree(fn);
+    remove(path);
+    yasm_xfree(path);
+}
+
+/* Assemble all input files using up to num_jobs worker processes.
+ * Messages are output in input file order.  Once a file fails, no more
+ * workers are started, those still running are killed, and the outputs
+ * of every file after the failing one are removed, so that just as in the
+ * sequential case nothing after the first failing file is reported or
+ * left behind.
+ */
+static int
+assemble_parallel(void)
+{
+    asm_job *jobs;
+    constcharparam *infile;
+    size_t i, n = 0, next = 0, flushed = 0;
+    unsigned long running = 0;
+    int failed = 0;
+    int killed = 0;
+
+    jobs = yasm_xmalloc(num_input_files * sizeof(asm_job));
+    STAILQ_FOREACH(infile, &input_files, link) {
+        jobs[n].in_filename = infile->param;
+        jobs[n].diag = NULL;
+        jobs[n].pid = -1;
+        jobs[n].done = 0;
+        jobs[n].status = EXIT_FAILURE;
+        n++;
+    }
+
+    for (;;) {
+        int status;
+        pid_t pid;
+
+        /* Start as many jobs as allowed */
+        while (!failed && next < n && running < num_jobs) {
+            start_job(&jobs[next]);
+            if (!jobs[next].done)
+                running++;
+            next++;
+        }
+
+        /* Output any completed jobs, in order */
+        while (!failed && flushed < next && jobs[flushed].done) {
+            output_job(&jobs[flushed]);
+            if (jobs[flushed].status != EXIT_SUCCESS)
+                failed = 1;
+            flushed++;
+        }
+
+        /* Stop the workers still assembling files after the failed one */
+        if (failed && !killed) {
+            for (i=flushed; i<next; i++) {
+                if (!jobs[i].done && jobs[i].pid > 0)
+                    kill(jobs[i].pid, SIGTERM);
+            }
+            killed = 1;
+        }
+
+        if (running == 0) {
+            if (failed || next == n)
+                break;
+            continue;
+        }
+
+        pid = waitpid(-1, &status, 0);
+        if (pid == -1) {
+            if (errno == EINTR)
+                continue;
+            break;      /* no children left to wait for */
+        }
+        for (i=0; i<next; i++) {
+            if (jobs[i].pid == pid && !jobs[i].done) {
+                jobs[i].done = 1;
+                if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS)
+                    jobs[i].status = EXIT_SUCCESS;
+                running--;
+                break;
+            }
+        }
+    }
+
+    /* Remove anything written for files after the failed one (flushed is
+     * just past it), as the sequential case never assembles them.
+     */
+    if (failed) {
+        for (i=flushed; i<next; i++) {
+            remove_job_output(&jobs[i], objdir_pathname, objext);
+            if (listdir_pathname)
+                remove_job_output(&jobs[i], listdir_pathname, listext);
+            if (mapdir_pathname)
+                remove_job_output(&jobs[i], mapdir_pathname, mapext);
+        }
+    }
+
+    /* Discard messages from jobs that finished after a failure */
+    for (i=0; i<n; i++) {
+        if (jobs[i].diag)
+            fclose(jobs[i].diag);
+    }
+    yasm_xfree(jobs);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+#endif
+
 /* Open the object file.  Returns 0 on failure. */
 static FILE *
 open_file(const char *filename, const char *mode)
@@ -1085,6 +1310,22 @@ opt_strict_handler(/*@unused@*/ char *cmd,
     return 0;
 }
 
+static int
+opt_jobs_handler(/*@unused@*/ char *cmd, char *param, /*@unused@*/ int extra)
+{
+    char *end;
+    unsigned long n;
+
+    assert(param != NULL);
+    n = strtoul(param, &end, 10);
+    if (*end != '\0' || n == 0) {
+        print_error(_("warning: invalid number of jobs `%s', using 1"), param);
+        n = 1;
+    }
+    num_jobs = n;
+    return 0;
+}
+
 static int
 opt_warning_handler(char *cmd, /*@unused@*/ char *param, int extra)
 {
@@ -24,9 +24,14 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+/* Need _GNU_SOURCE to define struct ucred */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 #include <util.h>
 
 #include <ctype.h>
+#include <setjmp.h>
 #include <libyasm/compat-queue.h>
 #include <libyasm/bitvect.h>
 #include <libyasm.h>
@@ -35,6 +40,27 @@
 #include <libgen.h>
 #endif
 
+#if defined(HAVE_UNISTD_H) && defined(HAVE_GETPID)
+#include <unistd.h>
+#endif
+
+#include <time.h>
+#if defined(HAVE_SYS_TIME_H) && defined(HAVE_GETTIMEOFDAY)
+#include <sys/time.h>
+#endif
+
+#if defined(HAVE_FORK) && defined(HAVE_SYS_WAIT_H) && \
+    defined(HAVE_SYS_SOCKET_H) && defined(HAVE_SYS_UN_H)
+#define USE_SERVER 1
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include "yasm-options.h"
 
 #if defined(CMAKE_BUILD) && defined(BUILD_SHARED_LIBS)
@@ -67,6 +93,11 @@ static int special_options = 0;
 /*@null@*/ /*@dependent@*/ static yasm_listfmt *cur_listfmt = NULL;
 /*@null@*/ /*@dependent@*/ static const yasm_listfmt_module *
     cur_listfmt_module = NULL;
+/* Object being assembled, so cleanup() can find it if a job fails */
+/*@null@*/ /*@dependent@*/ static yasm_object *cur_object = NULL;
+/* Likewise the job's line map and error list, freed if the job fails */
+/*@null@*/ /*@dependent@*/ static yasm_linemap *cur_linemap = NULL;
+/*@null@*/ /*@dependent@*/ static yasm_errwarns *cur_errwarns = NULL;
 static int preproc_only = 0;
 static unsigned int force_strict = 0;
 static int generate_make_dependencies = 0;
@@ -81,6 +112,18 @@ static enum {
     EWSTYLE_GNU = 0,
     EWSTYLE_VC
 } ewmsg_style = EWSTYLE_GNU;
+/*@null@*/ /*@only@*/ static char *cache_dir = NULL;
+static yasm_md5_context cmdline_md5;    /* command line, for cache keys */
+static unsigned char cache_key[16];
+static int cache_store = 0;     /* store output in cache when done */
+static int time_report = 0;
+static int mem_report = 0;
+/*@null@*/ /*@only@*/ static char *trace_filename = NULL;
+static int batch_job = 0;       /* nonzero while running a batch file job */
+static jmp_buf batch_job_abort;
+#ifdef USE_SERVER
+/*@null@*/ /*@only@*/ static char *server_socket = NULL;
+#endif
 
 /*@null@*/ /*@dependent@*/ static FILE *open_file(const char *filename,
                                                   const char *mode);
@@ -88,6 +131,8 @@ static void check_errors(/*@only@*/ yasm_errwarns *errwarns,
                          /*@only@*/ yasm_object *object,
                          /*@only@*/ yasm_linemap *linemap);
 static void cleanup(/*@null@*/ /*@only@*/ yasm_object *object);
+static /*@exits@*/ void job_fail(void);
+static int run_command(int argc, char *argv[]);
 
 /* Forward declarations: cmd line parser handlers */
 static int opt_special_handler(char *cmd, /*@null@*/ char *param, int extra);
@@ -100,6 +145,12 @@ static int opt_listfmt_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_listfile_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_objfile_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_mapfile_handler(char *cmd, /*@null@*/ char *param, int extra);
+static int opt_cache_dir_handler(char *cmd, /*@null@*/ char *param, int extra);
+static int opt_trace_out_handler(char *cmd, /*@null@*/ char *param, int extra);
+static int opt_time_report_handler(char *cmd, /*@null@*/ char *param,
+                                   int extra);
+static int opt_mem_report_handler(char *cmd, /*@null@*/ char *param,
+                                  int extra);
 static int opt_machine_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_strict_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_warning_handler(char *cmd, /*@null@*/ char *param, int extra);
@@ -116,6 +167,11 @@ static int opt_makedep_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_makedep_dos2unix_slash_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_prefix_handler(char *cmd, /*@null@*/ char *param, int extra);
 static int opt_suffix_handler(char *cmd, /*@null@*/ char *param, int extra);
+static int opt_batch_handler(char *cmd, /*@null@*/ char *param, int extra);
+#ifdef USE_SERVER
+static int opt_server_handler(char *cmd, /*@null@*/ char *param, int extra);
+static int opt_client_handler(char *cmd, /*@null@*/ char *param, int extra);
+#endif
 #if defined(CMAKE_BUILD) && defined(BUILD_SHARED_LIBS)
 static int opt_plugin_handler(char *cmd, /*@null@*/ char *param, int extra);
 #endif
@@ -182,10 +238,19 @@ static opt_option options[] =
       N_("name of object-file output"), N_("filename") },
     { 0, "mapfile", 1, opt_mapfile_handler, 0,
       N_("name of map-file output"), N_("filename") },
+    { 0, "cache-dir", 1, opt_cache_dir_handler, 0,
+      N_("reuse object files cached in directory"), N_("dir") },
     { 'm', "machine", 1, opt_machine_handler, 0,
       N_("select machine (list with -m help)"), N_("machine") },
     { 0, "force-strict", 0, opt_strict_handler, 0,
       N_("treat all sized operands as if `strict' was used"), NULL },
+    { 0, "time-report", 0, opt_time_report_handler, 0,
+      N_("report time spent in each assembly phase"), NULL },
+    { 0, "mem-report", 0, opt_mem_report_handler, 0,
+      N_("report memory use by subsystem"), NULL },
+    { 0, "trace-out", 1, opt_trace_out_handler, 0,
+      N_("write trace of assembler activity (Chrome trace format)"),
+      N_("file") },
     { 'w', NULL, 0, opt_warning_handler, 1,
       N_("inhibits warning messages"), NULL },
     { 'W', NULL, 0, opt_warning_handler, 0,
@@ -232,6 +297,16 @@ static opt_option options[] =
       N_("append argument to name of all external symbols"), N_("suffix") },
     { 0, "postfix", 1, opt_suffix_handler, 0,
       N_("append argument to name of all external symbols"), N_("suffix") },
+    { 0, "batch", 1, opt_batch_handler, 0,
+      N_("assemble each line of file as a command (must be first option)"),
+      N_("file") },
+#ifdef USE_SERVER
+    { 0, "server", 1, opt_server_handler, 0,
+      N_("serve assembly jobs on a local socket"), N_("socket") },
+    { 0, "client", 1, opt_client_handler, 0,
+      N_("forward command line to server (must be first option)"),
+      N_("socket") },
+#endif
 #if defined(CMAKE_BUILD) && defined(BUILD_SHARED_LIBS)
     { 'N', "plugin", 1, opt_plugin_handler, 0,
       N_("load plugin module"), N_("plugin") },
@@ -399,6 +474,8 @@ do_preproc_only(void)
     /* Initialize line map */
     linemap = yasm_linemap_create();
     yasm_linemap_set(linemap, in_filename, 0, 1, 1);
+    cur_linemap = linemap;
+    cur_errwarns = errwarns;
 
     /* Default output to stdout if not specified or generating dependency
        makefiles */
@@ -471,37 +548,669 @@ do_preproc_only(void)
     return EXIT_SUCCESS;
 }
 
+/* Assembly phases timed by --time-report */
+enum {
+    PHASE_PARSE = 0,
+    PHASE_FINALIZE,
+    PHASE_OPTIMIZE,
+    PHASE_DBGFMT,
+    PHASE_OUTPUT,
+    PHASE_LIST,
+    PHASE_MAKEDEP,
+    NUM_PHASES
+};
+
+static const char *phase_names[NUM_PHASES] = {
+    "parse", "finalize", "optimize", "debug info", "output", "listing",
+    "dependencies"
+};
+
+static struct {
+    int done;
+    double wall, cpu;
+    unsigned long bytecodes;    /* bytecodes in object after phase */
+} phase_times[NUM_PHASES];
+
+static double phase_start_wall, phase_start_cpu;
+static double preproc_wall, preproc_cpu;    /* part of parse phase */
+static unsigned long num_spans, num_spans_step2, num_expansions;
+/*@null@*/ /*@dependent@*/ static const yasm_preproc_module *
+    timed_preproc_real_module = NULL;
+static yasm_preproc_module timed_preproc_module;
+
+static double
+wall_time(void)
+{
+#if defined(HAVE_SYS_TIME_H) && defined(HAVE_GETTIMEOFDAY)
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1e6;
+#else
+    return (double)time(NULL);
+#endif
+}
+
+static double
+cpu_time(void)
+{
+    return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static char *
+timed_preproc_get_line(yasm_preproc *preproc)
+{
+    double wall = wall_time(), cpu = cpu_time();
+    char *line = timed_preproc_real_module->get_line(preproc);
+    preproc_wall += wall_time() - wall;
+    preproc_cpu += cpu_time() - cpu;
+    return line;
+}
+
+/* Times the preprocessor by routing get_line through a copy of its module
+ * structure.
+ */
+static void
+time_preproc(yasm_preproc *preproc)
+{
+    yasm_preproc_base *base = (yasm_preproc_base *)preproc;
+
+    timed_preproc_real_module = base->module;
+    timed_preproc_module = *base->module;
+    timed_preproc_module.get_line = timed_preproc_get_line;
+    base->module = &timed_preproc_module;
+}
+
+static void
+phase_begin(int phase)
+{
+    yasm_trace_begin("phase", phase_names[phase], NULL);
+    if (!time_report)
+        return;
+    phase_start_wall = wall_time();
+    phase_start_cpu = cpu_time();
+}
+
+static int
+count_bytecode(/*@unused@*/ yasm_bytecode *bc, void *d)
+{
+    (*(unsigned long *)d)++;
+    return 0;
+}
+
+static int
+count_section_bytecodes(yasm_section *sect, void *d)
+{
+    return yasm_section_bcs_traverse(sect, NULL, d, count_bytecode);
+}
+
+static void
+phase_end(int phase, yasm_object *object)
+{
+    yasm_trace_end();
+    if (!time_report)
+        return;
+    phase_times[phase].done = 1;
+    phase_times[phase].wall = wall_time() - phase_start_wall;
+    phase_times[phase].cpu = cpu_time() - phase_start_cpu;
+    phase_times[phase].bytecodes = 0;
+    yasm_object_sections_traverse(object, &phase_times[phase].bytecodes,
+                                  count_section_bytecodes);
+    if (phase == PHASE_OPTIMIZE) {
+        yasm_optimize_stats stats;
+
+        yasm_object_get_optimize_stats(object, &stats);
+        num_spans = stats.spans;
+        num_spans_step2 = stats.spans_step2;
+        num_expansions = stats.expansions;
+    }
+}
+
+/* Prints the phases run so far. */
+static void
+print_time_report(void)
+{
+    double wall = 0.0, cpu = 0.0;
+    int i;
+
+    if (!time_report)
+        return;
+
+    fprintf(errfile, _("time report for `%s':\n"), in_filename);
+    fprintf(errfile, "  %-16s%10s%10s%12s\n", _("phase"), _("wall (s)"),
+            _("CPU (s)"), _("bytecodes"));
+    for (i=0; i<NUM_PHASES; i++) {
+        if (!phase_times[i].done)
+            continue;
+        fprintf(errfile, "  %-16s%10.4f%10.4f%12lu\n", phase_names[i],
+                phase_times[i].wall, phase_times[i].cpu,
+                phase_times[i].bytecodes);
+        if (i == PHASE_PARSE) {
+            fprintf(errfile, "    %-14s%10.4f%10.4f", _("preprocess"),
+                    preproc_wall, preproc_cpu);
+            if (phase_times[i].wall > 0.0)
+                fprintf(errfile, _("%11.0f%% of parse"),
+                        100.0 * preproc_wall / phase_times[i].wall);
+            fputc('\n', errfile);
+        } else if (i == PHASE_OPTIMIZE)
+            fprintf(errfile, _("    spans: %lu, %lu needed step 2, "
+                               "%lu expansions\n"),
+                    num_spans, num_spans_step2, num_expansions);
+        wall += phase_times[i].wall;
+        cpu += phase_times[i].cpu;
+    }
+    fprintf(errfile, "  %-16s%10.4f%10.4f\n", _("total"), wall, cpu);
+}
+
+/* Chrome trace event output for --trace-out.  Events are written as they
+ * happen, so the trace file is valid JSON only once trace_close() is called.
+ */
+/*@null@*/ /*@dependent@*/ static FILE *trace_file = NULL;
+static double trace_start;
+static unsigned long trace_depth;
+
+static void
+trace_write_string(const char *str)
+{
+    fputc('"', trace_file);
+    for (; *str; str++) {
+        unsigned char ch = (unsigned char)*str;
+        if (ch == '"' || ch == '\\')
+            fprintf(trace_file, "\\%c", ch);
+        else if (ch < 0x20)
+            fprintf(trace_file, "\\u%04x", (unsigned int)ch);
+        else
+            fputc(ch, trace_file);
+    }
+    fputc('"', trace_file);
+}
+
+static void
+trace_write_event(char ph, /*@null@*/ const char *category,
+                  /*@null@*/ const char *name, /*@null@*/ const char *detail)
+{
+    fprintf(trace_file, ",\n{\"ph\":\"%c\",\"ts\":%.0f,\"pid\":1,\"tid\":1",
+            ph, (wall_time() - trace_start) * 1e6);
+    if (category) {
+        fputs(",\"cat\":", trace_file);
+        trace_write_string(category);
+    }
+    if (name) {
+        fputs(",\"name\":", trace_file);
+        trace_write_string(name);
+    }
+    if (detail) {
+        fputs(",\"args\":{\"detail\":", trace_file);
+        trace_write_string(detail);
+        fputc('}', trace_file);
+    }
+    fputc('}', trace_file);
+}
+
+static void
+trace_begin(const char *category, const char *name, const char *detail)
+{
+    trace_write_event('B', category, name, detail);
+    trace_depth++;
+}
+
+static void
+trace_end(void)
+{
+    if (trace_depth == 0)
+        return;
+    trace_write_event('E', NULL, NULL, NULL);
+    trace_depth--;
+}
+
+/* Opens the trace file and starts tracing.  Returns nonzero on failure. */
+static int
+trace_open(void)
+{
+    trace_file = open_file(trace_filename, "wt");
+    if (!trace_file)
+        return 1;
+    trace_start = wall_time();
+    trace_depth = 0;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", trace_file);
+    fputs("{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\","
+          "\"args\":{\"name\":\"yasm\"}}", trace_file);
+    yasm_trace_set_funcs(trace_begin, trace_end);
+    yasm_trace_begin("assemble", in_filename, obj_filename);
+    return 0;
+}
+
+/* Ends any regions left open (e.g. by an error) and finishes the file. */
+static void
+trace_close(void)
+{
+    if (!trace_file)
+        return;
+    while (trace_depth > 0)
+        trace_end();
+    yasm_trace_set_funcs(NULL, NULL);
+    fputs("\n]}\n", trace_file);
+    fclose(trace_file);
+    trace_file = NULL;
+}
+
+/* Memory accounting for --mem-report.  Each block handed out is preceded
+ * by a header recording its size and category.
+ */
+typedef union mem_header {
+    struct {
+        size_t size;
+        yasm_mem_category category;
+    } h;
+    double align_d;     /* the rest are for alignment */
+    long align_l;
+    void *align_p;
+} mem_header;
+
+static const char *mem_category_names[YASM_MEM_NUM_CATEGORIES] = {
+    "other", "expr", "intnum", "bytecode", "symrec", "linemap", "preproc",
+    "objfmt", "arena"
+};
+
+/* per category, and total at [YASM_MEM_NUM_CATEGORIES] */
+static struct {
+    unsigned long allocs;
+    unsigned long live, peak;
+} mem_stats[YASM_MEM_NUM_CATEGORIES+1];
+
+/* bytes released by yasm_object_compact(), to malloc or to the arenas */
+static unsigned long mem_compacted = 0;
+
+static void
+mem_account(const mem_header *h, int alloc)
+{
+    int idx[2], i;
+
+    idx[0] = (int)h->h.category;
+    idx[1] = YASM_MEM_NUM_CATEGORIES;
+    for (i=0; i<2; i++) {
+        if (alloc) {
+            mem_stats[idx[i]].allocs++;
+            mem_stats[idx[i]].live += (unsigned long)h->h.size;
+            if (mem_stats[idx[i]].live > mem_stats[idx[i]].peak)
+                mem_stats[idx[i]].peak = mem_stats[idx[i]].live;
+        } else
+            mem_stats[idx[i]].live -= (unsigned long)h->h.size;
+    }
+}
+
+/* Pieces of arena chunks move between the arena's own category and theirs */
+static void
+mem_suballoc(yasm_mem_category category, size_t size, int alloc)
+{
+    if (alloc) {
+        mem_stats[category].allocs++;
+        mem_stats[YASM_MEM_NUM_CATEGORIES].allocs++;
+        mem_stats[category].live += (unsigned long)size;
+        if (mem_stats[category].live > mem_stats[category].peak)
+            mem_stats[category].peak = mem_stats[category].live;
+        mem_stats[YASM_MEM_ARENA].live -= (unsigned long)size;
+    } else {
+        mem_stats[category].live -= (unsigned long)size;
+        mem_stats[YASM_MEM_ARENA].live += (unsigned long)size;
+    }
+}
+
+/* Bytes in use, not counting arena space that is free for reuse */
+static unsigned long
+mem_in_use(void)
+{
+    return mem_stats[YASM_MEM_NUM_CATEGORIES].live -
+        mem_stats[YASM_MEM_ARENA].live;
+}
+
+static void *
+mem_xmalloc(size_t size)
+{
+    mem_header *h;
+
+    if (size == 0)
+        size = 1;
+    h = malloc(sizeof(mem_header) + size);
+    if (!h)
+        yasm__fatal(N_("out of memory"));
+    h->h.size = size;
+    h->h.category = yasm_mem_get_category();
+    mem_account(h, 1);
+    return h + 1;
+}
+
+static void *
+mem_xcalloc(size_t nelem, size_t elsize)
+{
+    void *newmem;
+
+    if (nelem == 0 || elsize == 0)
+        nelem = elsize = 1;
+    newmem = mem_xmalloc(nelem * elsize);
+    memset(newmem, 0, nelem * elsize);
+    return newmem;
+}
+
+static void *
+mem_xrealloc(void *oldmem, size_t size)
+{
+    mem_header *h;
+
+    if (!oldmem)
+        return mem_xmalloc(size);
+    if (size == 0)
+        size = 1;
+
+    /* The block stays with the category it was allocated in */
+    h = (mem_header *)oldmem - 1;
+    mem_account(h, 0);
+    mem_stats[h->h.category].allocs--;
+    mem_stats[YASM_MEM_NUM_CATEGORIES].allocs--;
+    h = realloc(h, sizeof(mem_header) + size);
+    if (!h)
+        yasm__fatal(N_("out of memory"));
+    h->h.size = size;
+    mem_account(h, 1);
+    return h + 1;
+}
+
+static void
+mem_xfree(void *p)
+{
+    mem_header *h;
+
+    if (!p)
+        return;
+    h = (mem_header *)p - 1;
+    mem_account(h, 0);
+    free(h);
+}
+
+static void
+print_mem_report(void)
+{
+    int i;
+
+    fprintf(errfile, _("memory report for `%s':\n"),
+            in_filename ? in_filename : "-");
+    fprintf(errfile, "  %-12s%12s%14s%14s\n", _("category"), _("allocs"),
+            _("peak bytes"), _("live bytes"));
+    for (i=0; i<=YASM_MEM_NUM_CATEGORIES; i++) {
+        if (i < YASM_MEM_NUM_CATEGORIES && mem_stats[i].allocs == 0)
+            continue;
+        fprintf(errfile, "  %-12s%12lu%14lu%14lu\n",
+                i < YASM_MEM_NUM_CATEGORIES ? mem_category_names[i]
+                                            : _("total"),
+                mem_stats[i].allocs, mem_stats[i].peak, mem_stats[i].live);
+    }
+    fprintf(errfile, _("  %lu bytes reclaimed by compaction\n"),
+            mem_compacted);
+}
+
+/* Determines the object filename if not specified */
+static void
+set_default_obj_filename(void)
+{
+    const char *base_filename;
+
+    if (obj_filename)
+        return;
+
+    if (in_filename == NULL)
+        /* Default to yasm.out if no obj filename specified */
+        obj_filename = yasm__xstrdup("yasm.out");
+    else {
+        /* replace (or add) extension to base filename */
+        yasm__splitpath(in_filename, &base_filename);
+        if (base_filename[0] == '\0')
+            obj_filename = yasm__xstrdup("yasm.out");
+        else
+            obj_filename = replace_extension(base_filename,
+                                             cur_objfmt_module->extension,
+                                             "yasm.out");
+    }
+}
+
+/* Copies a file.  Returns nonzero on failure; the destination is only
+ * created once the source has been opened.
+ */
+static int
+copy_file(const char *from, const char *to)
+{
+    char buf[8192];
+    FILE *in, *out;
+    size_t got;
+    int err = 0;
+
+    in = fopen(from, "rb");
+    if (!in)
+        return 1;
+    out = fopen(to, "wb");
+    if (!out) {
+        fclose(in);
+        return 1;
+    }
+    while ((got = fread(buf, 1, sizeof(buf), in)) > 0) {
+        if (fwrite(buf, 1, got, out) != got) {
+            err = 1;
+            break;
+        }
+    }
+    if (ferror(in))
+        err = 1;
+    fclose(in);
+    if (fclose(out) != 0)
+        err = 1;
+    return err;
+}
+
+/* Object cache.  Entries are named by the MD5 of the yasm version, the
+ * command line, the modules in use, and the preprocessed source, and are
+ * only stored for assemblies that produced no messages, so on a hit the
+ * object file can simply be copied out of the cache.
+ */
+static /*@only@*/ char *
+cache_entry_name(const unsigned char key[16])
+{
+    static const char hexdigits[] = "0123456789abcdef";
+    char *name, *p;
+    int i;
+
+    /* leave room for a temporary file suffix */
+    name = yasm_xmalloc(strlen(cache_dir) + 1 + 32 + 24);
+    strcpy(name, cache_dir);
+    p = name + strlen(name);
+    *p++ = '/';
+    for (i=0; i<16; i++) {
+        *p++ = hexdigits[key[i] >> 4];
+        *p++ = hexdigits[key[i] & 0xf];
+    }
+    *p = '\0';
+    return name;
+}
+
+/* Does a preprocessed line have inputs or outputs the preprocessor does not
+ * see (and thus that are not covered by the cache key)?
+ */
+static int
+cache_line_has_side_effects(const char *line)
+{
+    const char *p;
+
+    /* incbin reads a file at parse time */
+    for (p = line; *p; p++) {
+        if ((*p == 'i' || *p == 'I') && yasm__strncasecmp(p, "incbin", 6) == 0)
+            return 1;
+    }
+
+    /* [map] writes a map file */
+    p = line;
+    while (isspace((unsigned char)*p))
+        p++;
+    if (*p == '[') {
+        p++;
+        while (isspace((unsigned char)*p))
+            p++;
+    }
+    if (yasm__strncasecmp(p, "map", 3) == 0 &&
+        !isalnum((unsigned char)p[3]) && p[3] != '_')
+        return 1;
+
+    return 0;
+}
+
+/* Preprocesses the input on its own to compute the cache key.  Returns
+ * nonzero if the result can be cached.
+ */
+static int
+cache_compute_key(/*@out@*/ unsigned char key[16])
+{
+    yasm_md5_context md5 = cmdline_md5;
+    yasm_linemap *linemap;
+    yasm_errwarns *errwarns;
+    const char *keywords[5];
+    char *line;
+    int i, cacheable = 1;
+
+    keywords[0] = cur_arch_module->keyword;
+    keywords[1] = cur_parser_module->keyword;
+    keywords[2] = cur_preproc_module->keyword;
+    keywords[3] = cur_objfmt_module->keyword;
+    keywords[4] = cur_dbgfmt_module->keyword;
+    for (i=0; i<5; i++)
+        yasm_md5_update(&md5, (const unsigned char *)keywords[i],
+                        (unsigned long)strlen(keywords[i])+1);
+    /* Object formats omit timestamps etc. in the test suite */
+    yasm_md5_update(&md5, (const unsigned char *)
+                    (getenv("YASM_TEST_SUITE") ? "T" : "-"), 1);
+    /* Debug formats record the working directory (or absolute paths) */
+    if (yasm__strcasecmp(cur_dbgfmt_module->keyword, "null") != 0) {
+        char *cwd = yasm__getcwd();
+        yasm_md5_update(&md5, (const unsigned char *)cwd,
+                        (unsigned long)strlen(cwd)+1);
+        yasm_xfree(cwd);
+    }
+
+    linemap = yasm_linemap_create();
+    yasm_linemap_set(linemap, in_filename, 0, 1, 1);
+    errwarns = yasm_errwarns_create();
+    cur_linemap = linemap;
+    cur_errwarns = errwarns;
+
+    cur_preproc = yasm_preproc_create(cur_preproc_module, in_filename, NULL,
+                                      linemap, errwarns);
+    apply_preproc_builtins();
+    apply_preproc_standard_macros(cur_parser_module->stdmacs);
+    apply_preproc_standard_macros(cur_objfmt_module->stdmacs);
+    apply_preproc_saved_options();
+
+    while ((line = yasm_preproc_get_line(cur_preproc)) != NULL) {
+        if (cache_line_has_side_effects(line))
+            cacheable = 0;
+        yasm_md5_update(&md5, (const unsigned char *)line,
+                        (unsigned long)strlen(line)+1);
+        yasm_xfree(line);
+        if (!cacheable)
+            break;
+    }
+
+    /* Any messages are left for the real assembly to report */
+    if (yasm_errwarns_num_errors(errwarns, 1) > 0)
+        cacheable = 0;
+    yasm_error_clear();
+    yasm_warn_clear();
+
+    yasm_preproc_destroy(cur_preproc);
+    cur_preproc = NULL;
+    yasm_errwarns_destroy(errwarns);
+    yasm_linemap_destroy(linemap);
+    cur_errwarns = NULL;
+    cur_linemap = NULL;
+
+    yasm_md5_final(key, &md5);
+    return cacheable;
+}
+
+/* Copies the object file out of the cache if there is a matching entry;
+ * otherwise arranges for do_assemble() to store its output.  Returns
+ * nonzero on a hit.
+ */
+static int
+cache_fetch(void)
+{
+    char *entry;
+    int hit;
+
+    /* Listings, map files, and dependencies are not cached, nor is the dbg
+     * object format, which writes to stderr.
+     */
+    if (list_filename || map_filename || generate_make_dependencies ||
+        trace_filename ||
+        yasm__strcasecmp(cur_objfmt_module->keyword, "dbg") == 0)
+        return 0;
+
+    set_default_obj_filename();
+    if (!cache_compute_key(cache_key))
+        return 0;
+
+    entry = cache_entry_name(cache_key);
+    hit = (copy_file(entry, obj_filename) == 0);
+    yasm_xfree(entry);
+    if (!hit)
+        cache_store = 1;
+    return hit;
+}
+
+/* Stores the object file in the cache (through a temporary file, so readers
+ * never see a partial entry).
+ */
+static void
+cache_put(void)
+{
+    char *entry, *temp;
+
+    entry = cache_entry_name(cache_key);
+    temp = yasm_xmalloc(strlen(entry) + 24);
+#ifdef HAVE_GETPID
+    sprintf(temp, "%s.%lu", entry, (unsigned long)getpid());
+#else
+    sprintf(temp, "%s.tmp", entry);
+#endif
+    if (copy_file(obj_filename, temp) != 0 || rename(temp, entry) != 0) {
+        remove(temp);
+        print_error(_("warning: could not write to cache directory `%s'"),
+                    cache_dir);
+    }
+    yasm_xfree(temp);
+    yasm_xfree(entry);
+}
+
 static int
 do_assemble(void)
 {
     yasm_object *object;
-    const char *base_filename;
     /*@null@*/ FILE *obj = NULL;
     yasm_arch_create_error arch_error;
     yasm_linemap *linemap;
     yasm_errwarns *errwarns = yasm_errwarns_create();
     int i, matched;
     const char *machine;
+    yasm_mem_category oldcat;
+    unsigned long live;
 
     /* Initialize line map */
     linemap = yasm_linemap_create();
     yasm_linemap_set(linemap, in_filename, 0, 1, 1);
+    cur_linemap = linemap;
+    cur_errwarns = errwarns;
 
-    /* determine the object filename if not specified */
-    if (!obj_filename) {
-        if (in_filename == NULL)
-            /* Default to yasm.out if no obj filename specified */
-            obj_filename = yasm__xstrdup("yasm.out");
-        else {
-            /* replace (or add) extension to base filename */
-            yasm__splitpath(in_filename, &base_filename);
-            if (base_filename[0] == '\0')
-                obj_filename = yasm__xstrdup("yasm.out");
-            else
-                obj_filename = replace_extension(base_filename,
-                                                 cur_objfmt_module->extension,
-                                                 "yasm.out");
-        }
+    set_default_obj_filename();
+
+    if (trace_filename && trace_open()) {
+        yasm_linemap_destroy(linemap);
+        yasm_errwarns_destroy(errwarns);
+        cleanup(NULL);
+        return EXIT_FAILURE;
     }
 
     /* Set up architecture using machine and parser. */
@@ -552,6 +1261,7 @@ do_assemble(void)
     /* Create object */
     object = yasm_object_create(in_filename, obj_filename, cur_arch,
                                 cur_objfmt_module, cur_dbgfmt_module);
+    cur_object = object;
     if (!object) {
         yasm_error_class eclass;
         unsigned long xrefline;
@@ -597,6 +1307,8 @@ do_assemble(void)
 
     cur_preproc = yasm_preproc_create(cur_preproc_module, in_filename,
                                       object->symtab, linemap, errwarns);
+    if (time_report)
+        time_preproc(cur_preproc);
 
     apply_preproc_builtins();
     apply_preproc_standard_macros(cur_parser_module->stdmacs);
@@ -609,103 +1321,727 @@ do_assemble(void)
                           cur_objfmt_module->default_x86_mode_bits);
     }
 
-    yasm_arch_set_var(cur_arch, "force_strict", force_strict);
+    yasm_arch_set_var(cur_arch, "force_strict", force_strict);
+
+    /* Try to enable the map file via a map NASM directive.  This is
+     * somewhat of a hack.
+     */
+    if (map_filename) {
+        const yasm_directive *dir = &cur_objfmt_module->directives[0];
+        matched = 0;
+        for (; dir && dir->name; dir++) {
+            if (yasm__strcasecmp(dir->name, "map") == 0 &&
+                yasm__strcasecmp(dir->parser, "nasm") == 0) {
+                yasm_valparamhead vps;
+                yasm_valparam *vp;
+                matched = 1;
+                yasm_vps_initialize(&vps);
+                vp = yasm_vp_create_string(NULL, yasm__xstrdup(map_filename));
+                yasm_vps_append(&vps, vp);
+                dir->handler(object, &vps, NULL, 0);
+                yasm_vps_delete(&vps);
+            }
+        }
+        if (!matched) {
+            print_error(
+                _("warning: object format `%s' does not support map files"),
+                cur_objfmt_module->keyword);
+        }
+    }
+
+    /* Parse! */
+    phase_begin(PHASE_PARSE);
+    cur_parser_module->do_parse(object, cur_preproc, list_filename != NULL,
+                                linemap, errwarns);
+    phase_end(PHASE_PARSE, object);
+
+    check_errors(errwarns, object, linemap);
+
+    /* Finalize parse */
+    phase_begin(PHASE_FINALIZE);
+    yasm_object_finalize(object, errwarns);
+    phase_end(PHASE_FINALIZE, object);
+    check_errors(errwarns, object, linemap);
+
+    /* Release parse-only state before optimizing */
+    live = mem_in_use();
+    yasm_object_compact(object);
+    if (mem_in_use() < live)
+        mem_compacted = live - mem_in_use();
+
+    /* Optimize */
+    phase_begin(PHASE_OPTIMIZE);
+    yasm_object_optimize(object, errwarns);
+    phase_end(PHASE_OPTIMIZE, object);
+    check_errors(errwarns, object, linemap);
+
+    /* generate any debugging information */
+    phase_begin(PHASE_DBGFMT);
+    yasm_dbgfmt_generate(object, linemap, errwarns);
+    phase_end(PHASE_DBGFMT, object);
+    check_errors(errwarns, object, linemap);
+
+    /* open the object file for output (if not already opened by dbg objfmt) */
+    if (!obj && yasm__strcasecmp(cur_objfmt_module->keyword, "dbg") != 0) {
+        obj = open_file(obj_filename, "wb");
+        if (!obj) {
+            cleanup(object);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* Write the object file */
+    phase_begin(PHASE_OUTPUT);
+    oldcat = yasm_mem_set_category(YASM_MEM_OBJFMT);
+    yasm_objfmt_output(object, obj?obj:stderr,
+                       yasm__strcasecmp(cur_dbgfmt_module->keyword, "null"),
+                       errwarns);
+    yasm_mem_set_category(oldcat);
+
+    /* Close object file */
+    if (obj)
+        fclose(obj);
+    phase_end(PHASE_OUTPUT, object);
+
+    /* If we had an error at this point, we also need to delete the output
+     * object file (to make sure it's not left newer than the source).
+     */
+    if (yasm_errwarns_num_errors(errwarns, warning_error) > 0)
+        remove(obj_filename);
+    check_errors(errwarns, object, linemap);
+
+    /* Open and write the list file */
+    if (list_filename) {
+        FILE *list = open_file(list_filename, "wt");
+        if (!list) {
+            cleanup(object);
+            return EXIT_FAILURE;
+        }
+        /* Initialize the list format */
+        phase_begin(PHASE_LIST);
+        cur_listfmt = yasm_listfmt_create(cur_listfmt_module, in_filename,
+                                          obj_filename);
+        yasm_listfmt_output(cur_listfmt, list, linemap, cur_arch);
+        fclose(list);
+        phase_end(PHASE_LIST, object);
+    }
+
+    /* Generate make dependency. */
+    if (generate_make_dependencies) {
+        phase_begin(PHASE_MAKEDEP);
+        do_generate_make_dependencies();
+        phase_end(PHASE_MAKEDEP, object);
+    }
+
+    /* Only cache output that comes with no messages to repeat on a hit */
+    if (cache_store && yasm_errwarns_num_errors(errwarns, 1) == 0)
+        cache_put();
+
+    yasm_errwarns_output_all(errwarns, linemap, warning_error,
+                             print_yasm_error, print_yasm_warning);
+    print_time_report();
+
+    yasm_linemap_destroy(linemap);
+    yasm_errwarns_destroy(errwarns);
+    cleanup(object);
+    yasm_delete_include_paths();
+    return EXIT_SUCCESS;
+}
+
+#ifdef USE_SERVER
+/* Server job request.  The header is followed by size bytes of NUL-terminated
+ * strings: the working directory, argc arguments, and envc environment
+ * entries.  The client's stdin, stdout, and stderr are passed along with the
+ * header; the server answers with a single exit status byte.
+ */
+typedef struct server_request {
+    unsigned long argc;
+    unsigned long envc;
+    unsigned long size;
+} server_request;
+
+/* Upper bound on the request size accepted by the server */
+#define SERVER_MAX_REQUEST  (1024UL*1024UL)
+
+extern char **environ;
+
+static int server_job = 0;  /* nonzero in a job forked by the server */
+
+static int
+server_sockaddr(const char *path, struct sockaddr_un *addr)
+{
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        print_error(_("socket name `%s' is too long"), path);
+        return 0;
+    }
+    memset(addr, 0, sizeof(struct sockaddr_un));
+    addr->sun_family = AF_UNIX;
+    strcpy(addr->sun_path, path);
+    return 1;
+}
+
+static int
+write_all(int fd, const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t got = write(fd, buf, len);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return 1;
+        buf += got;
+        len -= (size_t)got;
+    }
+    return 0;
+}
+
+static int
+read_all(int fd, char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t got = read(fd, buf, len);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return 1;
+        buf += got;
+        len -= (size_t)got;
+    }
+    return 0;
+}
+
+/* Forwards a command line to the server listening on path.  argv[1] is the
+ * --client option itself and is not forwarded.  Returns the exit status of
+ * the job, or -1 if the server could not be reached.
+ */
+static int
+do_client(const char *path, int argc, char *argv[])
+{
+    struct sockaddr_un addr;
+    server_request req;
+    struct msghdr msg;
+    struct iovec iov;
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(3*sizeof(int))];
+    } cmsgbuf;
+    struct cmsghdr *cmsg;
+    int fds[3] = {0, 1, 2};
+    size_t cwdlen = 256;
+    char *cwd, *buf, *p;
+    unsigned char status;
+    int i, sock;
+
+    if (!server_sockaddr(path, &addr))
+        return -1;
+
+    sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0)
+        return -1;
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        print_error(_("warning: could not connect to server `%s': %s"), path,
+                    strerror(errno));
+        close(sock);
+        return -1;
+    }
+
+    cwd = yasm_xmalloc(cwdlen);
+    while (!getcwd(cwd, cwdlen)) {
+        if (errno != ERANGE) {
+            print_error(_("could not determine current directory"));
+            yasm_xfree(cwd);
+            close(sock);
+            return EXIT_FAILURE;
+        }
+        cwdlen *= 2;
+        cwd = yasm_xrealloc(cwd, cwdlen);
+    }
+
+    /* Build request */
+    req.argc = (unsigned long)argc - 1;
+    req.envc = 0;
+    req.size = strlen(cwd) + 1 + strlen(argv[0]) + 1;
+    for (i=2; i<argc; i++)
+        req.size += strlen(argv[i]) + 1;
+    for (; environ[req.envc]; req.envc++)
+        req.size += strlen(environ[req.envc]) + 1;
+
+    buf = yasm_xmalloc(req.size);
+    p = buf;
+    strcpy(p, cwd);
+    p += strlen(p) + 1;
+    strcpy(p, argv[0]);
+    p += strlen(p) + 1;
+    for (i=2; i<argc; i++) {
+        strcpy(p, argv[i]);
+        p += strlen(p) + 1;
+    }
+    for (i=0; environ[i]; i++) {
+        strcpy(p, environ[i]);
+        p += strlen(p) + 1;
+    }
+    yasm_xfree(cwd);
+
+    /* Send header and standard descriptors, then the strings */
+    memset(&msg, 0, sizeof(msg));
+    iov.iov_base = (void *)&req;
+    iov.iov_len = sizeof(req);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsgbuf.buf;
+    msg.msg_controllen = sizeof(cmsgbuf.buf);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    if (sendmsg(sock, &msg, 0) != (ssize_t)sizeof(req)
+        || write_all(sock, buf, req.size) != 0
+        || read_all(sock, (char *)&status, 1) != 0) {
+        print_error(_("lost connection to server `%s'"), path);
+        status = EXIT_FAILURE;
+    }
+
+    yasm_xfree(buf);
+    close(sock);
+    return status;
+}
+
+/* Receives and runs one job on conn.  The job is run in a child process
+ * (which exits through the normal paths, e.g. check_errors()) so that its
+ * exit status can be passed back to the client.
+ */
+static int
+serve_job(int conn)
+{
+    server_request req;
+    struct msghdr msg;
+    struct iovec iov;
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(3*sizeof(int))];
+    } cmsgbuf;
+    struct cmsghdr *cmsg;
+    int fds[3];
+    char *buf = NULL, *p, *end, **args = NULL, **envp = NULL;
+    unsigned long i, nfds = 0;
+    unsigned char result = EXIT_FAILURE;
+    int status, retval = EXIT_FAILURE;
+    ssize_t got;
+    pid_t pid;
+
+    memset(&msg, 0, sizeof(msg));
+    iov.iov_base = (void *)&req;
+    iov.iov_len = sizeof(req);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsgbuf.buf;
+    msg.msg_controllen = sizeof(cmsgbuf.buf);
+
+    /* Take ownership of whatever descriptors came along, so they're closed
+     * even if the request is rejected.
+     */
+    got = recvmsg(conn, &msg, 0);
+    if (got < 0)
+        return EXIT_FAILURE;
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET
+        && cmsg->cmsg_type == SCM_RIGHTS && cmsg->cmsg_len >= CMSG_LEN(0)) {
+        nfds = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        if (nfds > 3)
+            nfds = 3;
+        memcpy(fds, CMSG_DATA(cmsg), nfds*sizeof(int));
+    }
+    if (got != (ssize_t)sizeof(req) || nfds != 3
+        || (msg.msg_flags & (MSG_TRUNC|MSG_CTRUNC)))
+        goto done;
+
+    if (req.argc == 0 || req.size == 0 || req.size > SERVER_MAX_REQUEST
+        || req.argc + req.envc >= req.size)
+        goto done;
+
+    buf = yasm_xmalloc(req.size);
+    if (read_all(conn, buf, req.size) != 0 || buf[req.size-1] != '\0')
+        goto done;
+
+    /* Split strings into argument and environment vectors */
+    args = yasm_xmalloc((req.argc+1)*sizeof(char *));
+    envp = yasm_xmalloc((req.envc+1)*sizeof(char *));
+    end = buf + req.size;
+    p = buf + strlen(buf) + 1;
+    for (i=0; i<req.argc; i++) {
+        if (p >= end)
+            goto done;
+        args[i] = p;
+        p += strlen(p) + 1;
+    }
+    args[req.argc] = NULL;
+    for (i=0; i<req.envc; i++) {
+        if (p >= end)
+            goto done;
+        envp[i] = p;
+        p += strlen(p) + 1;
+    }
+    envp[req.envc] = NULL;
+
+    pid = fork();
+    if (pid == 0) {
+        close(conn);
+        for (i=0; i<3; i++)
+            dup2(fds[i], (int)i);
+        for (i=0; i<3; i++)
+            if (fds[i] > 2)
+                close(fds[i]);
+        errfile = stderr;
+        if (chdir(buf) != 0) {
+            print_error(_("could not change directory to `%s'"), buf);
+            exit(EXIT_FAILURE);
+        }
+        environ = envp;
+        server_job = 1;
+        yasm_xfree(server_socket);
+        server_socket = NULL;
+        exit(run_command((int)req.argc, args));
+    }
+
+    for (i=0; i<nfds; i++)
+        close(fds[i]);
+    nfds = 0;
+    if (pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status))
+        result = (unsigned char)WEXITSTATUS(status);
+    write_all(conn, (const char *)&result, 1);
+    retval = EXIT_SUCCESS;
+
+done:
+    for (i=0; i<nfds; i++)
+        close(fds[i]);
+    if (envp)
+        yasm_xfree(envp);
+    if (args)
+        yasm_xfree(args);
+    if (buf)
+        yasm_xfree(buf);
+    return retval;
+}
+
+/* Nonzero if the peer on conn runs as the same user as the server.  Where
+ * that can't be checked, the socket's permissions alone keep others out.
+ */
+static int
+server_peer_ok(int conn)
+{
+#ifdef SO_PEERCRED
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+
+    return getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0
+        && len == sizeof(cred) && cred.uid == geteuid();
+#else
+    return 1;
+#endif
+}
+
+/* Adds one object format's standard macros to cur_preproc. */
+static void
+preload_objfmt_macros(const char *name, const char *keyword)
+{
+    yasm_objfmt_module *objfmt = yasm_load_objfmt(keyword);
+
+    if (objfmt)
+        apply_preproc_standard_macros(objfmt->stdmacs);
+}
+
+/* Has a parser's default preprocessor take in the standard macros of the
+ * parser and of every object format, so it can cache them.
+ */
+static void
+preload_parser_macros(const char *name, const char *keyword)
+{
+    yasm_linemap *linemap;
+    yasm_errwarns *errwarns;
+
+    cur_parser_module = yasm_load_parser(keyword);
+    if (!cur_parser_module)
+        return;
+    cur_preproc_module =
+        yasm_load_preproc(cur_parser_module->default_preproc_keyword);
+    /* Only preprocessors that keep anything between runs benefit */
+    if (!cur_preproc_module || !cur_preproc_module->cleanup)
+        return;
+
+    linemap = yasm_linemap_create();
+    yasm_linemap_set(linemap, "/dev/null", 0, 1, 1);
+    errwarns = yasm_errwarns_create();
+
+    cur_preproc = yasm_preproc_create(cur_preproc_module, "/dev/null", NULL,
+                                      linemap, errwarns);
+    apply_preproc_standard_macros(cur_parser_module->stdmacs);
+    yasm_list_objfmt(preload_objfmt_macros);
+
+    yasm_preproc_destroy(cur_preproc);
+    cur_preproc = NULL;
+    yasm_errwarns_destroy(errwarns);
+    yasm_linemap_destroy(linemap);
+}
+
+/* Fills the preprocessors' standard macro caches, so forked jobs inherit
+ * them rather than each tokenizing the macros again.
+ */
+static void
+preload_standard_macros(void)
+{
+    yasm_list_parser(preload_parser_macros);
+    cur_parser_module = NULL;
+    cur_preproc_module = NULL;
+}
+
+/* Accepts jobs on a local socket until killed.  Modules and libyasm have
+ * already been initialized, and each job is run in a forked copy of this
+ * process, so none of that startup work is repeated per job.
+ */
+static int
+do_server(const char *path)
+{
+    struct sockaddr_un addr;
+    int sock, conn, bound = 0;
+    mode_t oldmask;
+    pid_t pid;
+
+    if (!server_sockaddr(path, &addr))
+        return EXIT_FAILURE;
+
+    sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0) {
+        print_error(_("could not create socket: %s"), strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    /* Remove a socket left behind by an earlier server (nothing answers on
+     * it), but never one that is still in use.
+     */
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0
+        && errno == ECONNREFUSED)
+        unlink(path);
+    close(sock);
+
+    /* Jobs run as the server's user, so only that user may connect: the
+     * socket is created with no group or other permissions.
+     */
+    sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock >= 0) {
+        oldmask = umask(077);
+        bound = bind(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+        umask(oldmask);
+    }
+    if (!bound || chmod(path, S_IRUSR|S_IWUSR) != 0
+        || listen(sock, SOMAXCONN) != 0) {
+        print_error(_("could not listen on socket `%s': %s"), path,
+                    strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    preload_standard_macros();
+
+    for (;;) {
+        conn = accept(sock, NULL, NULL);
+
+        /* Reap finished jobs */
+        while (waitpid(-1, NULL, WNOHANG) > 0)
+            ;
+
+        if (conn < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            print_error(_("could not accept connection: %s"),
+                        strerror(errno));
+            break;
+        }
+        if (!server_peer_ok(conn)) {
+            print_error(_("warning: rejected connection from another user"));
+            close(conn);
+            continue;
+        }
+
+        fflush(NULL);
+        pid = fork();
+        if (pid == 0) {
+            close(sock);
+            _exit(serve_job(conn));
+        }
+        if (pid < 0)
+            print_error(_("could not start job: %s"), strerror(errno));
+        close(conn);
+    }
+
+    close(sock);
+    unlink(path);
+    return EXIT_FAILURE;
+}
+#endif
 
-    /* Try to enable the map file via a map NASM directive.  This is
-     * somewhat of a hack.
-     */
-    if (map_filename) {
-        const yasm_directive *dir = &cur_objfmt_module->directives[0];
-        matched = 0;
-        for (; dir && dir->name; dir++) {
-            if (yasm__strcasecmp(dir->name, "map") == 0 &&
-                yasm__strcasecmp(dir->parser, "nasm") == 0) {
-                yasm_valparamhead vps;
-                yasm_valparam *vp;
-                matched = 1;
-                yasm_vps_initialize(&vps);
-                vp = yasm_vp_create_string(NULL, yasm__xstrdup(map_filename));
-                yasm_vps_append(&vps, vp);
-                dir->handler(object, &vps, NULL, 0);
-                yasm_vps_delete(&vps);
-            }
-        }
-        if (!matched) {
-            print_error(
-                _("warning: object format `%s' does not support map files"),
-                cur_objfmt_module->keyword);
+/* Reads a line of any length from a batch file, without its newline.
+ * Returns NULL at end of file.
+ */
+static /*@null@*/ /*@only@*/ char *
+read_batch_line(FILE *f)
+{
+    size_t size = 256, len = 0;
+    char *line = yasm_xmalloc(size);
+
+    while (fgets(line+len, (int)(size-len), f)) {
+        len += strlen(line+len);
+        if (len > 0 && line[len-1] == '\n') {
+            line[--len] = '\0';
+            if (len > 0 && line[len-1] == '\r')
+                line[--len] = '\0';
+            return line;
         }
+        if (len+1 < size)
+            break;      /* last line without newline */
+        size *= 2;
+        line = yasm_xrealloc(line, size);
     }
+    if (len > 0)
+        return line;
+    yasm_xfree(line);
+    return NULL;
+}
 
-    /* Parse! */
-    cur_parser_module->do_parse(object, cur_preproc, list_filename != NULL,
-                                linemap, errwarns);
+/* Splits a batch file line into arguments in place, appending them to
+ * *args.  Arguments are separated by whitespace.  Double quotes may be used
+ * to include whitespace in an argument; within quotes, a backslash escapes
+ * a double quote or backslash.  A line starting with # is a comment.
+ * Returns nonzero on an unterminated quote.
+ */
+static int
+split_batch_line(char *line, char ***args, int *nargs, size_t *maxargs)
+{
+    char *src = line, *dest;
 
-    check_errors(errwarns, object, linemap);
+    while (isspace((unsigned char)*src))
+        src++;
+    if (*src == '#')
+        return 0;
 
-    /* Finalize parse */
-    yasm_object_finalize(object, errwarns);
-    check_errors(errwarns, object, linemap);
+    while (*src != '\0') {
+        if ((size_t)*nargs == *maxargs) {
+            *maxargs *= 2;
+            *args = yasm_xrealloc(*args, *maxargs*sizeof(char *));
+        }
+        (*args)[(*nargs)++] = dest = src;
 
-    /* Optimize */
-    yasm_object_optimize(object, errwarns);
-    check_errors(errwarns, object, linemap);
+        while (*src != '\0' && !isspace((unsigned char)*src)) {
+            if (*src != '"') {
+                *dest++ = *src++;
+                continue;
+            }
+            src++;
+            while (*src != '"') {
+                if (*src == '\0')
+                    return 1;
+                if (*src == '\\' && (src[1] == '"' || src[1] == '\\'))
+                    src++;
+                *dest++ = *src++;
+            }
+            src++;
+        }
+        if (*src != '\0')
+            src++;
+        *dest = '\0';
 
-    /* generate any debugging information */
-    yasm_dbgfmt_generate(object, linemap, errwarns);
-    check_errors(errwarns, object, linemap);
+        while (isspace((unsigned char)*src))
+            src++;
+    }
+    return 0;
+}
 
-    /* open the object file for output (if not already opened by dbg objfmt) */
-    if (!obj && yasm__strcasecmp(cur_objfmt_module->keyword, "dbg") != 0) {
-        obj = open_file(obj_filename, "wb");
-        if (!obj) {
-            cleanup(object);
-            return EXIT_FAILURE;
+/* Runs a single batch job, catching failures that would otherwise exit. */
+static int
+run_batch_job(int argc, char *argv[])
+{
+    if (setjmp(batch_job_abort) != 0) {
+        /* The jump skipped the job's own teardown.  Destroying the
+         * preprocessor resets its module state (nasm-pp's include and
+         * context stacks) for the next job; the rest is left to cleanup().
+         */
+        if (cur_preproc) {
+            yasm_preproc_destroy(cur_preproc);
+            cur_preproc = NULL;
+        }
+        if (cur_errwarns) {
+            yasm_errwarns_destroy(cur_errwarns);
+            cur_errwarns = NULL;
         }
+        if (cur_linemap) {
+            yasm_linemap_destroy(cur_linemap);
+            cur_linemap = NULL;
+        }
+        yasm_error_clear();
+        yasm_warn_clear();
+        return EXIT_FAILURE;
     }
+    return run_command(argc, argv);
+}
 
-    /* Write the object file */
-    yasm_objfmt_output(object, obj?obj:stderr,
-                       yasm__strcasecmp(cur_dbgfmt_module->keyword, "null"),
-                       errwarns);
-
-    /* Close object file */
-    if (obj)
-        fclose(obj);
-
-    /* If we had an error at this point, we also need to delete the output
-     * object file (to make sure it's not left newer than the source).
-     */
-    if (yasm_errwarns_num_errors(errwarns, warning_error) > 0)
-        remove(obj_filename);
-    check_errors(errwarns, object, linemap);
-
-    /* Open and write the list file */
-    if (list_filename) {
-        FILE *list = open_file(list_filename, "wt");
-        if (!list) {
-            cleanup(object);
+/* Runs each line of a batch file as a separate command, keeping the
+ * process (and its loaded modules) between jobs.  Options given after
+ * --batch on the command line are put ahead of each line's own.
+ */
+static int
+do_batch(const char *filename, int argc, char *argv[])
+{
+    FILE *f;
+    /*@null@*/ char *line;
+    char **args;
+    int nargs, i;
+    size_t maxargs = 16;
+    unsigned long lineno = 0;
+    int status = EXIT_SUCCESS;
+
+    if (strcmp(filename, "-") == 0)
+        f = stdin;
+    else {
+        f = open_file(filename, "rt");
+        if (!f)
             return EXIT_FAILURE;
-        }
-        /* Initialize the list format */
-        cur_listfmt = yasm_listfmt_create(cur_listfmt_module, in_filename,
-                                          obj_filename);
-        yasm_listfmt_output(cur_listfmt, list, linemap, cur_arch);
-        fclose(list);
     }
 
-    /* Generate make dependency. */
-    if (generate_make_dependencies)
-        do_generate_make_dependencies();
+    args = yasm_xmalloc(maxargs*sizeof(char *));
+    batch_job = 1;
+    while ((line = read_batch_line(f)) != NULL) {
+        lineno++;
+
+        /* parse_cmdline() modifies arguments, so copy the common ones */
+        nargs = 0;
+        for (i=0; i<argc-1; i++) {
+            if ((size_t)nargs == maxargs) {
+                maxargs *= 2;
+                args = yasm_xrealloc(args, maxargs*sizeof(char *));
+            }
+            args[nargs++] = i == 0 ? argv[0] : yasm__xstrdup(argv[i+1]);
+        }
 
-    yasm_errwarns_output_all(errwarns, linemap, warning_error,
-                             print_yasm_error, print_yasm_warning);
+        if (split_batch_line(line, &args, &nargs, &maxargs)) {
+            print_error(_("%s:%lu: unterminated quote"), filename, lineno);
+            status = EXIT_FAILURE;
+        } else if (nargs > argc-1) {
+            if (run_batch_job(nargs, args) != EXIT_SUCCESS)
+                status = EXIT_FAILURE;
+            cleanup(NULL);
+        }
 
-    yasm_linemap_destroy(linemap);
-    yasm_errwarns_destroy(errwarns);
-    cleanup(object);
-    yasm_delete_include_paths();
-    return EXIT_SUCCESS;
+        for (i=1; i<argc-1; i++)
+            yasm_xfree(args[i]);
+        yasm_xfree(line);
+    }
+    batch_job = 0;
+
+    yasm_xfree(args);
+    if (f != stdin)
+        fclose(f);
+    cleanup(NULL);
+    return status;
 }
 
 /* main function */
@@ -713,10 +2049,26 @@ do_assemble(void)
 int
 main(int argc, char *argv[])
 {
-    size_t i;
+    int i;
 
     errfile = stderr;
 
+    /* Memory accounting has to be in place before anything is allocated,
+     * so look for --mem-report ahead of the rest of the command line.
+     */
+    for (i=1; i<argc && strcmp(argv[i], "--") != 0; i++) {
+        if (strcmp(argv[i], "--mem-report") == 0 ||
+            strcmp(argv[i], "-mem-report") == 0) {
+            yasm_xmalloc = mem_xmalloc;
+            yasm_xcalloc = mem_xcalloc;
+            yasm_xrealloc = mem_xrealloc;
+            yasm_xfree = mem_xfree;
+            yasm_mem_suballoc = mem_suballoc;
+            mem_report = 1;
+            break;
+        }
+    }
+
 #if defined(HAVE_SETLOCALE) && defined(HAVE_LC_MESSAGES)
     setlocale(LC_MESSAGES, "");
 #endif
@@ -725,6 +2077,20 @@ main(int argc, char *argv[])
 #endif
     textdomain(PACKAGE);
 
+#ifdef USE_SERVER
+    /* Hand the job to a server if asked to; if it can't be reached, fall
+     * through and assemble locally.
+     */
+    if (argc > 1 && strncmp(argv[1], "--client=", 9) == 0) {
+        int status = do_client(&argv[1][9], argc, argv);
+        if (status >= 0)
+            return status;
+        argv[1] = argv[0];
+        argc--;
+        argv++;
+    }
+#endif
+
     /* Initialize errwarn handling */
     yasm_internal_error_ = handle_yasm_int_error;
     yasm_fatal = handle_yasm_fatal;
@@ -753,9 +2119,33 @@ main(int argc, char *argv[])
 #endif
 #endif
 
+    if (argc > 1 && strncmp(argv[1], "--batch=", 8) == 0)
+        return do_batch(&argv[1][8], argc, argv);
+
+    return run_command(argc, argv);
+}
+
+/* Parses the command line and runs the requested action.  Called once
+ * libyasm and the modules have been initialized.
+ */
+static int
+run_command(int argc, char *argv[])
+{
+    size_t i;
+
     /* Initialize parameter storage */
     STAILQ_INIT(&preproc_options);
 
+    /* Hash the command line for the object cache before parse_cmdline()
+     * splits up long options.
+     */
+    yasm_md5_init(&cmdline_md5);
+    yasm_md5_update(&cmdline_md5, (const unsigned char *)PACKAGE_STRING,
+                    (unsigned long)strlen(PACKAGE_STRING)+1);
+    for (i=1; i<(size_t)argc; i++)
+        yasm_md5_update(&cmdline_md5, (const unsigned char *)argv[i],
+                        (unsigned long)strlen(argv[i])+1);
+
     if (parse_cmdline(argc, argv, options, NELEMS(options), print_error))
         return EXIT_FAILURE;
 
@@ -777,6 +2167,16 @@ main(int argc, char *argv[])
             return EXIT_SUCCESS;
     }
 
+#ifdef USE_SERVER
+    if (server_socket) {
+        if (server_job || batch_job || argc != 2) {
+            print_error(_("`--server' cannot be combined with other options"));
+            return EXIT_FAILURE;
+        }
+        return do_server(server_socket);
+    }
+#endif
+
     /* Open error file if specified. */
     if (error_filename) {
         errfile = open_file(error_filename, "wt");
@@ -874,6 +2274,12 @@ main(int argc, char *argv[])
         }
     }
 
+    if (cache_dir && cache_fetch()) {
+        cleanup(NULL);
+        yasm_delete_include_paths();
+        return EXIT_SUCCESS;
+    }
+
     return do_assemble();
 }
 /*@=globstate =unrecog@*/
@@ -897,10 +2303,11 @@ check_errors(yasm_errwarns *errwarns, yasm_object *object,
     if (yasm_errwarns_num_errors(errwarns, warning_error) > 0) {
         yasm_errwarns_output_all(errwarns, linemap, warning_error,
                                  print_yasm_error, print_yasm_warning);
+        print_time_report();
         yasm_linemap_destroy(linemap);
         yasm_errwarns_destroy(errwarns);
         cleanup(object);
-        exit(EXIT_FAILURE);
+        job_fail();
     }
 }
 
@@ -910,10 +2317,94 @@ check_errors(yasm_errwarns *errwarns, yasm_object *object,
  */
 #define DO_FREE         1
 
+/* Returns per-job settings to their defaults once cleanup() has freed
+ * them, so the next job in a batch starts from scratch.
+ */
+static void
+reset_job_state(void)
+{
+    obj_filename = in_filename = NULL;
+    global_prefix = global_suffix = NULL;
+    list_filename = map_filename = NULL;
+    machine_name = NULL;
+    special_options = 0;
+    cur_arch = NULL;
+    cur_arch_module = NULL;
+    cur_parser_module = NULL;
+    cur_preproc_module = NULL;
+    objfmt_keyword = NULL;
+    cur_objfmt_module = NULL;
+    cur_dbgfmt_module = NULL;
+    cur_listfmt_module = NULL;
+    preproc_only = 0;
+    force_strict = 0;
+    generate_make_dependencies = 0;
+    makedep_with_empty_recipts = 0;
+    makedep_dos2unix_slash = 0;
+    makedep_out_filename = NULL;
+    makedep_target = NULL;
+    warning_error = 0;
+    error_filename = NULL;
+    ewmsg_style = EWSTYLE_GNU;
+    cache_dir = NULL;
+    cache_store = 0;
+    time_report = 0;
+    memset(phase_times, 0, sizeof(phase_times));
+    preproc_wall = preproc_cpu = 0.0;
+    trace_filename = NULL;
+#ifdef USE_SERVER
+    server_socket = NULL;
+#endif
+
+    if (errfile != stderr && errfile != stdout)
+        fclose(errfile);
+    errfile = stderr;
+
+    yasm_delete_include_paths();
+    yasm_mem_set_category(YASM_MEM_OTHER);
+
+    /* Back to the default set of enabled warnings */
+    yasm_errwarn_cleanup();
+    yasm_errwarn_initialize();
+}
+
+/* Ends the current job in failure.  Outside of a batch, that means exiting;
+ * in a batch, control returns to the batch loop to run the next job.
+ */
+static void
+job_fail(void)
+{
+    if (batch_job)
+        longjmp(batch_job_abort, 1);
+    exit(EXIT_FAILURE);
+}
+
+/* Releases anything a preprocessor module keeps between runs. */
+static void
+cleanup_preproc_module(const char *name, const char *keyword)
+{
+    yasm_preproc_module *preproc = yasm_load_preproc(keyword);
+
+    if (preproc && preproc->cleanup)
+        preproc->cleanup();
+}
+
 /* Cleans up all allocated structures. */
 static void
 cleanup(yasm_object *object)
 {
+    constcharparam *cp, *cpnext;
+
+    /* A job that failed part way through leaves its object behind */
+    if (!object)
+        object = cur_object;
+    cur_object = NULL;
+    /* Callers free the line map and error list themselves */
+    cur_linemap = NULL;
+    cur_errwarns = NULL;
+
+    trace_close();
+
     if (DO_FREE) {
         if (cur_listfmt)
             yasm_listfmt_destroy(cur_listfmt);
@@ -921,14 +2412,9 @@ cleanup(yasm_object *object)
             yasm_preproc_destroy(cur_preproc);
         if (object)
             yasm_object_destroy(object);
-
-        yasm_floatnum_cleanup();
-        yasm_intnum_cleanup();
-
-        yasm_errwarn_cleanup();
-
-        BitVector_Shutdown();
     }
+    cur_listfmt = NULL;
+    cur_preproc = NULL;
 
     if (DO_FREE) {
         if (in_filename)
@@ -943,8 +2429,46 @@ cleanup(yasm_object *object)
             yasm_xfree(machine_name);
         if (objfmt_keyword)
             yasm_xfree(objfmt_keyword);
+        if (cache_dir)
+            yasm_xfree(cache_dir);
+        if (trace_filename)
+            yasm_xfree(trace_filename);
+        if (error_filename)
+            yasm_xfree(error_filename);
+#ifdef USE_SERVER
+        if (server_socket)
+            yasm_xfree(server_socket);
+#endif
+
+        /* Saved preprocessor options (applied by each preprocessor) */
+        cp = STAILQ_FIRST(&preproc_options);
+        while (cp != NULL) {
+            cpnext = STAILQ_NEXT(cp, link);
+            yasm_xfree(cp);
+            cp = cpnext;
+        }
+        STAILQ_INIT(&preproc_options);
+    }
+
+    /* A batch keeps the process going for the next job */
+    if (batch_job) {
+        reset_job_state();
+        return;
     }
 
+    if (DO_FREE) {
+        yasm_list_preproc(cleanup_preproc_module);
+        yasm_floatnum_cleanup();
+        yasm_intnum_cleanup();
+
+        yasm_errwarn_cleanup();
+
+        BitVector_Shutdown();
+    }
+
+    if (mem_report)
+        print_mem_report();
+
     if (errfile != stderr && errfile != stdout)
         fclose(errfile);
 #if defined(CMAKE_BUILD) && defined(BUILD_SHARED_LIBS)
@@ -1008,7 +2532,7 @@ opt_arch_handler(/*@unused@*/ char *cmd, char *param, /*@unused@*/ int extra)
         }
         print_error(_("%s: unrecognized %s `%s'"), _("FATAL"),
                     _("architecture"), param);
-        exit(EXIT_FAILURE);
+        job_fail();
     }
     return 0;
 }
@@ -1027,7 +2551,7 @@ opt_parser_handler(/*@unused@*/ char *cmd, char *param, /*@unused@*/ int extra)
         }
         print_error(_("%s: unrecognized %s `%s'"), _("FATAL"), _("parser"),
                     param);
-        exit(EXIT_FAILURE);
+        job_fail();
     }
     return 0;
 }
@@ -1046,7 +2570,7 @@ opt_preproc_handler(/*@unused@*/ char *cmd, char *param, /*@unused@*/ int extra)
         }
         print_error(_("%s: unrecognized %s `%s'"), _("FATAL"),
                     _("preprocessor"), param);
-        exit(EXIT_FAILURE);
+        job_fail();
     }
     return 0;
 }
@@ -1066,7 +2590,7 @@ opt_objfmt_handler(/*@unused@*/ char *cmd, char *param, /*@unused@*/ int extra)
         }
         print_error(_("%s: unrecognized %s `%s'"), _("FATAL"),
                     _("object format"), param);
-        exit(EXIT_FAILURE);
+        job_fail();
     }
     if (objfmt_keyword)
         yasm_xfree(objfmt_keyword);
@@ -1090,7 +2614,7 @@ opt_dbgfmt_handler(/*@unused@*/ char *cmd, char *param, /*@unused@*/ int extra)
         }
         print_error(_("%s: unrecognized %s `%s'"), _("FATAL"),
                     _("debug format"), param);
-        exit(EXIT_FAILURE);
+        job_fail();
     }
     return 0;
 }
@@ -1110,7 +2634,7 @@ opt_listfmt_handler(/*@unused@*/ char *cmd, char *param,
         }
         print_error(_("%s: unrecognized %s `%s'"), _("FATAL"),
                     _("list format"), param);
-        exit(EXIT_FAILURE);
+        job_fail();
     }
     return 0;
 }
@@ -1163,6 +2687,56 @@ opt_mapfile_handler(/*@unused@*/ char *cmd, char *param,
     return 0;
 }
 
+static int
+opt_cache_dir_handler(/*@unused@*/ char *cmd, char *param,
+                      /*@unused@*/ int extra)
+{
+    if (cache_dir)
+        yasm_xfree(cache_dir);
+
+    assert(param != NULL);
+    cache_dir = yasm__xstrdup(param);
+
+    return 0;
+}
+
+static int
+opt_trace_out_handler(/*@unused@*/ char *cmd, char *param,
+                      /*@unused@*/ int extra)
+{
+    if (trace_filename)
+        yasm_xfree(trace_filename);
+
+    assert(param != NULL);
+    trace_filename = yasm__xstrdup(param);
+
+    return 0;
+}
+
+static int
+opt_time_report_handler(/*@unused@*/ char *cmd,
+                        /*@unused@*/ /*@null@*/ char *param,
+                        /*@unused@*/ int extra)
+{
+    time_report = 1;
+    return 0;
+}
+
+static int
+opt_mem_report_handler(/*@unused@*/ char *cmd,
+                       /*@unused@*/ /*@null@*/ char *param,
+                       /*@unused@*/ int extra)
+{
+    /* Enabled in main() before anything is allocated; this is only reached
+     * otherwise in server jobs, which inherit the server's allocator, and
+     * in batch file lines.
+     */
+    if (!mem_report)
+        print_error(
+            _("warning: `--mem-report' ignored in server and batch jobs"));
+    return 0;
+}
+
 static int
 opt_machine_handler(/*@unused@*/ char *cmd, char *param,
                     /*@unused@*/ int extra)
@@ -1364,6 +2938,42 @@ opt_suffix_handler(/*@unused@*/ char *cmd, char *param, /*@unused@*/ int extra)
     return 0;
 }
 
+static int
+opt_batch_handler(/*@unused@*/ char *cmd, /*@unused@*/ char *param,
+                  /*@unused@*/ int extra)
+{
+    /* Handled in main() when given first */
+    print_error(_("%s: `--batch' must be the first option"), _("FATAL"));
+    job_fail();
+    /*@notreached@*/
+    return 0;
+}
+
+#ifdef USE_SERVER
+static int
+opt_server_handler(/*@unused@*/ char *cmd, char *param, /*@unused@*/ int extra)
+{
+    if (server_socket)
+        yasm_xfree(server_socket);
+
+    assert(param != NULL);
+    server_socket = yasm__xstrdup(param);
+
+    return 0;
+}
+
+static int
+opt_client_handler(/*@unused@*/ char *cmd, /*@unused@*/ char *param,
+                   /*@unused@*/ int extra)
+{
+    /* Handled in main() when given first */
+    print_error(_("%s: `--client' must be the first option"), _("FATAL"));
+    job_fail();
+    /*@notreached@*/
+    return 0;
+}
+#endif
+
 #if defined(CMAKE_BUILD) && defined(BUILD_SHARED_LIBS)
 static int
 opt_plugin_handler(/*@unused@*/ char *cmd, char *param,
@@ -1411,7 +3021,7 @@ apply_preproc_standard_macros(const yasm_stdmac *stdmacs)
 static void
 apply_preproc_saved_options(void)
 {
-    constcharparam *cp, *cpnext;
+    constcharparam *cp;
 
     void (*funcs[3])(yasm_preproc *, const char *);
     funcs[0] = cur_preproc_module->add_include_file;
@@ -1422,14 +3032,6 @@ apply_preproc_saved_options(void)
         if (0 <= cp->id && cp->id < 3 && funcs[cp->id])
             funcs[cp->id](cur_preproc, cp->param);
     }
-
-    cp = STAILQ_FIRST(&preproc_options);
-    while (cp != NULL) {
-        cpnext = STAILQ_NEXT(cp, link);
-        yasm_xfree(cp);
-        cp = cpnext;
-    }
-    STAILQ_INIT(&preproc_options);
 }
 
 /* Replace extension on a filename (or append one if none is present).
@@ -1530,7 +3132,8 @@ handle_yasm_fatal(const char *fmt, va_list va)
     fprintf(errfile, "yasm: %s: ", _("FATAL"));
     vfprintf(errfile, gettext(fmt), va);
     fputc('\n', errfile);
-    exit(EXIT_FAILURE);
+    trace_close();
+    job_fail();
 }
 
 static const char *
@@ -44,6 +44,8 @@ typedef unsigned long uintptr_t;
 #include <libyasm/compat-queue.h>
 
 #include <libyasm/coretype.h>
+#include <libyasm/arena.h>
+#include <libyasm/intern.h>
 #include <libyasm/valparam.h>
 
 #include <libyasm/linemap.h>
@@ -68,8 +70,10 @@ typedef unsigned long uintptr_t;
 
 #include <libyasm/file.h>
 #include <libyasm/module.h>
+#include <libyasm/assemble.h>
 
 #include <libyasm/hamt.h>
 #include <libyasm/md5.h>
+#include <libyasm/trace.h>
 
 #endif
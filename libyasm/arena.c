@@ -0,0 +1,296 @@
+/*
+ * YASM memory arenas
+ *
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "util.h"
+
+#include "coretype.h"
+#include "arena.h"
+
+
+/* Arena memory is handed out in units of one header; every allocation is
+ * preceded by a header recording the chunk it came from, its size in
+ * units, and its memory category.  Freed allocations are kept on per-size
+ * free lists for reuse.
+ *
+ * The arenas of a thread form a stack, most recently created on top; the
+ * top arena is the current one.  Destroying an arena removes it from the
+ * stack wherever it is and releases its empty chunks.  A chunk still
+ * holding allocations is released when the last of them is freed, so
+ * memory that outlives the arena's owner doesn't dangle, and an owner that
+ * destroys its arena before its structures doesn't pay for free lists.
+ */
+typedef union arena_unit {
+    struct {
+        unsigned int chunk;     /* index of owning chunk; 0 for the heap */
+        unsigned short nunits;  /* size, in units (excluding header) */
+        unsigned char category; /* yasm_mem_category */
+    } h;
+    /*@null@*/ /*@dependent@*/ union arena_unit *next;  /* free list link */
+    /* for alignment */
+    void *p;
+    long l;
+    double d;
+} arena_unit;
+
+/* Allocations larger than this many units come from the heap */
+#define ARENA_MAX_UNITS     64
+
+/* Units per chunk */
+#define ARENA_CHUNK_UNITS   8192
+
+/* Chunks are referred to by index into a per-thread table, so that a
+ * header can find its chunk (and arena) in a few bytes.
+ */
+typedef struct arena_chunk {
+    /*@null@*/ /*@dependent@*/ yasm_arena *arena;  /* NULL if slot unused */
+    /*@null@*/ /*@owned@*/ arena_unit *mem;
+    unsigned long live;     /* allocations not yet freed */
+    unsigned int next;      /* next chunk of arena, or next unused slot */
+} arena_chunk;
+
+struct yasm_arena {
+    /* arena below this one on the stack */
+    /*@null@*/ /*@dependent@*/ struct yasm_arena *below;
+
+    int destroyed;          /* released when its last chunk is */
+    unsigned int nchunks;   /* number of chunks */
+    unsigned int chunks;    /* chunk list, most recent first (0 if none) */
+
+    /* unused space at the end of the most recent chunk */
+    /*@null@*/ /*@dependent@*/ arena_unit *avail, *avail_end;
+
+    /* free lists, indexed by size in units; linked through the unit after
+     * the header, so the header keeps its chunk
+     */
+    /*@null@*/ /*@dependent@*/ arena_unit *free[ARENA_MAX_UNITS+1];
+};
+
+static YASM_THREAD_LOCAL /*@null@*/ yasm_arena *cur_arena = NULL;
+
+/* chunk table; slot 0 is never used */
+static YASM_THREAD_LOCAL /*@null@*/ /*@only@*/ arena_chunk *chunk_table = NULL;
+static YASM_THREAD_LOCAL unsigned int chunk_table_size = 0;
+static YASM_THREAD_LOCAL unsigned int chunk_unused = 0;    /* slot list */
+static YASM_THREAD_LOCAL unsigned int chunk_count = 0;     /* slots in use */
+
+
+static unsigned int
+arena_chunk_new(yasm_arena *arena)
+{
+    unsigned int i;
+    arena_chunk *chunk;
+
+    if (chunk_unused == 0) {
+        unsigned int oldsize = chunk_table_size;
+        chunk_table_size = oldsize ? oldsize*2 : 16;
+        chunk_table = yasm__xrealloc_cat(YASM_MEM_OTHER, chunk_table,
+            chunk_table_size*sizeof(arena_chunk));
+        for (i=chunk_table_size-1; i>=oldsize && i>0; i--) {
+            chunk_table[i].arena = NULL;
+            chunk_table[i].next = chunk_unused;
+            chunk_unused = i;
+        }
+    }
+
+    i = chunk_unused;
+    chunk = &chunk_table[i];
+    chunk_unused = chunk->next;
+    chunk->arena = arena;
+    chunk->mem = yasm__xmalloc_cat(YASM_MEM_ARENA,
+                                   ARENA_CHUNK_UNITS*sizeof(arena_unit));
+    chunk->live = 0;
+    chunk_count++;
+    chunk->next = arena->chunks;
+    arena->chunks = i;
+    arena->nchunks++;
+    return i;
+}
+
+/* Releases a chunk of a destroyed arena, and the arena with its last. */
+static void
+arena_chunk_release(unsigned int i)
+{
+    arena_chunk *chunk = &chunk_table[i];
+    yasm_arena *arena = chunk->arena;
+
+    yasm_xfree(chunk->mem);
+    chunk->arena = NULL;
+    chunk->next = chunk_unused;
+    chunk_unused = i;
+    if (--arena->nchunks == 0)
+        yasm_xfree(arena);
+
+    /* Don't keep the table around with no arenas to use it */
+    if (--chunk_count == 0) {
+        yasm_xfree(chunk_table);
+        chunk_table = NULL;
+        chunk_table_size = 0;
+        chunk_unused = 0;
+    }
+}
+
+yasm_arena *
+yasm_arena_create(void)
+{
+    yasm_arena *arena = yasm_xmalloc(sizeof(yasm_arena));
+    int i;
+
+    arena->destroyed = 0;
+    arena->nchunks = 0;
+    arena->chunks = 0;
+    arena->avail = NULL;
+    arena->avail_end = NULL;
+    for (i=0; i<=ARENA_MAX_UNITS; i++)
+        arena->free[i] = NULL;
+
+    arena->below = cur_arena;
+    cur_arena = arena;
+    return arena;
+}
+
+void
+yasm_arena_destroy(yasm_arena *arena)
+{
+    yasm_arena **abovep = &cur_arena;
+    unsigned int i, next;
+
+    /* Take it off the stack */
+    while (*abovep != arena)
+        abovep = &(*abovep)->below;
+    *abovep = arena->below;
+
+    arena->destroyed = 1;
+    if (arena->nchunks == 0) {
+        yasm_xfree(arena);
+        return;
+    }
+    for (i = arena->chunks; i != 0; i = next) {
+        next = chunk_table[i].next;
+        if (chunk_table[i].live == 0)
+            arena_chunk_release(i);     /* may free arena with the last */
+    }
+}
+
+void *
+yasm__arena_xmalloc(yasm_mem_category category, size_t size)
+{
+    yasm_arena *arena = cur_arena;
+    size_t nunits = (size + sizeof(arena_unit) - 1) / sizeof(arena_unit);
+    arena_unit *u;
+
+    if (nunits == 0)
+        nunits = 1;
+
+    if (!arena || nunits > ARENA_MAX_UNITS) {
+        u = yasm__xmalloc_cat(category, (nunits+1)*sizeof(arena_unit));
+        u->h.chunk = 0;
+        return u+1;
+    }
+
+    u = arena->free[nunits];
+    if (u)
+        arena->free[nunits] = u[1].next;
+    else {
+        if (!arena->avail ||
+            (size_t)(arena->avail_end - arena->avail) < nunits+1) {
+            unsigned int i = arena_chunk_new(arena);
+            arena->avail = chunk_table[i].mem;
+            arena->avail_end = arena->avail+ARENA_CHUNK_UNITS;
+        }
+        u = arena->avail;
+        arena->avail += nunits+1;
+        u->h.chunk = arena->chunks;
+        u->h.nunits = (unsigned short)nunits;
+    }
+
+    u->h.category = (unsigned char)category;
+    chunk_table[u->h.chunk].live++;
+    if (yasm_mem_suballoc)
+        yasm_mem_suballoc(category, (nunits+1)*sizeof(arena_unit), 1);
+    return u+1;
+}
+
+void *
+yasm__arena_xrealloc(yasm_mem_category category, void *oldmem, size_t size)
+{
+    arena_unit *u;
+    void *newmem;
+    size_t oldsize;
+
+    if (!oldmem)
+        return yasm__arena_xmalloc(category, size);
+
+    u = (arena_unit *)oldmem - 1;
+    if (u->h.chunk == 0) {
+        size_t nunits = (size + sizeof(arena_unit) - 1) / sizeof(arena_unit);
+        if (nunits == 0)
+            nunits = 1;
+        u = yasm__xrealloc_cat(category, u, (nunits+1)*sizeof(arena_unit));
+        return u+1;
+    }
+
+    oldsize = u->h.nunits*sizeof(arena_unit);
+    if (size <= oldsize)
+        return oldmem;
+
+    newmem = yasm__arena_xmalloc(category, size);
+    memcpy(newmem, oldmem, oldsize);
+    yasm__arena_xfree(oldmem);
+    return newmem;
+}
+
+void
+yasm__arena_xfree(void *p)
+{
+    arena_unit *u;
+    arena_chunk *chunk;
+    yasm_arena *arena;
+    unsigned int nunits;
+
+    if (!p)
+        return;
+
+    u = (arena_unit *)p - 1;
+    if (u->h.chunk == 0) {
+        yasm_xfree(u);
+        return;
+    }
+
+    chunk = &chunk_table[u->h.chunk];
+    arena = chunk->arena;
+    nunits = u->h.nunits;
+    if (yasm_mem_suballoc)
+        yasm_mem_suballoc((yasm_mem_category)u->h.category,
+                          (nunits+1)*sizeof(arena_unit), 0);
+    chunk->live--;
+    if (arena->destroyed) {
+        if (chunk->live == 0)
+            arena_chunk_release(u->h.chunk);
+        return;
+    }
+    u[1].next = arena->free[nunits];
+    arena->free[nunits] = u;
+}
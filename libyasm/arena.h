@@ -0,0 +1,89 @@
+/**
+ * \file libyasm/arena.h
+ * \brief YASM memory arena interface.
+ *
+ * \license
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ * \endlicense
+ */
+#ifndef YASM_ARENA_H
+#define YASM_ARENA_H
+
+#ifndef YASM_LIB_DECL
+#define YASM_LIB_DECL
+#endif
+
+/** Create a new, empty memory arena, which becomes the arena that following
+ * yasm__arena_xmalloc() calls (in the current thread) allocate from.  Each
+ * #yasm_object owns an arena, which is current while the object exists.
+ * \return Newly allocated arena.
+ */
+YASM_LIB_DECL
+/*@only@*/ yasm_arena *yasm_arena_create(void);
+
+/** Destroy an arena.  Arenas need not be destroyed in the reverse order of
+ * creation: the most recently created arena that remains becomes (or stays)
+ * current, or the heap if there is none.  Chunks with nothing allocated
+ * from them are released at once, and the rest as soon as what was
+ * allocated from them is freed; memory is no longer kept for reuse.  An
+ * owner can therefore destroy its arena before freeing its own structures.
+ * \param arena     arena
+ */
+YASM_LIB_DECL
+void yasm_arena_destroy(/*@only@*/ yasm_arena *arena);
+
+/** Allocate memory from the current arena, or with yasm_xmalloc() if there
+ * is no current arena or the request is large.  Memory allocated this way
+ * must only be resized with yasm__arena_xrealloc() and released with
+ * yasm__arena_xfree(); it may outlive the arena's owner.
+ * \internal
+ * \param category  memory category
+ * \param size      number of bytes to allocate
+ * \return Allocated memory block.
+ */
+YASM_LIB_DECL
+/*@only@*/ /*@out@*/ void *yasm__arena_xmalloc(yasm_mem_category category,
+                                               size_t size);
+
+/** Resize memory allocated with yasm__arena_xmalloc().
+ * \internal
+ * \param category  memory category
+ * \param oldmem    memory block to resize; may be NULL
+ * \param size      new size, in bytes
+ * \return Re-allocated memory block.
+ */
+YASM_LIB_DECL
+/*@only@*/ void *yasm__arena_xrealloc(yasm_mem_category category,
+                                      /*@only@*/ /*@null@*/ void *oldmem,
+                                      size_t size);
+
+/** Release memory allocated with yasm__arena_xmalloc().  Memory is kept in
+ * its arena for reuse by later allocations of a similar size.
+ * \internal
+ * \param p         memory block to release; may be NULL
+ */
+YASM_LIB_DECL
+void yasm__arena_xfree(/*@only@*/ /*@null@*/ void *p);
+
+#endif
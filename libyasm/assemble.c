@@ -0,0 +1,427 @@
+/*
+ * YASM in-memory assembly
+ *
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "util.h"
+
+#include <setjmp.h>
+
+#include "libyasm-stdint.h"
+#include "coretype.h"
+#include "hamt.h"
+#include "valparam.h"
+
+#include "linemap.h"
+#include "errwarn.h"
+#include "expr.h"
+#include "symrec.h"
+
+#include "section.h"
+#include "arch.h"
+#include "dbgfmt.h"
+#include "objfmt.h"
+#include "parser.h"
+#include "preproc.h"
+
+#include "file.h"
+#include "module.h"
+#include "assemble.h"
+
+
+/* Messages collected for the caller */
+static YASM_THREAD_LOCAL /*@null@*/ char *messages_buf = NULL;
+static YASM_THREAD_LOCAL size_t messages_len = 0;
+static YASM_THREAD_LOCAL size_t messages_size = 0;
+
+static void
+add_message_str(const char *str)
+{
+    size_t len = strlen(str);
+
+    if (messages_len + len + 1 > messages_size) {
+        if (messages_size == 0)
+            messages_size = 256;
+        while (messages_len + len + 1 > messages_size)
+            messages_size *= 2;
+        messages_buf = yasm_xrealloc(messages_buf, messages_size);
+    }
+    memcpy(messages_buf + messages_len, str, len + 1);
+    messages_len += len;
+}
+
+static void
+add_message(/*@null@*/ const char *fn, unsigned long line, const char *kind,
+            const char *msg)
+{
+    char linestr[24];
+
+    if (fn) {
+        add_message_str(fn);
+        if (line) {
+            sprintf(linestr, ":%lu", line);
+            add_message_str(linestr);
+        }
+        add_message_str(": ");
+    }
+    add_message_str(yasm_gettext_hook(kind));
+    add_message_str(msg);
+    add_message_str("\n");
+}
+
+static void
+assemble_print_error(const char *fn, unsigned long line, const char *msg,
+                     const char *xref_fn, unsigned long xref_line,
+                     const char *xref_msg)
+{
+    add_message(fn, line, N_("error: "), msg);
+    if (xref_fn && xref_msg)
+        add_message(xref_fn, xref_line, N_("error: "), xref_msg);
+}
+
+static void
+assemble_print_warning(const char *fn, unsigned long line, const char *msg)
+{
+    add_message(fn, line, N_("warning: "), msg);
+}
+
+/* Reports an error not tied to a source line. */
+static void
+assemble_error(const char *what, const char *name)
+{
+    add_message_str(yasm_gettext_hook(N_("error: ")));
+    add_message_str(yasm_gettext_hook(what));
+    add_message_str(" `");
+    add_message_str(name);
+    add_message_str("'\n");
+}
+
+/* Largest fatal error message kept */
+#define FATAL_MAXSIZE   1024
+
+/* Fatal errors during yasm_assemble_memory() return to it from here */
+static YASM_THREAD_LOCAL /*@null@*/ jmp_buf *fatal_jmp = NULL;
+
+/* Handler for fatal errors outside yasm_assemble_memory() */
+static /*@exits@*/ void (*prev_fatal) (const char *message, va_list va);
+
+static void
+assemble_fatal(const char *fmt, va_list va)
+{
+    char msg[FATAL_MAXSIZE+1];
+
+    if (!fatal_jmp) {
+        prev_fatal(fmt, va);
+        return;
+    }
+#ifdef HAVE_VSNPRINTF
+    vsnprintf(msg, FATAL_MAXSIZE, yasm_gettext_hook(fmt), va);
+#else
+    vsprintf(msg, yasm_gettext_hook(fmt), va);
+#endif
+    add_message(NULL, 0, N_("fatal: "), msg);
+    longjmp(*fatal_jmp, 1);
+}
+
+/* What yasm_assemble_memory() has to release, however it stops */
+typedef struct assemble_state {
+    /*@null@*/ yasm_arch *arch;     /* until the object owns it */
+    /*@null@*/ yasm_object *object;
+    /*@null@*/ yasm_preproc *preproc;
+    /*@null@*/ yasm_linemap *linemap;
+    /*@null@*/ yasm_errwarns *errwarns;
+    /*@null@*/ FILE *out;           /* while output is being written */
+    /*@null@*/ unsigned char *outbuf;
+    size_t outlen;
+} assemble_state;
+
+static void
+apply_standard_macros(yasm_preproc *preproc, const yasm_stdmac *stdmacs,
+                      const char *parser, const char *preproc_keyword)
+{
+    int i, matched = -1;
+
+    if (!stdmacs)
+        return;
+
+    for (i=0; stdmacs[i].parser; i++)
+        if (yasm__strcasecmp(stdmacs[i].parser, parser) == 0 &&
+            yasm__strcasecmp(stdmacs[i].preproc, preproc_keyword) == 0)
+            matched = i;
+    if (matched >= 0 && stdmacs[matched].macros)
+        yasm_preproc_add_standard(preproc, stdmacs[matched].macros);
+}
+
+/* Runs an assembly, leaving what it allocated in st for the caller to
+ * release.  Returns nonzero if there were errors.
+ */
+static int
+assemble(assemble_state *st, const char *source, size_t source_len,
+         const yasm_assemble_options *options)
+{
+    const char *keyword, *objfmt_keyword, *machine, *source_name, *obj_name;
+    const yasm_arch_module *arch_module;
+    const yasm_parser_module *parser_module;
+    const yasm_preproc_module *preproc_module;
+    const yasm_objfmt_module *objfmt_module;
+    const yasm_dbgfmt_module *dbgfmt_module;
+    yasm_arch_create_error arch_error;
+    yasm_object *object;
+    yasm_preproc *preproc;
+    yasm_errwarns *errwarns;
+    char *predef;
+    int i, matched;
+
+    /* Load modules */
+    keyword = options->arch ? options->arch : "x86";
+    arch_module = yasm_load_arch(keyword);
+    if (!arch_module) {
+        assemble_error(N_("unrecognized architecture"), keyword);
+        return 1;
+    }
+    keyword = options->parser ? options->parser : "nasm";
+    parser_module = yasm_load_parser(keyword);
+    if (!parser_module) {
+        assemble_error(N_("unrecognized parser"), keyword);
+        return 1;
+    }
+    keyword = options->preproc ? options->preproc :
+        parser_module->default_preproc_keyword;
+    preproc_module = yasm_load_preproc(keyword);
+    if (!preproc_module) {
+        assemble_error(N_("unrecognized preprocessor"), keyword);
+        return 1;
+    }
+    objfmt_keyword = options->objfmt ? options->objfmt : "bin";
+    objfmt_module = yasm_load_objfmt(objfmt_keyword);
+    if (!objfmt_module) {
+        assemble_error(N_("unrecognized object format"), objfmt_keyword);
+        return 1;
+    }
+    keyword = options->dbgfmt ? options->dbgfmt : "null";
+    dbgfmt_module = yasm_load_dbgfmt(keyword);
+    if (!dbgfmt_module) {
+        assemble_error(N_("unrecognized debug format"), keyword);
+        return 1;
+    }
+
+    matched = 0;
+    for (i=0; parser_module->preproc_keywords[i]; i++)
+        if (yasm__strcasecmp(parser_module->preproc_keywords[i],
+                             preproc_module->keyword) == 0)
+            matched = 1;
+    if (!matched) {
+        assemble_error(N_("preprocessor not valid for parser"),
+                       preproc_module->keyword);
+        return 1;
+    }
+
+    /* Same machine defaults as the frontend */
+    if (options->machine)
+        machine = options->machine;
+    else if (yasm__strcasecmp(arch_module->keyword, "x86") == 0 &&
+             objfmt_module->default_x86_mode_bits == 64)
+        machine = "amd64";
+    else
+        machine = arch_module->default_machine_keyword;
+    if (yasm__strcasecmp(machine, "amd64") == 0 &&
+        yasm__strcasecmp(objfmt_module->keyword, "elfx32") == 0)
+        machine = "x32";
+
+    st->arch = yasm_arch_create(arch_module, machine, parser_module->keyword,
+                            &arch_error);
+    if (!st->arch) {
+        assemble_error(arch_error == YASM_ARCH_CREATE_BAD_PARSER ?
+                       N_("parser not valid for architecture") :
+                       N_("machine not valid for architecture"),
+                       arch_error == YASM_ARCH_CREATE_BAD_PARSER ?
+                       parser_module->keyword : machine);
+        return 1;
+    }
+
+    source_name = options->source_name ? options->source_name : "<memory>";
+    obj_name = options->obj_name ? options->obj_name : source_name;
+    object = yasm_object_create(source_name, obj_name, st->arch,
+                                objfmt_module, dbgfmt_module);
+    if (!object) {
+        yasm_error_class eclass;
+        unsigned long xrefline;
+        /*@only@*/ /*@null@*/ char *estr, *xrefstr;
+
+        yasm_error_fetch(&eclass, &estr, &xrefline, &xrefstr);
+        add_message(NULL, 0, N_("error: "), estr ? estr : "");
+        yasm_xfree(estr);
+        yasm_xfree(xrefstr);
+        return 1;
+    }
+    st->object = object;
+    st->arch = NULL;        /* owned by the object */
+    objfmt_module = ((yasm_objfmt_base *)object->objfmt)->module;
+
+    st->linemap = yasm_linemap_create();
+    yasm_linemap_set(st->linemap, source_name, 0, 1, 1);
+    st->errwarns = errwarns = yasm_errwarns_create();
+
+    /* The preprocessor reads the source through yasm_fopen_source() */
+    yasm__set_memory_source(source_name, source, source_len);
+    st->preproc = preproc = yasm_preproc_create(preproc_module, source_name,
+                                                object->symtab, st->linemap,
+                                                errwarns);
+
+    predef = yasm_xmalloc(strlen("__YASM_OBJFMT__=")
+                          + strlen(objfmt_keyword) + 1);
+    strcpy(predef, "__YASM_OBJFMT__=");
+    strcat(predef, objfmt_keyword);
+    yasm_preproc_define_builtin(preproc, predef);
+    yasm_xfree(predef);
+    apply_standard_macros(preproc, parser_module->stdmacs,
+                          parser_module->keyword, preproc_module->keyword);
+    apply_standard_macros(preproc, objfmt_module->stdmacs,
+                          parser_module->keyword, preproc_module->keyword);
+    if (options->predefines) {
+        for (i=0; options->predefines[i]; i++)
+            yasm_preproc_predefine_macro(preproc, options->predefines[i]);
+    }
+
+    if (yasm__strcasecmp(arch_module->keyword, "x86") == 0)
+        yasm_arch_set_var(object->arch, "mode_bits",
+                          objfmt_module->default_x86_mode_bits);
+
+    parser_module->do_parse(object, preproc, 0, st->linemap, errwarns);
+    yasm__set_memory_source(NULL, NULL, 0);
+    if (yasm_errwarns_num_errors(errwarns, options->warning_error) > 0)
+        return 1;
+
+    yasm_object_finalize(object, errwarns);
+    if (yasm_errwarns_num_errors(errwarns, options->warning_error) > 0)
+        return 1;
+    yasm_object_compact(object);
+
+    yasm_object_optimize(object, errwarns);
+    if (yasm_errwarns_num_errors(errwarns, options->warning_error) > 0)
+        return 1;
+
+    yasm_dbgfmt_generate(object, st->linemap, errwarns);
+    if (yasm_errwarns_num_errors(errwarns, options->warning_error) > 0)
+        return 1;
+
+    st->out = yasm_fopen_memory_write(&st->outbuf, &st->outlen);
+    if (!st->out) {
+        add_message(NULL, 0, N_("error: "),
+                    yasm_gettext_hook(N_("memory output not supported")));
+        return 1;
+    }
+    yasm_objfmt_output(object, st->out,
+                       yasm__strcasecmp(dbgfmt_module->keyword, "null"),
+                       errwarns);
+    fclose(st->out);
+    st->out = NULL;
+    return yasm_errwarns_num_errors(errwarns, options->warning_error) > 0;
+}
+
+int
+yasm_assemble_memory(const char *source, size_t source_len,
+                     const yasm_assemble_options *options,
+                     unsigned char **output, size_t *output_len,
+                     char **messages)
+{
+    static const yasm_assemble_options default_options;
+    assemble_state st;
+    jmp_buf fatal_env;
+    int errors;
+
+    if (!options)
+        options = &default_options;
+    *output = NULL;
+    *output_len = 0;
+    if (messages)
+        *messages = NULL;
+    if (messages_buf) {
+        yasm_xfree(messages_buf);
+        messages_buf = NULL;
+    }
+    messages_len = 0;
+    messages_size = 0;
+
+    st.arch = NULL;
+    st.object = NULL;
+    st.preproc = NULL;
+    st.linemap = NULL;
+    st.errwarns = NULL;
+    st.out = NULL;
+    st.outbuf = NULL;
+    st.outlen = 0;
+
+    if (yasm_fatal != assemble_fatal) {
+        prev_fatal = yasm_fatal;
+        yasm_fatal = assemble_fatal;
+    }
+    if (setjmp(fatal_env) == 0) {
+        fatal_jmp = &fatal_env;
+        errors = assemble(&st, source, source_len, options);
+    } else {
+        /* A fatal error; assemble_fatal() recorded the message */
+        yasm_error_clear();
+        yasm_warn_clear();
+        if (st.out)
+            fclose(st.out);
+        errors = 1;
+    }
+    fatal_jmp = NULL;
+
+    yasm__set_memory_source(NULL, NULL, 0);
+    if (st.errwarns) {
+        yasm_errwarns_output_all(st.errwarns, st.linemap,
+                                 options->warning_error,
+                                 assemble_print_error,
+                                 assemble_print_warning);
+        yasm_errwarns_destroy(st.errwarns);
+    }
+    if (st.preproc)
+        yasm_preproc_destroy(st.preproc);
+    if (st.object)
+        yasm_object_destroy(st.object);
+    if (st.arch)
+        yasm_arch_destroy(st.arch);
+    if (st.linemap)
+        yasm_linemap_destroy(st.linemap);
+
+    if (!errors) {
+        *output = st.outbuf;
+        *output_len = st.outlen;
+    } else if (st.outbuf)
+        yasm_xfree(st.outbuf);
+
+    if (messages && messages_len > 0) {
+        *messages = yasm_xmalloc(messages_len + 1);
+        memcpy(*messages, messages_buf, messages_len + 1);
+    }
+    if (messages_buf) {
+        yasm_xfree(messages_buf);
+        messages_buf = NULL;
+    }
+    messages_len = 0;
+    messages_size = 0;
+    return errors;
+}
@@ -0,0 +1,100 @@
+/**
+ * \file libyasm/assemble.h
+ * \brief YASM in-memory assembly interface.
+ *
+ * \license
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ * \endlicense
+ */
+#ifndef YASM_ASSEMBLE_H
+#define YASM_ASSEMBLE_H
+
+#ifndef YASM_LIB_DECL
+#define YASM_LIB_DECL
+#endif
+
+/** Options for yasm_assemble_memory().  Set unused fields to zero/NULL to
+ * get the same defaults as the yasm command line frontend.
+ */
+typedef struct yasm_assemble_options {
+    /*@null@*/ const char *arch;        /**< Architecture (x86). */
+    /*@null@*/ const char *machine;     /**< Machine (architecture default). */
+    /*@null@*/ const char *parser;      /**< Parser (nasm). */
+    /*@null@*/ const char *preproc;     /**< Preprocessor (parser default). */
+    /*@null@*/ const char *objfmt;      /**< Object format (bin). */
+    /*@null@*/ const char *dbgfmt;      /**< Debug format (null). */
+
+    /** Source filename used in messages and debug information
+     * ("<memory>").
+     */
+    /*@null@*/ const char *source_name;
+
+    /** Object filename, for object formats that record it (source
+     * filename).
+     */
+    /*@null@*/ const char *obj_name;
+
+    /** NULL-terminated list of macros to predefine, each in "name" or
+     * "name=value" form (none).
+     */
+    /*@null@*/ const char * const *predefines;
+
+    int warning_error;          /**< Treat warnings as errors (no). */
+} yasm_assemble_options;
+
+/** Assemble source held in memory into an object file (or flat binary)
+ * held in memory, without touching the filesystem for either.  This runs
+ * the same steps as the yasm command line frontend.
+ *
+ * libyasm must have been initialized as for the frontends:
+ * BitVector_Boot(), yasm_intnum_initialize(), yasm_floatnum_initialize(),
+ * and yasm_errwarn_initialize() (and the standard modules loaded, when
+ * they are built as a plugin).  Fatal errors (such as a missing include
+ * file) end the assembly and are reported with the other messages, rather
+ * than exiting.  To do so, the first call replaces #yasm_fatal with a
+ * handler that passes fatal errors outside yasm_assemble_memory() on to
+ * the handler it replaced.
+ *
+ * \note Requires memory stream support from the C library (fopencookie()
+ *       or funopen()); otherwise this always fails.
+ * \param source        source text
+ * \param source_len    length of source text, in bytes
+ * \param options       assembly options; NULL selects all defaults
+ * \param output        on success, the output (allocated with
+ *                      yasm_xmalloc(); caller frees); NULL on failure
+ * \param output_len    on success, length of output, in bytes
+ * \param messages      if not NULL, receives the error and warning
+ *                      messages as text, one per line (allocated with
+ *                      yasm_xmalloc(); caller frees), or NULL if there were
+ *                      none
+ * \return 0 on success, nonzero if there were errors.
+ */
+YASM_LIB_DECL
+int yasm_assemble_memory(const char *source, size_t source_len,
+                         /*@null@*/ const yasm_assemble_options *options,
+                         /*@out@*/ unsigned char **output,
+                         /*@out@*/ size_t *output_len,
+                         /*@null@*/ /*@out@*/ char **messages);
+
+#endif
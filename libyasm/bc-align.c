@@ -28,6 +28,7 @@
 
 #include "libyasm-stdint.h"
 #include "coretype.h"
+#include "arena.h"
 
 #include "errwarn.h"
 #include "intnum.h"
@@ -70,7 +71,8 @@ static const yasm_bytecode_callback bc_align_callback = {
     bc_align_calc_len,
     bc_align_expand,
     bc_align_tobytes,
-    YASM_BC_SPECIAL_OFFSET
+    YASM_BC_SPECIAL_OFFSET,
+    NULL
 };
 
 
@@ -84,7 +86,7 @@ bc_align_destroy(void *contents)
         yasm_expr_destroy(align->fill);
     if (align->maxskip)
         yasm_expr_destroy(align->maxskip);
-    yasm_xfree(contents);
+    yasm__arena_xfree(contents);
 }
 
 static void
@@ -234,7 +236,8 @@ yasm_bc_create_align(yasm_expr *boundary, yasm_expr *fill,
                      yasm_expr *maxskip, const unsigned char **code_fill,
                      unsigned long line)
 {
-    bytecode_align *align = yasm_xmalloc(sizeof(bytecode_align));
+    bytecode_align *align = yasm__arena_xmalloc(YASM_MEM_BYTECODE,
+                                                sizeof(bytecode_align));
 
     align->boundary = boundary;
     align->fill = fill;
@@ -28,6 +28,7 @@
 
 #include "libyasm-stdint.h"
 #include "coretype.h"
+#include "arena.h"
 
 #include "errwarn.h"
 #include "intnum.h"
@@ -36,7 +37,13 @@
 
 #include "bytecode.h"
 #include "arch.h"
+#include "section.h"
 
+/* Data values are accounted to YASM_MEM_BYTECODE */
+#define bc_xmalloc(size)    yasm__xmalloc_cat(YASM_MEM_BYTECODE, size)
+
+/* Data values are allocated from the current arena */
+#define dv_xmalloc(size)    yasm__arena_xmalloc(YASM_MEM_BYTECODE, size)
 
 struct yasm_dataval {
     /*@reldef@*/ STAILQ_ENTRY(yasm_dataval) link;
@@ -73,6 +80,7 @@ static int bc_data_tobytes(yasm_bytecode *bc, unsigned char **bufp,
                            unsigned char *bufstart, void *d,
                            yasm_output_value_func output_value,
                            /*@null@*/ yasm_output_reloc_func output_reloc);
+static void bc_data_compact(yasm_bytecode *bc);
 
 static const yasm_bytecode_callback bc_data_callback = {
     bc_data_destroy,
@@ -82,7 +90,8 @@ static const yasm_bytecode_callback bc_data_callback = {
     bc_data_calc_len,
     yasm_bc_expand_common,
     bc_data_tobytes,
-    0
+    0,
+    bc_data_compact
 };
 
 
@@ -91,7 +100,7 @@ bc_data_destroy(void *contents)
 {
     bytecode_data *bc_data = (bytecode_data *)contents;
     yasm_dvs_delete(&bc_data->datahead);
-    yasm_xfree(contents);
+    yasm__arena_xfree(contents);
 }
 
 static void
@@ -259,11 +268,119 @@ bc_data_tobytes(yasm_bytecode *bc, unsigned char **bufp,
     return 0;
 }
 
+/* Returns nonzero if a finalized value is a plain constant, i.e. one that
+ * yasm_value_output_basic() can output without knowing any offsets.
+ */
+static int
+dv_value_is_constant(yasm_value *val)
+{
+    if (val->rel || val->wrt || val->seg_of || val->rshift || val->curpos_rel
+        || val->ip_rel || val->section_rel)
+        return 0;
+    if (!val->abs)
+        return 1;
+    if (val->abs->op == YASM_EXPR_IDENT
+        && val->abs->terms[0].type == YASM_EXPR_FLOAT)
+        return 1;
+    return yasm_expr_get_intnum(&val->abs, 0) != NULL;
+}
+
+static void
+bc_data_compact(yasm_bytecode *bc)
+{
+    bytecode_data *bc_data = (bytecode_data *)bc->contents;
+    /*@null@*/ yasm_arch *arch = NULL;
+    yasm_dataval *dv, *dv2, *run, *next;
+    yasm_intnum *intn;
+    unsigned char *buf;
+    unsigned long len;
+    int sign;
+
+    if (bc->section)
+        arch = yasm_section_get_object(bc->section)->arch;
+
+    /* Values that only became constant during finalization (floats and
+     * forward references to EQUs) are converted to raw bytes here, so their
+     * expressions can be released.  Anything that doesn't convert cleanly
+     * is left for output to report.
+     */
+    STAILQ_FOREACH(dv, &bc_data->datahead, link) {
+        switch (dv->type) {
+            case DV_VALUE:
+                if (!arch || !dv_value_is_constant(&dv->data.val))
+                    break;
+                len = dv->data.val.size/8;
+                buf = bc_xmalloc(len);
+                if (yasm_value_output_basic(&dv->data.val, buf, len, bc, 1,
+                                            arch) != 1
+                    || yasm_error_occurred() || yasm_warn_occurred()) {
+                    yasm_error_clear();
+                    yasm_warn_clear();
+                    yasm_xfree(buf);
+                    break;
+                }
+                yasm_value_delete(&dv->data.val);
+                dv->type = DV_RAW;
+                dv->data.raw.contents = buf;
+                dv->data.raw.len = len;
+                break;
+            case DV_ULEB128:
+            case DV_SLEB128:
+                intn = yasm_expr_get_intnum(&dv->data.val.abs, 0);
+                if (!intn)
+                    break;
+                sign = dv->type == DV_SLEB128;
+                len = yasm_intnum_size_leb128(intn, sign);
+                buf = bc_xmalloc(len);
+                yasm_intnum_get_leb128(intn, buf, sign);
+                yasm_value_delete(&dv->data.val);
+                dv->type = DV_RAW;
+                dv->data.raw.contents = buf;
+                dv->data.raw.len = len;
+                break;
+            default:
+                break;
+        }
+    }
+
+    /* Merge runs of raw data into a single dataval. */
+    dv = STAILQ_FIRST(&bc_data->datahead);
+    yasm_dvs_initialize(&bc_data->datahead);
+    while (dv) {
+        run = dv;
+        len = 0;
+        for (next = dv; next && next->type == DV_RAW && !next->multiple;
+             next = STAILQ_NEXT(next, link))
+            len += next->data.raw.len;
+
+        if (next != run && next != STAILQ_NEXT(run, link)) {
+            buf = bc_xmalloc(len);
+            len = 0;
+            while (dv != next) {
+                memcpy(&buf[len], dv->data.raw.contents, dv->data.raw.len);
+                len += dv->data.raw.len;
+                yasm_xfree(dv->data.raw.contents);
+                dv2 = STAILQ_NEXT(dv, link);
+                if (dv != run)
+                    yasm__arena_xfree(dv);
+                dv = dv2;
+            }
+            run->data.raw.contents = buf;
+            run->data.raw.len = len;
+        } else
+            next = STAILQ_NEXT(run, link);
+
+        STAILQ_INSERT_TAIL(&bc_data->datahead, run, link);
+        dv = next;
+    }
+}
+
 yasm_bytecode *
 yasm_bc_create_data(yasm_datavalhead *datahead, unsigned int size,
                     int append_zero, yasm_arch *arch, unsigned long line)
 {
-    bytecode_data *data = yasm_xmalloc(sizeof(bytecode_data));
+    bytecode_data *data = yasm__arena_xmalloc(YASM_MEM_BYTECODE,
+                                              sizeof(bytecode_data));
     yasm_bytecode *bc = yasm_bc_create_common(&bc_data_callback, data, line);
     yasm_dataval *dv, *dv2, *dvo;
     yasm_intnum *intn;
@@ -279,7 +396,7 @@ yasm_bc_create_data(yasm_datavalhead *datahead, unsigned int size,
     STAILQ_FOREACH(dv, datahead, link) {
         if (dv->multiple && dv->type != DV_EMPTY && len > 0) {
             /* Flush previous data */
-            dvo = yasm_dv_create_raw(yasm_xmalloc(len), len);
+            dvo = yasm_dv_create_raw(bc_xmalloc(len), len);
             STAILQ_INSERT_TAIL(&data->datahead, dvo, link);
             len = 0;
         }
@@ -299,13 +416,13 @@ yasm_bc_create_data(yasm_datavalhead *datahead, unsigned int size,
                 else {
                     if (len > 0) {
                         /* Create bytecode for all previous len */
-                        dvo = yasm_dv_create_raw(yasm_xmalloc(len), len);
+                        dvo = yasm_dv_create_raw(bc_xmalloc(len), len);
                         STAILQ_INSERT_TAIL(&data->datahead, dvo, link);
                         len = 0;
                     }
 
                     /* Create bytecode for this value */
-                    dvo = yasm_xmalloc(sizeof(yasm_dataval));
+                    dvo = dv_xmalloc(sizeof(yasm_dataval));
                     STAILQ_INSERT_TAIL(&data->datahead, dvo, link);
                     dvo->multiple = dv->multiple;
                 }
@@ -323,7 +440,7 @@ yasm_bc_create_data(yasm_datavalhead *datahead, unsigned int size,
 
         if (dv->multiple && dv->type != DV_EMPTY && len > 0) {
             /* Flush this data */
-            dvo = yasm_dv_create_raw(yasm_xmalloc(len), len);
+            dvo = yasm_dv_create_raw(bc_xmalloc(len), len);
             STAILQ_INSERT_TAIL(&data->datahead, dvo, link);
             dvo->multiple = dv->multiple;
             len = 0;
@@ -335,7 +452,7 @@ yasm_bc_create_data(yasm_datavalhead *datahead, unsigned int size,
 
     /* Create final dataval for any trailing length */
     if (len > 0) {
-        dvo = yasm_dv_create_raw(yasm_xmalloc(len), len);
+        dvo = yasm_dv_create_raw(bc_xmalloc(len), len);
         STAILQ_INSERT_TAIL(&data->datahead, dvo, link);
     }
 
@@ -414,7 +531,7 @@ yasm_bc_create_data(yasm_datavalhead *datahead, unsigned int size,
         if (append_zero)
             dvo->data.raw.contents[len++] = 0;
         dv2 = STAILQ_NEXT(dv, link);
-        yasm_xfree(dv);
+        yasm__arena_xfree(dv);
         dv = dv2;
     }
 
@@ -447,7 +564,7 @@ yasm_bc_create_leb128(yasm_datavalhead *datahead, int sign, unsigned long line)
 yasm_dataval *
 yasm_dv_create_expr(yasm_expr *e)
 {
-    yasm_dataval *retval = yasm_xmalloc(sizeof(yasm_dataval));
+    yasm_dataval *retval = dv_xmalloc(sizeof(yasm_dataval));
 
     retval->type = DV_VALUE;
     yasm_value_initialize(&retval->data.val, e, 0);
@@ -459,7 +576,7 @@ yasm_dv_create_expr(yasm_expr *e)
 yasm_dataval *
 yasm_dv_create_raw(unsigned char *contents, unsigned long len)
 {
-    yasm_dataval *retval = yasm_xmalloc(sizeof(yasm_dataval));
+    yasm_dataval *retval = dv_xmalloc(sizeof(yasm_dataval));
 
     retval->type = DV_RAW;
     retval->data.raw.contents = contents;
@@ -472,7 +589,7 @@ yasm_dv_create_raw(unsigned char *contents, unsigned long len)
 yasm_dataval *
 yasm_dv_create_reserve(void)
 {
-    yasm_dataval *retval = yasm_xmalloc(sizeof(yasm_dataval));
+    yasm_dataval *retval = dv_xmalloc(sizeof(yasm_dataval));
 
     retval->type = DV_RESERVE;
     retval->multiple = NULL;
@@ -540,7 +657,7 @@ yasm_dvs_delete(yasm_datavalhead *headp)
         }
         if (cur->multiple)
             yasm_expr_destroy(cur->multiple);
-        yasm_xfree(cur);
+        yasm__arena_xfree(cur);
         cur = next;
     }
     STAILQ_INIT(headp);
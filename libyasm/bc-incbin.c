@@ -28,6 +28,7 @@
 
 #include "libyasm-stdint.h"
 #include "coretype.h"
+#include "arena.h"
 
 #include "linemap.h"
 
@@ -70,7 +71,8 @@ static const yasm_bytecode_callback bc_incbin_callback = {
     bc_incbin_calc_len,
     yasm_bc_expand_common,
     bc_incbin_tobytes,
-    0
+    0,
+    NULL
 };
 
 
@@ -81,7 +83,7 @@ bc_incbin_destroy(void *contents)
     yasm_xfree(incbin->filename);
     yasm_expr_destroy(incbin->start);
     yasm_expr_destroy(incbin->maxlen);
-    yasm_xfree(contents);
+    yasm__arena_xfree(contents);
 }
 
 static void
@@ -249,7 +251,8 @@ yasm_bytecode *
 yasm_bc_create_incbin(char *filename, yasm_expr *start, yasm_expr *maxlen,
                       yasm_linemap *linemap, unsigned long line)
 {
-    bytecode_incbin *incbin = yasm_xmalloc(sizeof(bytecode_incbin));
+    bytecode_incbin *incbin = yasm__arena_xmalloc(YASM_MEM_BYTECODE,
+                                                  sizeof(bytecode_incbin));
     unsigned long xline;
 
     /* Find from filename based on line number */
@@ -28,6 +28,7 @@
 
 #include "libyasm-stdint.h"
 #include "coretype.h"
+#include "arena.h"
 #include "file.h"
 
 #include "errwarn.h"
@@ -64,14 +65,15 @@ static const yasm_bytecode_callback bc_org_callback = {
     bc_org_calc_len,
     bc_org_expand,
     bc_org_tobytes,
-    YASM_BC_SPECIAL_OFFSET
+    YASM_BC_SPECIAL_OFFSET,
+    NULL
 };
 
 
 static void
 bc_org_destroy(void *contents)
 {
-    yasm_xfree(contents);
+    yasm__arena_xfree(contents);
 }
 
 static void
@@ -143,7 +145,8 @@ bc_org_tobytes(yasm_bytecode *bc, unsigned char **bufp,
 yasm_bytecode *
 yasm_bc_create_org(unsigned long start, unsigned long fill, unsigned long line)
 {
-    bytecode_org *org = yasm_xmalloc(sizeof(bytecode_org));
+    bytecode_org *org = yasm__arena_xmalloc(YASM_MEM_BYTECODE,
+                                            sizeof(bytecode_org));
 
     org->start = start;
     org->fill = fill;
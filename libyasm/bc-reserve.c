@@ -28,6 +28,7 @@
 
 #include "libyasm-stdint.h"
 #include "coretype.h"
+#include "arena.h"
 
 #include "errwarn.h"
 #include "intnum.h"
@@ -62,7 +63,8 @@ static const yasm_bytecode_callback bc_reserve_callback = {
     bc_reserve_calc_len,
     yasm_bc_expand_common,
     bc_reserve_tobytes,
-    YASM_BC_SPECIAL_RESERVE
+    YASM_BC_SPECIAL_RESERVE,
+    NULL
 };
 
 
@@ -71,7 +73,7 @@ bc_reserve_destroy(void *contents)
 {
     bytecode_reserve *reserve = (bytecode_reserve *)contents;
     yasm_expr_destroy(reserve->numitems);
-    yasm_xfree(contents);
+    yasm__arena_xfree(contents);
 }
 
 static void
@@ -89,11 +91,7 @@ bc_reserve_finalize(yasm_bytecode *bc, yasm_bytecode *prev_bc)
 {
     bytecode_reserve *reserve = (bytecode_reserve *)bc->contents;
     /* multiply reserve expression into multiple */
-    if (!bc->multiple)
-        bc->multiple = reserve->numitems;
-    else
-        bc->multiple = yasm_expr_create_tree(bc->multiple, YASM_EXPR_MUL,
-                                             reserve->numitems, bc->line);
+    yasm_bc_set_multiple(bc, reserve->numitems);
     reserve->numitems = NULL;
 }
 
@@ -128,7 +126,8 @@ yasm_bytecode *
 yasm_bc_create_reserve(yasm_expr *numitems, unsigned int itemsize,
                        unsigned long line)
 {
-    bytecode_reserve *reserve = yasm_xmalloc(sizeof(bytecode_reserve));
+    bytecode_reserve *reserve = yasm__arena_xmalloc(YASM_MEM_BYTECODE,
+                                                    sizeof(bytecode_reserve));
 
     /*@-mustfree@*/
     reserve->numitems = numitems;
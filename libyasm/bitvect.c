@@ -105,28 +105,32 @@ const N_int BitVector_BYTENORM[256] =
 
 #define BIT_VECTOR_HIDDEN_WORDS 3
 
+    /********************************************************************/
+    /* global machine-dependent constants (checked by "BitVector_Boot"): */
+    /********************************************************************/
+
+#define LOGBITS ((N_word) BIT_VECTOR_LOGBITS) /* = ld(BITS) (logarithmus dualis) */
+#define BITS    (LSB << LOGBITS)  /* = # of bits in machine word (power of 2) */
+#define MODMASK (BITS - 1)        /* = mask for calculating modulo BITS       */
+#define FACTOR  (LOGBITS - 3)     /* = ld(BITS / 8) (ld of # of bytes)        */
+
+#define LSB     ((N_word) 1)      /* = mask for least significant bit         */
+#define MSB     (LSB << MODMASK)  /* = mask for most significant bit          */
+
     /*****************************************************************/
     /* global machine-dependent constants (set by "BitVector_Boot"): */
     /*****************************************************************/
 
-static N_word BITS;     /* = # of bits in machine word (must be power of 2)  */
-static N_word MODMASK;  /* = BITS - 1 (mask for calculating modulo BITS)     */
-static N_word LOGBITS;  /* = ld(BITS) (logarithmus dualis)                   */
-static N_word FACTOR;   /* = ld(BITS / 8) (ld of # of bytes)                 */
-
-static N_word LSB = 1;  /* = mask for least significant bit                  */
-static N_word MSB;      /* = mask for most significant bit                   */
-
 static N_word LONGBITS; /* = # of bits in unsigned long                      */
 
 static N_word LOG10;    /* = logarithm to base 10 of BITS - 1                */
 static N_word EXP10;    /* = largest possible power of 10 in signed int      */
 
-    /********************************************************************/
-    /* global bit mask table for fast access (set by "BitVector_Boot"): */
-    /********************************************************************/
+    /*****************************************************/
+    /* bit mask for bit # index (modulo BITS) in a word: */
+    /*****************************************************/
 
-static wordptr BITMASKTAB;
+#define BITMASK(index)  (LSB << (index))
 
     /*****************************/
     /* global macro definitions: */
@@ -148,16 +152,16 @@ static wordptr BITMASKTAB;
     { target += count; source += count; while (count-- > 0) *--target = *--source; }
 
 #define BIT_VECTOR_CLR_BIT(address,index) \
-    *(address+(index>>LOGBITS)) &= NOT BITMASKTAB[index AND MODMASK];
+    *(address+(index>>LOGBITS)) &= NOT BITMASK(index AND MODMASK);
 
 #define BIT_VECTOR_SET_BIT(address,index) \
-    *(address+(index>>LOGBITS)) |= BITMASKTAB[index AND MODMASK];
+    *(address+(index>>LOGBITS)) |= BITMASK(index AND MODMASK);
 
 #define BIT_VECTOR_TST_BIT(address,index) \
-    ((*(address+(index>>LOGBITS)) AND BITMASKTAB[index AND MODMASK]) != 0)
+    ((*(address+(index>>LOGBITS)) AND BITMASK(index AND MODMASK)) != 0)
 
 #define BIT_VECTOR_FLP_BIT(address,index,mask) \
-    (mask = BITMASKTAB[index AND MODMASK]), \
+    (mask = BITMASK(index AND MODMASK)), \
     (((*(addr+(index>>LOGBITS)) ^= mask) AND mask) != 0)
 
 #define BIT_VECTOR_DIGITIZE(type,value,digit) \
@@ -165,6 +169,58 @@ static wordptr BITMASKTAB;
     digit -= value * 10; \
     digit += (type) '0';
 
+    /*****************************************************************/
+    /* bit scans within a non-zero word (using builtins if present): */
+    /*****************************************************************/
+
+#if defined(__GNUC__) && ((__GNUC__ > 3) || \
+                          ((__GNUC__ == 3) && (__GNUC_MINOR__ >= 4)))
+#if BIT_VECTOR_LOGBITS == 6
+#define BIT_VECTOR_HIGHEST(w)   (MODMASK - (N_word) __builtin_clzl(w))
+#define BIT_VECTOR_LOWEST(w)    ((N_word) __builtin_ctzl(w))
+#define BIT_VECTOR_POPCOUNT(w)  ((N_int) __builtin_popcountl(w))
+#else
+#define BIT_VECTOR_HIGHEST(w)   (MODMASK - (N_word) __builtin_clz(w))
+#define BIT_VECTOR_LOWEST(w)    ((N_word) __builtin_ctz(w))
+#define BIT_VECTOR_POPCOUNT(w)  ((N_int) __builtin_popcount(w))
+#endif
+#elif defined(_MSC_VER) && (BIT_VECTOR_LOGBITS == 5)
+#include <intrin.h>
+static N_word BIT_VECTOR_HIGHEST(N_word w)
+{
+    unsigned long i;
+    _BitScanReverse(&i, (unsigned long) w);
+    return((N_word) i);
+}
+static N_word BIT_VECTOR_LOWEST(N_word w)
+{
+    unsigned long i;
+    _BitScanForward(&i, (unsigned long) w);
+    return((N_word) i);
+}
+#else
+static N_word BIT_VECTOR_HIGHEST(N_word w)
+{
+    N_word i = MODMASK;
+    while (not (w AND MSB))
+    {
+        w <<= 1;
+        i--;
+    }
+    return(i);
+}
+static N_word BIT_VECTOR_LOWEST(N_word w)
+{
+    N_word i = 0;
+    while (not (w AND LSB))
+    {
+        w >>= 1;
+        i++;
+    }
+    return(i);
+}
+#endif
+
     /*********************************************************/
     /* private low-level functions (potentially dangerous!): */
     /*********************************************************/
@@ -334,47 +390,23 @@ ErrCode BitVector_Boot(void)
 {
     N_long longsample = 1L;
     N_word sample = LSB;
-    N_word lsb;
+    N_word bits;
 
     if (sizeof(N_word) > sizeof(size_t)) return(ErrCode_Type);
 
-    BITS = 1;
-    while (sample <<= 1) BITS++;    /* determine # of bits in a machine word */
+    bits = 1;
+    while (sample <<= 1) bits++;    /* determine # of bits in a machine word */
 
-    if (BITS != (sizeof(N_word) << 3)) return(ErrCode_Bits);
+    if (bits != (sizeof(N_word) << 3)) return(ErrCode_Bits);
 
-    if (BITS < 16) return(ErrCode_Word);
+    if (bits < 16) return(ErrCode_Word);
 
     LONGBITS = 1;
     while (longsample <<= 1) LONGBITS++;  /* = # of bits in an unsigned long */
 
-    if (BITS > LONGBITS) return(ErrCode_Long);
-
-    LOGBITS = 0;
-    sample = BITS;
-    lsb = (sample AND LSB);
-    while ((sample >>= 1) and (not lsb))
-    {
-        LOGBITS++;
-        lsb = (sample AND LSB);
-    }
+    if (bits > LONGBITS) return(ErrCode_Long);
 
-    if (sample) return(ErrCode_Powr);      /* # of bits is not a power of 2! */
-
-    if (BITS != (LSB << LOGBITS)) return(ErrCode_Loga);
-
-    MODMASK = BITS - 1;
-    FACTOR = LOGBITS - 3;  /* ld(BITS / 8) = ld(BITS) - ld(8) = ld(BITS) - 3 */
-    MSB = (LSB << MODMASK);
-
-    BITMASKTAB = (wordptr) yasm_xmalloc((size_t) (BITS << FACTOR));
-
-    if (BITMASKTAB == NULL) return(ErrCode_Null);
-
-    for ( sample = 0; sample < BITS; sample++ )
-    {
-        BITMASKTAB[sample] = (LSB << sample);
-    }
+    if (bits != BITS) return(ErrCode_Loga);   /* BIT_VECTOR_LOGBITS is wrong */
 
     LOG10 = (N_word) (MODMASK * 0.30103); /* = (BITS - 1) * ( ln 2 / ln 10 ) */
     EXP10 = power10(LOG10);
@@ -384,7 +416,6 @@ ErrCode BitVector_Boot(void)
 
 void BitVector_Shutdown(void)
 {
-    if (BITMASKTAB) yasm_xfree(BITMASKTAB);
 }
 
 N_word BitVector_Size(N_int bits)           /* bit vector size (# of words)  */
@@ -401,7 +432,7 @@ N_word BitVector_Mask(N_int bits)           /* bit vector mask (unused bits) */
     N_word mask;
 
     mask = bits AND MODMASK;
-    if (mask) mask = (N_word) ~(~0L << mask); else mask = (N_word) ~0L;
+    if (mask) mask = (N_word) ~(~0UL << mask); else mask = (N_word) ~0UL;
     return(mask);
 }
 
@@ -472,7 +503,7 @@ wordptr BitVector_Create(N_int bits, boolean clear)         /* malloc        */
     size = BitVector_Size(bits);
     mask = BitVector_Mask(bits);
     bytes = (size + BIT_VECTOR_HIDDEN_WORDS) << FACTOR;
-    addr = (wordptr) yasm_xmalloc((size_t) bytes);
+    addr = (wordptr) yasm__xmalloc_cat(YASM_MEM_INTNUM, (size_t) bytes);
     if (addr != NULL)
     {
         *addr++ = bits;
@@ -542,7 +573,7 @@ wordptr BitVector_Resize(wordptr oldaddr, N_int bits)       /* realloc       */
     else
     {
         bytes = (newsize + BIT_VECTOR_HIDDEN_WORDS) << FACTOR;
-        newaddr = (wordptr) yasm_xmalloc((size_t) bytes);
+        newaddr = (wordptr) yasm__xmalloc_cat(YASM_MEM_INTNUM, (size_t) bytes);
         if (newaddr != NULL)
         {
             *newaddr++ = bits;
@@ -617,7 +648,7 @@ void BitVector_Copy(wordptr X, wordptr Y)                           /* X = Y */
             if ( (*lastY AND (maskY AND NOT (maskY >> 1))) == 0 ) *lastY &= maskY;
             else
             {
-                fill = (N_word) ~0L;
+                fill = (N_word) ~0UL;
                 *lastY |= NOT maskY;
             }
             while ((sizeX > 0) and (sizeY > 0))
@@ -644,7 +675,7 @@ void BitVector_Fill(wordptr addr)                         /* X = ~{} set all */
 {
     N_word size = size_(addr);
     N_word mask = mask_(addr);
-    N_word fill = (N_word) ~0L;
+    N_word fill = (N_word) ~0UL;
 
     if (size > 0)
     {
@@ -657,7 +688,7 @@ void BitVector_Flip(wordptr addr)                         /* X = ~X flip all */
 {
     N_word size = size_(addr);
     N_word mask = mask_(addr);
-    N_word flip = (N_word) ~0L;
+    N_word flip = (N_word) ~0UL;
 
     if (size > 0)
     {
@@ -709,7 +740,7 @@ void BitVector_Reverse(wordptr X, wordptr Y)
         {
 /*          mask = mask_(Y);  */
 /*          mask &= NOT (mask >> 1);  */
-            mask = BITMASKTAB[(bits-1) AND MODMASK];
+            mask = BITMASK((bits-1) AND MODMASK);
             Y += size_(Y) - 1;
             value = 0;
             bit = LSB;
@@ -756,8 +787,8 @@ void BitVector_Interval_Empty(wordptr addr, N_int lower, N_int upper)
         loaddr = addr + lobase;
         hiaddr = addr + hibase;
 
-        lomask = (N_word)   (~0L << (lower AND MODMASK));
-        himask = (N_word) ~((~0L << (upper AND MODMASK)) << 1);
+        lomask = (N_word)   (~0UL << (lower AND MODMASK));
+        himask = (N_word) ~((~0UL << (upper AND MODMASK)) << 1);
 
         if (diff == 0)
         {
@@ -779,7 +810,7 @@ void BitVector_Interval_Fill(wordptr addr, N_int lower, N_int upper)
 {                                                  /* X = X + [lower..upper] */
     N_word  bits = bits_(addr);
     N_word  size = size_(addr);
-    N_word  fill = (N_word) ~0L;
+    N_word  fill = (N_word) ~0UL;
     wordptr loaddr;
     wordptr hiaddr;
     N_word  lobase;
@@ -796,8 +827,8 @@ void BitVector_Interval_Fill(wordptr addr, N_int lower, N_int upper)
         loaddr = addr + lobase;
         hiaddr = addr + hibase;
 
-        lomask = (N_word)   (~0L << (lower AND MODMASK));
-        himask = (N_word) ~((~0L << (upper AND MODMASK)) << 1);
+        lomask = (N_word)   (~0UL << (lower AND MODMASK));
+        himask = (N_word) ~((~0UL << (upper AND MODMASK)) << 1);
 
         if (diff == 0)
         {
@@ -820,7 +851,7 @@ void BitVector_Interval_Flip(wordptr addr, N_int lower, N_int upper)
 {                                                  /* X = X ^ [lower..upper] */
     N_word  bits = bits_(addr);
     N_word  size = size_(addr);
-    N_word  flip = (N_word) ~0L;
+    N_word  flip = (N_word) ~0UL;
     wordptr loaddr;
     wordptr hiaddr;
     N_word  lobase;
@@ -837,8 +868,8 @@ void BitVector_Interval_Flip(wordptr addr, N_int lower, N_int upper)
         loaddr = addr + lobase;
         hiaddr = addr + hibase;
 
-        lomask = (N_word)   (~0L << (lower AND MODMASK));
-        himask = (N_word) ~((~0L << (upper AND MODMASK)) << 1);
+        lomask = (N_word)   (~0UL << (lower AND MODMASK));
+        himask = (N_word) ~((~0UL << (upper AND MODMASK)) << 1);
 
         if (diff == 0)
         {
@@ -869,8 +900,8 @@ void BitVector_Interval_Reverse(wordptr addr, N_int lower, N_int upper)
     {
         loaddr = addr + (lower >> LOGBITS);
         hiaddr = addr + (upper >> LOGBITS);
-        lomask = BITMASKTAB[lower AND MODMASK];
-        himask = BITMASKTAB[upper AND MODMASK];
+        lomask = BITMASK(lower AND MODMASK);
+        himask = BITMASK(upper AND MODMASK);
         for ( bits = upper - lower + 1; bits > 1; bits -= 2 )
         {
             if (((*loaddr AND lomask) != 0) XOR ((*hiaddr AND himask) != 0))
@@ -914,7 +945,7 @@ boolean BitVector_interval_scan_inc(wordptr addr, N_int start,
     addr += offset;
     size -= offset;
 
-    bitmask = BITMASKTAB[start AND MODMASK];
+    bitmask = BITMASK(start AND MODMASK);
     mask = NOT (bitmask OR (bitmask - 1));
 
     value = *addr++;
@@ -990,7 +1021,7 @@ boolean BitVector_interval_scan_dec(wordptr addr, N_int start,
     addr += offset;
     size = ++offset;
 
-    bitmask = BITMASKTAB[start AND MODMASK];
+    bitmask = BITMASK(start AND MODMASK);
     mask = (bitmask - 1);
 
     value = *addr--;
@@ -1142,22 +1173,22 @@ void BitVector_Interval_Copy(wordptr X, wordptr Y, N_int Xoffset,
                         t_lower = t_lo_bit;
                         t_upper = BITS - 1;
                         t_bits = BITS - t_lo_bit;
-                        mask = (N_word) (~0L << t_lower);
+                        mask = (N_word) (~0UL << t_lower);
                         target = *X AND NOT mask;
                         break;
                     case 2:
                         t_lower = 0;
                         t_upper = t_hi_bit;
                         t_bits = t_hi_bit + 1;
-                        mask = (N_word) ((~0L << t_upper) << 1);
+                        mask = (N_word) ((~0UL << t_upper) << 1);
                         target = *X AND mask;
                         break;
                     case 3:
                         t_lower = t_lo_bit;
                         t_upper = t_hi_bit;
                         t_bits = t_hi_bit - t_lo_bit + 1;
-                        mask = (N_word) (~0L << t_lower);
-                        mask &= (N_word) ~((~0L << t_upper) << 1);
+                        mask = (N_word) (~0UL << t_lower);
+                        mask &= (N_word) ~((~0UL << t_upper) << 1);
                         target = *X AND NOT mask;
                         break;
                 }
@@ -1230,8 +1261,8 @@ void BitVector_Interval_Copy(wordptr X, wordptr Y, N_int Xoffset,
                 s_max = s_upper;
             }
             bits++;
-            mask = (N_word) (~0L << s_min);
-            mask &= (N_word) ~((~0L << s_max) << 1);
+            mask = (N_word) (~0UL << s_min);
+            mask &= (N_word) ~((~0UL << s_max) << 1);
             if (s_min == t_min) target |= (source AND mask);
             else
             {
@@ -1629,7 +1660,7 @@ ErrCode BitVector_from_Bin(wordptr addr, charptr string)
                     case (int) '0':
                         break;
                     case (int) '1':
-                        value |= BITMASKTAB[count];
+                        value |= BITMASK(count);
                         break;
                     case (int) '_':
                         count--;
@@ -2065,8 +2096,8 @@ charptr BitVector_to_Enum(wordptr addr)
     N_word  factor;
     N_word  power;
     N_word  start;
-    N_word  min;
-    N_word  max;
+    N_int   min;
+    N_int   max;
     charptr string;
     charptr target;
     boolean comma;
@@ -2552,10 +2583,11 @@ boolean BitVector_compute(wordptr X, wordptr Y, wordptr Z, boolean minus, boolea
             yy = *Y++;
             if (minus) zz = (N_word) NOT ( Z ? *Z++ : 0 );
             else       zz = (N_word)     ( Z ? *Z++ : 0 );
-            lo = (yy AND LSB) + (zz AND LSB) + cc;
-            hi = (yy >> 1) + (zz >> 1) + (lo >> 1);
-            cc = ((hi AND MSB) != 0);
-            *X++ = (hi << 1) OR (lo AND LSB);
+            lo = yy + zz;                   /* carry out iff sum wraps */
+            hi = (lo < yy);
+            lo += cc;
+            cc = hi OR (lo < cc);
+            *X++ = lo;
         }
         /* deal with most significant word (may be used only partially): */
         yy = *Y AND mask;
@@ -2845,7 +2877,7 @@ ErrCode BitVector_Div_Pos(wordptr Q, wordptr X, wordptr Y, wordptr R)
     while (bits-- > 0)
     {
         addr = Q + (bits >> LOGBITS);
-        mask = BITMASKTAB[bits AND MODMASK];
+        mask = BITMASK(bits AND MODMASK);
         flag = ((*addr AND mask) != 0);
         if (copy)
         {
@@ -3367,11 +3399,11 @@ void BitVector_Chunk_Store(wordptr addr, N_int chunksize, N_int offset,
         offset &= MODMASK;
         while (chunksize > 0)
         {
-            mask = (N_word) (~0L << offset);
+            mask = (N_word) (~0UL << offset);
             bits = offset + chunksize;
             if (bits < BITS)
             {
-                mask &= (N_word) ~(~0L << bits);
+                mask &= (N_word) ~(~0UL << bits);
                 bits = chunksize;
             }
             else bits = BITS - offset;
@@ -3379,8 +3411,8 @@ void BitVector_Chunk_Store(wordptr addr, N_int chunksize, N_int offset,
             temp &= mask;
             *addr &= NOT mask;
             *addr++ |= temp;
-            value >>= bits;
             chunksize -= bits;
+            if (chunksize > 0) value >>= bits;
             offset = 0;
         }
     }
@@ -3405,12 +3437,12 @@ N_long BitVector_Chunk_Read(wordptr addr, N_int chunksize, N_int offset)
             bits = offset + chunksize;
             if (bits < BITS)
             {
-                mask = (N_word) ~(~0L << bits);
+                mask = (N_word) ~(~0UL << bits);
                 bits = chunksize;
             }
             else
             {
-                mask = (N_word) ~0L;
+                mask = (N_word) ~0UL;
                 bits = BITS - offset;
             }
             temp = (N_long) ((*addr++ AND mask) >> offset);
@@ -3510,6 +3542,13 @@ boolean Set_subset(wordptr X, wordptr Y)                    /* X subset Y ?  */
 
 N_int Set_Norm(wordptr addr)                                /* = | X |       */
 {
+#ifdef BIT_VECTOR_POPCOUNT
+    N_word  size = size_(addr);
+    N_int   n = 0;
+
+    while (size-- > 0) n += BIT_VECTOR_POPCOUNT(*addr++);
+    return(n);
+#else
     byteptr byte;
     N_word  bytes;
     N_int   n;
@@ -3522,6 +3561,7 @@ N_int Set_Norm(wordptr addr)                                /* = | X |       */
         n += BitVector_BYTENORM[*byte++];
     }
     return(n);
+#endif
 }
 
 N_int Set_Norm2(wordptr addr)                               /* = | X |       */
@@ -3578,12 +3618,7 @@ Z_long Set_Min(wordptr addr)                                /* = min(X)      */
     }
     if (empty) return((Z_long) LONG_MAX);                  /* plus infinity  */
     i <<= LOGBITS;
-    while (not (c AND LSB))
-    {
-        c >>= 1;
-        i++;
-    }
-    return((Z_long) i);
+    return((Z_long) (i + BIT_VECTOR_LOWEST(c)));
 }
 
 Z_long Set_Max(wordptr addr)                                /* = max(X)      */
@@ -3599,13 +3634,8 @@ Z_long Set_Max(wordptr addr)                                /* = max(X)      */
         if ((c = *addr--)) empty = false; else i--;
     }
     if (empty) return((Z_long) LONG_MIN);                  /* minus infinity */
-    i <<= LOGBITS;
-    while (not (c AND MSB))
-    {
-        c <<= 1;
-        i--;
-    }
-    return((Z_long) --i);
+    i = (i - 1) << LOGBITS;
+    return((Z_long) (i + BIT_VECTOR_HIGHEST(c)));
 }
 
     /**********************************/
@@ -3769,8 +3799,8 @@ void Matrix_Transpose(wordptr X, N_int rowsX, N_int colsX,
                 ji = termj + i;
                 addij = ij >> LOGBITS;
                 addji = ji >> LOGBITS;
-                bitij = BITMASKTAB[ij AND MODMASK];
-                bitji = BITMASKTAB[ji AND MODMASK];
+                bitij = BITMASK(ij AND MODMASK);
+                bitji = BITMASK(ji AND MODMASK);
                 swap = ((*(Y+addij) AND bitij) != 0);
                 if ((*(Y+addji) AND bitji) != 0)
                      *(X+addij) |=     bitij;
@@ -3783,7 +3813,7 @@ void Matrix_Transpose(wordptr X, N_int rowsX, N_int colsX,
             }
             ii = termi + i;
             addii = ii >> LOGBITS;
-            bitii = BITMASKTAB[ii AND MODMASK];
+            bitii = BITMASK(ii AND MODMASK);
             if ((*(Y+addii) AND bitii) != 0)
                  *(X+addii) |=     bitii;
             else
@@ -3802,8 +3832,8 @@ void Matrix_Transpose(wordptr X, N_int rowsX, N_int colsX,
                 ji = termj + i;
                 addij = ij >> LOGBITS;
                 addji = ji >> LOGBITS;
-                bitij = BITMASKTAB[ij AND MODMASK];
-                bitji = BITMASKTAB[ji AND MODMASK];
+                bitij = BITMASK(ij AND MODMASK);
+                bitji = BITMASK(ji AND MODMASK);
                 if ((*(Y+addij) AND bitij) != 0)
                      *(X+addji) |=     bitji;
                 else
@@ -17,12 +17,27 @@
 #define YASM_LIB_DECL
 #endif
 
+#include <limits.h>
+
+/*  Bit vectors are processed a machine word at a time.  The word must not   */
+/*  be wider than an unsigned long, so use unsigned long where it is 64 bits */
+/*  wide (BIT_VECTOR_LOGBITS = ld(# of bits in a word)).                     */
+#if ULONG_MAX > 0xFFFFFFFFUL
+#define BIT_VECTOR_LOGBITS  6
+#else
+#define BIT_VECTOR_LOGBITS  5
+#endif
+
 typedef  unsigned   char    N_char;
 typedef  unsigned   char    N_byte;
 typedef  unsigned   short   N_short;
 typedef  unsigned   short   N_shortword;
 typedef  unsigned   int     N_int;
+#if BIT_VECTOR_LOGBITS == 6
+typedef  unsigned   long    N_word;
+#else
 typedef  unsigned   int     N_word;
+#endif
 typedef  unsigned   long    N_long;
 typedef  unsigned   long    N_longword;
 
@@ -34,7 +49,11 @@ typedef  signed     char    Z_byte;
 typedef  signed     short   Z_short;
 typedef  signed     short   Z_shortword;
 typedef  signed     int     Z_int;
+#if BIT_VECTOR_LOGBITS == 6
+typedef  signed     long    Z_word;
+#else
 typedef  signed     int     Z_word;
+#endif
 typedef  signed     long    Z_long;
 typedef  signed     long    Z_longword;
 
@@ -28,6 +28,7 @@
 
 #include "libyasm-stdint.h"
 #include "coretype.h"
+#include "arena.h"
 
 #include "errwarn.h"
 #include "intnum.h"
@@ -38,14 +39,40 @@
 #include "bytecode.h"
 
 
+/* Rarely used bytecode fields, allocated when first needed. */
+typedef struct yasm_bytecode_cold {
+    /* Number of times bytecode is repeated.  NULL=1. */
+    /*@only@*/ /*@null@*/ yasm_expr *multiple;
+
+    /* NULL-terminated array of labels that point to this bytecode (as the
+     * bytecode previous to the label).  The structure is extended to hold
+     * more than one label.
+     */
+    /*@dependent@*/ /*@null@*/ yasm_symrec *symrecs[1];
+} yasm_bytecode_cold;
+
+static yasm_bytecode_cold *
+bc_get_cold(yasm_bytecode *bc)
+{
+    if (!bc->cold) {
+        bc->cold = yasm__arena_xmalloc(YASM_MEM_BYTECODE,
+                                       sizeof(yasm_bytecode_cold));
+        bc->cold->multiple = NULL;
+        bc->cold->symrecs[0] = NULL;
+    }
+    return bc->cold;
+}
+
 void
 yasm_bc_set_multiple(yasm_bytecode *bc, yasm_expr *e)
 {
-    if (bc->multiple)
-        bc->multiple = yasm_expr_create_tree(bc->multiple, YASM_EXPR_MUL, e,
-                                             e->line);
+    yasm_bytecode_cold *cold = bc_get_cold(bc);
+
+    if (cold->multiple)
+        cold->multiple = yasm_expr_create_tree(cold->multiple, YASM_EXPR_MUL,
+                                               e, e->line);
     else
-        bc->multiple = e;
+        cold->multiple = e;
 }
 
 void
@@ -96,16 +123,16 @@ yasm_bytecode *
 yasm_bc_create_common(const yasm_bytecode_callback *callback, void *contents,
                       unsigned long line)
 {
-    yasm_bytecode *bc = yasm_xmalloc(sizeof(yasm_bytecode));
+    yasm_bytecode *bc = yasm__arena_xmalloc(YASM_MEM_BYTECODE,
+                                            sizeof(yasm_bytecode));
 
     bc->callback = callback;
     bc->section = NULL;
-    bc->multiple = (yasm_expr *)NULL;
     bc->len = 0;
     bc->mult_int = 1;
     bc->line = line;
     bc->offset = ~0UL;  /* obviously incorrect / uninitialized value */
-    bc->symrecs = NULL;
+    bc->cold = NULL;
     bc->contents = contents;
 
     return bc;
@@ -120,22 +147,27 @@ yasm_bc_get_section(yasm_bytecode *bc)
 void
 yasm_bc__add_symrec(yasm_bytecode *bc, yasm_symrec *sym)
 {
-    if (!bc->symrecs) {
-        bc->symrecs = yasm_xmalloc(2*sizeof(yasm_symrec *));
-        bc->symrecs[0] = sym;
-        bc->symrecs[1] = NULL;
-    } else {
-        /* Very inefficient implementation for large numbers of symbols.  But
-         * that would be very unusual, so use the simple algorithm instead.
-         */
-        size_t count = 1;
-        while (bc->symrecs[count])
-            count++;
-        bc->symrecs = yasm_xrealloc(bc->symrecs,
-                                    (count+2)*sizeof(yasm_symrec *));
-        bc->symrecs[count] = sym;
-        bc->symrecs[count+1] = NULL;
-    }
+    /* Very inefficient implementation for large numbers of symbols.  But
+     * that would be very unusual, so use the simple algorithm instead.
+     */
+    yasm_bytecode_cold *cold = bc_get_cold(bc);
+    size_t count = 0;
+
+    while (cold->symrecs[count])
+        count++;
+    cold = yasm__arena_xrealloc(YASM_MEM_BYTECODE, cold,
+        sizeof(yasm_bytecode_cold)+(count+1)*sizeof(yasm_symrec *));
+    bc->cold = cold;
+    cold->symrecs[count] = sym;
+    cold->symrecs[count+1] = NULL;
+}
+
+yasm_symrec **
+yasm_bc_get_symrecs(const yasm_bytecode *bc)
+{
+    if (!bc->cold || !bc->cold->symrecs[0])
+        return NULL;
+    return bc->cold->symrecs;
 }
 
 void
@@ -146,10 +178,11 @@ yasm_bc_destroy(yasm_bytecode *bc)
 
     if (bc->callback)
         bc->callback->destroy(bc->contents);
-    yasm_expr_destroy(bc->multiple);
-    if (bc->symrecs)
-        yasm_xfree(bc->symrecs);
-    yasm_xfree(bc);
+    if (bc->cold) {
+        yasm_expr_destroy(bc->cold->multiple);
+        yasm__arena_xfree(bc->cold);
+    }
+    yasm__arena_xfree(bc);
 }
 
 void
@@ -160,10 +193,10 @@ yasm_bc_print(const yasm_bytecode *bc, FILE *f, int indent_level)
     else
         bc->callback->print(bc->contents, f, indent_level);
     fprintf(f, "%*sMultiple=", indent_level, "");
-    if (!bc->multiple)
+    if (!bc->cold || !bc->cold->multiple)
         fprintf(f, "nil (1)");
     else
-        yasm_expr_print(bc->multiple, f);
+        yasm_expr_print(bc->cold->multiple, f);
     fprintf(f, "\n%*sLength=%lu\n", indent_level, "", bc->len);
     fprintf(f, "%*sLine Index=%lu\n", indent_level, "", bc->line);
     fprintf(f, "%*sOffset=%lx\n", indent_level, "", bc->offset);
@@ -174,28 +207,35 @@ yasm_bc_finalize(yasm_bytecode *bc, yasm_bytecode *prev_bc)
 {
     if (bc->callback)
         bc->callback->finalize(bc, prev_bc);
-    if (bc->multiple) {
+    if (bc->cold && bc->cold->multiple) {
         yasm_value val;
 
-        if (yasm_value_finalize_expr(&val, bc->multiple, prev_bc, 0))
+        if (yasm_value_finalize_expr(&val, bc->cold->multiple, prev_bc, 0))
             yasm_error_set(YASM_ERROR_TOO_COMPLEX,
                            N_("multiple expression too complex"));
         else if (val.rel)
             yasm_error_set(YASM_ERROR_NOT_ABSOLUTE,
                            N_("multiple expression not absolute"));
-        /* Finalize creates NULL output if value=0, but bc->multiple is NULL
+        /* Finalize creates NULL output if value=0, but the multiple is NULL
          * if value=1 (this difference is to make the common case small).
-         * However, this means we need to set bc->multiple explicitly to 0
+         * However, this means we need to set the multiple explicitly to 0
          * here if val.abs is NULL.
          */
         if (val.abs)
-            bc->multiple = val.abs;
+            bc->cold->multiple = val.abs;
         else
-            bc->multiple = yasm_expr_create_ident(
+            bc->cold->multiple = yasm_expr_create_ident(
                 yasm_expr_int(yasm_intnum_create_uint(0)), bc->line);
     }
 }
 
+void
+yasm_bc_compact(yasm_bytecode *bc)
+{
+    if (bc->callback && bc->callback->compact)
+        bc->callback->compact(bc);
+}
+
 /*@null@*/ yasm_intnum *
 yasm_calc_bc_dist(yasm_bytecode *precbc1, yasm_bytecode *precbc2)
 {
@@ -249,10 +289,10 @@ yasm_bc_calc_len(yasm_bytecode *bc, yasm_bc_add_span_func add_span,
 
     /* Check for multiples */
     bc->mult_int = 1;
-    if (bc->multiple) {
+    if (bc->cold && bc->cold->multiple) {
         /*@dependent@*/ /*@null@*/ const yasm_intnum *num;
 
-        num = yasm_expr_get_intnum(&bc->multiple, 0);
+        num = yasm_expr_get_intnum(&bc->cold->multiple, 0);
         if (num) {
             if (yasm_intnum_sign(num) < 0) {
                 yasm_error_set(YASM_ERROR_VALUE, N_("multiple is negative"));
@@ -260,13 +300,13 @@ yasm_bc_calc_len(yasm_bytecode *bc, yasm_bc_add_span_func add_span,
             } else
                 bc->mult_int = yasm_intnum_get_int(num);
         } else {
-            if (yasm_expr__contains(bc->multiple, YASM_EXPR_FLOAT)) {
+            if (yasm_expr__contains(bc->cold->multiple, YASM_EXPR_FLOAT)) {
                 yasm_error_set(YASM_ERROR_VALUE,
                     N_("expression must not contain floating point value"));
                 retval = -1;
             } else {
                 yasm_value value;
-                yasm_value_initialize(&value, bc->multiple, 0);
+                yasm_value_initialize(&value, bc->cold->multiple, 0);
                 add_span(add_span_data, bc, 0, &value, 0, 0);
                 bc->mult_int = 0;   /* assume 0 to start */
             }
@@ -355,8 +395,8 @@ yasm_bc_get_multiple(yasm_bytecode *bc, long *multiple, int calc_bc_dist)
     /*@dependent@*/ /*@null@*/ const yasm_intnum *num;
 
     *multiple = 1;
-    if (bc->multiple) {
-        num = yasm_expr_get_intnum(&bc->multiple, calc_bc_dist);
+    if (bc->cold && bc->cold->multiple) {
+        num = yasm_expr_get_intnum(&bc->cold->multiple, calc_bc_dist);
         if (!num) {
             yasm_error_set(YASM_ERROR_VALUE,
                            N_("could not determine multiple"));
@@ -374,7 +414,7 @@ yasm_bc_get_multiple(yasm_bytecode *bc, long *multiple, int calc_bc_dist)
 const yasm_expr *
 yasm_bc_get_multiple_expr(const yasm_bytecode *bc)
 {
-    return bc->multiple;
+    return bc->cold ? bc->cold->multiple : NULL;
 }
 
 yasm_insn *
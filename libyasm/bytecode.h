@@ -177,6 +177,14 @@ typedef struct yasm_bytecode_callback {
         /** Instruction bytecode. */
         YASM_BC_SPECIAL_INSN
     } special;
+
+    /** Releases data that is only needed before the bytecode is finalized,
+     * and shrinks the implementation-specific data where possible.
+     * Called from yasm_bc_compact().  May be NULL if there's nothing to
+     * compact.  Must not change the bytecode's output.
+     * \param bc            bytecode
+     */
+    void (*compact) (yasm_bytecode *bc);
 } yasm_bytecode_callback;
 
 /** A bytecode. */
@@ -196,11 +204,6 @@ struct yasm_bytecode {
      */
     /*@dependent@*/ /*@null@*/ yasm_section *section;
 
-    /** Number of times bytecode is repeated.
-     * NULL=1 (to save space in the common case).
-     */
-    /*@only@*/ /*@null@*/ yasm_expr *multiple;
-
     /** Total length of entire bytecode (not including multiple copies). */
     unsigned long len;
 
@@ -218,10 +221,11 @@ struct yasm_bytecode {
     /** Unique integer index of bytecode.  Used during optimization. */
     unsigned long bc_index;
 
-    /** NULL-terminated array of labels that point to this bytecode (as the
-     * bytecode previous to the label).  NULL if no labels point here.
+    /** Rarely used fields (the multiple and the labels that point to this
+     * bytecode), allocated only when one is set.  Use
+     * yasm_bc_get_multiple_expr() and yasm_bc_get_symrecs() to access.
      */
-    /*@null@*/ yasm_symrec **symrecs;
+    /*@null@*/ /*@only@*/ struct yasm_bytecode_cold *cold;
 
     /** Implementation-specific data (type identified by callback). */
     void *contents;
@@ -404,6 +408,15 @@ YASM_LIB_DECL
 YASM_LIB_DECL
 void yasm_bc__add_symrec(yasm_bytecode *bc, /*@dependent@*/ yasm_symrec *sym);
 
+/** Get the labels that point to a bytecode (as the bytecode previous to the
+ * label).
+ * \param bc    bytecode
+ * \return NULL-terminated array of symbols; NULL if no labels point here.
+ */
+YASM_LIB_DECL
+/*@null@*/ /*@dependent@*/ yasm_symrec **yasm_bc_get_symrecs
+    (const yasm_bytecode *bc);
+
 /** Delete (free allocated memory for) a bytecode.
  * \param bc    bytecode (only pointer to it); may be NULL
  */
@@ -425,6 +438,12 @@ void yasm_bc_print(const yasm_bytecode *bc, FILE *f, int indent_level);
 YASM_LIB_DECL
 void yasm_bc_finalize(yasm_bytecode *bc, yasm_bytecode *prev_bc);
 
+/** Compact a finalized bytecode, releasing memory it no longer needs.
+ * \param bc            bytecode
+ */
+YASM_LIB_DECL
+void yasm_bc_compact(yasm_bytecode *bc);
+
 /** Determine the distance between the starting offsets of two bytecodes.
  * \param precbc1       preceding bytecode to the first bytecode
  * \param precbc2       preceding bytecode to the second bytecode
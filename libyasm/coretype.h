@@ -95,6 +95,13 @@ typedef struct yasm_bytecode yasm_bytecode;
 /** Object.  \see section.h for details and related functions. */
 typedef struct yasm_object yasm_object;
 
+/** Memory arena (opaque type).  \see arena.h for related functions. */
+typedef struct yasm_arena yasm_arena;
+
+/** String intern table (opaque type).  \see intern.h for related functions.
+ */
+typedef struct yasm_intern_table yasm_intern_table;
+
 /** Section (opaque type).  \see section.h for related functions. */
 typedef struct yasm_section yasm_section;
 
@@ -390,4 +397,71 @@ YASM_LIB_DECL
 extern void (*yasm_xfree) (/*@only@*/ /*@out@*/ /*@null@*/ void *p)
     /*@modifies p@*/;
 
+/** Memory categories, for attributing allocations made through the
+ * yasm_xmalloc() family to the subsystem that owns them.  A replacement
+ * allocator can query the category of each allocation with
+ * yasm_mem_get_category().
+ */
+typedef enum yasm_mem_category {
+    YASM_MEM_OTHER = 0,     /**< Not otherwise categorized */
+    YASM_MEM_EXPR,          /**< Expressions */
+    YASM_MEM_INTNUM,        /**< Integers (including bit vectors) */
+    YASM_MEM_BYTECODE,      /**< Bytecodes and their contents */
+    YASM_MEM_SYMREC,        /**< Symbols and symbol tables */
+    YASM_MEM_LINEMAP,       /**< Line mappings and source lines */
+    YASM_MEM_PREPROC,       /**< Preprocessor tokens, lines, and macros */
+    YASM_MEM_OBJFMT,        /**< Object format output */
+    YASM_MEM_ARENA,         /**< Arena space not handed out */
+    YASM_MEM_NUM_CATEGORIES /**< Number of categories */
+} yasm_mem_category;
+
+/** Hook for attributing memory that an allocator hands out in pieces of
+ * larger blocks (see yasm__arena_xmalloc()).  The larger blocks are
+ * allocated in #YASM_MEM_ARENA; each piece is reported as it is handed out
+ * and again as it is released, so a replacement allocator can move its
+ * size between #YASM_MEM_ARENA and the piece's own category.  NULL (the
+ * default) if not needed.
+ * \param category  category of the piece
+ * \param size      size of the piece, in bytes
+ * \param alloc     nonzero if handed out, zero if released
+ */
+YASM_LIB_DECL
+extern /*@null@*/ void (*yasm_mem_suballoc)
+    (yasm_mem_category category, size_t size, int alloc);
+
+/** Set the category of following allocations (in the current thread).
+ * \param category  new category
+ * \return Previous category; should be restored when done.
+ */
+YASM_LIB_DECL
+yasm_mem_category yasm_mem_set_category(yasm_mem_category category);
+
+/** Get the category of allocations (in the current thread).
+ * \return Current category.
+ */
+YASM_LIB_DECL
+yasm_mem_category yasm_mem_get_category(void);
+
+/** yasm_xmalloc() with the allocation attributed to a category.
+ * \internal
+ * \param category  memory category
+ * \param size      number of bytes to allocate
+ * \return Allocated memory block.
+ */
+YASM_LIB_DECL
+/*@only@*/ /*@out@*/ void *yasm__xmalloc_cat(yasm_mem_category category,
+                                             size_t size);
+
+/** yasm_xrealloc() with the allocation attributed to a category.
+ * \internal
+ * \param category  memory category
+ * \param oldmem    memory block to resize
+ * \param size      new size, in bytes
+ * \return Re-allocated memory block.
+ */
+YASM_LIB_DECL
+/*@only@*/ void *yasm__xrealloc_cat(yasm_mem_category category,
+                                    /*@only@*/ /*@null@*/ void *oldmem,
+                                    size_t size);
+
 #endif
@@ -55,11 +55,10 @@ static const char *def_gettext_hook(const char *msgid);
 const char * (*yasm_gettext_hook) (const char *msgid) = def_gettext_hook;
 
 /* Error indicator */
-/* yasm_eclass is not static so that yasm_error_occurred macro can access it */
-yasm_error_class yasm_eclass;
-static /*@only@*/ /*@null@*/ char *yasm_estr;
-static unsigned long yasm_exrefline;
-static /*@only@*/ /*@null@*/ char *yasm_exrefstr;
+static YASM_THREAD_LOCAL yasm_error_class yasm_eclass;
+static /*@only@*/ /*@null@*/ YASM_THREAD_LOCAL char *yasm_estr;
+static YASM_THREAD_LOCAL unsigned long yasm_exrefline;
+static /*@only@*/ /*@null@*/ YASM_THREAD_LOCAL char *yasm_exrefstr;
 
 /* Warning indicator */
 typedef struct warn {
@@ -68,10 +67,11 @@ typedef struct warn {
     yasm_warn_class wclass;
     /*@owned@*/ /*@null@*/ char *wstr;
 } warn;
-static STAILQ_HEAD(warn_head, warn) yasm_warns;
+STAILQ_HEAD(warn_head, warn);
+static YASM_THREAD_LOCAL struct warn_head yasm_warns;
 
 /* Enabled warnings.  See errwarn.h for a list. */
-static unsigned long warn_class_enabled;
+static YASM_THREAD_LOCAL unsigned long warn_class_enabled;
 
 typedef struct errwarn_data {
     /*@reldef@*/ SLIST_ENTRY(errwarn_data) link;
@@ -98,7 +98,7 @@ struct yasm_errwarns {
 };
 
 /* Static buffer for use by conv_unprint(). */
-static char unprint[5];
+static YASM_THREAD_LOCAL char unprint[5];
 
 
 static const char *
@@ -257,6 +257,12 @@ yasm_error_clear(void)
     yasm_exrefstr = NULL;
 }
 
+yasm_error_class
+yasm_error_occurred(void)
+{
+    return yasm_eclass;
+}
+
 int
 yasm_error_matches(yasm_error_class eclass)
 {
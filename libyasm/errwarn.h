@@ -68,7 +68,10 @@ typedef enum yasm_error_class {
     YASM_ERROR_PARSE            = 0x8040  /**< Parser error */
 } yasm_error_class;
 
-/** Initialize any internal data structures. */
+/** Initialize any internal data structures.  The error and warning
+ * indicators are per-thread, so this must be called in each thread that uses
+ * libyasm.
+ */
 YASM_LIB_DECL
 void yasm_errwarn_initialize(void);
 
@@ -126,6 +129,7 @@ void yasm_error_clear(void);
  * be treated as a boolean value.
  * \return Current error indicator.
  */
+YASM_LIB_DECL
 yasm_error_class yasm_error_occurred(void);
 
 /** Check the error indicator against an error class.  To check if any error
@@ -138,12 +142,6 @@ yasm_error_class yasm_error_occurred(void);
 YASM_LIB_DECL
 int yasm_error_matches(yasm_error_class eclass);
 
-#ifndef YASM_DOXYGEN
-YASM_LIB_DECL
-extern yasm_error_class yasm_eclass;
-#define yasm_error_occurred()       yasm_eclass
-#endif
-
 /** Set the error indicator (va_list version).  Has no effect if the error
  * indicator is already set.
  * \param eclass    error class
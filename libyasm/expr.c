@@ -28,6 +28,7 @@
 
 #include "libyasm-stdint.h"
 #include "coretype.h"
+#include "arena.h"
 #include "bitvect.h"
 
 #include "errwarn.h"
@@ -41,6 +42,13 @@
 
 #include "arch.h"
 
+/* Expressions are allocated from the current arena, and accounted to
+ * YASM_MEM_EXPR.
+ */
+#define expr_xmalloc(size)          yasm__arena_xmalloc(YASM_MEM_EXPR, size)
+#define expr_xrealloc(oldmem, size) \
+    yasm__arena_xrealloc(YASM_MEM_EXPR, oldmem, size)
+#define expr_xfree(e)               yasm__arena_xfree(e)
 
 static /*@only@*/ yasm_expr *expr_level_op
     (/*@returned@*/ /*@only@*/ yasm_expr *e, int fold_const,
@@ -54,8 +62,8 @@ static void expr_delete_term(yasm_expr__item *term, int recurse);
 /* Bitmap of used items.  We should really never need more than 2 at a time,
  * so 31 is pretty much overkill.
  */
-static unsigned long itempool_used = 0;
-static yasm_expr__item itempool[31];
+static YASM_THREAD_LOCAL unsigned long itempool_used = 0;
+static YASM_THREAD_LOCAL yasm_expr__item itempool[31];
 
 /* allocate a new expression node, with children as defined.
  * If it's a unary operator, put the element in left and set right=NULL. */
@@ -64,31 +72,35 @@ yasm_expr *
 yasm_expr_create(yasm_expr_op op, yasm_expr__item *left,
                  yasm_expr__item *right, unsigned long line)
 {
-    yasm_expr *ptr, *sube;
+    yasm_expr *ptr = NULL, *sube;
+    yasm_expr__item terms[2];
+    int numterms = 0;
     unsigned long z;
-    ptr = yasm_xmalloc(sizeof(yasm_expr));
 
-    ptr->op = op;
-    ptr->numterms = 0;
-    ptr->terms[0].type = YASM_EXPR_NONE;
-    ptr->terms[1].type = YASM_EXPR_NONE;
+    terms[0].type = YASM_EXPR_NONE;
+    terms[1].type = YASM_EXPR_NONE;
     if (left) {
-        ptr->terms[0] = *left;  /* structure copy */
+        terms[0] = *left;       /* structure copy */
         z = (unsigned long)(left-itempool);
         if (z>=31)
             yasm_internal_error(N_("could not find expritem in pool"));
         itempool_used &= ~(1<<z);
-        ptr->numterms++;
+        numterms++;
 
         /* Search downward until we find something *other* than an
-         * IDENT, then bring it up to the current level.
+         * IDENT, then bring it up to the current level.  Rather than
+         * freeing the first IDENT node, reuse it for this expression;
+         * every node has room for two terms.
          */
-        while (ptr->terms[0].type == YASM_EXPR_EXPR &&
-               ptr->terms[0].data.expn->op == YASM_EXPR_IDENT) {
-            sube = ptr->terms[0].data.expn;
-            ptr->terms[0] = sube->terms[0];     /* structure copy */
+        while (terms[0].type == YASM_EXPR_EXPR &&
+               terms[0].data.expn->op == YASM_EXPR_IDENT) {
+            sube = terms[0].data.expn;
+            terms[0] = sube->terms[0];  /* structure copy */
             /*@-usereleased@*/
-            yasm_xfree(sube);
+            if (!ptr)
+                ptr = sube;
+            else
+                expr_xfree(sube);
             /*@=usereleased@*/
         }
     } else {
@@ -96,26 +108,35 @@ yasm_expr_create(yasm_expr_op op, yasm_expr__item *left,
     }
 
     if (right) {
-        ptr->terms[1] = *right; /* structure copy */
+        terms[1] = *right;      /* structure copy */
         z = (unsigned long)(right-itempool);
         if (z>=31)
             yasm_internal_error(N_("could not find expritem in pool"));
         itempool_used &= ~(1<<z);
-        ptr->numterms++;
+        numterms++;
 
         /* Search downward until we find something *other* than an
          * IDENT, then bring it up to the current level.
          */
-        while (ptr->terms[1].type == YASM_EXPR_EXPR &&
-               ptr->terms[1].data.expn->op == YASM_EXPR_IDENT) {
-            sube = ptr->terms[1].data.expn;
-            ptr->terms[1] = sube->terms[0];     /* structure copy */
+        while (terms[1].type == YASM_EXPR_EXPR &&
+               terms[1].data.expn->op == YASM_EXPR_IDENT) {
+            sube = terms[1].data.expn;
+            terms[1] = sube->terms[0];  /* structure copy */
             /*@-usereleased@*/
-            yasm_xfree(sube);
+            if (!ptr)
+                ptr = sube;
+            else
+                expr_xfree(sube);
             /*@=usereleased@*/
         }
     }
 
+    if (!ptr)
+        ptr = expr_xmalloc(sizeof(yasm_expr));
+    ptr->op = op;
+    ptr->numterms = numterms;
+    ptr->terms[0] = terms[0];   /* structure copy */
+    ptr->terms[1] = terms[1];   /* structure copy */
     ptr->line = line;
 
     return expr_level_op(ptr, 1, 1, 0);
@@ -283,7 +304,7 @@ expr_xform_bc_dist_base(/*@returned@*/ /*@only@*/ yasm_expr *e,
     }
     if (e->numterms != numterms) {
         e->numterms = numterms;
-        e = yasm_xrealloc(e, sizeof(yasm_expr)+((numterms<2) ? 0 :
+        e = expr_xrealloc(e, sizeof(yasm_expr)+((numterms<2) ? 0 :
                           sizeof(yasm_expr__item)*(numterms-2)));
         if (numterms == 1)
             e->op = YASM_EXPR_IDENT;
@@ -362,7 +383,7 @@ yasm_expr__bc_dist_subst(yasm_expr **ep, void *cbd,
 static void
 expr_xform_neg_item(yasm_expr *e, yasm_expr__item *ei)
 {
-    yasm_expr *sube = yasm_xmalloc(sizeof(yasm_expr));
+    yasm_expr *sube = expr_xmalloc(sizeof(yasm_expr));
 
     /* Build -1*ei subexpression */
     sube->op = YASM_EXPR_MUL;
@@ -435,7 +456,7 @@ expr_xform_neg_helper(/*@returned@*/ /*@only@*/ yasm_expr *e)
             /* Everything else.  MUL will be combined when it's leveled.
              * Make a new expr (to replace e) with -1*e.
              */
-            ne = yasm_xmalloc(sizeof(yasm_expr));
+            ne = expr_xmalloc(sizeof(yasm_expr));
             ne->op = YASM_EXPR_MUL;
             ne->line = e->line;
             ne->numterms = 2;
@@ -627,7 +648,7 @@ expr_level_op(/*@returned@*/ /*@only@*/ yasm_expr *e, int fold_const,
      */
     while (e->op == YASM_EXPR_IDENT && e->terms[0].type == YASM_EXPR_EXPR) {
         yasm_expr *sube = e->terms[0].data.expn;
-        yasm_xfree(e);
+        expr_xfree(e);
         e = sube;
     }
 
@@ -645,7 +666,7 @@ expr_level_op(/*@returned@*/ /*@only@*/ yasm_expr *e, int fold_const,
                e->terms[i].data.expn->op == YASM_EXPR_IDENT) {
             yasm_expr *sube = e->terms[i].data.expn;
             e->terms[i] = sube->terms[0];
-            yasm_xfree(sube);
+            expr_xfree(sube);
         }
 
         if (e->terms[i].type == YASM_EXPR_EXPR &&
@@ -718,7 +739,7 @@ expr_level_op(/*@returned@*/ /*@only@*/ yasm_expr *e, int fold_const,
         level_numterms <= fold_numterms) {
         /* Downsize e if necessary */
         if (fold_numterms < e->numterms && e->numterms > 2)
-            e = yasm_xrealloc(e, sizeof(yasm_expr)+((fold_numterms<2) ? 0 :
+            e = expr_xrealloc(e, sizeof(yasm_expr)+((fold_numterms<2) ? 0 :
                               sizeof(yasm_expr__item)*(fold_numterms-2)));
         /* Update numterms */
         e->numterms = fold_numterms;
@@ -735,7 +756,7 @@ expr_level_op(/*@returned@*/ /*@only@*/ yasm_expr *e, int fold_const,
     }
 
     /* Alloc more (or conceivably less, but not usually) space for e */
-    e = yasm_xrealloc(e, sizeof(yasm_expr)+((level_numterms<2) ? 0 :
+    e = expr_xrealloc(e, sizeof(yasm_expr)+((level_numterms<2) ? 0 :
                       sizeof(yasm_expr__item)*(level_numterms-2)));
 
     /* Copy up ExprItem's.  Iterate from right to left to keep the same
@@ -773,7 +794,7 @@ expr_level_op(/*@returned@*/ /*@only@*/ yasm_expr *e, int fold_const,
             /* delete subexpression, but *don't delete nodes* (as we've just
              * copied them!)
              */
-            yasm_xfree(sube);
+            expr_xfree(sube);
         } else if (o != i) {
             /* copy operand if it changed places */
             if (o == first_int_term)
@@ -999,7 +1020,7 @@ yasm_expr__copy_except(const yasm_expr *e, int except)
     if (e == NULL)
         return NULL;
 
-    n = yasm_xmalloc(sizeof(yasm_expr) +
+    n = expr_xmalloc(sizeof(yasm_expr) +
                      sizeof(yasm_expr__item)*(e->numterms<2?0:e->numterms-2));
 
     n->op = e->op;
@@ -1038,7 +1059,7 @@ expr_destroy_each(/*@only@*/ yasm_expr *e, /*@unused@*/ void *d)
     int i;
     for (i=0; i<e->numterms; i++)
         expr_delete_term(&e->terms[i], 0);
-    yasm_xfree(e);      /* free ourselves */
+    expr_xfree(e);      /* free ourselves */
     return 0;   /* don't stop recursion */
 }
 
@@ -1216,7 +1237,7 @@ yasm_expr_extract_segoff(yasm_expr **ep)
         retval = e->terms[0].data.expn;
     else {
         /* Need to build IDENT expression to hold non-expression contents */
-        retval = yasm_xmalloc(sizeof(yasm_expr));
+        retval = expr_xmalloc(sizeof(yasm_expr));
         retval->op = YASM_EXPR_IDENT;
         retval->numterms = 1;
         retval->terms[0] = e->terms[0]; /* structure copy */
@@ -1245,7 +1266,7 @@ yasm_expr_extract_wrt(yasm_expr **ep)
         retval = e->terms[1].data.expn;
     else {
         /* Need to build IDENT expression to hold non-expression contents */
-        retval = yasm_xmalloc(sizeof(yasm_expr));
+        retval = expr_xmalloc(sizeof(yasm_expr));
         retval->op = YASM_EXPR_IDENT;
         retval->numterms = 1;
         retval->terms[0] = e->terms[1]; /* structure copy */
@@ -69,8 +69,8 @@ typedef struct yasm_expr__item {
 /** Expression. */
 struct yasm_expr {
     yasm_expr_op op;    /**< Operation. */
-    unsigned long line; /**< Line number where expression was defined. */
     int numterms;       /**< Number of terms in the expression. */
+    unsigned long line; /**< Line number where expression was defined. */
 
     /** Terms of the expression.  Structure may be extended to include more
      * terms, as some operations may allow more than two operand terms
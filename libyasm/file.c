@@ -24,6 +24,10 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
+/* Need _GNU_SOURCE to prototype fopencookie() */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 #include <util.h>
 
 /* Need either unistd.h or direct.h to prototype getcwd() and mkdir() */
@@ -623,6 +627,239 @@ yasm_add_include_path(const char *path)
     STAILQ_INSERT_TAIL(&incpaths, np, link);
 }
 
+/* Buffer substituted for a source file by yasm_fopen_source() */
+static YASM_THREAD_LOCAL /*@null@*/ const char *memory_source_name = NULL;
+static YASM_THREAD_LOCAL /*@null@*/ const void *memory_source_buf = NULL;
+static YASM_THREAD_LOCAL size_t memory_source_len = 0;
+
+FILE *
+yasm_fopen_source(const char *filename)
+{
+    if (memory_source_name && strcmp(filename, memory_source_name) == 0)
+        return yasm_fopen_memory_read(memory_source_buf, memory_source_len);
+    if (strcmp(filename, "-") == 0)
+        return stdin;
+    return fopen(filename, "r");
+}
+
+void
+yasm__set_memory_source(const char *filename, const void *buf, size_t len)
+{
+    memory_source_name = filename;
+    memory_source_buf = buf;
+    memory_source_len = len;
+}
+
+#if defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN)
+/* Memory stream state.  Read streams use the caller's buffer in place;
+ * write streams grow their own, which is handed over on close.
+ */
+typedef struct memory_stream {
+    /*@null@*/ const unsigned char *data;   /* read streams */
+    /*@null@*/ unsigned char *buf;          /* write streams */
+    size_t len;         /* length of data */
+    size_t size;        /* allocated size of buf */
+    size_t pos;         /* current position */
+
+    /* where to store the result on close (write streams) */
+    /*@null@*/ unsigned char **outbuf;
+    /*@null@*/ size_t *outlen;
+} memory_stream;
+
+static size_t
+memory_stream_read(memory_stream *ms, char *buf, size_t size)
+{
+    if (ms->pos >= ms->len)
+        return 0;
+    if (size > ms->len - ms->pos)
+        size = ms->len - ms->pos;
+    /* write streams are opened for update, so may be read back too */
+    memcpy(buf, (ms->data ? ms->data : ms->buf) + ms->pos, size);
+    ms->pos += size;
+    return size;
+}
+
+static size_t
+memory_stream_write(memory_stream *ms, const char *buf, size_t size)
+{
+    if (ms->pos + size > ms->size) {
+        size_t newsize = ms->size ? ms->size : 4096;
+        while (newsize < ms->pos + size)
+            newsize *= 2;
+        ms->buf = yasm_xrealloc(ms->buf, newsize);
+        ms->size = newsize;
+    }
+    /* seeks past the end leave a gap to be zero-filled */
+    if (ms->pos > ms->len)
+        memset(ms->buf + ms->len, 0, ms->pos - ms->len);
+    memcpy(ms->buf + ms->pos, buf, size);
+    ms->pos += size;
+    if (ms->pos > ms->len)
+        ms->len = ms->pos;
+    return size;
+}
+
+static int
+memory_stream_seek(memory_stream *ms, long *offset, int whence)
+{
+    long base;
+
+    switch (whence) {
+        case SEEK_SET:
+            base = 0;
+            break;
+        case SEEK_CUR:
+            base = (long)ms->pos;
+            break;
+        case SEEK_END:
+            base = (long)ms->len;
+            break;
+        default:
+            return -1;
+    }
+    if (*offset < -base)
+        return -1;
+    ms->pos = (size_t)(base + *offset);
+    *offset = (long)ms->pos;
+    return 0;
+}
+
+static int
+memory_stream_close(memory_stream *ms)
+{
+    if (ms->outbuf) {
+        /* always hand over an allocated buffer, even if empty */
+        if (!ms->buf)
+            ms->buf = yasm_xmalloc(1);
+        *ms->outbuf = ms->buf;
+        *ms->outlen = ms->len;
+    }
+    yasm_xfree(ms);
+    return 0;
+}
+#endif
+
+#if defined(HAVE_FOPENCOOKIE)
+static ssize_t
+memory_cookie_read(void *cookie, char *buf, size_t size)
+{
+    return (ssize_t)memory_stream_read(cookie, buf, size);
+}
+
+static ssize_t
+memory_cookie_write(void *cookie, const char *buf, size_t size)
+{
+    return (ssize_t)memory_stream_write(cookie, buf, size);
+}
+
+static int
+memory_cookie_seek(void *cookie, off64_t *offset, int whence)
+{
+    long off = (long)*offset;
+    if (memory_stream_seek(cookie, &off, whence) != 0)
+        return -1;
+    *offset = (off64_t)off;
+    return 0;
+}
+
+static int
+memory_cookie_close(void *cookie)
+{
+    return memory_stream_close(cookie);
+}
+
+static FILE *
+memory_stream_open(memory_stream *ms, const char *mode)
+{
+    cookie_io_functions_t funcs;
+    FILE *f;
+
+    funcs.read = memory_cookie_read;
+    funcs.write = memory_cookie_write;
+    funcs.seek = memory_cookie_seek;
+    funcs.close = memory_cookie_close;
+    f = fopencookie(ms, mode, funcs);
+    if (!f)
+        yasm_xfree(ms);
+    return f;
+}
+#elif defined(HAVE_FUNOPEN)
+static int
+memory_funopen_read(void *cookie, char *buf, int size)
+{
+    return (int)memory_stream_read(cookie, buf, (size_t)size);
+}
+
+static int
+memory_funopen_write(void *cookie, const char *buf, int size)
+{
+    return (int)memory_stream_write(cookie, buf, (size_t)size);
+}
+
+static fpos_t
+memory_funopen_seek(void *cookie, fpos_t offset, int whence)
+{
+    long off = (long)offset;
+    if (memory_stream_seek(cookie, &off, whence) != 0)
+        return -1;
+    return (fpos_t)off;
+}
+
+static int
+memory_funopen_close(void *cookie)
+{
+    return memory_stream_close(cookie);
+}
+
+static FILE *
+memory_stream_open(memory_stream *ms, /*@unused@*/ const char *mode)
+{
+    FILE *f = funopen(ms, memory_funopen_read, memory_funopen_write,
+                      memory_funopen_seek, memory_funopen_close);
+    if (!f)
+        yasm_xfree(ms);
+    return f;
+}
+#endif
+
+FILE *
+yasm_fopen_memory_read(const void *buf, size_t len)
+{
+#if defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN)
+    memory_stream *ms = yasm_xmalloc(sizeof(memory_stream));
+
+    ms->data = buf;
+    ms->buf = NULL;
+    ms->len = len;
+    ms->size = 0;
+    ms->pos = 0;
+    ms->outbuf = NULL;
+    ms->outlen = NULL;
+    return memory_stream_open(ms, "r");
+#else
+    return NULL;
+#endif
+}
+
+FILE *
+yasm_fopen_memory_write(unsigned char **buf, size_t *len)
+{
+#if defined(HAVE_FOPENCOOKIE) || defined(HAVE_FUNOPEN)
+    memory_stream *ms = yasm_xmalloc(sizeof(memory_stream));
+
+    ms->data = NULL;
+    ms->buf = NULL;
+    ms->len = 0;
+    ms->size = 0;
+    ms->pos = 0;
+    ms->outbuf = buf;
+    ms->outlen = len;
+    return memory_stream_open(ms, "w+");
+#else
+    return NULL;
+#endif
+}
+
 size_t
 yasm_fwrite_16_l(unsigned short val, FILE *f)
 {
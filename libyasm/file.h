@@ -222,6 +222,49 @@ YASM_LIB_DECL
     (const char *iname, const char *from, const char *mode,
      /*@null@*/ /*@out@*/ /*@only@*/ char **oname);
 
+/** Open the main input file of a preprocessor.  The filename "-" is standard
+ * input, and the name given to yasm__set_memory_source() reads that buffer
+ * instead of a file.  The stream should be closed with fclose() unless it is
+ * stdin.
+ * \param filename  input filename
+ * \return Opened file, or NULL if it could not be opened.
+ */
+YASM_LIB_DECL
+/*@null@*/ FILE *yasm_fopen_source(const char *filename);
+
+/** Make yasm_fopen_source() read a buffer in memory for the given filename
+ * (in the current thread).
+ * \internal
+ * \param filename  filename to substitute, or NULL to stop substituting
+ * \param buf       buffer contents (must remain valid until reset)
+ * \param len       length of buffer, in bytes
+ */
+YASM_LIB_DECL
+void yasm__set_memory_source(/*@null@*/ const char *filename,
+                             /*@null@*/ const void *buf, size_t len);
+
+/** Open a read-only stream on a buffer in memory.  Not supported on all
+ * platforms.
+ * \param buf       buffer contents (must remain valid until fclose())
+ * \param len       length of buffer, in bytes
+ * \return Opened stream, or NULL if memory streams are not supported.
+ */
+YASM_LIB_DECL
+/*@null@*/ FILE *yasm_fopen_memory_read(const void *buf, size_t len);
+
+/** Open a stream that writes into a growing buffer in memory.  The stream
+ * may be seeked (including past its end, which fills the gap with zeros).
+ * Not supported on all platforms.
+ * \param buf       where to store the buffer (allocated with yasm_xmalloc())
+ *                  when the stream is closed with fclose()
+ * \param len       where to store the length of the data when the stream is
+ *                  closed
+ * \return Opened stream, or NULL if memory streams are not supported.
+ */
+YASM_LIB_DECL
+/*@null@*/ FILE *yasm_fopen_memory_write(/*@out@*/ unsigned char **buf,
+                                         /*@out@*/ size_t *len);
+
 /** Delete any stored include paths added by yasm_add_include_path().
  */
 YASM_LIB_DECL
@@ -46,9 +46,22 @@
  * Only L.O. bit of Sign byte is significant.  The rest is zero.
  * Exponent is bias 32767.
  * Mantissa does NOT have an implied one bit (it's explicit).
+ *
+ * Literals with no more than 19 significant digits are instead kept in
+ * decimal form (dec_mant * 10^dec_exponent, mantissa NULL).  Single and
+ * double precision values are converted directly from that form; the
+ * internal format is only computed when it's actually needed.
  */
+#ifdef _MSC_VER
+typedef unsigned __int64 floatnum_ul;
+#else
+typedef uint64_t floatnum_ul;
+#endif
+
 struct yasm_floatnum {
-    /*@only@*/ wordptr mantissa;        /* Allocated to MANT_BITS bits */
+    /*@only@*/ /*@null@*/ wordptr mantissa; /* Allocated to MANT_BITS bits */
+    floatnum_ul dec_mant;               /* decimal mantissa (if no mantissa) */
+    int dec_exponent;                   /* decimal exponent (if no mantissa) */
     unsigned short exponent;
     unsigned char sign;
     unsigned char flags;
@@ -58,6 +71,7 @@ struct yasm_floatnum {
 #define MANT_BITS       80
 #define MANT_BYTES      10
 #define MANT_SIGDIGITS  24
+#define DEC_SIGDIGITS   19              /* digits that fit in dec_mant */
 #define EXP_BIAS        0x7FFF
 #define EXP_INF         0xFFFF
 #define EXP_MAX         0xFFFE
@@ -66,6 +80,7 @@ struct yasm_floatnum {
 
 /* Flag settings for flags field */
 #define FLAG_ISZERO     1<<0
+#define FLAG_INEXACT    1<<1    /* mantissa isn't the exact value */
 
 /* Note this structure integrates the floatnum structure */
 typedef struct POT_Entry_s {
@@ -89,7 +104,7 @@ typedef struct POT_Entry_Source_s {
  * entry[12-n] = 10 ** (-2 ** n) for 0 <= n <= 12.
  * entry[13] = 1.0
  */
-static /*@only@*/ POT_Entry *POT_TableN;
+static /*@only@*/ YASM_THREAD_LOCAL POT_Entry *POT_TableN;
 static POT_Entry_Source POT_TableN_Source[] = {
     {{0xe3,0x2d,0xde,0x9f,0xce,0xd2,0xc8,0x04,0xdd,0xa6},0x4ad8}, /* 1e-4096 */
     {{0x25,0x49,0xe4,0x2d,0x36,0x34,0x4f,0x53,0xae,0xce},0x656b}, /* 1e-2048 */
@@ -117,7 +132,7 @@ static POT_Entry_Source POT_TableN_Source[] = {
  * before the table.  This -1 entry is created at runtime by duplicating the
  * 0 entry.
  */
-static /*@only@*/ POT_Entry *POT_TableP;
+static /*@only@*/ YASM_THREAD_LOCAL POT_Entry *POT_TableP;
 static POT_Entry_Source POT_TableP_Source[] = {
     {{0x4c,0xc9,0x9a,0x97,0x20,0x8a,0x02,0x52,0x60,0xc4},0xb525}, /* 1e+4096 */
     {{0x4d,0xa7,0xe4,0x5d,0x3d,0xc5,0x5d,0x3b,0x8b,0x9e},0x9a92}, /* 1e+2048 */
@@ -136,6 +151,672 @@ static POT_Entry_Source POT_TableP_Source[] = {
 };
 
 
+/* 128-bit approximations of the powers of ten 10^POW10_MIN_EXP through
+ * 10^POW10_MAX_EXP, normalized so the top bit is set, used for the direct
+ * single and double precision conversions.  Positive powers are truncated;
+ * negative powers are rounded up.  Each entry is {high 64 bits, low 64 bits}.
+ */
+#define POW10_MIN_EXP   (-342)
+#define POW10_MAX_EXP   308
+#define FLOATNUM_UL(hi, lo) \
+    ((((floatnum_ul)(hi)) << 32) | (floatnum_ul)(lo))
+#define POW10_ENTRY(hh, hl, lh, ll) \
+    {FLOATNUM_UL(hh, hl), FLOATNUM_UL(lh, ll)}
+static const floatnum_ul POW10_Table[][2] = {
+    POW10_ENTRY(0xeef453d6,0x923bd65a,0x113faa29,0x06a13b3f), /* 1e-342 */
+    POW10_ENTRY(0x9558b466,0x1b6565f8,0x4ac7ca59,0xa424c507), /* 1e-341 */
+    POW10_ENTRY(0xbaaee17f,0xa23ebf76,0x5d79bcf0,0x0d2df649), /* 1e-340 */
+    POW10_ENTRY(0xe95a99df,0x8ace6f53,0xf4d82c2c,0x107973dc), /* 1e-339 */
+    POW10_ENTRY(0x91d8a02b,0xb6c10594,0x79071b9b,0x8a4be869), /* 1e-338 */
+    POW10_ENTRY(0xb64ec836,0xa47146f9,0x9748e282,0x6cdee284), /* 1e-337 */
+    POW10_ENTRY(0xe3e27a44,0x4d8d98b7,0xfd1b1b23,0x08169b25), /* 1e-336 */
+    POW10_ENTRY(0x8e6d8c6a,0xb0787f72,0xfe30f0f5,0xe50e20f7), /* 1e-335 */
+    POW10_ENTRY(0xb208ef85,0x5c969f4f,0xbdbd2d33,0x5e51a935), /* 1e-334 */
+    POW10_ENTRY(0xde8b2b66,0xb3bc4723,0xad2c7880,0x35e61382), /* 1e-333 */
+    POW10_ENTRY(0x8b16fb20,0x3055ac76,0x4c3bcb50,0x21afcc31), /* 1e-332 */
+    POW10_ENTRY(0xaddcb9e8,0x3c6b1793,0xdf4abe24,0x2a1bbf3d), /* 1e-331 */
+    POW10_ENTRY(0xd953e862,0x4b85dd78,0xd71d6dad,0x34a2af0d), /* 1e-330 */
+    POW10_ENTRY(0x87d4713d,0x6f33aa6b,0x8672648c,0x40e5ad68), /* 1e-329 */
+    POW10_ENTRY(0xa9c98d8c,0xcb009506,0x680efdaf,0x511f18c2), /* 1e-328 */
+    POW10_ENTRY(0xd43bf0ef,0xfdc0ba48,0x0212bd1b,0x2566def2), /* 1e-327 */
+    POW10_ENTRY(0x84a57695,0xfe98746d,0x014bb630,0xf7604b57), /* 1e-326 */
+    POW10_ENTRY(0xa5ced43b,0x7e3e9188,0x419ea3bd,0x35385e2d), /* 1e-325 */
+    POW10_ENTRY(0xcf42894a,0x5dce35ea,0x52064cac,0x828675b9), /* 1e-324 */
+    POW10_ENTRY(0x818995ce,0x7aa0e1b2,0x7343efeb,0xd1940993), /* 1e-323 */
+    POW10_ENTRY(0xa1ebfb42,0x19491a1f,0x1014ebe6,0xc5f90bf8), /* 1e-322 */
+    POW10_ENTRY(0xca66fa12,0x9f9b60a6,0xd41a26e0,0x77774ef6), /* 1e-321 */
+    POW10_ENTRY(0xfd00b897,0x478238d0,0x8920b098,0x955522b4), /* 1e-320 */
+    POW10_ENTRY(0x9e20735e,0x8cb16382,0x55b46e5f,0x5d5535b0), /* 1e-319 */
+    POW10_ENTRY(0xc5a89036,0x2fddbc62,0xeb2189f7,0x34aa831d), /* 1e-318 */
+    POW10_ENTRY(0xf712b443,0xbbd52b7b,0xa5e9ec75,0x01d523e4), /* 1e-317 */
+    POW10_ENTRY(0x9a6bb0aa,0x55653b2d,0x47b233c9,0x2125366e), /* 1e-316 */
+    POW10_ENTRY(0xc1069cd4,0xeabe89f8,0x999ec0bb,0x696e840a), /* 1e-315 */
+    POW10_ENTRY(0xf148440a,0x256e2c76,0xc00670ea,0x43ca250d), /* 1e-314 */
+    POW10_ENTRY(0x96cd2a86,0x5764dbca,0x38040692,0x6a5e5728), /* 1e-313 */
+    POW10_ENTRY(0xbc807527,0xed3e12bc,0xc6050837,0x04f5ecf2), /* 1e-312 */
+    POW10_ENTRY(0xeba09271,0xe88d976b,0xf7864a44,0xc633682e), /* 1e-311 */
+    POW10_ENTRY(0x93445b87,0x31587ea3,0x7ab3ee6a,0xfbe0211d), /* 1e-310 */
+    POW10_ENTRY(0xb8157268,0xfdae9e4c,0x5960ea05,0xbad82964), /* 1e-309 */
+    POW10_ENTRY(0xe61acf03,0x3d1a45df,0x6fb92487,0x298e33bd), /* 1e-308 */
+    POW10_ENTRY(0x8fd0c162,0x06306bab,0xa5d3b6d4,0x79f8e056), /* 1e-307 */
+    POW10_ENTRY(0xb3c4f1ba,0x87bc8696,0x8f48a489,0x9877186c), /* 1e-306 */
+    POW10_ENTRY(0xe0b62e29,0x29aba83c,0x331acdab,0xfe94de87), /* 1e-305 */
+    POW10_ENTRY(0x8c71dcd9,0xba0b4925,0x9ff0c08b,0x7f1d0b14), /* 1e-304 */
+    POW10_ENTRY(0xaf8e5410,0x288e1b6f,0x07ecf0ae,0x5ee44dd9), /* 1e-303 */
+    POW10_ENTRY(0xdb71e914,0x32b1a24a,0xc9e82cd9,0xf69d6150), /* 1e-302 */
+    POW10_ENTRY(0x892731ac,0x9faf056e,0xbe311c08,0x3a225cd2), /* 1e-301 */
+    POW10_ENTRY(0xab70fe17,0xc79ac6ca,0x6dbd630a,0x48aaf406), /* 1e-300 */
+    POW10_ENTRY(0xd64d3d9d,0xb981787d,0x092cbbcc,0xdad5b108), /* 1e-299 */
+    POW10_ENTRY(0x85f04682,0x93f0eb4e,0x25bbf560,0x08c58ea5), /* 1e-298 */
+    POW10_ENTRY(0xa76c5823,0x38ed2621,0xaf2af2b8,0x0af6f24e), /* 1e-297 */
+    POW10_ENTRY(0xd1476e2c,0x07286faa,0x1af5af66,0x0db4aee1), /* 1e-296 */
+    POW10_ENTRY(0x82cca4db,0x847945ca,0x50d98d9f,0xc890ed4d), /* 1e-295 */
+    POW10_ENTRY(0xa37fce12,0x6597973c,0xe50ff107,0xbab528a0), /* 1e-294 */
+    POW10_ENTRY(0xcc5fc196,0xfefd7d0c,0x1e53ed49,0xa96272c8), /* 1e-293 */
+    POW10_ENTRY(0xff77b1fc,0xbebcdc4f,0x25e8e89c,0x13bb0f7a), /* 1e-292 */
+    POW10_ENTRY(0x9faacf3d,0xf73609b1,0x77b19161,0x8c54e9ac), /* 1e-291 */
+    POW10_ENTRY(0xc795830d,0x75038c1d,0xd59df5b9,0xef6a2417), /* 1e-290 */
+    POW10_ENTRY(0xf97ae3d0,0xd2446f25,0x4b057328,0x6b44ad1d), /* 1e-289 */
+    POW10_ENTRY(0x9becce62,0x836ac577,0x4ee367f9,0x430aec32), /* 1e-288 */
+    POW10_ENTRY(0xc2e801fb,0x244576d5,0x229c41f7,0x93cda73f), /* 1e-287 */
+    POW10_ENTRY(0xf3a20279,0xed56d48a,0x6b435275,0x78c1110f), /* 1e-286 */
+    POW10_ENTRY(0x9845418c,0x345644d6,0x830a1389,0x6b78aaa9), /* 1e-285 */
+    POW10_ENTRY(0xbe5691ef,0x416bd60c,0x23cc986b,0xc656d553), /* 1e-284 */
+    POW10_ENTRY(0xedec366b,0x11c6cb8f,0x2cbfbe86,0xb7ec8aa8), /* 1e-283 */
+    POW10_ENTRY(0x94b3a202,0xeb1c3f39,0x7bf7d714,0x32f3d6a9), /* 1e-282 */
+    POW10_ENTRY(0xb9e08a83,0xa5e34f07,0xdaf5ccd9,0x3fb0cc53), /* 1e-281 */
+    POW10_ENTRY(0xe858ad24,0x8f5c22c9,0xd1b3400f,0x8f9cff68), /* 1e-280 */
+    POW10_ENTRY(0x91376c36,0xd99995be,0x23100809,0xb9c21fa1), /* 1e-279 */
+    POW10_ENTRY(0xb5854744,0x8ffffb2d,0xabd40a0c,0x2832a78a), /* 1e-278 */
+    POW10_ENTRY(0xe2e69915,0xb3fff9f9,0x16c90c8f,0x323f516c), /* 1e-277 */
+    POW10_ENTRY(0x8dd01fad,0x907ffc3b,0xae3da7d9,0x7f6792e3), /* 1e-276 */
+    POW10_ENTRY(0xb1442798,0xf49ffb4a,0x99cd11cf,0xdf41779c), /* 1e-275 */
+    POW10_ENTRY(0xdd95317f,0x31c7fa1d,0x40405643,0xd711d583), /* 1e-274 */
+    POW10_ENTRY(0x8a7d3eef,0x7f1cfc52,0x482835ea,0x666b2572), /* 1e-273 */
+    POW10_ENTRY(0xad1c8eab,0x5ee43b66,0xda324365,0x0005eecf), /* 1e-272 */
+    POW10_ENTRY(0xd863b256,0x369d4a40,0x90bed43e,0x40076a82), /* 1e-271 */
+    POW10_ENTRY(0x873e4f75,0xe2224e68,0x5a7744a6,0xe804a291), /* 1e-270 */
+    POW10_ENTRY(0xa90de353,0x5aaae202,0x711515d0,0xa205cb36), /* 1e-269 */
+    POW10_ENTRY(0xd3515c28,0x31559a83,0x0d5a5b44,0xca873e03), /* 1e-268 */
+    POW10_ENTRY(0x8412d999,0x1ed58091,0xe858790a,0xfe9486c2), /* 1e-267 */
+    POW10_ENTRY(0xa5178fff,0x668ae0b6,0x626e974d,0xbe39a872), /* 1e-266 */
+    POW10_ENTRY(0xce5d73ff,0x402d98e3,0xfb0a3d21,0x2dc8128f), /* 1e-265 */
+    POW10_ENTRY(0x80fa687f,0x881c7f8e,0x7ce66634,0xbc9d0b99), /* 1e-264 */
+    POW10_ENTRY(0xa139029f,0x6a239f72,0x1c1fffc1,0xebc44e80), /* 1e-263 */
+    POW10_ENTRY(0xc9874347,0x44ac874e,0xa327ffb2,0x66b56220), /* 1e-262 */
+    POW10_ENTRY(0xfbe91419,0x15d7a922,0x4bf1ff9f,0x0062baa8), /* 1e-261 */
+    POW10_ENTRY(0x9d71ac8f,0xada6c9b5,0x6f773fc3,0x603db4a9), /* 1e-260 */
+    POW10_ENTRY(0xc4ce17b3,0x99107c22,0xcb550fb4,0x384d21d3), /* 1e-259 */
+    POW10_ENTRY(0xf6019da0,0x7f549b2b,0x7e2a53a1,0x46606a48), /* 1e-258 */
+    POW10_ENTRY(0x99c10284,0x4f94e0fb,0x2eda7444,0xcbfc426d), /* 1e-257 */
+    POW10_ENTRY(0xc0314325,0x637a1939,0xfa911155,0xfefb5308), /* 1e-256 */
+    POW10_ENTRY(0xf03d93ee,0xbc589f88,0x793555ab,0x7eba27ca), /* 1e-255 */
+    POW10_ENTRY(0x96267c75,0x35b763b5,0x4bc1558b,0x2f3458de), /* 1e-254 */
+    POW10_ENTRY(0xbbb01b92,0x83253ca2,0x9eb1aaed,0xfb016f16), /* 1e-253 */
+    POW10_ENTRY(0xea9c2277,0x23ee8bcb,0x465e15a9,0x79c1cadc), /* 1e-252 */
+    POW10_ENTRY(0x92a1958a,0x7675175f,0x0bfacd89,0xec191ec9), /* 1e-251 */
+    POW10_ENTRY(0xb749faed,0x14125d36,0xcef980ec,0x671f667b), /* 1e-250 */
+    POW10_ENTRY(0xe51c79a8,0x5916f484,0x82b7e127,0x80e7401a), /* 1e-249 */
+    POW10_ENTRY(0x8f31cc09,0x37ae58d2,0xd1b2ecb8,0xb0908810), /* 1e-248 */
+    POW10_ENTRY(0xb2fe3f0b,0x8599ef07,0x861fa7e6,0xdcb4aa15), /* 1e-247 */
+    POW10_ENTRY(0xdfbdcece,0x67006ac9,0x67a791e0,0x93e1d49a), /* 1e-246 */
+    POW10_ENTRY(0x8bd6a141,0x006042bd,0xe0c8bb2c,0x5c6d24e0), /* 1e-245 */
+    POW10_ENTRY(0xaecc4991,0x4078536d,0x58fae9f7,0x73886e18), /* 1e-244 */
+    POW10_ENTRY(0xda7f5bf5,0x90966848,0xaf39a475,0x506a899e), /* 1e-243 */
+    POW10_ENTRY(0x888f9979,0x7a5e012d,0x6d8406c9,0x52429603), /* 1e-242 */
+    POW10_ENTRY(0xaab37fd7,0xd8f58178,0xc8e5087b,0xa6d33b83), /* 1e-241 */
+    POW10_ENTRY(0xd5605fcd,0xcf32e1d6,0xfb1e4a9a,0x90880a64), /* 1e-240 */
+    POW10_ENTRY(0x855c3be0,0xa17fcd26,0x5cf2eea0,0x9a55067f), /* 1e-239 */
+    POW10_ENTRY(0xa6b34ad8,0xc9dfc06f,0xf42faa48,0xc0ea481e), /* 1e-238 */
+    POW10_ENTRY(0xd0601d8e,0xfc57b08b,0xf13b94da,0xf124da26), /* 1e-237 */
+    POW10_ENTRY(0x823c1279,0x5db6ce57,0x76c53d08,0xd6b70858), /* 1e-236 */
+    POW10_ENTRY(0xa2cb1717,0xb52481ed,0x54768c4b,0x0c64ca6e), /* 1e-235 */
+    POW10_ENTRY(0xcb7ddcdd,0xa26da268,0xa9942f5d,0xcf7dfd09), /* 1e-234 */
+    POW10_ENTRY(0xfe5d5415,0x0b090b02,0xd3f93b35,0x435d7c4c), /* 1e-233 */
+    POW10_ENTRY(0x9efa548d,0x26e5a6e1,0xc47bc501,0x4a1a6daf), /* 1e-232 */
+    POW10_ENTRY(0xc6b8e9b0,0x709f109a,0x359ab641,0x9ca1091b), /* 1e-231 */
+    POW10_ENTRY(0xf867241c,0x8cc6d4c0,0xc30163d2,0x03c94b62), /* 1e-230 */
+    POW10_ENTRY(0x9b407691,0xd7fc44f8,0x79e0de63,0x425dcf1d), /* 1e-229 */
+    POW10_ENTRY(0xc2109436,0x4dfb5636,0x985915fc,0x12f542e4), /* 1e-228 */
+    POW10_ENTRY(0xf294b943,0xe17a2bc4,0x3e6f5b7b,0x17b2939d), /* 1e-227 */
+    POW10_ENTRY(0x979cf3ca,0x6cec5b5a,0xa705992c,0xeecf9c42), /* 1e-226 */
+    POW10_ENTRY(0xbd8430bd,0x08277231,0x50c6ff78,0x2a838353), /* 1e-225 */
+    POW10_ENTRY(0xece53cec,0x4a314ebd,0xa4f8bf56,0x35246428), /* 1e-224 */
+    POW10_ENTRY(0x940f4613,0xae5ed136,0x871b7795,0xe136be99), /* 1e-223 */
+    POW10_ENTRY(0xb9131798,0x99f68584,0x28e2557b,0x59846e3f), /* 1e-222 */
+    POW10_ENTRY(0xe757dd7e,0xc07426e5,0x331aeada,0x2fe589cf), /* 1e-221 */
+    POW10_ENTRY(0x9096ea6f,0x3848984f,0x3ff0d2c8,0x5def7621), /* 1e-220 */
+    POW10_ENTRY(0xb4bca50b,0x065abe63,0x0fed077a,0x756b53a9), /* 1e-219 */
+    POW10_ENTRY(0xe1ebce4d,0xc7f16dfb,0xd3e84959,0x12c62894), /* 1e-218 */
+    POW10_ENTRY(0x8d3360f0,0x9cf6e4bd,0x64712dd7,0xabbbd95c), /* 1e-217 */
+    POW10_ENTRY(0xb080392c,0xc4349dec,0xbd8d794d,0x96aacfb3), /* 1e-216 */
+    POW10_ENTRY(0xdca04777,0xf541c567,0xecf0d7a0,0xfc5583a0), /* 1e-215 */
+    POW10_ENTRY(0x89e42caa,0xf9491b60,0xf41686c4,0x9db57244), /* 1e-214 */
+    POW10_ENTRY(0xac5d37d5,0xb79b6239,0x311c2875,0xc522ced5), /* 1e-213 */
+    POW10_ENTRY(0xd77485cb,0x25823ac7,0x7d633293,0x366b828b), /* 1e-212 */
+    POW10_ENTRY(0x86a8d39e,0xf77164bc,0xae5dff9c,0x02033197), /* 1e-211 */
+    POW10_ENTRY(0xa8530886,0xb54dbdeb,0xd9f57f83,0x0283fdfc), /* 1e-210 */
+    POW10_ENTRY(0xd267caa8,0x62a12d66,0xd072df63,0xc324fd7b), /* 1e-209 */
+    POW10_ENTRY(0x8380dea9,0x3da4bc60,0x4247cb9e,0x59f71e6d), /* 1e-208 */
+    POW10_ENTRY(0xa4611653,0x8d0deb78,0x52d9be85,0xf074e608), /* 1e-207 */
+    POW10_ENTRY(0xcd795be8,0x70516656,0x67902e27,0x6c921f8b), /* 1e-206 */
+    POW10_ENTRY(0x806bd971,0x4632dff6,0x00ba1cd8,0xa3db53b6), /* 1e-205 */
+    POW10_ENTRY(0xa086cfcd,0x97bf97f3,0x80e8a40e,0xccd228a4), /* 1e-204 */
+    POW10_ENTRY(0xc8a883c0,0xfdaf7df0,0x6122cd12,0x8006b2cd), /* 1e-203 */
+    POW10_ENTRY(0xfad2a4b1,0x3d1b5d6c,0x796b8057,0x20085f81), /* 1e-202 */
+    POW10_ENTRY(0x9cc3a6ee,0xc6311a63,0xcbe33036,0x74053bb0), /* 1e-201 */
+    POW10_ENTRY(0xc3f490aa,0x77bd60fc,0xbedbfc44,0x11068a9c), /* 1e-200 */
+    POW10_ENTRY(0xf4f1b4d5,0x15acb93b,0xee92fb55,0x15482d44), /* 1e-199 */
+    POW10_ENTRY(0x99171105,0x2d8bf3c5,0x751bdd15,0x2d4d1c4a), /* 1e-198 */
+    POW10_ENTRY(0xbf5cd546,0x78eef0b6,0xd262d45a,0x78a0635d), /* 1e-197 */
+    POW10_ENTRY(0xef340a98,0x172aace4,0x86fb8971,0x16c87c34), /* 1e-196 */
+    POW10_ENTRY(0x9580869f,0x0e7aac0e,0xd45d35e6,0xae3d4da0), /* 1e-195 */
+    POW10_ENTRY(0xbae0a846,0xd2195712,0x89748360,0x59cca109), /* 1e-194 */
+    POW10_ENTRY(0xe998d258,0x869facd7,0x2bd1a438,0x703fc94b), /* 1e-193 */
+    POW10_ENTRY(0x91ff8377,0x5423cc06,0x7b6306a3,0x4627ddcf), /* 1e-192 */
+    POW10_ENTRY(0xb67f6455,0x292cbf08,0x1a3bc84c,0x17b1d542), /* 1e-191 */
+    POW10_ENTRY(0xe41f3d6a,0x7377eeca,0x20caba5f,0x1d9e4a93), /* 1e-190 */
+    POW10_ENTRY(0x8e938662,0x882af53e,0x547eb47b,0x7282ee9c), /* 1e-189 */
+    POW10_ENTRY(0xb23867fb,0x2a35b28d,0xe99e619a,0x4f23aa43), /* 1e-188 */
+    POW10_ENTRY(0xdec681f9,0xf4c31f31,0x6405fa00,0xe2ec94d4), /* 1e-187 */
+    POW10_ENTRY(0x8b3c113c,0x38f9f37e,0xde83bc40,0x8dd3dd04), /* 1e-186 */
+    POW10_ENTRY(0xae0b158b,0x4738705e,0x9624ab50,0xb148d445), /* 1e-185 */
+    POW10_ENTRY(0xd98ddaee,0x19068c76,0x3badd624,0xdd9b0957), /* 1e-184 */
+    POW10_ENTRY(0x87f8a8d4,0xcfa417c9,0xe54ca5d7,0x0a80e5d6), /* 1e-183 */
+    POW10_ENTRY(0xa9f6d30a,0x038d1dbc,0x5e9fcf4c,0xcd211f4c), /* 1e-182 */
+    POW10_ENTRY(0xd47487cc,0x8470652b,0x7647c320,0x0069671f), /* 1e-181 */
+    POW10_ENTRY(0x84c8d4df,0xd2c63f3b,0x29ecd9f4,0x0041e073), /* 1e-180 */
+    POW10_ENTRY(0xa5fb0a17,0xc777cf09,0xf4681071,0x00525890), /* 1e-179 */
+    POW10_ENTRY(0xcf79cc9d,0xb955c2cc,0x7182148d,0x4066eeb4), /* 1e-178 */
+    POW10_ENTRY(0x81ac1fe2,0x93d599bf,0xc6f14cd8,0x48405530), /* 1e-177 */
+    POW10_ENTRY(0xa21727db,0x38cb002f,0xb8ada00e,0x5a506a7c), /* 1e-176 */
+    POW10_ENTRY(0xca9cf1d2,0x06fdc03b,0xa6d90811,0xf0e4851c), /* 1e-175 */
+    POW10_ENTRY(0xfd442e46,0x88bd304a,0x908f4a16,0x6d1da663), /* 1e-174 */
+    POW10_ENTRY(0x9e4a9cec,0x15763e2e,0x9a598e4e,0x043287fe), /* 1e-173 */
+    POW10_ENTRY(0xc5dd4427,0x1ad3cdba,0x40eff1e1,0x853f29fd), /* 1e-172 */
+    POW10_ENTRY(0xf7549530,0xe188c128,0xd12bee59,0xe68ef47c), /* 1e-171 */
+    POW10_ENTRY(0x9a94dd3e,0x8cf578b9,0x82bb74f8,0x301958ce), /* 1e-170 */
+    POW10_ENTRY(0xc13a148e,0x3032d6e7,0xe36a5236,0x3c1faf01), /* 1e-169 */
+    POW10_ENTRY(0xf18899b1,0xbc3f8ca1,0xdc44e6c3,0xcb279ac1), /* 1e-168 */
+    POW10_ENTRY(0x96f5600f,0x15a7b7e5,0x29ab103a,0x5ef8c0b9), /* 1e-167 */
+    POW10_ENTRY(0xbcb2b812,0xdb11a5de,0x7415d448,0xf6b6f0e7), /* 1e-166 */
+    POW10_ENTRY(0xebdf6617,0x91d60f56,0x111b495b,0x3464ad21), /* 1e-165 */
+    POW10_ENTRY(0x936b9fce,0xbb25c995,0xcab10dd9,0x00beec34), /* 1e-164 */
+    POW10_ENTRY(0xb84687c2,0x69ef3bfb,0x3d5d514f,0x40eea742), /* 1e-163 */
+    POW10_ENTRY(0xe65829b3,0x046b0afa,0x0cb4a5a3,0x112a5112), /* 1e-162 */
+    POW10_ENTRY(0x8ff71a0f,0xe2c2e6dc,0x47f0e785,0xeaba72ab), /* 1e-161 */
+    POW10_ENTRY(0xb3f4e093,0xdb73a093,0x59ed2167,0x65690f56), /* 1e-160 */
+    POW10_ENTRY(0xe0f218b8,0xd25088b8,0x306869c1,0x3ec3532c), /* 1e-159 */
+    POW10_ENTRY(0x8c974f73,0x83725573,0x1e414218,0xc73a13fb), /* 1e-158 */
+    POW10_ENTRY(0xafbd2350,0x644eeacf,0xe5d1929e,0xf90898fa), /* 1e-157 */
+    POW10_ENTRY(0xdbac6c24,0x7d62a583,0xdf45f746,0xb74abf39), /* 1e-156 */
+    POW10_ENTRY(0x894bc396,0xce5da772,0x6b8bba8c,0x328eb783), /* 1e-155 */
+    POW10_ENTRY(0xab9eb47c,0x81f5114f,0x066ea92f,0x3f326564), /* 1e-154 */
+    POW10_ENTRY(0xd686619b,0xa27255a2,0xc80a537b,0x0efefebd), /* 1e-153 */
+    POW10_ENTRY(0x8613fd01,0x45877585,0xbd06742c,0xe95f5f36), /* 1e-152 */
+    POW10_ENTRY(0xa798fc41,0x96e952e7,0x2c481138,0x23b73704), /* 1e-151 */
+    POW10_ENTRY(0xd17f3b51,0xfca3a7a0,0xf75a1586,0x2ca504c5), /* 1e-150 */
+    POW10_ENTRY(0x82ef8513,0x3de648c4,0x9a984d73,0xdbe722fb), /* 1e-149 */
+    POW10_ENTRY(0xa3ab6658,0x0d5fdaf5,0xc13e60d0,0xd2e0ebba), /* 1e-148 */
+    POW10_ENTRY(0xcc963fee,0x10b7d1b3,0x318df905,0x079926a8), /* 1e-147 */
+    POW10_ENTRY(0xffbbcfe9,0x94e5c61f,0xfdf17746,0x497f7052), /* 1e-146 */
+    POW10_ENTRY(0x9fd561f1,0xfd0f9bd3,0xfeb6ea8b,0xedefa633), /* 1e-145 */
+    POW10_ENTRY(0xc7caba6e,0x7c5382c8,0xfe64a52e,0xe96b8fc0), /* 1e-144 */
+    POW10_ENTRY(0xf9bd690a,0x1b68637b,0x3dfdce7a,0xa3c673b0), /* 1e-143 */
+    POW10_ENTRY(0x9c1661a6,0x51213e2d,0x06bea10c,0xa65c084e), /* 1e-142 */
+    POW10_ENTRY(0xc31bfa0f,0xe5698db8,0x486e494f,0xcff30a62), /* 1e-141 */
+    POW10_ENTRY(0xf3e2f893,0xdec3f126,0x5a89dba3,0xc3efccfa), /* 1e-140 */
+    POW10_ENTRY(0x986ddb5c,0x6b3a76b7,0xf8962946,0x5a75e01c), /* 1e-139 */
+    POW10_ENTRY(0xbe895233,0x86091465,0xf6bbb397,0xf1135823), /* 1e-138 */
+    POW10_ENTRY(0xee2ba6c0,0x678b597f,0x746aa07d,0xed582e2c), /* 1e-137 */
+    POW10_ENTRY(0x94db4838,0x40b717ef,0xa8c2a44e,0xb4571cdc), /* 1e-136 */
+    POW10_ENTRY(0xba121a46,0x50e4ddeb,0x92f34d62,0x616ce413), /* 1e-135 */
+    POW10_ENTRY(0xe896a0d7,0xe51e1566,0x77b020ba,0xf9c81d17), /* 1e-134 */
+    POW10_ENTRY(0x915e2486,0xef32cd60,0x0ace1474,0xdc1d122e), /* 1e-133 */
+    POW10_ENTRY(0xb5b5ada8,0xaaff80b8,0x0d819992,0x132456ba), /* 1e-132 */
+    POW10_ENTRY(0xe3231912,0xd5bf60e6,0x10e1fff6,0x97ed6c69), /* 1e-131 */
+    POW10_ENTRY(0x8df5efab,0xc5979c8f,0xca8d3ffa,0x1ef463c1), /* 1e-130 */
+    POW10_ENTRY(0xb1736b96,0xb6fd83b3,0xbd308ff8,0xa6b17cb2), /* 1e-129 */
+    POW10_ENTRY(0xddd0467c,0x64bce4a0,0xac7cb3f6,0xd05ddbde), /* 1e-128 */
+    POW10_ENTRY(0x8aa22c0d,0xbef60ee4,0x6bcdf07a,0x423aa96b), /* 1e-127 */
+    POW10_ENTRY(0xad4ab711,0x2eb3929d,0x86c16c98,0xd2c953c6), /* 1e-126 */
+    POW10_ENTRY(0xd89d64d5,0x7a607744,0xe871c7bf,0x077ba8b7), /* 1e-125 */
+    POW10_ENTRY(0x87625f05,0x6c7c4a8b,0x11471cd7,0x64ad4972), /* 1e-124 */
+    POW10_ENTRY(0xa93af6c6,0xc79b5d2d,0xd598e40d,0x3dd89bcf), /* 1e-123 */
+    POW10_ENTRY(0xd389b478,0x79823479,0x4aff1d10,0x8d4ec2c3), /* 1e-122 */
+    POW10_ENTRY(0x843610cb,0x4bf160cb,0xcedf722a,0x585139ba), /* 1e-121 */
+    POW10_ENTRY(0xa54394fe,0x1eedb8fe,0xc2974eb4,0xee658828), /* 1e-120 */
+    POW10_ENTRY(0xce947a3d,0xa6a9273e,0x733d2262,0x29feea32), /* 1e-119 */
+    POW10_ENTRY(0x811ccc66,0x8829b887,0x0806357d,0x5a3f525f), /* 1e-118 */
+    POW10_ENTRY(0xa163ff80,0x2a3426a8,0xca07c2dc,0xb0cf26f7), /* 1e-117 */
+    POW10_ENTRY(0xc9bcff60,0x34c13052,0xfc89b393,0xdd02f0b5), /* 1e-116 */
+    POW10_ENTRY(0xfc2c3f38,0x41f17c67,0xbbac2078,0xd443ace2), /* 1e-115 */
+    POW10_ENTRY(0x9d9ba783,0x2936edc0,0xd54b944b,0x84aa4c0d), /* 1e-114 */
+    POW10_ENTRY(0xc5029163,0xf384a931,0x0a9e795e,0x65d4df11), /* 1e-113 */
+    POW10_ENTRY(0xf64335bc,0xf065d37d,0x4d4617b5,0xff4a16d5), /* 1e-112 */
+    POW10_ENTRY(0x99ea0196,0x163fa42e,0x504bced1,0xbf8e4e45), /* 1e-111 */
+    POW10_ENTRY(0xc06481fb,0x9bcf8d39,0xe45ec286,0x2f71e1d6), /* 1e-110 */
+    POW10_ENTRY(0xf07da27a,0x82c37088,0x5d767327,0xbb4e5a4c), /* 1e-109 */
+    POW10_ENTRY(0x964e858c,0x91ba2655,0x3a6a07f8,0xd510f86f), /* 1e-108 */
+    POW10_ENTRY(0xbbe226ef,0xb628afea,0x890489f7,0x0a55368b), /* 1e-107 */
+    POW10_ENTRY(0xeadab0ab,0xa3b2dbe5,0x2b45ac74,0xccea842e), /* 1e-106 */
+    POW10_ENTRY(0x92c8ae6b,0x464fc96f,0x3b0b8bc9,0x0012929d), /* 1e-105 */
+    POW10_ENTRY(0xb77ada06,0x17e3bbcb,0x09ce6ebb,0x40173744), /* 1e-104 */
+    POW10_ENTRY(0xe5599087,0x9ddcaabd,0xcc420a6a,0x101d0515), /* 1e-103 */
+    POW10_ENTRY(0x8f57fa54,0xc2a9eab6,0x9fa94682,0x4a12232d), /* 1e-102 */
+    POW10_ENTRY(0xb32df8e9,0xf3546564,0x47939822,0xdc96abf9), /* 1e-101 */
+    POW10_ENTRY(0xdff97724,0x70297ebd,0x59787e2b,0x93bc56f7), /* 1e-100 */
+    POW10_ENTRY(0x8bfbea76,0xc619ef36,0x57eb4edb,0x3c55b65a), /* 1e-99 */
+    POW10_ENTRY(0xaefae514,0x77a06b03,0xede62292,0x0b6b23f1), /* 1e-98 */
+    POW10_ENTRY(0xdab99e59,0x958885c4,0xe95fab36,0x8e45eced), /* 1e-97 */
+    POW10_ENTRY(0x88b402f7,0xfd75539b,0x11dbcb02,0x18ebb414), /* 1e-96 */
+    POW10_ENTRY(0xaae103b5,0xfcd2a881,0xd652bdc2,0x9f26a119), /* 1e-95 */
+    POW10_ENTRY(0xd59944a3,0x7c0752a2,0x4be76d33,0x46f0495f), /* 1e-94 */
+    POW10_ENTRY(0x857fcae6,0x2d8493a5,0x6f70a440,0x0c562ddb), /* 1e-93 */
+    POW10_ENTRY(0xa6dfbd9f,0xb8e5b88e,0xcb4ccd50,0x0f6bb952), /* 1e-92 */
+    POW10_ENTRY(0xd097ad07,0xa71f26b2,0x7e2000a4,0x1346a7a7), /* 1e-91 */
+    POW10_ENTRY(0x825ecc24,0xc873782f,0x8ed40066,0x8c0c28c8), /* 1e-90 */
+    POW10_ENTRY(0xa2f67f2d,0xfa90563b,0x72890080,0x2f0f32fa), /* 1e-89 */
+    POW10_ENTRY(0xcbb41ef9,0x79346bca,0x4f2b40a0,0x3ad2ffb9), /* 1e-88 */
+    POW10_ENTRY(0xfea126b7,0xd78186bc,0xe2f610c8,0x4987bfa8), /* 1e-87 */
+    POW10_ENTRY(0x9f24b832,0xe6b0f436,0x0dd9ca7d,0x2df4d7c9), /* 1e-86 */
+    POW10_ENTRY(0xc6ede63f,0xa05d3143,0x91503d1c,0x79720dbb), /* 1e-85 */
+    POW10_ENTRY(0xf8a95fcf,0x88747d94,0x75a44c63,0x97ce912a), /* 1e-84 */
+    POW10_ENTRY(0x9b69dbe1,0xb548ce7c,0xc986afbe,0x3ee11aba), /* 1e-83 */
+    POW10_ENTRY(0xc24452da,0x229b021b,0xfbe85bad,0xce996168), /* 1e-82 */
+    POW10_ENTRY(0xf2d56790,0xab41c2a2,0xfae27299,0x423fb9c3), /* 1e-81 */
+    POW10_ENTRY(0x97c560ba,0x6b0919a5,0xdccd879f,0xc967d41a), /* 1e-80 */
+    POW10_ENTRY(0xbdb6b8e9,0x05cb600f,0x5400e987,0xbbc1c920), /* 1e-79 */
+    POW10_ENTRY(0xed246723,0x473e3813,0x290123e9,0xaab23b68), /* 1e-78 */
+    POW10_ENTRY(0x9436c076,0x0c86e30b,0xf9a0b672,0x0aaf6521), /* 1e-77 */
+    POW10_ENTRY(0xb9447093,0x8fa89bce,0xf808e40e,0x8d5b3e69), /* 1e-76 */
+    POW10_ENTRY(0xe7958cb8,0x7392c2c2,0xb60b1d12,0x30b20e04), /* 1e-75 */
+    POW10_ENTRY(0x90bd77f3,0x483bb9b9,0xb1c6f22b,0x5e6f48c2), /* 1e-74 */
+    POW10_ENTRY(0xb4ecd5f0,0x1a4aa828,0x1e38aeb6,0x360b1af3), /* 1e-73 */
+    POW10_ENTRY(0xe2280b6c,0x20dd5232,0x25c6da63,0xc38de1b0), /* 1e-72 */
+    POW10_ENTRY(0x8d590723,0x948a535f,0x579c487e,0x5a38ad0e), /* 1e-71 */
+    POW10_ENTRY(0xb0af48ec,0x79ace837,0x2d835a9d,0xf0c6d851), /* 1e-70 */
+    POW10_ENTRY(0xdcdb1b27,0x98182244,0xf8e43145,0x6cf88e65), /* 1e-69 */
+    POW10_ENTRY(0x8a08f0f8,0xbf0f156b,0x1b8e9ecb,0x641b58ff), /* 1e-68 */
+    POW10_ENTRY(0xac8b2d36,0xeed2dac5,0xe272467e,0x3d222f3f), /* 1e-67 */
+    POW10_ENTRY(0xd7adf884,0xaa879177,0x5b0ed81d,0xcc6abb0f), /* 1e-66 */
+    POW10_ENTRY(0x86ccbb52,0xea94baea,0x98e94712,0x9fc2b4e9), /* 1e-65 */
+    POW10_ENTRY(0xa87fea27,0xa539e9a5,0x3f2398d7,0x47b36224), /* 1e-64 */
+    POW10_ENTRY(0xd29fe4b1,0x8e88640e,0x8eec7f0d,0x19a03aad), /* 1e-63 */
+    POW10_ENTRY(0x83a3eeee,0xf9153e89,0x1953cf68,0x300424ac), /* 1e-62 */
+    POW10_ENTRY(0xa48ceaaa,0xb75a8e2b,0x5fa8c342,0x3c052dd7), /* 1e-61 */
+    POW10_ENTRY(0xcdb02555,0x653131b6,0x3792f412,0xcb06794d), /* 1e-60 */
+    POW10_ENTRY(0x808e1755,0x5f3ebf11,0xe2bbd88b,0xbee40bd0), /* 1e-59 */
+    POW10_ENTRY(0xa0b19d2a,0xb70e6ed6,0x5b6aceae,0xae9d0ec4), /* 1e-58 */
+    POW10_ENTRY(0xc8de0475,0x64d20a8b,0xf245825a,0x5a445275), /* 1e-57 */
+    POW10_ENTRY(0xfb158592,0xbe068d2e,0xeed6e2f0,0xf0d56712), /* 1e-56 */
+    POW10_ENTRY(0x9ced737b,0xb6c4183d,0x55464dd6,0x9685606b), /* 1e-55 */
+    POW10_ENTRY(0xc428d05a,0xa4751e4c,0xaa97e14c,0x3c26b886), /* 1e-54 */
+    POW10_ENTRY(0xf5330471,0x4d9265df,0xd53dd99f,0x4b3066a8), /* 1e-53 */
+    POW10_ENTRY(0x993fe2c6,0xd07b7fab,0xe546a803,0x8efe4029), /* 1e-52 */
+    POW10_ENTRY(0xbf8fdb78,0x849a5f96,0xde985204,0x72bdd033), /* 1e-51 */
+    POW10_ENTRY(0xef73d256,0xa5c0f77c,0x963e6685,0x8f6d4440), /* 1e-50 */
+    POW10_ENTRY(0x95a86376,0x27989aad,0xdde70013,0x79a44aa8), /* 1e-49 */
+    POW10_ENTRY(0xbb127c53,0xb17ec159,0x5560c018,0x580d5d52), /* 1e-48 */
+    POW10_ENTRY(0xe9d71b68,0x9dde71af,0xaab8f01e,0x6e10b4a6), /* 1e-47 */
+    POW10_ENTRY(0x92267121,0x62ab070d,0xcab39613,0x04ca70e8), /* 1e-46 */
+    POW10_ENTRY(0xb6b00d69,0xbb55c8d1,0x3d607b97,0xc5fd0d22), /* 1e-45 */
+    POW10_ENTRY(0xe45c10c4,0x2a2b3b05,0x8cb89a7d,0xb77c506a), /* 1e-44 */
+    POW10_ENTRY(0x8eb98a7a,0x9a5b04e3,0x77f3608e,0x92adb242), /* 1e-43 */
+    POW10_ENTRY(0xb267ed19,0x40f1c61c,0x55f038b2,0x37591ed3), /* 1e-42 */
+    POW10_ENTRY(0xdf01e85f,0x912e37a3,0x6b6c46de,0xc52f6688), /* 1e-41 */
+    POW10_ENTRY(0x8b61313b,0xbabce2c6,0x2323ac4b,0x3b3da015), /* 1e-40 */
+    POW10_ENTRY(0xae397d8a,0xa96c1b77,0xabec975e,0x0a0d081a), /* 1e-39 */
+    POW10_ENTRY(0xd9c7dced,0x53c72255,0x96e7bd35,0x8c904a21), /* 1e-38 */
+    POW10_ENTRY(0x881cea14,0x545c7575,0x7e50d641,0x77da2e54), /* 1e-37 */
+    POW10_ENTRY(0xaa242499,0x697392d2,0xdde50bd1,0xd5d0b9e9), /* 1e-36 */
+    POW10_ENTRY(0xd4ad2dbf,0xc3d07787,0x955e4ec6,0x4b44e864), /* 1e-35 */
+    POW10_ENTRY(0x84ec3c97,0xda624ab4,0xbd5af13b,0xef0b113e), /* 1e-34 */
+    POW10_ENTRY(0xa6274bbd,0xd0fadd61,0xecb1ad8a,0xeacdd58e), /* 1e-33 */
+    POW10_ENTRY(0xcfb11ead,0x453994ba,0x67de18ed,0xa5814af2), /* 1e-32 */
+    POW10_ENTRY(0x81ceb32c,0x4b43fcf4,0x80eacf94,0x8770ced7), /* 1e-31 */
+    POW10_ENTRY(0xa2425ff7,0x5e14fc31,0xa1258379,0xa94d028d), /* 1e-30 */
+    POW10_ENTRY(0xcad2f7f5,0x359a3b3e,0x096ee458,0x13a04330), /* 1e-29 */
+    POW10_ENTRY(0xfd87b5f2,0x8300ca0d,0x8bca9d6e,0x188853fc), /* 1e-28 */
+    POW10_ENTRY(0x9e74d1b7,0x91e07e48,0x775ea264,0xcf55347e), /* 1e-27 */
+    POW10_ENTRY(0xc6120625,0x76589dda,0x95364afe,0x032a819e), /* 1e-26 */
+    POW10_ENTRY(0xf79687ae,0xd3eec551,0x3a83ddbd,0x83f52205), /* 1e-25 */
+    POW10_ENTRY(0x9abe14cd,0x44753b52,0xc4926a96,0x72793543), /* 1e-24 */
+    POW10_ENTRY(0xc16d9a00,0x95928a27,0x75b7053c,0x0f178294), /* 1e-23 */
+    POW10_ENTRY(0xf1c90080,0xbaf72cb1,0x5324c68b,0x12dd6339), /* 1e-22 */
+    POW10_ENTRY(0x971da050,0x74da7bee,0xd3f6fc16,0xebca5e04), /* 1e-21 */
+    POW10_ENTRY(0xbce50864,0x92111aea,0x88f4bb1c,0xa6bcf585), /* 1e-20 */
+    POW10_ENTRY(0xec1e4a7d,0xb69561a5,0x2b31e9e3,0xd06c32e6), /* 1e-19 */
+    POW10_ENTRY(0x9392ee8e,0x921d5d07,0x3aff322e,0x62439fd0), /* 1e-18 */
+    POW10_ENTRY(0xb877aa32,0x36a4b449,0x09befeb9,0xfad487c3), /* 1e-17 */
+    POW10_ENTRY(0xe69594be,0xc44de15b,0x4c2ebe68,0x7989a9b4), /* 1e-16 */
+    POW10_ENTRY(0x901d7cf7,0x3ab0acd9,0x0f9d3701,0x4bf60a11), /* 1e-15 */
+    POW10_ENTRY(0xb424dc35,0x095cd80f,0x538484c1,0x9ef38c95), /* 1e-14 */
+    POW10_ENTRY(0xe12e1342,0x4bb40e13,0x2865a5f2,0x06b06fba), /* 1e-13 */
+    POW10_ENTRY(0x8cbccc09,0x6f5088cb,0xf93f87b7,0x442e45d4), /* 1e-12 */
+    POW10_ENTRY(0xafebff0b,0xcb24aafe,0xf78f69a5,0x1539d749), /* 1e-11 */
+    POW10_ENTRY(0xdbe6fece,0xbdedd5be,0xb573440e,0x5a884d1c), /* 1e-10 */
+    POW10_ENTRY(0x89705f41,0x36b4a597,0x31680a88,0xf8953031), /* 1e-9 */
+    POW10_ENTRY(0xabcc7711,0x8461cefc,0xfdc20d2b,0x36ba7c3e), /* 1e-8 */
+    POW10_ENTRY(0xd6bf94d5,0xe57a42bc,0x3d329076,0x04691b4d), /* 1e-7 */
+    POW10_ENTRY(0x8637bd05,0xaf6c69b5,0xa63f9a49,0xc2c1b110), /* 1e-6 */
+    POW10_ENTRY(0xa7c5ac47,0x1b478423,0x0fcf80dc,0x33721d54), /* 1e-5 */
+    POW10_ENTRY(0xd1b71758,0xe219652b,0xd3c36113,0x404ea4a9), /* 1e-4 */
+    POW10_ENTRY(0x83126e97,0x8d4fdf3b,0x645a1cac,0x083126ea), /* 1e-3 */
+    POW10_ENTRY(0xa3d70a3d,0x70a3d70a,0x3d70a3d7,0x0a3d70a4), /* 1e-2 */
+    POW10_ENTRY(0xcccccccc,0xcccccccc,0xcccccccc,0xcccccccd), /* 1e-1 */
+    POW10_ENTRY(0x80000000,0x00000000,0x00000000,0x00000000), /* 1e+0 */
+    POW10_ENTRY(0xa0000000,0x00000000,0x00000000,0x00000000), /* 1e+1 */
+    POW10_ENTRY(0xc8000000,0x00000000,0x00000000,0x00000000), /* 1e+2 */
+    POW10_ENTRY(0xfa000000,0x00000000,0x00000000,0x00000000), /* 1e+3 */
+    POW10_ENTRY(0x9c400000,0x00000000,0x00000000,0x00000000), /* 1e+4 */
+    POW10_ENTRY(0xc3500000,0x00000000,0x00000000,0x00000000), /* 1e+5 */
+    POW10_ENTRY(0xf4240000,0x00000000,0x00000000,0x00000000), /* 1e+6 */
+    POW10_ENTRY(0x98968000,0x00000000,0x00000000,0x00000000), /* 1e+7 */
+    POW10_ENTRY(0xbebc2000,0x00000000,0x00000000,0x00000000), /* 1e+8 */
+    POW10_ENTRY(0xee6b2800,0x00000000,0x00000000,0x00000000), /* 1e+9 */
+    POW10_ENTRY(0x9502f900,0x00000000,0x00000000,0x00000000), /* 1e+10 */
+    POW10_ENTRY(0xba43b740,0x00000000,0x00000000,0x00000000), /* 1e+11 */
+    POW10_ENTRY(0xe8d4a510,0x00000000,0x00000000,0x00000000), /* 1e+12 */
+    POW10_ENTRY(0x9184e72a,0x00000000,0x00000000,0x00000000), /* 1e+13 */
+    POW10_ENTRY(0xb5e620f4,0x80000000,0x00000000,0x00000000), /* 1e+14 */
+    POW10_ENTRY(0xe35fa931,0xa0000000,0x00000000,0x00000000), /* 1e+15 */
+    POW10_ENTRY(0x8e1bc9bf,0x04000000,0x00000000,0x00000000), /* 1e+16 */
+    POW10_ENTRY(0xb1a2bc2e,0xc5000000,0x00000000,0x00000000), /* 1e+17 */
+    POW10_ENTRY(0xde0b6b3a,0x76400000,0x00000000,0x00000000), /* 1e+18 */
+    POW10_ENTRY(0x8ac72304,0x89e80000,0x00000000,0x00000000), /* 1e+19 */
+    POW10_ENTRY(0xad78ebc5,0xac620000,0x00000000,0x00000000), /* 1e+20 */
+    POW10_ENTRY(0xd8d726b7,0x177a8000,0x00000000,0x00000000), /* 1e+21 */
+    POW10_ENTRY(0x87867832,0x6eac9000,0x00000000,0x00000000), /* 1e+22 */
+    POW10_ENTRY(0xa968163f,0x0a57b400,0x00000000,0x00000000), /* 1e+23 */
+    POW10_ENTRY(0xd3c21bce,0xcceda100,0x00000000,0x00000000), /* 1e+24 */
+    POW10_ENTRY(0x84595161,0x401484a0,0x00000000,0x00000000), /* 1e+25 */
+    POW10_ENTRY(0xa56fa5b9,0x9019a5c8,0x00000000,0x00000000), /* 1e+26 */
+    POW10_ENTRY(0xcecb8f27,0xf4200f3a,0x00000000,0x00000000), /* 1e+27 */
+    POW10_ENTRY(0x813f3978,0xf8940984,0x40000000,0x00000000), /* 1e+28 */
+    POW10_ENTRY(0xa18f07d7,0x36b90be5,0x50000000,0x00000000), /* 1e+29 */
+    POW10_ENTRY(0xc9f2c9cd,0x04674ede,0xa4000000,0x00000000), /* 1e+30 */
+    POW10_ENTRY(0xfc6f7c40,0x45812296,0x4d000000,0x00000000), /* 1e+31 */
+    POW10_ENTRY(0x9dc5ada8,0x2b70b59d,0xf0200000,0x00000000), /* 1e+32 */
+    POW10_ENTRY(0xc5371912,0x364ce305,0x6c280000,0x00000000), /* 1e+33 */
+    POW10_ENTRY(0xf684df56,0xc3e01bc6,0xc7320000,0x00000000), /* 1e+34 */
+    POW10_ENTRY(0x9a130b96,0x3a6c115c,0x3c7f4000,0x00000000), /* 1e+35 */
+    POW10_ENTRY(0xc097ce7b,0xc90715b3,0x4b9f1000,0x00000000), /* 1e+36 */
+    POW10_ENTRY(0xf0bdc21a,0xbb48db20,0x1e86d400,0x00000000), /* 1e+37 */
+    POW10_ENTRY(0x96769950,0xb50d88f4,0x13144480,0x00000000), /* 1e+38 */
+    POW10_ENTRY(0xbc143fa4,0xe250eb31,0x17d955a0,0x00000000), /* 1e+39 */
+    POW10_ENTRY(0xeb194f8e,0x1ae525fd,0x5dcfab08,0x00000000), /* 1e+40 */
+    POW10_ENTRY(0x92efd1b8,0xd0cf37be,0x5aa1cae5,0x00000000), /* 1e+41 */
+    POW10_ENTRY(0xb7abc627,0x050305ad,0xf14a3d9e,0x40000000), /* 1e+42 */
+    POW10_ENTRY(0xe596b7b0,0xc643c719,0x6d9ccd05,0xd0000000), /* 1e+43 */
+    POW10_ENTRY(0x8f7e32ce,0x7bea5c6f,0xe4820023,0xa2000000), /* 1e+44 */
+    POW10_ENTRY(0xb35dbf82,0x1ae4f38b,0xdda2802c,0x8a800000), /* 1e+45 */
+    POW10_ENTRY(0xe0352f62,0xa19e306e,0xd50b2037,0xad200000), /* 1e+46 */
+    POW10_ENTRY(0x8c213d9d,0xa502de45,0x4526f422,0xcc340000), /* 1e+47 */
+    POW10_ENTRY(0xaf298d05,0x0e4395d6,0x9670b12b,0x7f410000), /* 1e+48 */
+    POW10_ENTRY(0xdaf3f046,0x51d47b4c,0x3c0cdd76,0x5f114000), /* 1e+49 */
+    POW10_ENTRY(0x88d8762b,0xf324cd0f,0xa5880a69,0xfb6ac800), /* 1e+50 */
+    POW10_ENTRY(0xab0e93b6,0xefee0053,0x8eea0d04,0x7a457a00), /* 1e+51 */
+    POW10_ENTRY(0xd5d238a4,0xabe98068,0x72a49045,0x98d6d880), /* 1e+52 */
+    POW10_ENTRY(0x85a36366,0xeb71f041,0x47a6da2b,0x7f864750), /* 1e+53 */
+    POW10_ENTRY(0xa70c3c40,0xa64e6c51,0x999090b6,0x5f67d924), /* 1e+54 */
+    POW10_ENTRY(0xd0cf4b50,0xcfe20765,0xfff4b4e3,0xf741cf6d), /* 1e+55 */
+    POW10_ENTRY(0x82818f12,0x81ed449f,0xbff8f10e,0x7a8921a4), /* 1e+56 */
+    POW10_ENTRY(0xa321f2d7,0x226895c7,0xaff72d52,0x192b6a0d), /* 1e+57 */
+    POW10_ENTRY(0xcbea6f8c,0xeb02bb39,0x9bf4f8a6,0x9f764490), /* 1e+58 */
+    POW10_ENTRY(0xfee50b70,0x25c36a08,0x02f236d0,0x4753d5b4), /* 1e+59 */
+    POW10_ENTRY(0x9f4f2726,0x179a2245,0x01d76242,0x2c946590), /* 1e+60 */
+    POW10_ENTRY(0xc722f0ef,0x9d80aad6,0x424d3ad2,0xb7b97ef5), /* 1e+61 */
+    POW10_ENTRY(0xf8ebad2b,0x84e0d58b,0xd2e08987,0x65a7deb2), /* 1e+62 */
+    POW10_ENTRY(0x9b934c3b,0x330c8577,0x63cc55f4,0x9f88eb2f), /* 1e+63 */
+    POW10_ENTRY(0xc2781f49,0xffcfa6d5,0x3cbf6b71,0xc76b25fb), /* 1e+64 */
+    POW10_ENTRY(0xf316271c,0x7fc3908a,0x8bef464e,0x3945ef7a), /* 1e+65 */
+    POW10_ENTRY(0x97edd871,0xcfda3a56,0x97758bf0,0xe3cbb5ac), /* 1e+66 */
+    POW10_ENTRY(0xbde94e8e,0x43d0c8ec,0x3d52eeed,0x1cbea317), /* 1e+67 */
+    POW10_ENTRY(0xed63a231,0xd4c4fb27,0x4ca7aaa8,0x63ee4bdd), /* 1e+68 */
+    POW10_ENTRY(0x945e455f,0x24fb1cf8,0x8fe8caa9,0x3e74ef6a), /* 1e+69 */
+    POW10_ENTRY(0xb975d6b6,0xee39e436,0xb3e2fd53,0x8e122b44), /* 1e+70 */
+    POW10_ENTRY(0xe7d34c64,0xa9c85d44,0x60dbbca8,0x7196b616), /* 1e+71 */
+    POW10_ENTRY(0x90e40fbe,0xea1d3a4a,0xbc8955e9,0x46fe31cd), /* 1e+72 */
+    POW10_ENTRY(0xb51d13ae,0xa4a488dd,0x6babab63,0x98bdbe41), /* 1e+73 */
+    POW10_ENTRY(0xe264589a,0x4dcdab14,0xc696963c,0x7eed2dd1), /* 1e+74 */
+    POW10_ENTRY(0x8d7eb760,0x70a08aec,0xfc1e1de5,0xcf543ca2), /* 1e+75 */
+    POW10_ENTRY(0xb0de6538,0x8cc8ada8,0x3b25a55f,0x43294bcb), /* 1e+76 */
+    POW10_ENTRY(0xdd15fe86,0xaffad912,0x49ef0eb7,0x13f39ebe), /* 1e+77 */
+    POW10_ENTRY(0x8a2dbf14,0x2dfcc7ab,0x6e356932,0x6c784337), /* 1e+78 */
+    POW10_ENTRY(0xacb92ed9,0x397bf996,0x49c2c37f,0x07965404), /* 1e+79 */
+    POW10_ENTRY(0xd7e77a8f,0x87daf7fb,0xdc33745e,0xc97be906), /* 1e+80 */
+    POW10_ENTRY(0x86f0ac99,0xb4e8dafd,0x69a028bb,0x3ded71a3), /* 1e+81 */
+    POW10_ENTRY(0xa8acd7c0,0x222311bc,0xc40832ea,0x0d68ce0c), /* 1e+82 */
+    POW10_ENTRY(0xd2d80db0,0x2aabd62b,0xf50a3fa4,0x90c30190), /* 1e+83 */
+    POW10_ENTRY(0x83c7088e,0x1aab65db,0x792667c6,0xda79e0fa), /* 1e+84 */
+    POW10_ENTRY(0xa4b8cab1,0xa1563f52,0x577001b8,0x91185938), /* 1e+85 */
+    POW10_ENTRY(0xcde6fd5e,0x09abcf26,0xed4c0226,0xb55e6f86), /* 1e+86 */
+    POW10_ENTRY(0x80b05e5a,0xc60b6178,0x544f8158,0x315b05b4), /* 1e+87 */
+    POW10_ENTRY(0xa0dc75f1,0x778e39d6,0x696361ae,0x3db1c721), /* 1e+88 */
+    POW10_ENTRY(0xc913936d,0xd571c84c,0x03bc3a19,0xcd1e38e9), /* 1e+89 */
+    POW10_ENTRY(0xfb587849,0x4ace3a5f,0x04ab48a0,0x4065c723), /* 1e+90 */
+    POW10_ENTRY(0x9d174b2d,0xcec0e47b,0x62eb0d64,0x283f9c76), /* 1e+91 */
+    POW10_ENTRY(0xc45d1df9,0x42711d9a,0x3ba5d0bd,0x324f8394), /* 1e+92 */
+    POW10_ENTRY(0xf5746577,0x930d6500,0xca8f44ec,0x7ee36479), /* 1e+93 */
+    POW10_ENTRY(0x9968bf6a,0xbbe85f20,0x7e998b13,0xcf4e1ecb), /* 1e+94 */
+    POW10_ENTRY(0xbfc2ef45,0x6ae276e8,0x9e3fedd8,0xc321a67e), /* 1e+95 */
+    POW10_ENTRY(0xefb3ab16,0xc59b14a2,0xc5cfe94e,0xf3ea101e), /* 1e+96 */
+    POW10_ENTRY(0x95d04aee,0x3b80ece5,0xbba1f1d1,0x58724a12), /* 1e+97 */
+    POW10_ENTRY(0xbb445da9,0xca61281f,0x2a8a6e45,0xae8edc97), /* 1e+98 */
+    POW10_ENTRY(0xea157514,0x3cf97226,0xf52d09d7,0x1a3293bd), /* 1e+99 */
+    POW10_ENTRY(0x924d692c,0xa61be758,0x593c2626,0x705f9c56), /* 1e+100 */
+    POW10_ENTRY(0xb6e0c377,0xcfa2e12e,0x6f8b2fb0,0x0c77836c), /* 1e+101 */
+    POW10_ENTRY(0xe498f455,0xc38b997a,0x0b6dfb9c,0x0f956447), /* 1e+102 */
+    POW10_ENTRY(0x8edf98b5,0x9a373fec,0x4724bd41,0x89bd5eac), /* 1e+103 */
+    POW10_ENTRY(0xb2977ee3,0x00c50fe7,0x58edec91,0xec2cb657), /* 1e+104 */
+    POW10_ENTRY(0xdf3d5e9b,0xc0f653e1,0x2f2967b6,0x6737e3ed), /* 1e+105 */
+    POW10_ENTRY(0x8b865b21,0x5899f46c,0xbd79e0d2,0x0082ee74), /* 1e+106 */
+    POW10_ENTRY(0xae67f1e9,0xaec07187,0xecd85906,0x80a3aa11), /* 1e+107 */
+    POW10_ENTRY(0xda01ee64,0x1a708de9,0xe80e6f48,0x20cc9495), /* 1e+108 */
+    POW10_ENTRY(0x884134fe,0x908658b2,0x3109058d,0x147fdcdd), /* 1e+109 */
+    POW10_ENTRY(0xaa51823e,0x34a7eede,0xbd4b46f0,0x599fd415), /* 1e+110 */
+    POW10_ENTRY(0xd4e5e2cd,0xc1d1ea96,0x6c9e18ac,0x7007c91a), /* 1e+111 */
+    POW10_ENTRY(0x850fadc0,0x9923329e,0x03e2cf6b,0xc604ddb0), /* 1e+112 */
+    POW10_ENTRY(0xa6539930,0xbf6bff45,0x84db8346,0xb786151c), /* 1e+113 */
+    POW10_ENTRY(0xcfe87f7c,0xef46ff16,0xe6126418,0x65679a63), /* 1e+114 */
+    POW10_ENTRY(0x81f14fae,0x158c5f6e,0x4fcb7e8f,0x3f60c07e), /* 1e+115 */
+    POW10_ENTRY(0xa26da399,0x9aef7749,0xe3be5e33,0x0f38f09d), /* 1e+116 */
+    POW10_ENTRY(0xcb090c80,0x01ab551c,0x5cadf5bf,0xd3072cc5), /* 1e+117 */
+    POW10_ENTRY(0xfdcb4fa0,0x02162a63,0x73d9732f,0xc7c8f7f6), /* 1e+118 */
+    POW10_ENTRY(0x9e9f11c4,0x014dda7e,0x2867e7fd,0xdcdd9afa), /* 1e+119 */
+    POW10_ENTRY(0xc646d635,0x01a1511d,0xb281e1fd,0x541501b8), /* 1e+120 */
+    POW10_ENTRY(0xf7d88bc2,0x4209a565,0x1f225a7c,0xa91a4226), /* 1e+121 */
+    POW10_ENTRY(0x9ae75759,0x6946075f,0x3375788d,0xe9b06958), /* 1e+122 */
+    POW10_ENTRY(0xc1a12d2f,0xc3978937,0x0052d6b1,0x641c83ae), /* 1e+123 */
+    POW10_ENTRY(0xf209787b,0xb47d6b84,0xc0678c5d,0xbd23a49a), /* 1e+124 */
+    POW10_ENTRY(0x9745eb4d,0x50ce6332,0xf840b7ba,0x963646e0), /* 1e+125 */
+    POW10_ENTRY(0xbd176620,0xa501fbff,0xb650e5a9,0x3bc3d898), /* 1e+126 */
+    POW10_ENTRY(0xec5d3fa8,0xce427aff,0xa3e51f13,0x8ab4cebe), /* 1e+127 */
+    POW10_ENTRY(0x93ba47c9,0x80e98cdf,0xc66f336c,0x36b10137), /* 1e+128 */
+    POW10_ENTRY(0xb8a8d9bb,0xe123f017,0xb80b0047,0x445d4184), /* 1e+129 */
+    POW10_ENTRY(0xe6d3102a,0xd96cec1d,0xa60dc059,0x157491e5), /* 1e+130 */
+    POW10_ENTRY(0x9043ea1a,0xc7e41392,0x87c89837,0xad68db2f), /* 1e+131 */
+    POW10_ENTRY(0xb454e4a1,0x79dd1877,0x29babe45,0x98c311fb), /* 1e+132 */
+    POW10_ENTRY(0xe16a1dc9,0xd8545e94,0xf4296dd6,0xfef3d67a), /* 1e+133 */
+    POW10_ENTRY(0x8ce2529e,0x2734bb1d,0x1899e4a6,0x5f58660c), /* 1e+134 */
+    POW10_ENTRY(0xb01ae745,0xb101e9e4,0x5ec05dcf,0xf72e7f8f), /* 1e+135 */
+    POW10_ENTRY(0xdc21a117,0x1d42645d,0x76707543,0xf4fa1f73), /* 1e+136 */
+    POW10_ENTRY(0x899504ae,0x72497eba,0x6a06494a,0x791c53a8), /* 1e+137 */
+    POW10_ENTRY(0xabfa45da,0x0edbde69,0x0487db9d,0x17636892), /* 1e+138 */
+    POW10_ENTRY(0xd6f8d750,0x9292d603,0x45a9d284,0x5d3c42b6), /* 1e+139 */
+    POW10_ENTRY(0x865b8692,0x5b9bc5c2,0x0b8a2392,0xba45a9b2), /* 1e+140 */
+    POW10_ENTRY(0xa7f26836,0xf282b732,0x8e6cac77,0x68d7141e), /* 1e+141 */
+    POW10_ENTRY(0xd1ef0244,0xaf2364ff,0x3207d795,0x430cd926), /* 1e+142 */
+    POW10_ENTRY(0x8335616a,0xed761f1f,0x7f44e6bd,0x49e807b8), /* 1e+143 */
+    POW10_ENTRY(0xa402b9c5,0xa8d3a6e7,0x5f16206c,0x9c6209a6), /* 1e+144 */
+    POW10_ENTRY(0xcd036837,0x130890a1,0x36dba887,0xc37a8c0f), /* 1e+145 */
+    POW10_ENTRY(0x80222122,0x6be55a64,0xc2494954,0xda2c9789), /* 1e+146 */
+    POW10_ENTRY(0xa02aa96b,0x06deb0fd,0xf2db9baa,0x10b7bd6c), /* 1e+147 */
+    POW10_ENTRY(0xc83553c5,0xc8965d3d,0x6f928294,0x94e5acc7), /* 1e+148 */
+    POW10_ENTRY(0xfa42a8b7,0x3abbf48c,0xcb772339,0xba1f17f9), /* 1e+149 */
+    POW10_ENTRY(0x9c69a972,0x84b578d7,0xff2a7604,0x14536efb), /* 1e+150 */
+    POW10_ENTRY(0xc38413cf,0x25e2d70d,0xfef51385,0x19684aba), /* 1e+151 */
+    POW10_ENTRY(0xf46518c2,0xef5b8cd1,0x7eb25866,0x5fc25d69), /* 1e+152 */
+    POW10_ENTRY(0x98bf2f79,0xd5993802,0xef2f773f,0xfbd97a61), /* 1e+153 */
+    POW10_ENTRY(0xbeeefb58,0x4aff8603,0xaafb550f,0xfacfd8fa), /* 1e+154 */
+    POW10_ENTRY(0xeeaaba2e,0x5dbf6784,0x95ba2a53,0xf983cf38), /* 1e+155 */
+    POW10_ENTRY(0x952ab45c,0xfa97a0b2,0xdd945a74,0x7bf26183), /* 1e+156 */
+    POW10_ENTRY(0xba756174,0x393d88df,0x94f97111,0x9aeef9e4), /* 1e+157 */
+    POW10_ENTRY(0xe912b9d1,0x478ceb17,0x7a37cd56,0x01aab85d), /* 1e+158 */
+    POW10_ENTRY(0x91abb422,0xccb812ee,0xac62e055,0xc10ab33a), /* 1e+159 */
+    POW10_ENTRY(0xb616a12b,0x7fe617aa,0x577b986b,0x314d6009), /* 1e+160 */
+    POW10_ENTRY(0xe39c4976,0x5fdf9d94,0xed5a7e85,0xfda0b80b), /* 1e+161 */
+    POW10_ENTRY(0x8e41ade9,0xfbebc27d,0x14588f13,0xbe847307), /* 1e+162 */
+    POW10_ENTRY(0xb1d21964,0x7ae6b31c,0x596eb2d8,0xae258fc8), /* 1e+163 */
+    POW10_ENTRY(0xde469fbd,0x99a05fe3,0x6fca5f8e,0xd9aef3bb), /* 1e+164 */
+    POW10_ENTRY(0x8aec23d6,0x80043bee,0x25de7bb9,0x480d5854), /* 1e+165 */
+    POW10_ENTRY(0xada72ccc,0x20054ae9,0xaf561aa7,0x9a10ae6a), /* 1e+166 */
+    POW10_ENTRY(0xd910f7ff,0x28069da4,0x1b2ba151,0x8094da04), /* 1e+167 */
+    POW10_ENTRY(0x87aa9aff,0x79042286,0x90fb44d2,0xf05d0842), /* 1e+168 */
+    POW10_ENTRY(0xa99541bf,0x57452b28,0x353a1607,0xac744a53), /* 1e+169 */
+    POW10_ENTRY(0xd3fa922f,0x2d1675f2,0x42889b89,0x97915ce8), /* 1e+170 */
+    POW10_ENTRY(0x847c9b5d,0x7c2e09b7,0x69956135,0xfebada11), /* 1e+171 */
+    POW10_ENTRY(0xa59bc234,0xdb398c25,0x43fab983,0x7e699095), /* 1e+172 */
+    POW10_ENTRY(0xcf02b2c2,0x1207ef2e,0x94f967e4,0x5e03f4bb), /* 1e+173 */
+    POW10_ENTRY(0x8161afb9,0x4b44f57d,0x1d1be0ee,0xbac278f5), /* 1e+174 */
+    POW10_ENTRY(0xa1ba1ba7,0x9e1632dc,0x6462d92a,0x69731732), /* 1e+175 */
+    POW10_ENTRY(0xca28a291,0x859bbf93,0x7d7b8f75,0x03cfdcfe), /* 1e+176 */
+    POW10_ENTRY(0xfcb2cb35,0xe702af78,0x5cda7352,0x44c3d43e), /* 1e+177 */
+    POW10_ENTRY(0x9defbf01,0xb061adab,0x3a088813,0x6afa64a7), /* 1e+178 */
+    POW10_ENTRY(0xc56baec2,0x1c7a1916,0x088aaa18,0x45b8fdd0), /* 1e+179 */
+    POW10_ENTRY(0xf6c69a72,0xa3989f5b,0x8aad549e,0x57273d45), /* 1e+180 */
+    POW10_ENTRY(0x9a3c2087,0xa63f6399,0x36ac54e2,0xf678864b), /* 1e+181 */
+    POW10_ENTRY(0xc0cb28a9,0x8fcf3c7f,0x84576a1b,0xb416a7dd), /* 1e+182 */
+    POW10_ENTRY(0xf0fdf2d3,0xf3c30b9f,0x656d44a2,0xa11c51d5), /* 1e+183 */
+    POW10_ENTRY(0x969eb7c4,0x7859e743,0x9f644ae5,0xa4b1b325), /* 1e+184 */
+    POW10_ENTRY(0xbc4665b5,0x96706114,0x873d5d9f,0x0dde1fee), /* 1e+185 */
+    POW10_ENTRY(0xeb57ff22,0xfc0c7959,0xa90cb506,0xd155a7ea), /* 1e+186 */
+    POW10_ENTRY(0x9316ff75,0xdd87cbd8,0x09a7f124,0x42d588f2), /* 1e+187 */
+    POW10_ENTRY(0xb7dcbf53,0x54e9bece,0x0c11ed6d,0x538aeb2f), /* 1e+188 */
+    POW10_ENTRY(0xe5d3ef28,0x2a242e81,0x8f1668c8,0xa86da5fa), /* 1e+189 */
+    POW10_ENTRY(0x8fa47579,0x1a569d10,0xf96e017d,0x694487bc), /* 1e+190 */
+    POW10_ENTRY(0xb38d92d7,0x60ec4455,0x37c981dc,0xc395a9ac), /* 1e+191 */
+    POW10_ENTRY(0xe070f78d,0x3927556a,0x85bbe253,0xf47b1417), /* 1e+192 */
+    POW10_ENTRY(0x8c469ab8,0x43b89562,0x93956d74,0x78ccec8e), /* 1e+193 */
+    POW10_ENTRY(0xaf584166,0x54a6babb,0x387ac8d1,0x970027b2), /* 1e+194 */
+    POW10_ENTRY(0xdb2e51bf,0xe9d0696a,0x06997b05,0xfcc0319e), /* 1e+195 */
+    POW10_ENTRY(0x88fcf317,0xf22241e2,0x441fece3,0xbdf81f03), /* 1e+196 */
+    POW10_ENTRY(0xab3c2fdd,0xeeaad25a,0xd527e81c,0xad7626c3), /* 1e+197 */
+    POW10_ENTRY(0xd60b3bd5,0x6a5586f1,0x8a71e223,0xd8d3b074), /* 1e+198 */
+    POW10_ENTRY(0x85c70565,0x62757456,0xf6872d56,0x67844e49), /* 1e+199 */
+    POW10_ENTRY(0xa738c6be,0xbb12d16c,0xb428f8ac,0x016561db), /* 1e+200 */
+    POW10_ENTRY(0xd106f86e,0x69d785c7,0xe13336d7,0x01beba52), /* 1e+201 */
+    POW10_ENTRY(0x82a45b45,0x0226b39c,0xecc00246,0x61173473), /* 1e+202 */
+    POW10_ENTRY(0xa34d7216,0x42b06084,0x27f002d7,0xf95d0190), /* 1e+203 */
+    POW10_ENTRY(0xcc20ce9b,0xd35c78a5,0x31ec038d,0xf7b441f4), /* 1e+204 */
+    POW10_ENTRY(0xff290242,0xc83396ce,0x7e670471,0x75a15271), /* 1e+205 */
+    POW10_ENTRY(0x9f79a169,0xbd203e41,0x0f0062c6,0xe984d386), /* 1e+206 */
+    POW10_ENTRY(0xc75809c4,0x2c684dd1,0x52c07b78,0xa3e60868), /* 1e+207 */
+    POW10_ENTRY(0xf92e0c35,0x37826145,0xa7709a56,0xccdf8a82), /* 1e+208 */
+    POW10_ENTRY(0x9bbcc7a1,0x42b17ccb,0x88a66076,0x400bb691), /* 1e+209 */
+    POW10_ENTRY(0xc2abf989,0x935ddbfe,0x6acff893,0xd00ea435), /* 1e+210 */
+    POW10_ENTRY(0xf356f7eb,0xf83552fe,0x0583f6b8,0xc4124d43), /* 1e+211 */
+    POW10_ENTRY(0x98165af3,0x7b2153de,0xc3727a33,0x7a8b704a), /* 1e+212 */
+    POW10_ENTRY(0xbe1bf1b0,0x59e9a8d6,0x744f18c0,0x592e4c5c), /* 1e+213 */
+    POW10_ENTRY(0xeda2ee1c,0x7064130c,0x1162def0,0x6f79df73), /* 1e+214 */
+    POW10_ENTRY(0x9485d4d1,0xc63e8be7,0x8addcb56,0x45ac2ba8), /* 1e+215 */
+    POW10_ENTRY(0xb9a74a06,0x37ce2ee1,0x6d953e2b,0xd7173692), /* 1e+216 */
+    POW10_ENTRY(0xe8111c87,0xc5c1ba99,0xc8fa8db6,0xccdd0437), /* 1e+217 */
+    POW10_ENTRY(0x910ab1d4,0xdb9914a0,0x1d9c9892,0x400a22a2), /* 1e+218 */
+    POW10_ENTRY(0xb54d5e4a,0x127f59c8,0x2503beb6,0xd00cab4b), /* 1e+219 */
+    POW10_ENTRY(0xe2a0b5dc,0x971f303a,0x2e44ae64,0x840fd61d), /* 1e+220 */
+    POW10_ENTRY(0x8da471a9,0xde737e24,0x5ceaecfe,0xd289e5d2), /* 1e+221 */
+    POW10_ENTRY(0xb10d8e14,0x56105dad,0x7425a83e,0x872c5f47), /* 1e+222 */
+    POW10_ENTRY(0xdd50f199,0x6b947518,0xd12f124e,0x28f77719), /* 1e+223 */
+    POW10_ENTRY(0x8a5296ff,0xe33cc92f,0x82bd6b70,0xd99aaa6f), /* 1e+224 */
+    POW10_ENTRY(0xace73cbf,0xdc0bfb7b,0x636cc64d,0x1001550b), /* 1e+225 */
+    POW10_ENTRY(0xd8210bef,0xd30efa5a,0x3c47f7e0,0x5401aa4e), /* 1e+226 */
+    POW10_ENTRY(0x8714a775,0xe3e95c78,0x65acfaec,0x34810a71), /* 1e+227 */
+    POW10_ENTRY(0xa8d9d153,0x5ce3b396,0x7f1839a7,0x41a14d0d), /* 1e+228 */
+    POW10_ENTRY(0xd31045a8,0x341ca07c,0x1ede4811,0x1209a050), /* 1e+229 */
+    POW10_ENTRY(0x83ea2b89,0x2091e44d,0x934aed0a,0xab460432), /* 1e+230 */
+    POW10_ENTRY(0xa4e4b66b,0x68b65d60,0xf81da84d,0x5617853f), /* 1e+231 */
+    POW10_ENTRY(0xce1de406,0x42e3f4b9,0x36251260,0xab9d668e), /* 1e+232 */
+    POW10_ENTRY(0x80d2ae83,0xe9ce78f3,0xc1d72b7c,0x6b426019), /* 1e+233 */
+    POW10_ENTRY(0xa1075a24,0xe4421730,0xb24cf65b,0x8612f81f), /* 1e+234 */
+    POW10_ENTRY(0xc94930ae,0x1d529cfc,0xdee033f2,0x6797b627), /* 1e+235 */
+    POW10_ENTRY(0xfb9b7cd9,0xa4a7443c,0x169840ef,0x017da3b1), /* 1e+236 */
+    POW10_ENTRY(0x9d412e08,0x06e88aa5,0x8e1f2895,0x60ee864e), /* 1e+237 */
+    POW10_ENTRY(0xc491798a,0x08a2ad4e,0xf1a6f2ba,0xb92a27e2), /* 1e+238 */
+    POW10_ENTRY(0xf5b5d7ec,0x8acb58a2,0xae10af69,0x6774b1db), /* 1e+239 */
+    POW10_ENTRY(0x9991a6f3,0xd6bf1765,0xacca6da1,0xe0a8ef29), /* 1e+240 */
+    POW10_ENTRY(0xbff610b0,0xcc6edd3f,0x17fd090a,0x58d32af3), /* 1e+241 */
+    POW10_ENTRY(0xeff394dc,0xff8a948e,0xddfc4b4c,0xef07f5b0), /* 1e+242 */
+    POW10_ENTRY(0x95f83d0a,0x1fb69cd9,0x4abdaf10,0x1564f98e), /* 1e+243 */
+    POW10_ENTRY(0xbb764c4c,0xa7a4440f,0x9d6d1ad4,0x1abe37f1), /* 1e+244 */
+    POW10_ENTRY(0xea53df5f,0xd18d5513,0x84c86189,0x216dc5ed), /* 1e+245 */
+    POW10_ENTRY(0x92746b9b,0xe2f8552c,0x32fd3cf5,0xb4e49bb4), /* 1e+246 */
+    POW10_ENTRY(0xb7118682,0xdbb66a77,0x3fbc8c33,0x221dc2a1), /* 1e+247 */
+    POW10_ENTRY(0xe4d5e823,0x92a40515,0x0fabaf3f,0xeaa5334a), /* 1e+248 */
+    POW10_ENTRY(0x8f05b116,0x3ba6832d,0x29cb4d87,0xf2a7400e), /* 1e+249 */
+    POW10_ENTRY(0xb2c71d5b,0xca9023f8,0x743e20e9,0xef511012), /* 1e+250 */
+    POW10_ENTRY(0xdf78e4b2,0xbd342cf6,0x914da924,0x6b255416), /* 1e+251 */
+    POW10_ENTRY(0x8bab8eef,0xb6409c1a,0x1ad089b6,0xc2f7548e), /* 1e+252 */
+    POW10_ENTRY(0xae9672ab,0xa3d0c320,0xa184ac24,0x73b529b1), /* 1e+253 */
+    POW10_ENTRY(0xda3c0f56,0x8cc4f3e8,0xc9e5d72d,0x90a2741e), /* 1e+254 */
+    POW10_ENTRY(0x88658996,0x17fb1871,0x7e2fa67c,0x7a658892), /* 1e+255 */
+    POW10_ENTRY(0xaa7eebfb,0x9df9de8d,0xddbb901b,0x98feeab7), /* 1e+256 */
+    POW10_ENTRY(0xd51ea6fa,0x85785631,0x552a7422,0x7f3ea565), /* 1e+257 */
+    POW10_ENTRY(0x8533285c,0x936b35de,0xd53a8895,0x8f87275f), /* 1e+258 */
+    POW10_ENTRY(0xa67ff273,0xb8460356,0x8a892aba,0xf368f137), /* 1e+259 */
+    POW10_ENTRY(0xd01fef10,0xa657842c,0x2d2b7569,0xb0432d85), /* 1e+260 */
+    POW10_ENTRY(0x8213f56a,0x67f6b29b,0x9c3b2962,0x0e29fc73), /* 1e+261 */
+    POW10_ENTRY(0xa298f2c5,0x01f45f42,0x8349f3ba,0x91b47b8f), /* 1e+262 */
+    POW10_ENTRY(0xcb3f2f76,0x42717713,0x241c70a9,0x36219a73), /* 1e+263 */
+    POW10_ENTRY(0xfe0efb53,0xd30dd4d7,0xed238cd3,0x83aa0110), /* 1e+264 */
+    POW10_ENTRY(0x9ec95d14,0x63e8a506,0xf4363804,0x324a40aa), /* 1e+265 */
+    POW10_ENTRY(0xc67bb459,0x7ce2ce48,0xb143c605,0x3edcd0d5), /* 1e+266 */
+    POW10_ENTRY(0xf81aa16f,0xdc1b81da,0xdd94b786,0x8e94050a), /* 1e+267 */
+    POW10_ENTRY(0x9b10a4e5,0xe9913128,0xca7cf2b4,0x191c8326), /* 1e+268 */
+    POW10_ENTRY(0xc1d4ce1f,0x63f57d72,0xfd1c2f61,0x1f63a3f0), /* 1e+269 */
+    POW10_ENTRY(0xf24a01a7,0x3cf2dccf,0xbc633b39,0x673c8cec), /* 1e+270 */
+    POW10_ENTRY(0x976e4108,0x8617ca01,0xd5be0503,0xe085d813), /* 1e+271 */
+    POW10_ENTRY(0xbd49d14a,0xa79dbc82,0x4b2d8644,0xd8a74e18), /* 1e+272 */
+    POW10_ENTRY(0xec9c459d,0x51852ba2,0xddf8e7d6,0x0ed1219e), /* 1e+273 */
+    POW10_ENTRY(0x93e1ab82,0x52f33b45,0xcabb90e5,0xc942b503), /* 1e+274 */
+    POW10_ENTRY(0xb8da1662,0xe7b00a17,0x3d6a751f,0x3b936243), /* 1e+275 */
+    POW10_ENTRY(0xe7109bfb,0xa19c0c9d,0x0cc51267,0x0a783ad4), /* 1e+276 */
+    POW10_ENTRY(0x906a617d,0x450187e2,0x27fb2b80,0x668b24c5), /* 1e+277 */
+    POW10_ENTRY(0xb484f9dc,0x9641e9da,0xb1f9f660,0x802dedf6), /* 1e+278 */
+    POW10_ENTRY(0xe1a63853,0xbbd26451,0x5e7873f8,0xa0396973), /* 1e+279 */
+    POW10_ENTRY(0x8d07e334,0x55637eb2,0xdb0b487b,0x6423e1e8), /* 1e+280 */
+    POW10_ENTRY(0xb049dc01,0x6abc5e5f,0x91ce1a9a,0x3d2cda62), /* 1e+281 */
+    POW10_ENTRY(0xdc5c5301,0xc56b75f7,0x7641a140,0xcc7810fb), /* 1e+282 */
+    POW10_ENTRY(0x89b9b3e1,0x1b6329ba,0xa9e904c8,0x7fcb0a9d), /* 1e+283 */
+    POW10_ENTRY(0xac2820d9,0x623bf429,0x546345fa,0x9fbdcd44), /* 1e+284 */
+    POW10_ENTRY(0xd732290f,0xbacaf133,0xa97c1779,0x47ad4095), /* 1e+285 */
+    POW10_ENTRY(0x867f59a9,0xd4bed6c0,0x49ed8eab,0xcccc485d), /* 1e+286 */
+    POW10_ENTRY(0xa81f3014,0x49ee8c70,0x5c68f256,0xbfff5a74), /* 1e+287 */
+    POW10_ENTRY(0xd226fc19,0x5c6a2f8c,0x73832eec,0x6fff3111), /* 1e+288 */
+    POW10_ENTRY(0x83585d8f,0xd9c25db7,0xc831fd53,0xc5ff7eab), /* 1e+289 */
+    POW10_ENTRY(0xa42e74f3,0xd032f525,0xba3e7ca8,0xb77f5e55), /* 1e+290 */
+    POW10_ENTRY(0xcd3a1230,0xc43fb26f,0x28ce1bd2,0xe55f35eb), /* 1e+291 */
+    POW10_ENTRY(0x80444b5e,0x7aa7cf85,0x7980d163,0xcf5b81b3), /* 1e+292 */
+    POW10_ENTRY(0xa0555e36,0x1951c366,0xd7e105bc,0xc332621f), /* 1e+293 */
+    POW10_ENTRY(0xc86ab5c3,0x9fa63440,0x8dd9472b,0xf3fefaa7), /* 1e+294 */
+    POW10_ENTRY(0xfa856334,0x878fc150,0xb14f98f6,0xf0feb951), /* 1e+295 */
+    POW10_ENTRY(0x9c935e00,0xd4b9d8d2,0x6ed1bf9a,0x569f33d3), /* 1e+296 */
+    POW10_ENTRY(0xc3b83581,0x09e84f07,0x0a862f80,0xec4700c8), /* 1e+297 */
+    POW10_ENTRY(0xf4a642e1,0x4c6262c8,0xcd27bb61,0x2758c0fa), /* 1e+298 */
+    POW10_ENTRY(0x98e7e9cc,0xcfbd7dbd,0x8038d51c,0xb897789c), /* 1e+299 */
+    POW10_ENTRY(0xbf21e440,0x03acdd2c,0xe0470a63,0xe6bd56c3), /* 1e+300 */
+    POW10_ENTRY(0xeeea5d50,0x04981478,0x1858ccfc,0xe06cac74), /* 1e+301 */
+    POW10_ENTRY(0x95527a52,0x02df0ccb,0x0f37801e,0x0c43ebc8), /* 1e+302 */
+    POW10_ENTRY(0xbaa718e6,0x8396cffd,0xd3056025,0x8f54e6ba), /* 1e+303 */
+    POW10_ENTRY(0xe950df20,0x247c83fd,0x47c6b82e,0xf32a2069), /* 1e+304 */
+    POW10_ENTRY(0x91d28b74,0x16cdd27e,0x4cdc331d,0x57fa5441), /* 1e+305 */
+    POW10_ENTRY(0xb6472e51,0x1c81471d,0xe0133fe4,0xadf8e952), /* 1e+306 */
+    POW10_ENTRY(0xe3d8f9e5,0x63a198e5,0x58180fdd,0xd97723a6), /* 1e+307 */
+    POW10_ENTRY(0x8e679c2f,0x5e44ff8f,0x570f09ea,0xa7ea7648), /* 1e+308 */
+};
+#undef POW10_ENTRY
+
 static void
 POT_Table_Init_Entry(/*@out@*/ POT_Entry *e, POT_Entry_Source *s, int dec_exp)
 {
@@ -152,8 +833,8 @@ POT_Table_Init_Entry(/*@out@*/ POT_Entry *e, POT_Entry_Source *s, int dec_exp)
     /* Set sign to 0 (positive) */
     e->f.sign = 0;
 
-    /* Clear flags */
-    e->f.flags = 0;
+    /* Only 10^0 through 10^32 fit exactly in the mantissa */
+    e->f.flags = (dec_exp < 0 || dec_exp > 32) ? FLAG_INEXACT : 0;
 }
 
 /*@-compdef@*/
@@ -291,8 +972,11 @@ floatnum_mul(yasm_floatnum *acc, const yasm_floatnum *op)
     BitVector_Move_Left(product, (N_int)norm_amt);
     acc->exponent -= (unsigned short)norm_amt;
 
-    /* Store the highest bits of the result */
+    /* Store the highest bits of the result, noting if any others are set */
     BitVector_Interval_Copy(acc->mantissa, product, 0, MANT_BITS, MANT_BITS);
+    if (Set_Min(product) < MANT_BITS)
+        acc->flags |= FLAG_INEXACT;
+    acc->flags |= op->flags & FLAG_INEXACT;
 
     /* Free allocated variables */
     BitVector_Destroy(product);
@@ -300,24 +984,174 @@ floatnum_mul(yasm_floatnum *acc, const yasm_floatnum *op)
     BitVector_Destroy(op2);
 }
 
+/* Set a (zeroed) mantissa to an integer value. */
+static void
+floatnum_set_mant(wordptr mantissa, floatnum_ul val)
+{
+    BitVector_Chunk_Store(mantissa, 32, 0, (N_long)(val & 0xFFFFFFFFUL));
+    BitVector_Chunk_Store(mantissa, 32, 32, (N_long)(val >> 32));
+}
+
+/* Multiply the mantissa by 10 and add in a digit, first moving dec_mant
+ * into it if the number is still in decimal form.
+ */
+static void
+floatnum_mul10_add(yasm_floatnum *flt, floatnum_ul dec_mant, int digit)
+{
+    wordptr operand[2];
+    boolean carry;
+
+    if (!flt->mantissa) {
+        flt->mantissa = BitVector_Create(MANT_BITS, TRUE);
+        floatnum_set_mant(flt->mantissa, dec_mant);
+    }
+
+    operand[0] = BitVector_Create(MANT_BITS, TRUE);
+    operand[1] = BitVector_Create(MANT_BITS, TRUE);
+
+    /* Multiply mantissa by 10 [x = (x<<1)+(x<<3)] */
+    BitVector_shift_left(flt->mantissa, 0);
+    BitVector_Copy(operand[0], flt->mantissa);
+    BitVector_Move_Left(flt->mantissa, 2);
+    carry = 0;
+    BitVector_add(operand[1], operand[0], flt->mantissa, &carry);
+
+    /* Add in current digit */
+    BitVector_Empty(operand[0]);
+    BitVector_Chunk_Store(operand[0], 4, 0, (N_long)digit);
+    carry = 0;
+    BitVector_add(flt->mantissa, operand[1], operand[0], &carry);
+
+    BitVector_Destroy(operand[1]);
+    BitVector_Destroy(operand[0]);
+}
+
+/* Convert an integer mantissa to the internal format by normalizing it and
+ * multiplying by 10^dec_exponent.
+ */
+static void
+floatnum_scale(yasm_floatnum *flt, int dec_exponent)
+{
+    int POT_index;
+
+    /* Normalize the number, checking for 0 first. */
+    if (BitVector_is_empty(flt->mantissa)) {
+        /* Mantissa is 0, zero exponent too. */
+        flt->exponent = 0;
+        /* Set zero flag so output functions don't see 0 value as underflow. */
+        flt->flags |= FLAG_ISZERO;
+        return;
+    }
+    /* Exponent if already norm. */
+    flt->exponent = (unsigned short)(0x7FFF+(MANT_BITS-1));
+    floatnum_normalize(flt);
+
+    /* The number is normalized.  Now multiply by 10 the number of times
+     * specified in DecExponent.  This uses the power of ten tables to speed
+     * up this operation (and make it more accurate).
+     */
+    if (dec_exponent > 0) {
+        POT_index = 0;
+        /* Until we hit 1.0 or finish exponent or overflow */
+        while ((POT_index < 14) && (dec_exponent != 0) &&
+               (flt->exponent != EXP_INF)) {
+            /* Find the first power of ten in the table which is just less than
+             * the exponent.
+             */
+            while (dec_exponent < POT_TableP[POT_index].dec_exponent)
+                POT_index++;
+
+            if (POT_index < 14) {
+                /* Subtract out what we're multiplying in from exponent */
+                dec_exponent -= POT_TableP[POT_index].dec_exponent;
+
+                /* Multiply by current power of 10 */
+                floatnum_mul(flt, &POT_TableP[POT_index].f);
+            }
+        }
+    } else if (dec_exponent < 0) {
+        POT_index = 0;
+        /* Until we hit 1.0 or finish exponent or underflow */
+        while ((POT_index < 14) && (dec_exponent != 0) &&
+               (flt->exponent != EXP_ZERO)) {
+            /* Find the first power of ten in the table which is just less than
+             * the exponent.
+             */
+            while (dec_exponent > POT_TableN[POT_index].dec_exponent)
+                POT_index++;
+
+            if (POT_index < 14) {
+                /* Subtract out what we're multiplying in from exponent */
+                dec_exponent -= POT_TableN[POT_index].dec_exponent;
+
+                /* Multiply by current power of 10 */
+                floatnum_mul(flt, &POT_TableN[POT_index].f);
+            }
+        }
+    }
+
+    /* Round the result if it's inexact. (Don't round underflow or overflow).
+     * Also don't increment if this would cause the mantissa to wrap.
+     */
+    if ((flt->flags & FLAG_INEXACT) &&
+        (flt->exponent != EXP_INF) && (flt->exponent != EXP_ZERO) &&
+        !BitVector_is_full(flt->mantissa))
+        BitVector_increment(flt->mantissa);
+}
+
+/* Get flt in the internal format.  If it's in decimal form, it's converted
+ * into tmp, and tmp->mantissa must be destroyed by the caller.
+ */
+static const yasm_floatnum *
+floatnum_binary(const yasm_floatnum *flt, /*@out@*/ yasm_floatnum *tmp)
+{
+    floatnum_ul dec_mant = flt->dec_mant, pow5 = 1;
+    int dec_exponent = flt->dec_exponent, bin_exponent = 0;
+    int i;
+
+    if (flt->mantissa)
+        return flt;
+
+    /* dec_mant * 10^-n is the binary fraction (dec_mant / 5^n) * 2^-n if
+     * 5^n divides dec_mant; convert those exactly, so that half-way values
+     * can be rounded to even.
+     */
+    for (i=dec_exponent; i<0 && pow5 <= dec_mant/5; i++)
+        pow5 *= 5;
+    if (i == 0 && dec_exponent < 0 && dec_mant % pow5 == 0) {
+        dec_mant /= pow5;
+        bin_exponent = dec_exponent;
+        dec_exponent = 0;
+    }
+
+    tmp->mantissa = BitVector_Create(MANT_BITS, TRUE);
+    floatnum_set_mant(tmp->mantissa, dec_mant);
+    tmp->dec_mant = 0;
+    tmp->dec_exponent = 0;
+    tmp->sign = flt->sign;
+    tmp->flags = 0;
+    floatnum_scale(tmp, dec_exponent);
+    if (tmp->exponent != EXP_ZERO)
+        tmp->exponent = (unsigned short)(tmp->exponent + bin_exponent);
+    return tmp;
+}
+
 yasm_floatnum *
 yasm_floatnum_create(const char *str)
 {
     yasm_floatnum *flt;
     int dec_exponent, dec_exp_add;      /* decimal (powers of 10) exponent */
-    int POT_index;
-    wordptr operand[2];
+    floatnum_ul dec_mant;
     int sig_digits;
     int decimal_pt;
-    boolean carry;
 
     flt = yasm_xmalloc(sizeof(yasm_floatnum));
 
-    flt->mantissa = BitVector_Create(MANT_BITS, TRUE);
-
-    /* allocate and initialize calculation variables */
-    operand[0] = BitVector_Create(MANT_BITS, TRUE);
-    operand[1] = BitVector_Create(MANT_BITS, TRUE);
+    /* Digits are collected in dec_mant while they fit; the mantissa is only
+     * created for longer numbers.
+     */
+    flt->mantissa = NULL;
+    dec_mant = 0;
     dec_exponent = 0;
     sig_digits = 0;
     decimal_pt = 1;
@@ -354,24 +1188,17 @@ yasm_floatnum_create(const char *str)
         /* The number is of the form "yyy.xxxx" (where y <> 0). */
         while (isdigit(*str)) {
             /* See if we've processed more than the max significant digits: */
-            if (sig_digits < MANT_SIGDIGITS) {
-                /* Multiply mantissa by 10 [x = (x<<1)+(x<<3)] */
-                BitVector_shift_left(flt->mantissa, 0);
-                BitVector_Copy(operand[0], flt->mantissa);
-                BitVector_Move_Left(flt->mantissa, 2);
-                carry = 0;
-                BitVector_add(operand[1], operand[0], flt->mantissa, &carry);
-
-                /* Add in current digit */
-                BitVector_Empty(operand[0]);
-                BitVector_Chunk_Store(operand[0], 4, 0, (N_long)(*str-'0'));
-                carry = 0;
-                BitVector_add(flt->mantissa, operand[1], operand[0], &carry);
-            } else {
+            if (sig_digits < DEC_SIGDIGITS)
+                dec_mant = dec_mant*10 + (floatnum_ul)(*str-'0');
+            else if (sig_digits < MANT_SIGDIGITS)
+                floatnum_mul10_add(flt, dec_mant, *str-'0');
+            else {
                 /* Can't integrate more digits with mantissa, so instead just
                  * raise by a power of ten.
                  */
                 dec_exponent++;
+                if (*str != '0')
+                    flt->flags |= FLAG_INEXACT;
             }
             sig_digits++;
             str++;
@@ -391,18 +1218,17 @@ yasm_floatnum_create(const char *str)
                 /* Raise by a power of ten */
                 dec_exponent--;
 
-                /* Multiply mantissa by 10 [x = (x<<1)+(x<<3)] */
-                BitVector_shift_left(flt->mantissa, 0);
-                BitVector_Copy(operand[0], flt->mantissa);
-                BitVector_Move_Left(flt->mantissa, 2);
-                carry = 0;
-                BitVector_add(operand[1], operand[0], flt->mantissa, &carry);
-
-                /* Add in current digit */
-                BitVector_Empty(operand[0]);
-                BitVector_Chunk_Store(operand[0], 4, 0, (N_long)(*str-'0'));
-                carry = 0;
-                BitVector_add(flt->mantissa, operand[1], operand[0], &carry);
+                /* Multiply mantissa by 10 and add in current digit */
+                dec_mant = dec_mant*10 + (floatnum_ul)(*str-'0');
+            } else if (*str != '0') {
+                /* The digit is dropped, so the decimal form isn't exact;
+                 * use the internal format so it's always used for output.
+                 */
+                if (!flt->mantissa) {
+                    flt->mantissa = BitVector_Create(MANT_BITS, TRUE);
+                    floatnum_set_mant(flt->mantissa, dec_mant);
+                }
+                flt->flags |= FLAG_INEXACT;
             }
             sig_digits++;
             str++;
@@ -419,74 +1245,25 @@ yasm_floatnum_create(const char *str)
         dec_exponent += dec_exp_add;
     }
 
-    /* Free calculation variables. */
-    BitVector_Destroy(operand[1]);
-    BitVector_Destroy(operand[0]);
-
-    /* Normalize the number, checking for 0 first. */
-    if (BitVector_is_empty(flt->mantissa)) {
-        /* Mantissa is 0, zero exponent too. */
+    if (!flt->mantissa) {
+        /* Keep the number in decimal form.  Trailing zeros are dropped so
+         * that a value is converted the same way however it's written.
+         */
+        while (dec_mant != 0 && dec_mant % 10 == 0) {
+            dec_mant /= 10;
+            dec_exponent++;
+        }
+        flt->dec_mant = dec_mant;
+        flt->dec_exponent = dec_exponent;
         flt->exponent = 0;
-        /* Set zero flag so output functions don't see 0 value as underflow. */
-        flt->flags |= FLAG_ISZERO;
-        /* Return 0 value. */
+        if (dec_mant == 0)
+            flt->flags |= FLAG_ISZERO;
         return flt;
     }
-    /* Exponent if already norm. */
-    flt->exponent = (unsigned short)(0x7FFF+(MANT_BITS-1));
-    floatnum_normalize(flt);
-
-    /* The number is normalized.  Now multiply by 10 the number of times
-     * specified in DecExponent.  This uses the power of ten tables to speed
-     * up this operation (and make it more accurate).
-     */
-    if (dec_exponent > 0) {
-        POT_index = 0;
-        /* Until we hit 1.0 or finish exponent or overflow */
-        while ((POT_index < 14) && (dec_exponent != 0) &&
-               (flt->exponent != EXP_INF)) {
-            /* Find the first power of ten in the table which is just less than
-             * the exponent.
-             */
-            while (dec_exponent < POT_TableP[POT_index].dec_exponent)
-                POT_index++;
-
-            if (POT_index < 14) {
-                /* Subtract out what we're multiplying in from exponent */
-                dec_exponent -= POT_TableP[POT_index].dec_exponent;
-
-                /* Multiply by current power of 10 */
-                floatnum_mul(flt, &POT_TableP[POT_index].f);
-            }
-        }
-    } else if (dec_exponent < 0) {
-        POT_index = 0;
-        /* Until we hit 1.0 or finish exponent or underflow */
-        while ((POT_index < 14) && (dec_exponent != 0) &&
-               (flt->exponent != EXP_ZERO)) {
-            /* Find the first power of ten in the table which is just less than
-             * the exponent.
-             */
-            while (dec_exponent > POT_TableN[POT_index].dec_exponent)
-                POT_index++;
-
-            if (POT_index < 14) {
-                /* Subtract out what we're multiplying in from exponent */
-                dec_exponent -= POT_TableN[POT_index].dec_exponent;
-
-                /* Multiply by current power of 10 */
-                floatnum_mul(flt, &POT_TableN[POT_index].f);
-            }
-        }
-    }
-
-    /* Round the result. (Don't round underflow or overflow).  Also don't
-     * increment if this would cause the mantissa to wrap.
-     */
-    if ((flt->exponent != EXP_INF) && (flt->exponent != EXP_ZERO) &&
-        !BitVector_is_full(flt->mantissa))
-        BitVector_increment(flt->mantissa);
 
+    flt->dec_mant = 0;
+    flt->dec_exponent = 0;
+    floatnum_scale(flt, dec_exponent);
     return flt;
 }
 
@@ -495,7 +1272,9 @@ yasm_floatnum_copy(const yasm_floatnum *flt)
 {
     yasm_floatnum *f = yasm_xmalloc(sizeof(yasm_floatnum));
 
-    f->mantissa = BitVector_Clone(flt->mantissa);
+    f->mantissa = flt->mantissa ? BitVector_Clone(flt->mantissa) : NULL;
+    f->dec_mant = flt->dec_mant;
+    f->dec_exponent = flt->dec_exponent;
     f->exponent = flt->exponent;
     f->sign = flt->sign;
     f->flags = flt->flags;
@@ -506,7 +1285,8 @@ yasm_floatnum_copy(const yasm_floatnum *flt)
 void
 yasm_floatnum_destroy(yasm_floatnum *flt)
 {
-    BitVector_Destroy(flt->mantissa);
+    if (flt->mantissa)
+        BitVector_Destroy(flt->mantissa);
     yasm_xfree(flt);
 }
 
@@ -554,6 +1334,7 @@ floatnum_get_common(const yasm_floatnum *flt, /*@out@*/ unsigned char *ptr,
                     N_int exp_bits)
 {
     long exponent = (long)flt->exponent;
+    N_int round_bit;
     wordptr output;
     charptr buf;
     unsigned int len;
@@ -569,8 +1350,12 @@ floatnum_get_common(const yasm_floatnum *flt, /*@out@*/ unsigned char *ptr,
                             (N_int)((MANT_BITS-implicit1)-mant_bits),
                             mant_bits);
 
-    /* round mantissa */
-    if (BitVector_bit_test(flt->mantissa, (MANT_BITS-implicit1)-(mant_bits+1)))
+    /* round mantissa; exactly half-way values are rounded to even */
+    round_bit = (MANT_BITS-implicit1)-(mant_bits+1);
+    if (BitVector_bit_test(flt->mantissa, round_bit) &&
+        ((flt->flags & FLAG_INEXACT) ||
+         Set_Min(flt->mantissa) < (Z_long)round_bit ||
+         BitVector_bit_test(output, 0)))
         BitVector_increment(output);
 
     if (BitVector_bit_test(output, mant_bits)) {
@@ -630,6 +1415,126 @@ floatnum_get_common(const yasm_floatnum *flt, /*@out@*/ unsigned char *ptr,
     return retval;
 }
 
+/* Multiply two 64-bit values; returns the high 64 bits of the product and
+ * the low 64 bits in lo.
+ */
+static floatnum_ul
+floatnum_mul64(floatnum_ul a, floatnum_ul b, /*@out@*/ floatnum_ul *lo)
+{
+    floatnum_ul a0 = a & 0xFFFFFFFFUL, a1 = a >> 32;
+    floatnum_ul b0 = b & 0xFFFFFFFFUL, b1 = b >> 32;
+    floatnum_ul p00 = a0*b0, p01 = a0*b1, p10 = a1*b0, p11 = a1*b1;
+    floatnum_ul mid = (p00 >> 32) + (p01 & 0xFFFFFFFFUL) +
+        (p10 & 0xFFFFFFFFUL);
+
+    *lo = (mid << 32) | (p00 & 0xFFFFFFFFUL);
+    return p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+
+/* Function used by conversion routines to convert a decimal form value
+ * directly to a format with an implicit one bit, correctly rounded, using
+ * the Eisel-Lemire algorithm.
+ *
+ * Parameters are as for floatnum_get_common() (mant_bits <= 52).
+ *
+ * Returns 1 on success, 0 if the result can't be determined this way (it's
+ * too close to a rounding boundary, or isn't a normal number); the internal
+ * format must then be used.
+ */
+static int
+floatnum_get_dec(const yasm_floatnum *flt, /*@out@*/ unsigned char *ptr,
+                 N_int byte_size, N_int mant_bits, N_int exp_bits)
+{
+    floatnum_ul man = flt->dec_mant;
+    floatnum_ul hi, lo, y_hi, y_lo, mask, bits;
+    const floatnum_ul *pow10;
+    long exponent;
+    int dec_exp = flt->dec_exponent;
+    int clz = 0, msb;
+    unsigned int i;
+
+    if (man == 0) {
+        memset(ptr, 0, byte_size);
+        ptr[byte_size-1] = (unsigned char)(flt->sign << 7);
+        return 1;
+    }
+    if (dec_exp < POW10_MIN_EXP || dec_exp > POW10_MAX_EXP)
+        return 0;
+    pow10 = POW10_Table[dec_exp-POW10_MIN_EXP];
+
+    /* Normalize the mantissa so the top bit is set. */
+    for (i=32; i>0; i/=2) {
+        if ((man >> (64-i)) == 0) {
+            man <<= i;
+            clz += (int)i;
+        }
+    }
+
+    /* Binary exponent: floor(dec_exp*log2(10)) + 64 + bias - clz.
+     * 217706/65536 is log2(10) to enough precision for the table range.
+     */
+    if (dec_exp >= 0)
+        exponent = 217706L*dec_exp/65536;
+    else
+        exponent = -((65535-217706L*dec_exp)/65536);
+    exponent += 64 + ((1L<<(exp_bits-1))-1) - clz;
+
+    /* Multiply by the high half of the power of ten.  If the bits below the
+     * result mantissa (and rounding bit) are all ones, the low half could
+     * carry into them, so include it too.
+     */
+    mask = (((floatnum_ul)1) << (61-mant_bits)) - 1;
+    hi = floatnum_mul64(man, pow10[0], &lo);
+    if ((hi & mask) == mask && lo + man < man) {
+        y_hi = floatnum_mul64(man, pow10[1], &y_lo);
+        lo += y_hi;
+        if (lo < y_hi)
+            hi++;
+        if ((hi & mask) == mask && lo + 1 == 0 && y_lo + man < man)
+            return 0;
+    }
+
+    /* Shift to mant_bits+2 bits (including the implicit one and a rounding
+     * bit).
+     */
+    msb = (int)(hi >> 63);
+    bits = hi >> (msb + 61 - mant_bits);
+    exponent -= 1 ^ msb;
+
+    /* Round (to even) to mant_bits+1 bits.  If the product looks exactly
+     * half-way between two values, it is only known to be exact (and thus
+     * really half-way) when the power of ten is an exact 64-bit value.
+     */
+    if (lo == 0 && (hi & mask) == 0 && (bits & 3) == 1) {
+        if (dec_exp < 0 || dec_exp > 27)
+            return 0;
+        /* With msb set, one more bit was shifted out below the round bit. */
+        if (msb == 0 || ((hi >> (61-mant_bits)) & 1) == 0)
+            bits &= ~(floatnum_ul)1;
+    }
+    bits += bits & 1;
+    bits >>= 1;
+    if (bits >> (mant_bits+1)) {
+        bits >>= 1;
+        exponent++;
+    }
+
+    /* Leave underflow, denormals and overflow to the internal format. */
+    if (exponent <= 0 || exponent >= (1L<<exp_bits)-1)
+        return 0;
+
+    bits &= (((floatnum_ul)1) << mant_bits) - 1;
+    bits |= ((floatnum_ul)exponent) << mant_bits;
+    bits |= ((floatnum_ul)flt->sign) << (byte_size*8-1);
+
+    /* get little-endian bytes */
+    for (i=0; i<byte_size; i++) {
+        ptr[i] = (unsigned char)(bits & 0xFF);
+        bits >>= 8;
+    }
+    return 1;
+}
+
 /* IEEE-754r "half precision" format:
  * 16 bits:
  * 15     9      Bit 0
@@ -675,29 +1580,43 @@ yasm_floatnum_get_sized(const yasm_floatnum *flt, unsigned char *ptr,
                         size_t destsize, size_t valsize, size_t shift,
                         int bigendian, int warn)
 {
+    yasm_floatnum tmp;
+    const yasm_floatnum *bin;
     int retval;
     if (destsize*8 != valsize || shift>0 || bigendian) {
         /* TODO */
         yasm_internal_error(N_("unsupported floatnum functionality"));
     }
+
+    /* Convert decimal form single and double precision values directly. */
+    if (!flt->mantissa) {
+        if (destsize == 4 && floatnum_get_dec(flt, ptr, 4, 23, 8))
+            return 0;
+        if (destsize == 8 && floatnum_get_dec(flt, ptr, 8, 52, 11))
+            return 0;
+    }
+
+    bin = floatnum_binary(flt, &tmp);
     switch (destsize) {
         case 2:
-            retval = floatnum_get_common(flt, ptr, 2, 10, 1, 5);
+            retval = floatnum_get_common(bin, ptr, 2, 10, 1, 5);
             break;
         case 4:
-            retval = floatnum_get_common(flt, ptr, 4, 23, 1, 8);
+            retval = floatnum_get_common(bin, ptr, 4, 23, 1, 8);
             break;
         case 8:
-            retval = floatnum_get_common(flt, ptr, 8, 52, 1, 11);
+            retval = floatnum_get_common(bin, ptr, 8, 52, 1, 11);
             break;
         case 10:
-            retval = floatnum_get_common(flt, ptr, 10, 64, 0, 15);
+            retval = floatnum_get_common(bin, ptr, 10, 64, 0, 15);
             break;
         default:
             yasm_internal_error(N_("Invalid float conversion size"));
             /*@notreached@*/
             return 1;
     }
+    if (bin == &tmp)
+        BitVector_Destroy(tmp.mantissa);
     if (warn) {
         if (retval < 0)
             yasm_warn_set(YASM_WARN_GENERAL,
@@ -727,15 +1646,20 @@ yasm_floatnum_check_size(/*@unused@*/ const yasm_floatnum *flt, size_t size)
 void
 yasm_floatnum_print(const yasm_floatnum *flt, FILE *f)
 {
+    yasm_floatnum tmp;
+    const yasm_floatnum *bin;
     unsigned char out[10];
     unsigned char *str;
     int i;
 
     /* Internal format */
-    str = BitVector_to_Hex(flt->mantissa);
+    bin = floatnum_binary(flt, &tmp);
+    str = BitVector_to_Hex(bin->mantissa);
     fprintf(f, "%c %s *2^%04x\n", flt->sign?'-':'+', (char *)str,
-            flt->exponent);
+            bin->exponent);
     yasm_xfree(str);
+    if (bin == &tmp)
+        BitVector_Destroy(tmp.mantissa);
 
     /* 32-bit (single precision) format */
     fprintf(f, "32-bit: %d: ",
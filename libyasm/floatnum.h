@@ -36,11 +36,13 @@
 #define YASM_LIB_DECL
 #endif
 
-/** Initialize floatnum internal data structures. */
+/** Initialize floatnum internal data structures.  This state is per-thread,
+ * so this must be called in each thread that uses libyasm.
+ */
 YASM_LIB_DECL
 void yasm_floatnum_initialize(void);
 
-/** Clean up internal floatnum allocations. */
+/** Clean up internal floatnum allocations for the calling thread. */
 YASM_LIB_DECL
 void yasm_floatnum_cleanup(void);
 
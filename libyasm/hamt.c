@@ -48,9 +48,39 @@ typedef struct HAMTNode {
     uintptr_t BaseValue;                /* Base of HAMTNode list or value */
 } HAMTNode;
 
+/* Subtrie node lists and entries are carved out of chunks owned by the
+ * HAMT, which are all released together when it is destroyed.  Node lists
+ * are allocated in power-of-two sizes, so most insertions into a subtrie
+ * fit in place; lists that are outgrown are kept on per-size free lists.
+ */
+typedef struct HAMTChunk {
+    /*@null@*/ /*@owned@*/ struct HAMTChunk *next;
+    HAMTNode nodes[1];                  /* actually longer */
+} HAMTChunk;
+
+/* Number of node list sizes (1, 2, 4, ... 32 nodes) */
+#define HAMT_NUM_SIZES      6
+
+/* Number of nodes in the first chunk (unless reserved otherwise), and the
+ * most in any later chunk; each chunk is twice the size of the previous.
+ */
+#define HAMT_CHUNK_MIN      32
+#define HAMT_CHUNK_MAX      4096
+
+/* Nodes taken up by an entry */
+#define HAMT_ENTRY_NODES    \
+    ((sizeof(HAMTEntry)+sizeof(HAMTNode)-1)/sizeof(HAMTNode))
+
 struct HAMT {
     STAILQ_HEAD(HAMTEntryHead, HAMTEntry) entries;
     HAMTNode *root;
+
+    /* node storage */
+    /*@null@*/ /*@owned@*/ HAMTChunk *chunks;
+    /*@null@*/ /*@dependent@*/ HAMTNode *avail;
+    size_t avail_len;       /* nodes available at avail */
+    size_t chunk_size;      /* nodes in the next chunk */
+    /*@null@*/ /*@dependent@*/ HAMTNode *free[HAMT_NUM_SIZES];
     /*@exits@*/ void (*error_func) (const char *file, unsigned int line,
                                     const char *message);
     unsigned long (*HashKey) (const char *key);
@@ -77,6 +107,77 @@ struct HAMT {
     } while (0)
 #define GetSubTrie(n)           (HAMTNode *)(((n)->BaseValue | 1) ^ 1)
 
+/* Returns the log2 of the allocated size of a node list holding n nodes. */
+static int
+NodesSizeIndex(unsigned long n)
+{
+    int i = 0;
+    while ((1UL<<i) < n)
+        i++;
+    return i;
+}
+
+static /*@dependent@*/ HAMTNode *
+HAMT_carve(HAMT *hamt, size_t n)
+{
+    HAMTNode *nodes;
+
+    if (hamt->avail_len < n) {
+        HAMTChunk *chunk;
+        size_t size = hamt->chunk_size;
+
+        if (size < n)
+            size = n;
+        chunk = yasm_xmalloc(sizeof(HAMTChunk)+(size-1)*sizeof(HAMTNode));
+        chunk->next = hamt->chunks;
+        hamt->chunks = chunk;
+        hamt->avail = chunk->nodes;
+        hamt->avail_len = size;
+        if (hamt->chunk_size < HAMT_CHUNK_MAX)
+            hamt->chunk_size *= 2;
+    }
+
+    nodes = hamt->avail;
+    hamt->avail += n;
+    hamt->avail_len -= n;
+    return nodes;
+}
+
+/* Allocates a node list with room for n nodes. */
+static /*@dependent@*/ HAMTNode *
+HAMT_alloc_nodes(HAMT *hamt, unsigned long n)
+{
+    int i = NodesSizeIndex(n);
+    HAMTNode *nodes = hamt->free[i];
+
+    if (nodes) {
+        hamt->free[i] = (HAMTNode *)nodes->BaseValue;
+        return nodes;
+    }
+    return HAMT_carve(hamt, (size_t)1<<i);
+}
+
+/* Releases a node list allocated with room for n nodes. */
+static void
+HAMT_free_nodes(HAMT *hamt, /*@dependent@*/ HAMTNode *nodes, unsigned long n)
+{
+    int i = NodesSizeIndex(n);
+
+    nodes->BaseValue = (uintptr_t)hamt->free[i];
+    hamt->free[i] = nodes;
+}
+
+static /*@dependent@*/ HAMTEntry *
+HAMT_new_entry(HAMT *hamt, /*@dependent@*/ const char *str,
+               /*@only@*/ void *data)
+{
+    HAMTEntry *entry = (HAMTEntry *)HAMT_carve(hamt, HAMT_ENTRY_NODES);
+    entry->str = str;
+    entry->data = data;
+    STAILQ_INSERT_TAIL(&hamt->entries, entry, next);
+    return entry;
+}
+
 static unsigned long
 HashKey(const char *key)
 {
@@ -123,6 +224,13 @@ HAMT_create(int nocase, /*@exits@*/ void (*error_func)
     STAILQ_INIT(&hamt->entries);
     hamt->root = yasm_xmalloc(32*sizeof(HAMTNode));
 
+    hamt->chunks = NULL;
+    hamt->avail = NULL;
+    hamt->avail_len = 0;
+    hamt->chunk_size = HAMT_CHUNK_MIN;
+    for (i=0; i<HAMT_NUM_SIZES; i++)
+        hamt->free[i] = NULL;
+
     for (i=0; i<32; i++) {
         hamt->root[i].BitMapKey = 0;
         hamt->root[i].BaseValue = 0;
@@ -142,41 +250,31 @@ HAMT_create(int nocase, /*@exits@*/ void (*error_func)
     return hamt;
 }
 
-static void
-HAMT_delete_trie(HAMTNode *node)
+void
+HAMT_reserve(HAMT *hamt, unsigned long count)
 {
-    if (IsSubTrie(node)) {
-        unsigned long i, Size;
-
-        /* Count total number of bits in bitmap to determine size */
-        BitCount(Size, node->BitMapKey);
-        Size &= 0x1F;
-        if (Size == 0)
-            Size = 32;
-
-        for (i=0; i<Size; i++)
-            HAMT_delete_trie(&(GetSubTrie(node))[i]);
-        yasm_xfree(GetSubTrie(node));
-    }
+    /* Allow for about one subtrie node per entry */
+    size_t size = (size_t)count*(HAMT_ENTRY_NODES+1);
+
+    if (!hamt->chunks && size > hamt->chunk_size)
+        hamt->chunk_size = size;
 }
 
 void
 HAMT_destroy(HAMT *hamt, void (*deletefunc) (/*@only@*/ void *data))
 {
-    int i;
+    HAMTEntry *entry;
 
-    /* delete entries */
-    while (!STAILQ_EMPTY(&hamt->entries)) {
-        HAMTEntry *entry;
-        entry = STAILQ_FIRST(&hamt->entries);
-        STAILQ_REMOVE_HEAD(&hamt->entries, next);
+    /* delete data */
+    STAILQ_FOREACH(entry, &hamt->entries, next)
         deletefunc(entry->data);
-        yasm_xfree(entry);
-    }
 
-    /* delete trie */
-    for (i=0; i<32; i++)
-        HAMT_delete_trie(&hamt->root[i]);
+    /* delete entries and trie */
+    while (hamt->chunks) {
+        HAMTChunk *chunk = hamt->chunks;
+        hamt->chunks = chunk->next;
+        yasm_xfree(chunk);
+    }
 
     yasm_xfree(hamt->root);
     yasm_xfree(hamt);
@@ -231,10 +329,7 @@ HAMT_insert(HAMT *hamt, const char *str, void *data, int *replace,
 
     if (!node->BaseValue) {
         node->BitMapKey = key;
-        entry = yasm_xmalloc(sizeof(HAMTEntry));
-        entry->str = str;
-        entry->data = data;
-        STAILQ_INSERT_TAIL(&hamt->entries, entry, next);
+        entry = HAMT_new_entry(hamt, str, data);
         SetValue(hamt, node, entry);
         if (IsSubTrie(node))
             hamt->error_func(__FILE__, __LINE__,
@@ -279,7 +374,7 @@ HAMT_insert(HAMT *hamt, const char *str, void *data, int *replace,
                         /* Still equal, build one-node subtrie and continue
                          * downward.
                          */
-                        newnodes = yasm_xmalloc(sizeof(HAMTNode));
+                        newnodes = HAMT_alloc_nodes(hamt, 1);
                         newnodes[0].BitMapKey = key2;
                         newnodes[0].BaseValue = node->BaseValue;
                         node->BitMapKey = 1<<keypart;
@@ -288,12 +383,8 @@ HAMT_insert(HAMT *hamt, const char *str, void *data, int *replace,
                         level++;
                     } else {
                         /* partitioned: allocate two-node subtrie */
-                        newnodes = yasm_xmalloc(2*sizeof(HAMTNode));
-
-                        entry = yasm_xmalloc(sizeof(HAMTEntry));
-                        entry->str = str;
-                        entry->data = data;
-                        STAILQ_INSERT_TAIL(&hamt->entries, entry, next);
+                        newnodes = HAMT_alloc_nodes(hamt, 2);
+                        entry = HAMT_new_entry(hamt, str, data);
 
                         /* Copy nodes into subtrie based on order */
                         if (keypart2 < keypart) {
@@ -338,23 +429,27 @@ HAMT_insert(HAMT *hamt, const char *str, void *data, int *replace,
             Size &= 0x1F;
             if (Size == 0)
                 Size = 32;
-            newnodes = yasm_xmalloc(Size*sizeof(HAMTNode));
 
             /* Count bits below to find where to insert new node at */
             BitCount(Map, node->BitMapKey & ~((~0UL)<<keypart));
             Map &= 0x1F;        /* Clamp to <32 */
-            /* Copy existing nodes leaving gap for new node */
-            memcpy(newnodes, GetSubTrie(node), Map*sizeof(HAMTNode));
-            memcpy(&newnodes[Map+1], &(GetSubTrie(node))[Map],
-                   (Size-Map-1)*sizeof(HAMTNode));
-            /* Delete old subtrie */
-            yasm_xfree(GetSubTrie(node));
+            if (NodesSizeIndex(Size) == NodesSizeIndex(Size-1)) {
+                /* Fits in place: move up nodes to leave gap for new node */
+                newnodes = GetSubTrie(node);
+                memmove(&newnodes[Map+1], &newnodes[Map],
+                        (Size-Map-1)*sizeof(HAMTNode));
+            } else {
+                newnodes = HAMT_alloc_nodes(hamt, Size);
+                /* Copy existing nodes leaving gap for new node */
+                memcpy(newnodes, GetSubTrie(node), Map*sizeof(HAMTNode));
+                memcpy(&newnodes[Map+1], &(GetSubTrie(node))[Map],
+                       (Size-Map-1)*sizeof(HAMTNode));
+                /* Delete old subtrie */
+                HAMT_free_nodes(hamt, GetSubTrie(node), Size-1);
+            }
             /* Set up new node */
             newnodes[Map].BitMapKey = key;
-            entry = yasm_xmalloc(sizeof(HAMTEntry));
-            entry->str = str;
-            entry->data = data;
-            STAILQ_INSERT_TAIL(&hamt->entries, entry, next);
+            entry = HAMT_new_entry(hamt, str, data);
             SetValue(hamt, &newnodes[Map], entry);
             SetSubTrie(hamt, node, newnodes);
 
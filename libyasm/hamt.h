@@ -49,6 +49,15 @@ YASM_LIB_DECL
 HAMT *HAMT_create(int nocase, /*@exits@*/ void (*error_func)
     (const char *file, unsigned int line, const char *message));
 
+/** Hint the number of entries a HAMT is expected to hold, so storage for
+ * them can be allocated up front.  Has no effect once entries have been
+ * inserted.
+ * \param hamt          Hash array mapped trie
+ * \param count         Expected number of entries
+ */
+YASM_LIB_DECL
+void HAMT_reserve(HAMT *hamt, unsigned long count);
+
 /** Delete HAMT and all data associated with it.  Uses deletefunc() to delete
  * each data item.
  * \param hamt          Hash array mapped trie
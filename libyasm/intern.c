@@ -0,0 +1,222 @@
+/*
+ * YASM string interning
+ *
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "util.h"
+
+#include "coretype.h"
+#include "intern.h"
+#include "phash.h"
+
+
+/* Interned strings are kept in an open-addressed hash table (linear
+ * probing, power-of-two size, grown at 3/4 load).  The strings themselves
+ * are kept in a string pool that is only released when the table is
+ * destroyed.
+ */
+typedef struct intern_entry {
+    /*@null@*/ /*@dependent@*/ const char *str;
+    unsigned int hash;
+} intern_entry;
+
+struct yasm__strpool_chunk {
+    /*@null@*/ /*@owned@*/ struct yasm__strpool_chunk *next;
+    char data[1];       /* actually longer */
+};
+
+/* Bytes of string storage per chunk */
+#define INTERN_CHUNK_SIZE   16384
+
+/* Initial number of hash table entries; must be a power of 2 */
+#define INTERN_INIT_SIZE    256
+
+struct yasm_intern_table {
+    /*@only@*/ intern_entry *entries;
+    size_t size;        /* number of entries; power of 2 */
+    size_t count;       /* number of entries in use */
+
+    yasm__strpool pool;
+};
+
+yasm_intern_table *
+yasm_intern_table_create(void)
+{
+    yasm_intern_table *table = yasm_xmalloc(sizeof(yasm_intern_table));
+    size_t i;
+
+    table->size = INTERN_INIT_SIZE;
+    table->count = 0;
+    table->entries = yasm_xmalloc(table->size*sizeof(intern_entry));
+    for (i=0; i<table->size; i++)
+        table->entries[i].str = NULL;
+    yasm__strpool_init(&table->pool, INTERN_CHUNK_SIZE);
+    return table;
+}
+
+void
+yasm_intern_table_destroy(yasm_intern_table *table)
+{
+    yasm__strpool_delete(&table->pool);
+    yasm_xfree(table->entries);
+    yasm_xfree(table);
+}
+
+void
+yasm__strpool_init(yasm__strpool *pool, size_t chunk_size)
+{
+    pool->chunks = NULL;
+    pool->avail = NULL;
+    pool->avail_len = 0;
+    pool->chunk_size = chunk_size;
+}
+
+void
+yasm__strpool_delete(yasm__strpool *pool)
+{
+    while (pool->chunks) {
+        struct yasm__strpool_chunk *chunk = pool->chunks;
+        pool->chunks = chunk->next;
+        yasm_xfree(chunk);
+    }
+    pool->avail = NULL;
+    pool->avail_len = 0;
+}
+
+char *
+yasm__strpool_add(yasm__strpool *pool, const char *str, size_t len)
+{
+    struct yasm__strpool_chunk *chunk;
+    char *s;
+
+    if (len+1 > pool->avail_len) {
+        if (len+1 > pool->chunk_size/4) {
+            /* Give long strings their own chunk, but keep using the
+             * current chunk for short ones.
+             */
+            chunk = yasm_xmalloc(sizeof(struct yasm__strpool_chunk)+len);
+            if (pool->chunks) {
+                chunk->next = pool->chunks->next;
+                pool->chunks->next = chunk;
+            } else {
+                chunk->next = NULL;
+                pool->chunks = chunk;
+            }
+            s = chunk->data;
+            memcpy(s, str, len);
+            s[len] = '\0';
+            return s;
+        }
+        chunk = yasm_xmalloc(sizeof(struct yasm__strpool_chunk)+
+                             pool->chunk_size);
+        chunk->next = pool->chunks;
+        pool->chunks = chunk;
+        pool->avail = chunk->data;
+        pool->avail_len = pool->chunk_size;
+    }
+
+    s = pool->avail;
+    memcpy(s, str, len);
+    s[len] = '\0';
+    pool->avail += len+1;
+    pool->avail_len -= len+1;
+    return s;
+}
+
+static void
+intern_grow(yasm_intern_table *table)
+{
+    intern_entry *old = table->entries;
+    size_t oldsize = table->size;
+    size_t mask, i;
+
+    table->size *= 2;
+    mask = table->size-1;
+    table->entries = yasm_xmalloc(table->size*sizeof(intern_entry));
+    for (i=0; i<table->size; i++)
+        table->entries[i].str = NULL;
+
+    for (i=0; i<oldsize; i++) {
+        size_t j;
+        if (!old[i].str)
+            continue;
+        j = old[i].hash & mask;
+        while (table->entries[j].str)
+            j = (j+1) & mask;
+        table->entries[j] = old[i];     /* structure copy */
+    }
+    yasm_xfree(old);
+}
+
+/* Finds a string's entry in a table, or the empty entry where it would go.
+ */
+static intern_entry *
+intern_find(yasm_intern_table *table, const char *str, size_t len,
+            unsigned int hash)
+{
+    size_t mask, i;
+    intern_entry *entry;
+
+    mask = table->size-1;
+    for (i = hash & mask; table->entries[i].str; i = (i+1) & mask) {
+        entry = &table->entries[i];
+        if (entry->hash == hash && strncmp(entry->str, str, len) == 0 &&
+            entry->str[len] == '\0')
+            return entry;
+    }
+    return &table->entries[i];
+}
+
+const char *
+yasm_intern_len(yasm_intern_table *table, const char *str, size_t len)
+{
+    unsigned int hash = (unsigned int)phash_lookup(str, len, 0);
+    intern_entry *entry = intern_find(table, str, len, hash);
+
+    if (entry->str)
+        return entry->str;
+
+    entry->str = yasm__strpool_add(&table->pool, str, len);
+    entry->hash = hash;
+    str = entry->str;
+
+    if (++table->count > table->size/4*3)
+        intern_grow(table);
+    return str;
+}
+
+const char *
+yasm_intern(yasm_intern_table *table, const char *str)
+{
+    return yasm_intern_len(table, str, strlen(str));
+}
+
+const char *
+yasm_intern_find(yasm_intern_table *table, const char *str)
+{
+    size_t len = strlen(str);
+
+    return intern_find(table, str, len,
+                       (unsigned int)phash_lookup(str, len, 0))->str;
+}
@@ -0,0 +1,119 @@
+/**
+ * \file libyasm/intern.h
+ * \brief YASM string interning interface.
+ *
+ * \license
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ * \endlicense
+ */
+#ifndef YASM_INTERN_H
+#define YASM_INTERN_H
+
+#ifndef YASM_LIB_DECL
+#define YASM_LIB_DECL
+#endif
+
+/** Create a new, empty string intern table.  Each #yasm_object owns a
+ * table that its symbol and section names are interned in.
+ * \return Newly allocated table.
+ */
+YASM_LIB_DECL
+/*@only@*/ yasm_intern_table *yasm_intern_table_create(void);
+
+/** Destroy a string intern table, releasing all strings interned in it.
+ * \param table     table
+ */
+YASM_LIB_DECL
+void yasm_intern_table_destroy(/*@only@*/ yasm_intern_table *table);
+
+/** Intern a string in a table.  Equal strings interned in the same table
+ * return the same pointer, so interned strings can be compared with ==.
+ * The returned string must not be modified or freed; it remains valid
+ * until the table is destroyed.
+ * \param table     table
+ * \param str       string
+ * \return Interned copy of str.
+ */
+YASM_LIB_DECL
+/*@dependent@*/ const char *yasm_intern(yasm_intern_table *table,
+                                        const char *str);
+
+/** Intern the first len characters of a string in a table.
+ * \see yasm_intern().
+ * \param table     table
+ * \param str       string (need not be 0-terminated)
+ * \param len       length of string, in characters
+ * \return Interned, 0-terminated copy of str.
+ */
+YASM_LIB_DECL
+/*@dependent@*/ const char *yasm_intern_len(yasm_intern_table *table,
+                                            const char *str, size_t len);
+
+/** Look up a string in a table without interning it.
+ * \param table     table
+ * \param str       string
+ * \return Interned copy of str, or NULL if str has not been interned.
+ */
+YASM_LIB_DECL
+/*@null@*/ /*@dependent@*/ const char *yasm_intern_find
+    (yasm_intern_table *table, const char *str);
+
+/** Chunked storage for 0-terminated strings that are all released at once.
+ * \internal
+ */
+typedef struct yasm__strpool {
+    /*@null@*/ /*@owned@*/ struct yasm__strpool_chunk *chunks;
+    /*@null@*/ /*@dependent@*/ char *avail;  /**< free space in chunk */
+    size_t avail_len;               /**< length of free space */
+    size_t chunk_size;              /**< bytes of storage per chunk */
+} yasm__strpool;
+
+/** Initialize an empty string pool.
+ * \internal
+ * \param pool      string pool
+ * \param chunk_size bytes of storage to allocate at a time; strings longer
+ *                  than a quarter of this get storage of their own
+ */
+YASM_LIB_DECL
+void yasm__strpool_init(/*@out@*/ yasm__strpool *pool, size_t chunk_size);
+
+/** Release all strings in a string pool.  The pool is left empty.
+ * \internal
+ * \param pool      string pool
+ */
+YASM_LIB_DECL
+void yasm__strpool_delete(yasm__strpool *pool);
+
+/** Copy the first len characters of a string into a string pool.
+ * \internal
+ * \param pool      string pool
+ * \param str       string (need not be 0-terminated)
+ * \param len       length of string, in characters
+ * \return 0-terminated copy of str, valid until the pool is deleted.
+ */
+YASM_LIB_DECL
+/*@dependent@*/ char *yasm__strpool_add(yasm__strpool *pool, const char *str,
+                                        size_t len);
+
+#endif
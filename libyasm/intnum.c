@@ -40,21 +40,38 @@
 /* "Native" "word" size for intnum calculations. */
 #define BITVECT_NATIVE_SIZE     256
 
+/* Integers are accounted to YASM_MEM_INTNUM */
+#define intnum_xmalloc(size)    yasm__xmalloc_cat(YASM_MEM_INTNUM, size)
+
+/* Integer type for values stored inline. */
+#ifdef _MSC_VER
+typedef __int64 intnum_l;
+typedef unsigned __int64 intnum_ul;
+#else
+typedef int64_t intnum_l;
+typedef uint64_t intnum_ul;
+#endif
+
+/* Sign bit of an inline value */
+#define INTNUM_L_SIGN   (((intnum_ul)1) << 63)
+
 struct yasm_intnum {
     union val {
-        long l;                 /* integer value (for integers <32 bits) */
-        wordptr bv;             /* bit vector (for integers >=32 bits) */
+        intnum_l l;             /* integer value (for integers <64 bits) */
+        wordptr bv;             /* bit vector (for integers >=64 bits) */
     } val;
     enum { INTNUM_L, INTNUM_BV } type;
 };
 
 /* static bitvect used for conversions */
-static /*@only@*/ wordptr conv_bv;
+static /*@only@*/ YASM_THREAD_LOCAL wordptr conv_bv;
 
 /* static bitvects used for computation */
-static /*@only@*/ wordptr result, spare, op1static, op2static;
+static /*@only@*/ YASM_THREAD_LOCAL wordptr result, spare, op1static,
+    op2static;
 
-static /*@only@*/ BitVector_from_Dec_static_data *from_dec_data;
+static /*@only@*/ YASM_THREAD_LOCAL
+    BitVector_from_Dec_static_data *from_dec_data;
 
 
 void
@@ -79,30 +96,84 @@ yasm_intnum_cleanup(void)
     BitVector_Destroy(conv_bv);
 }
 
+/* Convert a 64-bit two's complement value to an inline value (without
+ * relying on implementation-defined unsigned to signed conversion).
+ */
+static intnum_l
+intnum_l_from_ul(intnum_ul u)
+{
+    if (u & INTNUM_L_SIGN)
+        return -(intnum_l)(~u) - 1;
+    return (intnum_l)u;
+}
+
+/* Arithmetic shift right of an inline value; count must be < 64. */
+static intnum_l
+intnum_l_sar(intnum_l v, unsigned int count)
+{
+    if (v < 0)
+        return ~(intnum_l)((intnum_ul)~v >> count);
+    return (intnum_l)((intnum_ul)v >> count);
+}
+
+/* Returns nonzero if u has no bits set at or above bit number bits
+ * (matches Set_Max(u) < bits).
+ */
+static int
+intnum_ul_fits(intnum_ul u, long bits)
+{
+    if (bits >= 64)
+        return 1;
+    if (bits <= 0)
+        return u == 0;
+    return (u >> bits) == 0;
+}
+
+/* Store a 64-bit value into the low bits of a bitvect, zero-extending. */
+static void
+intnum_ul_tobv(wordptr bv, intnum_ul u)
+{
+    BitVector_Empty(bv);
+    BitVector_Chunk_Store(bv, 32, 0, (N_long)(u & 0xFFFFFFFFUL));
+    BitVector_Chunk_Store(bv, 32, 32, (N_long)(u >> 32));
+}
+
+/* Store an inline value into a bitvect, sign-extending. */
+static void
+intnum_l_tobv(wordptr bv, intnum_l v)
+{
+    intnum_ul_tobv(bv, (intnum_ul)v);
+    if (v < 0)
+        BitVector_Interval_Fill(bv, 64, BITVECT_NATIVE_SIZE-1);
+}
+
+/* Read the low 64 bits of a bitvect. */
+static intnum_ul
+intnum_ul_frombv(wordptr bv)
+{
+    return ((intnum_ul)BitVector_Chunk_Read(bv, 32, 32) << 32) |
+        (intnum_ul)BitVector_Chunk_Read(bv, 32, 0);
+}
+
 /* Compress a bitvector into intnum storage.
  * If saved as a bitvector, clones the passed bitvector.
- * Can modify the passed bitvector.
  */
 static void
 intnum_frombv(/*@out@*/ yasm_intnum *intn, wordptr bv)
 {
-    if (Set_Max(bv) < 31) {
+    int fits;
+
+    /* Fits inline if bits 63 and up are all equal to the sign bit. */
+    if (BitVector_msb_(bv)) {
+        Set_Complement(bv, bv);
+        fits = Set_Max(bv) < 63;
+        Set_Complement(bv, bv);
+    } else
+        fits = Set_Max(bv) < 63;
+
+    if (fits) {
         intn->type = INTNUM_L;
-        intn->val.l = (long)BitVector_Chunk_Read(bv, 31, 0);
-    } else if (BitVector_msb_(bv)) {
-        /* Negative, negate and see if we'll fit into a long. */
-        unsigned long ul;
-        BitVector_Negate(bv, bv);
-        if (Set_Max(bv) >= 32 ||
-            ((ul = BitVector_Chunk_Read(bv, 32, 0)) & 0x80000000)) {
-            /* too negative */
-            BitVector_Negate(bv, bv);
-            intn->type = INTNUM_BV;
-            intn->val.bv = BitVector_Clone(bv);
-        } else {
-            intn->type = INTNUM_L;
-            intn->val.l = -((long)ul);
-        }
+        intn->val.l = intnum_l_from_ul(intnum_ul_frombv(bv));
     } else {
         intn->type = INTNUM_BV;
         intn->val.bv = BitVector_Clone(bv);
@@ -118,20 +189,56 @@ intnum_tobv(/*@returned@*/ wordptr bv, const yasm_intnum *intn)
     if (intn->type == INTNUM_BV)
         return intn->val.bv;
 
-    BitVector_Empty(bv);
-    if (intn->val.l >= 0)
-        BitVector_Chunk_Store(bv, 32, 0, (unsigned long)intn->val.l);
-    else {
-        BitVector_Chunk_Store(bv, 32, 0, (unsigned long)-intn->val.l);
-        BitVector_Negate(bv, bv);
-    }
+    intnum_l_tobv(bv, intn->val.l);
     return bv;
 }
 
+/* Scan a literal of digits in the given radix (2, 8, 10, or 16) directly
+ * into an inline value.  Underscores are skipped except in decimal, as in
+ * the bitvect conversions.  Returns zero, leaving the literal to the bitvect
+ * conversion (and its error reporting), if it is empty, has any other
+ * characters, or doesn't fit inline.
+ */
+static int
+intnum_scan_l(const char *str, unsigned int radix, /*@out@*/ intnum_l *val)
+{
+    intnum_ul v = 0;
+    unsigned int d;
+    int c, ndigits = 0;
+
+    for (; (c = (unsigned char)*str) != '\0'; str++) {
+        if (c >= '0' && c <= '9')
+            d = (unsigned int)(c - '0');
+        else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+            d = (unsigned int)((c | 0x20) - 'a' + 10);
+        else if (c == '_' && radix != 10)
+            continue;
+        else
+            return 0;
+        if (d >= radix)
+            return 0;
+        /* v*radix+d must stay below 2^63 */
+        if (v >= (((intnum_ul)1) << 59) &&
+            v > (INTNUM_L_SIGN - 1 - d) / radix)
+            return 0;
+        v = v*radix + d;
+        ndigits++;
+    }
+    if (ndigits == 0)
+        return 0;
+    *val = (intnum_l)v;
+    return 1;
+}
+
 yasm_intnum *
 yasm_intnum_create_dec(char *str)
 {
-    yasm_intnum *intn = yasm_xmalloc(sizeof(yasm_intnum));
+    yasm_intnum *intn = intnum_xmalloc(sizeof(yasm_intnum));
+
+    if (intnum_scan_l(str, 10, &intn->val.l)) {
+        intn->type = INTNUM_L;
+        return intn;
+    }
 
     switch (BitVector_from_Dec_static(from_dec_data, conv_bv,
                                       (unsigned char *)str)) {
@@ -152,7 +259,12 @@ yasm_intnum_create_dec(char *str)
 yasm_intnum *
 yasm_intnum_create_bin(char *str)
 {
-    yasm_intnum *intn = yasm_xmalloc(sizeof(yasm_intnum));
+    yasm_intnum *intn = intnum_xmalloc(sizeof(yasm_intnum));
+
+    if (intnum_scan_l(str, 2, &intn->val.l)) {
+        intn->type = INTNUM_L;
+        return intn;
+    }
 
     switch (BitVector_from_Bin(conv_bv, (unsigned char *)str)) {
         case ErrCode_Pars:
@@ -172,7 +284,12 @@ yasm_intnum_create_bin(char *str)
 yasm_intnum *
 yasm_intnum_create_oct(char *str)
 {
-    yasm_intnum *intn = yasm_xmalloc(sizeof(yasm_intnum));
+    yasm_intnum *intn = intnum_xmalloc(sizeof(yasm_intnum));
+
+    if (intnum_scan_l(str, 8, &intn->val.l)) {
+        intn->type = INTNUM_L;
+        return intn;
+    }
 
     switch (BitVector_from_Oct(conv_bv, (unsigned char *)str)) {
         case ErrCode_Pars:
@@ -192,7 +309,12 @@ yasm_intnum_create_oct(char *str)
 yasm_intnum *
 yasm_intnum_create_hex(char *str)
 {
-    yasm_intnum *intn = yasm_xmalloc(sizeof(yasm_intnum));
+    yasm_intnum *intn = intnum_xmalloc(sizeof(yasm_intnum));
+
+    if (intnum_scan_l(str, 16, &intn->val.l)) {
+        intn->type = INTNUM_L;
+        return intn;
+    }
 
     switch (BitVector_from_Hex(conv_bv, (unsigned char *)str)) {
         case ErrCode_Pars:
@@ -213,7 +335,7 @@ yasm_intnum_create_hex(char *str)
 yasm_intnum *
 yasm_intnum_create_charconst_nasm(const char *str)
 {
-    yasm_intnum *intn = yasm_xmalloc(sizeof(yasm_intnum));
+    yasm_intnum *intn = intnum_xmalloc(sizeof(yasm_intnum));
     size_t len = strlen(str);
 
     if(len*8 > BITVECT_NATIVE_SIZE)
@@ -221,35 +343,22 @@ yasm_intnum_create_charconst_nasm(const char *str)
                        N_("Character constant too large for internal format"));
 
     /* be conservative in choosing bitvect in case MSB is set */
-    if (len > 3) {
+    if (len > 7) {
+        /* >=64 bit conversion */
         BitVector_Empty(conv_bv);
-        intn->type = INTNUM_BV;
+        while (len) {
+            BitVector_Move_Left(conv_bv, 8);
+            BitVector_Chunk_Store(conv_bv, 8, 0,
+                                  ((unsigned long)str[--len]) & 0xff);
+        }
+        intnum_frombv(intn, conv_bv);
     } else {
         intn->val.l = 0;
         intn->type = INTNUM_L;
-    }
-
-    switch (len) {
-        case 3:
-            intn->val.l |= ((unsigned long)str[2]) & 0xff;
-            intn->val.l <<= 8;
-            /*@fallthrough@*/
-        case 2:
-            intn->val.l |= ((unsigned long)str[1]) & 0xff;
+        while (len) {
             intn->val.l <<= 8;
-            /*@fallthrough@*/
-        case 1:
-            intn->val.l |= ((unsigned long)str[0]) & 0xff;
-        case 0:
-            break;
-        default:
-            /* >=32 bit conversion */
-            while (len) {
-                BitVector_Move_Left(conv_bv, 8);
-                BitVector_Chunk_Store(conv_bv, 8, 0,
-                                      ((unsigned long)str[--len]) & 0xff);
-            }
-            intn->val.bv = BitVector_Clone(conv_bv);
+            intn->val.l |= ((unsigned long)str[--len]) & 0xff;
+        }
     }
 
     return intn;
@@ -258,7 +367,7 @@ yasm_intnum_create_charconst_nasm(const char *str)
 yasm_intnum *
 yasm_intnum_create_charconst_tasm(const char *str)
 {
-    yasm_intnum *intn = yasm_xmalloc(sizeof(yasm_intnum));
+    yasm_intnum *intn = intnum_xmalloc(sizeof(yasm_intnum));
     size_t len = strlen(str);
     size_t i;
 
@@ -267,37 +376,21 @@ yasm_intnum_create_charconst_tasm(const char *str)
                        N_("Character constant too large for internal format"));
 
     /* be conservative in choosing bitvect in case MSB is set */
-    if (len > 3) {
+    /* tasm uses big endian notation */
+    if (len > 7) {
+        /* >=64 bit conversion */
         BitVector_Empty(conv_bv);
-        intn->type = INTNUM_BV;
+        for (i = 0; i < len; i++)
+            BitVector_Chunk_Store(conv_bv, 8, (len-i-1)*8,
+                                  ((unsigned long)str[i]) & 0xff);
+        intnum_frombv(intn, conv_bv);
     } else {
         intn->val.l = 0;
         intn->type = INTNUM_L;
-    }
-
-    /* tasm uses big endian notation */
-    i = 0;
-    switch (len) {
-        case 3:
-            intn->val.l |= ((unsigned long)str[i++]) & 0xff;
+        for (i = 0; i < len; i++) {
             intn->val.l <<= 8;
-            /*@fallthrough@*/
-        case 2:
-            intn->val.l |= ((unsigned long)str[i++]) & 0xff;
-            intn->val.l <<= 8;
-            /*@fallthrough@*/
-        case 1:
-            intn->val.l |= ((unsigned long)str[i++]) & 0xff;
-        case 0:
-            break;
-        default:
-            /* >=32 bit conversion */
-            while (i < len) {
-                BitVector_Chunk_Store(conv_bv, 8, (len-i-1)*8,
-                                      ((unsigned long)str[i]) & 0xff);
-                i++;
-            }
-            intn->val.bv = BitVector_Clone(conv_bv);
+            intn->val.l |= ((unsigned long)str[i]) & 0xff;
+        }
     }
 
     return intn;
@@ -307,15 +400,15 @@ yasm_intnum_create_charconst_tasm(const char *str)
 yasm_intnum *
 yasm_intnum_create_uint(unsigned long i)
 {
-    yasm_intnum *intn = yasm_xmalloc(sizeof(yasm_intnum));
+    yasm_intnum *intn = intnum_xmalloc(sizeof(yasm_intnum));
 
-    if (i > LONG_MAX) {
+    if ((intnum_ul)i & INTNUM_L_SIGN) {
         /* Too big, store as bitvector */
         intn->val.bv = BitVector_Create(BITVECT_NATIVE_SIZE, TRUE);
         intn->type = INTNUM_BV;
-        BitVector_Chunk_Store(intn->val.bv, 32, 0, i);
+        intnum_ul_tobv(intn->val.bv, (intnum_ul)i);
     } else {
-        intn->val.l = (long)i;
+        intn->val.l = (intnum_l)i;
         intn->type = INTNUM_L;
     }
 
@@ -325,7 +418,7 @@ yasm_intnum_create_uint(unsigned long i)
 yasm_intnum *
 yasm_intnum_create_int(long i)
 {
-    yasm_intnum *intn = yasm_xmalloc(sizeof(yasm_intnum));
+    yasm_intnum *intn = intnum_xmalloc(sizeof(yasm_intnum));
 
     intn->val.l = i;
     intn->type = INTNUM_L;
@@ -337,7 +430,7 @@ yasm_intnum *
 yasm_intnum_create_leb128(const unsigned char *ptr, int sign,
                           unsigned long *size)
 {
-    yasm_intnum *intn = yasm_xmalloc(sizeof(yasm_intnum));
+    yasm_intnum *intn = intnum_xmalloc(sizeof(yasm_intnum));
     const unsigned char *ptr_orig = ptr;
     unsigned long i = 0;
 
@@ -366,7 +459,7 @@ yasm_intnum *
 yasm_intnum_create_sized(unsigned char *ptr, int sign, size_t srcsize,
                          int bigendian)
 {
-    yasm_intnum *intn = yasm_xmalloc(sizeof(yasm_intnum));
+    yasm_intnum *intn = intnum_xmalloc(sizeof(yasm_intnum));
     unsigned long i = 0;
 
     if (srcsize*8 > BITVECT_NATIVE_SIZE)
@@ -394,7 +487,7 @@ yasm_intnum_create_sized(unsigned char *ptr, int sign, size_t srcsize,
 yasm_intnum *
 yasm_intnum_copy(const yasm_intnum *intn)
 {
-    yasm_intnum *n = yasm_xmalloc(sizeof(yasm_intnum));
+    yasm_intnum *n = intnum_xmalloc(sizeof(yasm_intnum));
 
     switch (intn->type) {
         case INTNUM_L:
@@ -419,6 +512,155 @@ yasm_intnum_destroy(yasm_intnum *intn)
     yasm_xfree(intn);
 }
 
+/* Calculate with inline values.  Returns nonzero and sets acc if the
+ * result fits inline.  Returns zero, leaving acc unchanged, if the result
+ * overflows or the operation needs the bit vector calculation (including
+ * its error handling).
+ */
+static int
+intnum_calc_l(yasm_intnum *acc, yasm_expr_op op,
+              /*@null@*/ const yasm_intnum *operand)
+{
+    intnum_l a = acc->val.l;
+    intnum_l b = operand ? operand->val.l : 0;
+    intnum_l r;
+    intnum_ul ua = (intnum_ul)a, ub = (intnum_ul)b, ur;
+
+    switch (op) {
+        case YASM_EXPR_ADD:
+            ur = ua + ub;
+            if ((ua ^ ur) & (ub ^ ur) & INTNUM_L_SIGN)
+                return 0;
+            r = intnum_l_from_ul(ur);
+            break;
+        case YASM_EXPR_SUB:
+            ur = ua - ub;
+            if ((ua ^ ub) & (ua ^ ur) & INTNUM_L_SIGN)
+                return 0;
+            r = intnum_l_from_ul(ur);
+            break;
+        case YASM_EXPR_MUL:
+        case YASM_EXPR_DIV:
+        case YASM_EXPR_SIGNDIV:
+        case YASM_EXPR_MOD:
+        case YASM_EXPR_SIGNMOD:
+            /* Work with magnitudes; like the bit vector calculation, the
+             * quotient is truncated and the remainder takes the sign of
+             * the dividend.
+             */
+            if (a < 0)
+                ua = -ua;
+            if (b < 0)
+                ub = -ub;
+            if (op == YASM_EXPR_MUL) {
+                if (ub != 0 && ua > ~(intnum_ul)0 / ub)
+                    return 0;
+                ur = ua * ub;
+            } else if (ub == 0)
+                return 0;
+            else if (op == YASM_EXPR_MOD || op == YASM_EXPR_SIGNMOD) {
+                ur = ua % ub;
+                if (a < 0)
+                    ur = -ur;
+                r = intnum_l_from_ul(ur);
+                break;
+            } else
+                ur = ua / ub;
+            if ((a < 0) != (b < 0)) {
+                if (ur > INTNUM_L_SIGN)
+                    return 0;
+                ur = -ur;
+            } else if (ur >= INTNUM_L_SIGN)
+                return 0;
+            r = intnum_l_from_ul(ur);
+            break;
+        case YASM_EXPR_NEG:
+            if (ua == INTNUM_L_SIGN)
+                return 0;
+            r = -a;
+            break;
+        case YASM_EXPR_NOT:
+            r = ~a;
+            break;
+        case YASM_EXPR_OR:
+            r = a | b;
+            break;
+        case YASM_EXPR_AND:
+            r = a & b;
+            break;
+        case YASM_EXPR_XOR:
+            r = a ^ b;
+            break;
+        case YASM_EXPR_XNOR:
+            r = ~(a ^ b);
+            break;
+        case YASM_EXPR_NOR:
+            r = ~(a | b);
+            break;
+        case YASM_EXPR_SHL:
+            if (b < 0 || a == 0)
+                r = 0;
+            else if (b >= 63)
+                return 0;
+            else {
+                r = intnum_l_from_ul(ua << b);
+                if (intnum_l_sar(r, (unsigned int)b) != a)
+                    return 0;
+            }
+            break;
+        case YASM_EXPR_SHR:
+            if (b < 0)
+                r = 0;
+            else
+                r = intnum_l_sar(a, b > 63 ? 63 : (unsigned int)b);
+            break;
+        case YASM_EXPR_LOR:
+            r = (a != 0) || (b != 0);
+            break;
+        case YASM_EXPR_LAND:
+            r = (a != 0) && (b != 0);
+            break;
+        case YASM_EXPR_LNOT:
+            r = (a == 0);
+            break;
+        case YASM_EXPR_LXOR:
+            r = (a != 0) ^ (b != 0);
+            break;
+        case YASM_EXPR_LXNOR:
+            r = !((a != 0) ^ (b != 0));
+            break;
+        case YASM_EXPR_LNOR:
+            r = !((a != 0) || (b != 0));
+            break;
+        case YASM_EXPR_EQ:
+            r = (a == b);
+            break;
+        case YASM_EXPR_LT:
+            r = (a < b);
+            break;
+        case YASM_EXPR_GT:
+            r = (a > b);
+            break;
+        case YASM_EXPR_LE:
+            r = (a <= b);
+            break;
+        case YASM_EXPR_GE:
+            r = (a >= b);
+            break;
+        case YASM_EXPR_NE:
+            r = (a != b);
+            break;
+        case YASM_EXPR_IDENT:
+            r = a;
+            break;
+        default:
+            return 0;
+    }
+
+    acc->val.l = r;
+    return 1;
+}
+
 /*@-nullderef -nullpass -branchstate@*/
 int
 yasm_intnum_calc(yasm_intnum *acc, yasm_expr_op op, yasm_intnum *operand)
@@ -427,13 +669,6 @@ yasm_intnum_calc(yasm_intnum *acc, yasm_expr_op op, yasm_intnum *operand)
     wordptr op1, op2 = NULL;
     N_int count;
 
-    /* Always do computations with in full bit vector.
-     * Bit vector results must be calculated through intermediate storage.
-     */
-    op1 = intnum_tobv(op1static, acc);
-    if (operand)
-        op2 = intnum_tobv(op2static, operand);
-
     if (!operand && op != YASM_EXPR_NEG && op != YASM_EXPR_NOT &&
         op != YASM_EXPR_LNOT) {
         yasm_error_set(YASM_ERROR_ARITHMETIC,
@@ -442,6 +677,18 @@ yasm_intnum_calc(yasm_intnum *acc, yasm_expr_op op, yasm_intnum *operand)
         return 1;
     }
 
+    /* Calculate inline when both values and the result fit in 64 bits. */
+    if (acc->type == INTNUM_L && (!operand || operand->type == INTNUM_L) &&
+        intnum_calc_l(acc, op, operand))
+        return 0;
+
+    /* Otherwise do computations with in full bit vector.
+     * Bit vector results must be calculated through intermediate storage.
+     */
+    op1 = intnum_tobv(op1static, acc);
+    if (operand)
+        op2 = intnum_tobv(op2static, operand);
+
     /* A operation does a bitvector computation if result is allocated. */
     switch (op) {
         case YASM_EXPR_ADD:
@@ -513,7 +760,10 @@ yasm_intnum_calc(yasm_intnum *acc, yasm_expr_op op, yasm_intnum *operand)
         case YASM_EXPR_SHL:
             if (operand->type == INTNUM_L && operand->val.l >= 0) {
                 BitVector_Copy(result, op1);
-                BitVector_Move_Left(result, (N_int)operand->val.l);
+                if (operand->val.l >= BITVECT_NATIVE_SIZE)
+                    BitVector_Empty(result);
+                else
+                    BitVector_Move_Left(result, (N_int)operand->val.l);
             } else      /* don't even bother, just zero result */
                 BitVector_Empty(result);
             break;
@@ -521,7 +771,8 @@ yasm_intnum_calc(yasm_intnum *acc, yasm_expr_op op, yasm_intnum *operand)
             if (operand->type == INTNUM_L && operand->val.l >= 0) {
                 BitVector_Copy(result, op1);
                 carry = BitVector_msb_(op1);
-                count = (N_int)operand->val.l;
+                count = operand->val.l < BITVECT_NATIVE_SIZE ?
+                    (N_int)operand->val.l : BITVECT_NATIVE_SIZE;
                 while (count-- > 0)
                     BitVector_shift_right(result, carry);
             } else      /* don't even bother, just zero result */
@@ -603,7 +854,7 @@ yasm_intnum_calc(yasm_intnum *acc, yasm_expr_op op, yasm_intnum *operand)
             return 1;
     }
 
-    /* Try to fit the result into 32 bits if possible */
+    /* Try to fit the result into 64 bits if possible */
     if (acc->type == INTNUM_BV)
         BitVector_Destroy(acc->val.bv);
     intnum_frombv(acc, result);
@@ -664,18 +915,18 @@ yasm_intnum_set(yasm_intnum *intn, const yasm_intnum *val)
 void
 yasm_intnum_set_uint(yasm_intnum *intn, unsigned long val)
 {
-    if (val > LONG_MAX) {
+    if ((intnum_ul)val & INTNUM_L_SIGN) {
         if (intn->type != INTNUM_BV) {
             intn->val.bv = BitVector_Create(BITVECT_NATIVE_SIZE, TRUE);
             intn->type = INTNUM_BV;
         }
-        BitVector_Chunk_Store(intn->val.bv, 32, 0, val);
+        intnum_ul_tobv(intn->val.bv, (intnum_ul)val);
     } else {
         if (intn->type == INTNUM_BV) {
             BitVector_Destroy(intn->val.bv);
             intn->type = INTNUM_L;
         }
-        intn->val.l = (long)val;
+        intn->val.l = (intnum_l)val;
     }
 }
 
@@ -727,13 +978,14 @@ yasm_intnum_get_uint(const yasm_intnum *intn)
         case INTNUM_L:
             if (intn->val.l < 0)
                 return 0;
+            if (intn->val.l > 0xFFFFFFFFL)
+                return ULONG_MAX;
             return (unsigned long)intn->val.l;
         case INTNUM_BV:
+            /* it's a BV, so it's out of the range of 32 bits */
             if (BitVector_msb_(intn->val.bv))
                 return 0;
-            if (Set_Max(intn->val.bv) > 32)
-                return ULONG_MAX;
-            return BitVector_Chunk_Read(intn->val.bv, 32, 0);
+            return ULONG_MAX;
         default:
             yasm_internal_error(N_("unknown intnum type"));
             /*@notreached@*/
@@ -746,25 +998,15 @@ yasm_intnum_get_int(const yasm_intnum *intn)
 {
     switch (intn->type) {
         case INTNUM_L:
-            return intn->val.l;
+            if (intn->val.l < -0x7FFFFFFFL)
+                return LONG_MIN;
+            if (intn->val.l > 0x7FFFFFFFL)
+                return LONG_MAX;
+            return (long)intn->val.l;
         case INTNUM_BV:
-            if (BitVector_msb_(intn->val.bv)) {
-                /* it's negative: negate the bitvector to get a positive
-                 * number, then negate the positive number.
-                 */
-                unsigned long ul;
-
-                BitVector_Negate(conv_bv, intn->val.bv);
-                if (Set_Max(conv_bv) >= 32) {
-                    /* too negative */
-                    return LONG_MIN;
-                }
-                ul = BitVector_Chunk_Read(conv_bv, 32, 0);
-                /* check for too negative */
-                return (ul & 0x80000000) ? LONG_MIN : -((long)ul);
-            }
-
-            /* it's positive, and since it's a BV, it must be >0x7FFFFFFF */
+            /* it's a BV, so it's out of the range of 32 bits */
+            if (BitVector_msb_(intn->val.bv))
+                return LONG_MIN;
             return LONG_MAX;
         default:
             yasm_internal_error(N_("unknown intnum type"));
@@ -797,6 +1039,33 @@ yasm_intnum_get_sized(const yasm_intnum *intn, unsigned char *ptr,
         yasm_warn_set(YASM_WARN_GENERAL,
                       N_("value does not fit in %d bit field"), valsize);
 
+    /* Inline values going into at most 64 bits don't need a bitvect */
+    if (intn->type == INTNUM_L && destsize <= 8 && valsize <= 64 &&
+        shift < 64 && rshift < 64 && !bigendian) {
+        intnum_l v = intn->val.l;
+        intnum_ul data = 0, mask;
+        size_t i;
+
+        for (i=0; i<destsize; i++)
+            data |= (intnum_ul)ptr[i] << (i*8);
+
+        if (rshift > 0) {
+            if (warn && ((intnum_ul)v & ((((intnum_ul)1) << rshift)-1)))
+                yasm_warn_set(YASM_WARN_GENERAL,
+                              N_("misaligned value, truncating to boundary"));
+            v = intnum_l_sar(v, (unsigned int)rshift);
+            shift = 0;
+        }
+
+        mask = valsize < 64 ? (((intnum_ul)1) << valsize)-1 : ~(intnum_ul)0;
+        data &= ~(mask << shift);
+        data |= ((intnum_ul)v & mask) << shift;
+
+        for (i=0; i<destsize; i++)
+            ptr[i] = (unsigned char)(data >> (i*8));
+        return;
+    }
+
     /* Read the original data into a bitvect */
     if (bigendian) {
         /* TODO */
@@ -844,6 +1113,23 @@ yasm_intnum_check_size(const yasm_intnum *intn, size_t size, size_t rshift,
 {
     wordptr val;
 
+    if (intn->type == INTNUM_L) {
+        intnum_l v = intn->val.l;
+
+        if (size >= BITVECT_NATIVE_SIZE)
+            return 1;
+        if (rshift > 0)
+            v = intnum_l_sar(v, rshift > 63 ? 63 : (unsigned int)rshift);
+        if (v < 0) {
+            /* negative is never okay for unsigned range */
+            if (rangetype <= 0)
+                return 0;
+            return intnum_ul_fits((intnum_ul)~v, (long)size-1);
+        }
+        return intnum_ul_fits((intnum_ul)v,
+                              rangetype == 1 ? (long)size-1 : (long)size);
+    }
+
     /* If not already a bitvect, convert value to a bitvect */
     if (intn->type == INTNUM_BV) {
         if (rshift > 0) {
@@ -884,30 +1170,11 @@ yasm_intnum_check_size(const yasm_intnum *intn, size_t size, size_t rshift,
 int
 yasm_intnum_in_range(const yasm_intnum *intn, long low, long high)
 {
-    wordptr val = intnum_tobv(result, intn);
-    wordptr lval = op1static;
-    wordptr hval = op2static;
-
-    /* Convert high and low to bitvects */
-    BitVector_Empty(lval);
-    if (low >= 0)
-        BitVector_Chunk_Store(lval, 32, 0, (unsigned long)low);
-    else {
-        BitVector_Chunk_Store(lval, 32, 0, (unsigned long)(-low));
-        BitVector_Negate(lval, lval);
-    }
-
-    BitVector_Empty(hval);
-    if (high >= 0)
-        BitVector_Chunk_Store(hval, 32, 0, (unsigned long)high);
-    else {
-        BitVector_Chunk_Store(hval, 32, 0, (unsigned long)(-high));
-        BitVector_Negate(hval, hval);
-    }
+    /* BVs are out of the range of a 64-bit long */
+    if (intn->type == INTNUM_BV)
+        return 0;
 
-    /* Compare! */
-    return (BitVector_Compare(val, lval) >= 0
-            && BitVector_Compare(val, hval) <= 0);
+    return (intn->val.l >= low && intn->val.l <= high);
 }
 
 static unsigned long
@@ -1004,13 +1271,7 @@ yasm_get_sleb128(long v, unsigned char *ptr)
         return 1;
     }
 
-    BitVector_Empty(val);
-    if (v >= 0)
-        BitVector_Chunk_Store(val, 32, 0, (unsigned long)v);
-    else {
-        BitVector_Chunk_Store(val, 32, 0, (unsigned long)(-v));
-        BitVector_Negate(val, val);
-    }
+    intnum_l_tobv(val, v);
     return get_leb128(val, ptr, 1);
 }
 
@@ -1022,13 +1283,7 @@ yasm_size_sleb128(long v)
     if (v == 0)
         return 1;
 
-    BitVector_Empty(val);
-    if (v >= 0)
-        BitVector_Chunk_Store(val, 32, 0, (unsigned long)v);
-    else {
-        BitVector_Chunk_Store(val, 32, 0, (unsigned long)(-v));
-        BitVector_Negate(val, val);
-    }
+    intnum_l_tobv(val, v);
     return size_leb128(val, 1);
 }
 
@@ -1043,8 +1298,7 @@ yasm_get_uleb128(unsigned long v, unsigned char *ptr)
         return 1;
     }
 
-    BitVector_Empty(val);
-    BitVector_Chunk_Store(val, 32, 0, v);
+    intnum_ul_tobv(val, v);
     return get_leb128(val, ptr, 0);
 }
 
@@ -1056,8 +1310,7 @@ yasm_size_uleb128(unsigned long v)
     if (v == 0)
         return 1;
 
-    BitVector_Empty(val);
-    BitVector_Chunk_Store(val, 32, 0, v);
+    intnum_ul_tobv(val, v);
     return size_leb128(val, 0);
 }
 
@@ -1068,10 +1321,25 @@ yasm_intnum_get_str(const yasm_intnum *intn)
 
     switch (intn->type) {
         case INTNUM_L:
-            s = yasm_xmalloc(16);
-            sprintf((char *)s, "%ld", intn->val.l);
+        {
+            /* 64-bit values can't be portably printed with sprintf */
+            char buf[24];
+            char *p = &buf[sizeof(buf)-1];
+            intnum_ul ul = (intnum_ul)intn->val.l;
+
+            if (intn->val.l < 0)
+                ul = -ul;
+            *p = '\0';
+            do {
+                *--p = (char)('0' + (int)(ul % 10));
+                ul /= 10;
+            } while (ul != 0);
+            if (intn->val.l < 0)
+                *--p = '-';
+            s = yasm_xmalloc((size_t)(&buf[sizeof(buf)]-p));
+            strcpy((char *)s, p);
             return (char *)s;
-            break;
+        }
         case INTNUM_BV:
             return (char *)BitVector_to_Dec(intn->val.bv);
             break;
@@ -1087,8 +1355,16 @@ yasm_intnum_print(const yasm_intnum *intn, FILE *f)
 
     switch (intn->type) {
         case INTNUM_L:
-            fprintf(f, "0x%lx", intn->val.l);
+        {
+            intnum_ul ul = (intnum_ul)intn->val.l;
+
+            if (ul >> 32)
+                fprintf(f, "0x%lx%08lx", (unsigned long)(ul >> 32),
+                        (unsigned long)(ul & 0xFFFFFFFFUL));
+            else
+                fprintf(f, "0x%lx", (unsigned long)ul);
             break;
+        }
         case INTNUM_BV:
             s = BitVector_to_Hex(intn->val.bv);
             fprintf(f, "0x%s", (char *)s);
@@ -34,11 +34,13 @@
 #define YASM_LIB_DECL
 #endif
 
-/** Initialize intnum internal data structures. */
+/** Initialize intnum internal data structures.  This state is per-thread, so
+ * this must be called in each thread that uses libyasm.
+ */
 YASM_LIB_DECL
 void yasm_intnum_initialize(void);
 
-/** Clean up internal intnum allocations. */
+/** Clean up internal intnum allocations for the calling thread. */
 YASM_LIB_DECL
 void yasm_intnum_cleanup(void);
 
@@ -30,6 +30,7 @@
 #include "hamt.h"
 
 #include "errwarn.h"
+#include "intern.h"
 #include "linemap.h"
 
 
@@ -50,10 +51,13 @@ typedef struct line_source_info {
     /* first bytecode on line; NULL if no bytecodes on line */
     /*@null@*/ /*@dependent@*/ yasm_bytecode *bc;
 
-    /* source code line */
-    /*@owned@*/ char *source;
+    /* source code line (in sources storage) */
+    /*@null@*/ /*@dependent@*/ const char *source;
 } line_source_info;
 
+/* Bytes of source text storage per chunk */
+#define SOURCE_CHUNK_SIZE   65536
+
 struct yasm_linemap {
     /* Shared storage for filenames */
     /*@only@*/ /*@null@*/ HAMT *filenames;
@@ -69,6 +73,9 @@ struct yasm_linemap {
     /* Bytecode and source line information */
     /*@only@*/ line_source_info *source_info;
     size_t source_info_size;
+
+    /* Append-only storage for source lines */
+    yasm__strpool sources;
 };
 
 static void
@@ -86,6 +93,7 @@ yasm_linemap_set(yasm_linemap *linemap, const char *filename,
     unsigned long i;
     int replace = 0;
     line_mapping *mapping = NULL;
+    yasm_mem_category oldcat = yasm_mem_set_category(YASM_MEM_LINEMAP);
 
     if (virtual_line == 0) {
         virtual_line = linemap->current;
@@ -135,6 +143,8 @@ yasm_linemap_set(yasm_linemap *linemap, const char *filename,
     mapping->line = virtual_line;
     mapping->file_line = file_line;
     mapping->line_inc = line_inc;
+
+    yasm_mem_set_category(oldcat);
 }
 
 unsigned long
@@ -164,6 +174,7 @@ yasm_linemap *
 yasm_linemap_create(void)
 {
     size_t i;
+    yasm_mem_category oldcat = yasm_mem_set_category(YASM_MEM_LINEMAP);
     yasm_linemap *linemap = yasm_xmalloc(sizeof(yasm_linemap));
 
     linemap->filenames = HAMT_create(0, yasm_internal_error_);
@@ -183,18 +194,16 @@ yasm_linemap_create(void)
         linemap->source_info[i].bc = NULL;
         linemap->source_info[i].source = NULL;
     }
+    yasm__strpool_init(&linemap->sources, SOURCE_CHUNK_SIZE);
 
+    yasm_mem_set_category(oldcat);
     return linemap;
 }
 
 void
 yasm_linemap_destroy(yasm_linemap *linemap)
 {
-    size_t i;
-    for (i=0; i<linemap->source_info_size; i++) {
-        if (linemap->source_info[i].source)
-            yasm_xfree(linemap->source_info[i].source);
-    }
+    yasm__strpool_delete(&linemap->sources);
     yasm_xfree(linemap->source_info);
 
     yasm_xfree(linemap->map_vector);
@@ -216,6 +225,7 @@ yasm_linemap_add_source(yasm_linemap *linemap, yasm_bytecode *bc,
                         const char *source)
 {
     size_t i;
+    yasm_mem_category oldcat = yasm_mem_set_category(YASM_MEM_LINEMAP);
 
     while (linemap->current > linemap->source_info_size) {
         /* allocate another size bins when full for 2x space */
@@ -228,12 +238,15 @@ yasm_linemap_add_source(yasm_linemap *linemap, yasm_bytecode *bc,
         linemap->source_info_size *= 2;
     }
 
-    /* Delete existing info for that line (if any) */
-    if (linemap->source_info[linemap->current-1].source)
-        yasm_xfree(linemap->source_info[linemap->current-1].source);
-
+    /* Replace existing info for that line (if any); the old source text
+     * stays in the source storage until the linemap is destroyed.
+     */
     linemap->source_info[linemap->current-1].bc = bc;
-    linemap->source_info[linemap->current-1].source = yasm__xstrdup(source);
+    linemap->source_info[linemap->current-1].source =
+        source[0] == '\0' ? "" :
+        yasm__strpool_add(&linemap->sources, source, strlen(source));
+
+    yasm_mem_set_category(oldcat);
 }
 
 unsigned long
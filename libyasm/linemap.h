@@ -73,7 +73,8 @@ int yasm_linemap_get_source(yasm_linemap *linemap, unsigned long line,
  * \param linemap       line mapping repository
  * \param bc            bytecode (if any)
  * \param source        source code line
- * \note The source code line pointer is NOT kept, it is strdup'ed.
+ * \note The source code line pointer is NOT kept, it is copied into storage
+ *       owned by the linemap.
  */
 YASM_LIB_DECL
 void yasm_linemap_add_source(yasm_linemap *linemap,
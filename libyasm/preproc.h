@@ -106,6 +106,12 @@ typedef struct yasm_preproc_module {
      * Call yasm_preproc_add_standard() instead of calling this function.
      */
     void (*add_standard) (yasm_preproc *preproc, const char **macros);
+
+    /** Release anything the module keeps from one preprocessor to the next,
+     * such as cached standard macros.  Only called while no preprocessors
+     * of the module exist.  May be NULL.
+     */
+    /*@null@*/ void (*cleanup) (void);
 } yasm_preproc_module;
 
 /** Initialize preprocessor.
@@ -30,6 +30,8 @@
 
 #include "libyasm-stdint.h"
 #include "coretype.h"
+#include "arena.h"
+#include "intern.h"
 #include "hamt.h"
 #include "valparam.h"
 #include "assocdat.h"
@@ -47,6 +49,7 @@
 
 #include "dbgfmt.h"
 #include "objfmt.h"
+#include "trace.h"
 
 #include "inttree.h"
 
@@ -56,7 +59,7 @@ struct yasm_section {
 
     /*@dependent@*/ yasm_object *object;    /* Pointer to parent object */
 
-    /*@owned@*/ char *name;     /* strdup()'ed name (given by user) */
+    /*@dependent@*/ const char *name;   /* interned name (given by user) */
 
     /* associated data; NULL if none */
     /*@null@*/ /*@only@*/ yasm__assoc_data *assoc_data;
@@ -214,9 +217,19 @@ directives_add(yasm_object *object, /*@null@*/ const yasm_directive *dir)
         yasm_directive_wrap *wrap = yasm_xmalloc(sizeof(yasm_directive_wrap));
 
         if (!level2) {
+            const yasm_directive *d;
+            unsigned long count = 0;
+
+            /* Size for the rest of this parser's directives in the list */
+            level2 = HAMT_create(1, yasm_internal_error_);
+            for (d = dir; d->name; d++) {
+                if (strcmp(d->parser, dir->parser) == 0)
+                    count++;
+            }
+            HAMT_reserve(level2, count);
+
             replace = 0;
-            level2 = HAMT_insert(object->directives, dir->parser,
-                                 HAMT_create(1, yasm_internal_error_),
+            level2 = HAMT_insert(object->directives, dir->parser, level2,
                                  &replace, directive_level1_delete);
         }
         replace = 0;
@@ -237,6 +250,13 @@ yasm_object_create(const char *src_filename, const char *obj_filename,
     yasm_object *object = yasm_xmalloc(sizeof(yasm_object));
     int matched, i;
 
+    /* Allocate from the object's arena until it's destroyed */
+    object->arena = yasm_arena_create();
+    object->strings = yasm_intern_table_create();
+    object->optimize_stats.spans = 0;
+    object->optimize_stats.spans_step2 = 0;
+    object->optimize_stats.expansions = 0;
+
     object->src_filename = yasm__xstrdup(src_filename);
     object->obj_filename = yasm__xstrdup(obj_filename);
 
@@ -245,7 +265,7 @@ yasm_object_create(const char *src_filename, const char *obj_filename,
     object->global_suffix = yasm__xstrdup("");
 
     /* Create empty symbol table */
-    object->symtab = yasm_symtab_create();
+    object->symtab = yasm_symtab_create(object->strings);
 
     /* Initialize sections linked list */
     STAILQ_INIT(&object->sections);
@@ -329,13 +349,18 @@ yasm_object_get_general(yasm_object *object, const char *name,
     yasm_section *s;
     yasm_bytecode *bc;
 
+    const char *iname = yasm_intern_find(object->strings, name);
+
     /* Search through current sections to see if we already have one with
-     * that name.
+     * that name.  Names are interned, so compare pointers; if the name
+     * hasn't been interned, there can't be one.
      */
-    STAILQ_FOREACH(s, &object->sections, link) {
-        if (strcmp(s->name, name) == 0) {
-            *isnew = 0;
-            return s;
+    if (iname) {
+        STAILQ_FOREACH(s, &object->sections, link) {
+            if (s->name == iname) {
+                *isnew = 0;
+                return s;
+            }
         }
     }
 
@@ -346,7 +371,7 @@ yasm_object_get_general(yasm_object *object, const char *name,
     STAILQ_INSERT_TAIL(&object->sections, s, link);
 
     s->object = object;
-    s->name = yasm__xstrdup(name);
+    s->name = iname ? iname : yasm_intern(object->strings, name);
     s->assoc_data = NULL;
     s->align = align;
 
@@ -384,6 +409,9 @@ yasm_object_directive(yasm_object *object, const char *name,
     HAMT *level2;
     yasm_directive_wrap *wrap;
 
+    if (!object->directives)
+        return 1;
+
     level2 = HAMT_search(object->directives, parser);
     if (!level2)
         return 1;
@@ -473,6 +501,12 @@ yasm_object_destroy(yasm_object *object)
 {
     yasm_section *cur, *next;
 
+    /* Destroy the arena first, so the frees below only count down its
+     * chunks (releasing each as it empties) rather than refilling its free
+     * lists.
+     */
+    yasm_arena_destroy(object->arena);
+
     /* Delete object format, debug format, and arch.  This can be called
      * due to an error in yasm_object_create(), so look out for NULLs.
      */
@@ -490,7 +524,8 @@ yasm_object_destroy(yasm_object *object)
     }
 
     /* Delete directives HAMT */
-    HAMT_destroy(object->directives, directive_level1_delete);
+    if (object->directives)
+        HAMT_destroy(object->directives, directive_level1_delete);
 
     /* Delete prefix/suffix */
     yasm_xfree(object->global_prefix);
@@ -507,6 +542,8 @@ yasm_object_destroy(yasm_object *object)
     if (object->arch)
         yasm_arch_destroy(object->arch);
 
+    yasm_intern_table_destroy(object->strings);
+
     yasm_xfree(object);
 }
 
@@ -551,6 +588,24 @@ yasm_object_finalize(yasm_object *object, yasm_errwarns *errwarns)
     }
 }
 
+void
+yasm_object_compact(yasm_object *object)
+{
+    yasm_section *sect;
+    yasm_bytecode *cur;
+
+    /* Directives are only processed during parsing */
+    if (object->directives) {
+        HAMT_destroy(object->directives, directive_level1_delete);
+        object->directives = NULL;
+    }
+
+    STAILQ_FOREACH(sect, &object->sections, link) {
+        STAILQ_FOREACH(cur, &sect->bcs, link)
+            yasm_bc_compact(cur);
+    }
+}
+
 int
 yasm_object_sections_traverse(yasm_object *object, /*@null@*/ void *d,
                               int (*func) (yasm_section *sect,
@@ -572,8 +627,11 @@ yasm_object_find_general(yasm_object *object, const char *name)
 {
     yasm_section *cur;
 
+    name = yasm_intern_find(object->strings, name);
+    if (!name)
+        return NULL;
     STAILQ_FOREACH(cur, &object->sections, link) {
-        if (strcmp(cur->name, name) == 0)
+        if (cur->name == name)
             return cur;
     }
     return NULL;
@@ -638,7 +696,7 @@ yasm_section_bcs_append(yasm_section *sect, yasm_bytecode *bc)
             STAILQ_INSERT_TAIL(&sect->bcs, bc, link);
             return bc;
         } else
-            yasm_xfree(bc);
+            yasm__arena_xfree(bc);
     }
     return (yasm_bytecode *)NULL;
 }
@@ -694,7 +752,6 @@ yasm_section_destroy(yasm_section *sect)
     if (!sect)
         return;
 
-    yasm_xfree(sect->name);
     yasm__assoc_data_destroy(sect->assoc_data);
 
     /* Delete bytecodes */
@@ -1305,6 +1362,13 @@ optimize_term_expand(IntervalTreeNode *node, void *d)
     span->active = 2;       /* Mark as being in Q */
 }
 
+void
+yasm_object_get_optimize_stats(const yasm_object *object,
+                               yasm_optimize_stats *stats)
+{
+    *stats = object->optimize_stats;    /* structure copy */
+}
+
 void
 yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns)
 {
@@ -1321,6 +1385,10 @@ yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns)
     STAILQ_INIT(&optd.offset_setters);
     optd.itree = IT_create();
 
+    object->optimize_stats.spans = 0;
+    object->optimize_stats.spans_step2 = 0;
+    object->optimize_stats.expansions = 0;
+
     /* Create an placeholder offset setter for spans to point to; this will
      * get updated if/when we actually run into one.
      */
@@ -1333,6 +1401,7 @@ yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns)
     optd.os = os;
 
     /* Step 1a */
+    yasm_trace_begin("optimize", "step 1a", NULL);
     STAILQ_FOREACH(sect, &object->sections, link) {
         unsigned long offset = 0;
 
@@ -1367,7 +1436,7 @@ yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns)
                     STAILQ_INSERT_TAIL(&optd.offset_setters, os, link);
                     optd.os = os;
 
-                    if (bc->multiple) {
+                    if (yasm_bc_get_multiple_expr(bc)) {
                         yasm_error_set(YASM_ERROR_VALUE,
                             N_("cannot combine multiples and setting assembly position"));
                         yasm_errwarn_propagate(errwarns, bc->line);
@@ -1381,6 +1450,7 @@ yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns)
             bc = STAILQ_NEXT(bc, link);
         }
     }
+    yasm_trace_end();
 
     if (saw_error) {
         optimize_cleanup(&optd);
@@ -1388,7 +1458,9 @@ yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns)
     }
 
     /* Step 1b */
+    yasm_trace_begin("optimize", "step 1b", NULL);
     TAILQ_FOREACH_SAFE(span, &optd.spans, link, span_temp) {
+        object->optimize_stats.spans++;
         span_create_terms(span);
         if (yasm_error_occurred()) {
             yasm_errwarn_propagate(errwarns, span->bc->line);
@@ -1415,6 +1487,7 @@ yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns)
         }
         span->cur_val = span->new_val;
     }
+    yasm_trace_end();
 
     if (saw_error) {
         optimize_cleanup(&optd);
@@ -1422,12 +1495,16 @@ yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns)
     }
 
     /* Step 1c */
-    if (update_all_bc_offsets(object, errwarns)) {
+    yasm_trace_begin("optimize", "step 1c", NULL);
+    retval = update_all_bc_offsets(object, errwarns);
+    yasm_trace_end();
+    if (retval) {
         optimize_cleanup(&optd);
         return;
     }
 
     /* Step 1d */
+    yasm_trace_begin("optimize", "step 1d", NULL);
     STAILQ_INIT(&optd.QB);
     TAILQ_FOREACH(span, &optd.spans, link) {
         yasm_intnum *intn;
@@ -1457,8 +1534,10 @@ yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns)
             /* Exceeded threshold, add span to QB */
             STAILQ_INSERT_TAIL(&optd.QB, span, linkq);
             span->active = 2;
+            object->optimize_stats.spans_step2++;
         }
     }
+    yasm_trace_end();
 
     /* Do we need step 2?  If not, go ahead and exit. */
     if (STAILQ_EMPTY(&optd.QB)) {
@@ -1502,6 +1581,7 @@ yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns)
     }
 
     /* Step 2 */
+    yasm_trace_begin("optimize", "step 2", NULL);
     STAILQ_INIT(&optd.QA);
     while (!STAILQ_EMPTY(&optd.QA) || !(STAILQ_EMPTY(&optd.QB))) {
         unsigned long orig_len;
@@ -1536,6 +1616,7 @@ yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns)
                                 span->new_val, &span->neg_thres,
                                 &span->pos_thres);
         yasm_errwarn_propagate(errwarns, span->bc->line);
+        object->optimize_stats.expansions++;
 
         if (retval < 0) {
             /* error */
@@ -1591,6 +1672,7 @@ yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns)
             os = STAILQ_NEXT(os, link);
         }
     }
+    yasm_trace_end();
 
     if (saw_error) {
         optimize_cleanup(&optd);
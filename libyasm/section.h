@@ -45,6 +45,13 @@ struct yasm_reloc {
     /*@dependent@*/ yasm_symrec *sym;       /**< Relocated symbol */
 };
 
+/** Statistics from a yasm_object_optimize() call. */
+typedef struct yasm_optimize_stats {
+    unsigned long spans;        /**< Spans processed in step 1b */
+    unsigned long spans_step2;  /**< Spans queued for step 2 */
+    unsigned long expansions;   /**< Span expansions in step 2 */
+} yasm_optimize_stats;
+
 /** An object.  This is the internal representation of an object file. */
 struct yasm_object {
     /*@owned@*/ char *src_filename;     /**< Source filename */
@@ -64,15 +71,29 @@ struct yasm_object {
     /*@reldef@*/ STAILQ_HEAD(yasm_sectionhead, yasm_section) sections;
 
     /** Directives, organized as two level HAMT; first level is parser,
-     * second level is directive name.
+     * second level is directive name.  NULL once the object has been
+     * compacted.
      */
-    /*@owned@*/ struct HAMT *directives;
+    /*@owned@*/ /*@null@*/ struct HAMT *directives;
 
     /** Prefix prepended to externally-visible symbols (empty string if none) */
     /*@owned@*/ char *global_prefix;
 
     /** Suffix appended to externally-visible symbols (empty string if none) */
     /*@owned@*/ char *global_suffix;
+
+    /** Arena that the object's expressions, bytecodes, symbols, and other
+     * parse-time structures are allocated from.  Current from creation
+     * until the object is destroyed.
+     */
+    /*@owned@*/ yasm_arena *arena;
+
+    /** String table that symbol, section, and other names are interned in.
+     */
+    /*@owned@*/ yasm_intern_table *strings;
+
+    /** Statistics from the last yasm_object_optimize() call. */
+    yasm_optimize_stats optimize_stats;
 };
 
 /** Create a new object.  A default section is created as the first section.
@@ -150,6 +171,15 @@ void yasm_object_print(const yasm_object *object, FILE *f, int indent_level);
 YASM_LIB_DECL
 void yasm_object_finalize(yasm_object *object, yasm_errwarns *errwarns);
 
+/** Compact an object after finalization, releasing state that is only
+ * needed during parsing (such as the directive table) and shrinking the
+ * contents of each bytecode.  No further directives may be processed for
+ * the object once it's been compacted.
+ * \param object        object
+ */
+YASM_LIB_DECL
+void yasm_object_compact(yasm_object *object);
+
 /** Traverses all sections in an object, calling a function on each section.
  * \param object        object
  * \param d             data pointer passed to func on each call
@@ -201,6 +231,15 @@ void yasm_object_set_global_suffix(yasm_object *object, const char *suffix);
 YASM_LIB_DECL
 void yasm_object_optimize(yasm_object *object, yasm_errwarns *errwarns);
 
+/** Get the statistics from the most recent yasm_object_optimize() call on
+ * an object.  All zero if the object hasn't been optimized.
+ * \param object        object
+ * \param stats         statistics (output)
+ */
+YASM_LIB_DECL
+void yasm_object_get_optimize_stats(const yasm_object *object,
+                                    /*@out@*/ yasm_optimize_stats *stats);
+
 /** Determine if a section is flagged to contain code.
  * \param sect      section
  * \return Nonzero if section is flagged to contain code.
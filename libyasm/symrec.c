@@ -28,12 +28,15 @@
 
 #include <limits.h>
 #include <ctype.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "libyasm-stdint.h"
 #include "coretype.h"
+#include "arena.h"
+#include "intern.h"
 #include "valparam.h"
-#include "hamt.h"
-#include "assocdat.h"
 
 #include "errwarn.h"
 #include "intnum.h"
@@ -57,8 +60,18 @@ typedef enum {
                                    purpose */
 } sym_type;
 
+/* Symbol table iterator; embedded in each symbol in the table, linking the
+ * symbols in insertion order.
+ */
+struct yasm_symtab_iter {
+    /*@null@*/ /*@dependent@*/ struct yasm_symtab_iter *next;
+    /*@dependent@*/ struct yasm_symtab_iter **prevp;    /* link to this */
+    /*@dependent@*/ yasm_symrec *rec;
+};
+
 struct yasm_symrec {
-    char *name;
+    /*@dependent@*/ const char *name;   /* interned */
+    yasm_symtab_iter iter;      /* only used for symbols in the table */
     sym_type type;
     yasm_sym_status status;
     yasm_sym_vis visibility;
@@ -74,8 +87,9 @@ struct yasm_symrec {
     unsigned int size;          /* 0 if not user-defined */
     const char *segment;        /* for segmented systems like DOS */
 
-    /* associated data; NULL if none */
-    /*@null@*/ /*@only@*/ yasm__assoc_data *assoc_data;
+    /* symbol table the symbol belongs to, and its ID within it */
+    /*@dependent@*/ yasm_symtab *symtab;
+    unsigned long id;
 };
 
 /* Linked list of symbols not in the symbol table. */
@@ -84,13 +98,73 @@ typedef struct non_table_symrec_s {
      /*@owned@*/ yasm_symrec *rec;
 } non_table_symrec;
 
+/* The symbol table is an open-addressed hash table in the style of
+ * SwissTable.  Each slot has a control byte that is SYMTAB_EMPTY,
+ * SYMTAB_DELETED, or the top 7 bits of the hash of the symbol's name, and
+ * the control bytes are probed a group of SYMTAB_GROUP at a time (16 with
+ * SSE2 compares, otherwise 8 as a single word), so slots holding other
+ * symbols are almost always skipped without looking at the symbols
+ * themselves.  Groups are probed linearly
+ * until a group with an empty slot; deleted slots don't end the probe, but
+ * are reused.  The table is rebuilt at 7/8 load (counting deleted slots),
+ * doubling in size unless most of the load was deleted slots.
+ */
+#define SYMTAB_EMPTY        0x80
+#define SYMTAB_DELETED      0xFE
+
+#ifdef __SSE2__
+#define SYMTAB_GROUP        16
+#else
+#ifdef _MSC_VER
+typedef unsigned __int64 symtab_group;
+#else
+typedef uint64_t symtab_group;
+#endif
+
+#define SYMTAB_GROUP        8
+#define SYMTAB_GROUP_LSB    (((symtab_group)0x01010101UL << 32) | 0x01010101UL)
+#define SYMTAB_GROUP_MSB    (((symtab_group)0x80808080UL << 32) | 0x80808080UL)
+#endif
+
+/* Initial number of slots; must be a power of 2 and a multiple of
+ * SYMTAB_GROUP.
+ */
+#define SYMTAB_INIT_SIZE    128
+
+/* Data associated with symbols is kept in side arrays in the symbol table,
+ * one per data callback, indexed by symbol ID.
+ */
+typedef struct symtab_side {
+    /*@dependent@*/ const yasm_assoc_data_callback *callback;
+    /*@only@*/ void **data;     /* NULL entries if no data */
+    unsigned long size;         /* number of entries */
+} symtab_side;
+
 struct yasm_symtab {
-    /* The symbol table: a hash array mapped trie (HAMT). */
-    /*@only@*/ HAMT *sym_table;
+    /*@only@*/ unsigned char *ctrl;     /* control bytes */
+    /*@only@*/ yasm_symrec **slots;
+    size_t size;        /* number of slots */
+    size_t count;       /* number of slots in use or deleted */
+
+    /* Symbols in the table, in insertion order */
+    /*@null@*/ /*@dependent@*/ yasm_symtab_iter *first;
+    /*@dependent@*/ yasm_symtab_iter **last;
+
     /* Symbols not in the table */
     SLIST_HEAD(nontablesymhead_s, non_table_symrec_s) non_table_syms;
 
+    /* ID for the next symbol created (in or out of the table) */
+    unsigned long next_id;
+
+    /* Associated data side arrays */
+    /*@null@*/ /*@only@*/ symtab_side *sides;
+    int num_sides;
+
     int case_sensitive;
+
+    /* Table symbol names are interned in */
+    /*@dependent@*/ yasm_intern_table *strings;
+    /*@null@*/ /*@only@*/ yasm_intern_table *own_strings;
 };
 
 static void
@@ -131,12 +205,28 @@ static yasm_assoc_data_callback common_size_cb = {
 };
 
 yasm_symtab *
-yasm_symtab_create(void)
+yasm_symtab_create(yasm_intern_table *strings)
 {
-    yasm_symtab *symtab = yasm_xmalloc(sizeof(yasm_symtab));
-    symtab->sym_table = HAMT_create(0, yasm_internal_error_);
+    yasm_symtab *symtab = yasm__xmalloc_cat(YASM_MEM_SYMREC,
+                                            sizeof(yasm_symtab));
+    symtab->size = SYMTAB_INIT_SIZE;
+    symtab->count = 0;
+    symtab->ctrl = yasm__xmalloc_cat(YASM_MEM_SYMREC, symtab->size);
+    memset(symtab->ctrl, SYMTAB_EMPTY, symtab->size);
+    symtab->slots = yasm__xmalloc_cat(YASM_MEM_SYMREC,
+                                      symtab->size*sizeof(yasm_symrec *));
+    symtab->first = NULL;
+    symtab->last = &symtab->first;
+    symtab->next_id = 0;
+    symtab->sides = NULL;
+    symtab->num_sides = 0;
     SLIST_INIT(&symtab->non_table_syms);
     symtab->case_sensitive = 1;
+    if (strings) {
+        symtab->strings = strings;
+        symtab->own_strings = NULL;
+    } else
+        symtab->strings = symtab->own_strings = yasm_intern_table_create();
     return symtab;
 }
 
@@ -146,27 +236,20 @@ yasm_symtab_set_case_sensitive(yasm_symtab *symtab, int sensitive)
     symtab->case_sensitive = sensitive;
 }
 
+/* Associated data is destroyed separately, see yasm_symtab_destroy(). */
 static void
-symrec_destroy_one(/*@only@*/ void *d)
+symrec_destroy_one(/*@only@*/ yasm_symrec *sym)
 {
-    yasm_symrec *sym = d;
-    yasm_xfree(sym->name);
     if (sym->type == SYM_EQU && (sym->status & YASM_SYM_VALUED))
         yasm_expr_destroy(sym->value.expn);
-    yasm__assoc_data_destroy(sym->assoc_data);
-    yasm_xfree(sym);
+    yasm__arena_xfree(sym);
 }
 
 static /*@partial@*/ yasm_symrec *
-symrec_new_common(/*@keep@*/ char *name, int case_sensitive)
+symrec_new_common(yasm_symtab *symtab, /*@dependent@*/ const char *name)
 {
-    yasm_symrec *rec = yasm_xmalloc(sizeof(yasm_symrec));
-
-    if (!case_sensitive) {
-        char *c;
-        for (c=name; *c; c++)
-            *c = tolower(*c);
-    }
+    yasm_symrec *rec = yasm__arena_xmalloc(YASM_MEM_SYMREC,
+                                           sizeof(yasm_symrec));
 
     rec->name = name;
     rec->type = SYM_UNKNOWN;
@@ -176,33 +259,200 @@ symrec_new_common(/*@keep@*/ char *name, int case_sensitive)
     rec->visibility = YASM_SYM_LOCAL;
     rec->size = 0;
     rec->segment = NULL;
-    rec->assoc_data = NULL;
+    rec->symtab = symtab;
+    rec->id = symtab->next_id++;
     return rec;
 }
 
+static unsigned long
+symtab_hash(const yasm_symtab *symtab, const char *name)
+{
+    unsigned long hash = 2166136261UL;
+
+    /* FNV-1a */
+    if (symtab->case_sensitive) {
+        for (; *name; name++)
+            hash = ((hash ^ (unsigned char)*name) * 16777619UL)
+                   & 0xFFFFFFFFUL;
+    } else {
+        for (; *name; name++)
+            hash = ((hash ^ (unsigned char)tolower(*name)) * 16777619UL)
+                   & 0xFFFFFFFFUL;
+    }
+    return hash;
+}
+
+#ifdef __SSE2__
+/* Returns a mask with bit i set if control byte i of the group is tag. */
+static unsigned int
+symtab_group_match(const unsigned char *ctrl, unsigned char tag)
+{
+    __m128i w = _mm_loadu_si128((const __m128i *)ctrl);
+    return (unsigned int)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(w, _mm_set1_epi8((char)tag)));
+}
+
+/* Returns nonzero if the group has an empty slot. */
+static int
+symtab_group_has_empty(const unsigned char *ctrl)
+{
+    return symtab_group_match(ctrl, SYMTAB_EMPTY) != 0;
+}
+#else
+static unsigned int
+symtab_group_match(const unsigned char *ctrl, unsigned char tag)
+{
+    symtab_group w, x;
+    unsigned int match = 0;
+    int i;
+
+    memcpy(&w, ctrl, sizeof(w));
+    x = w ^ (SYMTAB_GROUP_LSB * tag);
+    /* Nonzero if any control byte in the group matches the tag */
+    if ((x - SYMTAB_GROUP_LSB) & ~x & SYMTAB_GROUP_MSB) {
+        for (i=0; i<SYMTAB_GROUP; i++) {
+            if (ctrl[i] == tag)
+                match |= 1U << i;
+        }
+    }
+    return match;
+}
+
+static int
+symtab_group_has_empty(const unsigned char *ctrl)
+{
+    symtab_group w;
+
+    memcpy(&w, ctrl, sizeof(w));
+    return (w & ~(w << 6) & SYMTAB_GROUP_MSB) != 0;
+}
+#endif
+
+/* Returns the slot holding the symbol called name, or NULL if there's no
+ * such symbol in the table.
+ */
+static /*@null@*/ yasm_symrec **
+symtab_find(const yasm_symtab *symtab, const char *name, unsigned long hash)
+{
+    unsigned char tag = (unsigned char)(hash >> 25);
+    size_t mask = symtab->size/SYMTAB_GROUP - 1;
+    size_t g, i;
+
+    for (g = hash & mask; ; g = (g+1) & mask) {
+        const unsigned char *ctrl = &symtab->ctrl[g*SYMTAB_GROUP];
+        unsigned int match = symtab_group_match(ctrl, tag);
+
+        for (i=0; match; i++, match >>= 1) {
+            yasm_symrec *rec;
+            if (!(match & 1))
+                continue;
+            rec = symtab->slots[g*SYMTAB_GROUP+i];
+            if (rec->name == name || (symtab->case_sensitive ?
+                    strcmp(rec->name, name) :
+                    yasm__strcasecmp(rec->name, name)) == 0)
+                return &symtab->slots[g*SYMTAB_GROUP+i];
+        }
+        /* A group with an empty slot ends the probe sequence */
+        if (symtab_group_has_empty(ctrl))
+            return NULL;
+    }
+}
+
+/* Puts a symbol into the first empty or deleted slot in its probe sequence.
+ * Returns nonzero if the slot was empty.
+ */
+static int
+symtab_place(yasm_symtab *symtab, yasm_symrec *rec, unsigned long hash)
+{
+    size_t mask = symtab->size/SYMTAB_GROUP - 1;
+    size_t g, i;
+
+    for (g = hash & mask; ; g = (g+1) & mask) {
+        unsigned char *ctrl = &symtab->ctrl[g*SYMTAB_GROUP];
+        for (i=0; i<SYMTAB_GROUP; i++) {
+            if (ctrl[i] & 0x80) {
+                int empty = (ctrl[i] == SYMTAB_EMPTY);
+                ctrl[i] = (unsigned char)(hash >> 25);
+                symtab->slots[g*SYMTAB_GROUP+i] = rec;
+                return empty;
+            }
+        }
+    }
+}
+
+static void
+symtab_rebuild(yasm_symtab *symtab)
+{
+    yasm_symtab_iter *iter;
+    size_t num = 0;
+
+    for (iter = symtab->first; iter; iter = iter->next)
+        num++;
+    if (num > symtab->size/2)
+        symtab->size *= 2;
+    symtab->count = num;
+    yasm_xfree(symtab->ctrl);
+    yasm_xfree(symtab->slots);
+    symtab->ctrl = yasm__xmalloc_cat(YASM_MEM_SYMREC, symtab->size);
+    memset(symtab->ctrl, SYMTAB_EMPTY, symtab->size);
+    symtab->slots = yasm__xmalloc_cat(YASM_MEM_SYMREC,
+                                      symtab->size*sizeof(yasm_symrec *));
+
+    for (iter = symtab->first; iter; iter = iter->next)
+        symtab_place(symtab, iter->rec, symtab_hash(symtab, iter->rec->name));
+}
+
 static /*@partial@*/ /*@dependent@*/ yasm_symrec *
-symtab_get_or_new_in_table(yasm_symtab *symtab, /*@only@*/ char *name)
+symtab_get_or_new_in_table(yasm_symtab *symtab, const char *name)
 {
-    yasm_symrec *rec = symrec_new_common(name, symtab->case_sensitive);
-    int replace = 0;
+    unsigned long hash = symtab_hash(symtab, name);
+    yasm_symrec **slot = symtab_find(symtab, name, hash);
+    yasm_symrec *rec;
 
-    rec->status = YASM_SYM_NOSTATUS;
+    if (slot)
+        return *slot;
 
     if (!symtab->case_sensitive) {
+        char *lname = yasm__xstrdup(name);
         char *c;
-        for (c=name; *c; c++)
+        for (c=lname; *c; c++)
             *c = tolower(*c);
-    }
+        rec = symrec_new_common(symtab, yasm_intern(symtab->strings, lname));
+        yasm_xfree(lname);
+    } else
+        rec = symrec_new_common(symtab, yasm_intern(symtab->strings, name));
+    rec->status = YASM_SYM_NOSTATUS;
+
+    rec->iter.next = NULL;
+    rec->iter.prevp = symtab->last;
+    rec->iter.rec = rec;
+    *symtab->last = &rec->iter;
+    symtab->last = &rec->iter.next;
 
-    return HAMT_insert(symtab->sym_table, name, rec, &replace,
-                       symrec_destroy_one);
+    if (symtab_place(symtab, rec, hash) &&
+        ++symtab->count > symtab->size/8*7)
+        symtab_rebuild(symtab);
+    return rec;
 }
 
 static /*@partial@*/ /*@dependent@*/ yasm_symrec *
-symtab_get_or_new_not_in_table(yasm_symtab *symtab, /*@only@*/ char *name)
+symtab_get_or_new_not_in_table(yasm_symtab *symtab, const char *name)
 {
-    non_table_symrec *sym = yasm_xmalloc(sizeof(non_table_symrec));
-    sym->rec = symrec_new_common(name, symtab->case_sensitive);
+    non_table_symrec *sym = yasm__xmalloc_cat(YASM_MEM_SYMREC,
+                                              sizeof(non_table_symrec));
+    const char *symname;
+
+    if (!symtab->case_sensitive) {
+        char *lname = yasm__xstrdup(name);
+        char *c;
+        for (c=lname; *c; c++)
+            *c = tolower(*c);
+        symname = yasm_intern(symtab->strings, lname);
+        yasm_xfree(lname);
+    } else
+        symname = yasm_intern(symtab->strings, name);
+
+    sym->rec = symrec_new_common(symtab, symname);
 
     sym->rec->status = YASM_SYM_NOTINTABLE;
 
@@ -216,12 +466,16 @@ symtab_get_or_new_not_in_table(yasm_symtab *symtab, /*@only@*/ char *name)
 static /*@partial@*/ /*@dependent@*/ yasm_symrec *
 symtab_get_or_new(yasm_symtab *symtab, const char *name, int in_table)
 {
-    char *symname = yasm__xstrdup(name);
+    yasm_mem_category oldcat = yasm_mem_set_category(YASM_MEM_SYMREC);
+    yasm_symrec *rec;
 
     if (in_table)
-        return symtab_get_or_new_in_table(symtab, symname);
+        rec = symtab_get_or_new_in_table(symtab, name);
     else
-        return symtab_get_or_new_not_in_table(symtab, symname);
+        rec = symtab_get_or_new_not_in_table(symtab, name);
+
+    yasm_mem_set_category(oldcat);
+    return rec;
 }
 /*@=freshtrans =mustfree@*/
 
@@ -229,25 +483,32 @@ int
 yasm_symtab_traverse(yasm_symtab *symtab, void *d,
                      int (*func) (yasm_symrec *sym, void *d))
 {
-    return HAMT_traverse(symtab->sym_table, d, (int (*) (void *, void *))func);
+    yasm_symtab_iter *iter;
+
+    for (iter = symtab->first; iter; iter = iter->next) {
+        int retval = func(iter->rec, d);
+        if (retval != 0)
+            return retval;
+    }
+    return 0;
 }
 
 const yasm_symtab_iter *
 yasm_symtab_first(const yasm_symtab *symtab)
 {
-    return (const yasm_symtab_iter *)HAMT_first(symtab->sym_table);
+    return symtab->first;
 }
 
 /*@null@*/ const yasm_symtab_iter *
 yasm_symtab_next(const yasm_symtab_iter *prev)
 {
-    return (const yasm_symtab_iter *)HAMT_next((const HAMTEntry *)prev);
+    return prev->next;
 }
 
 yasm_symrec *
 yasm_symtab_iter_value(const yasm_symtab_iter *cur)
 {
-    return (yasm_symrec *)HAMTEntry_get_data((const HAMTEntry *)cur);
+    return cur->rec;
 }
 
 yasm_symrec *
@@ -277,17 +538,37 @@ yasm_symtab_use(yasm_symtab *symtab, const char *name, unsigned long line)
 yasm_symrec *
 yasm_symtab_get(yasm_symtab *symtab, const char *name)
 {
-    if (!symtab->case_sensitive) {
-        char *_name = yasm__xstrdup(name);
-        char *c;
-        yasm_symrec *ret;
-        for (c=_name; *c; c++)
-            *c = tolower(*c);
-        ret = HAMT_search(symtab->sym_table, _name);
-        yasm_xfree(_name);
-        return ret;
-    } else
-      return HAMT_search(symtab->sym_table, name);
+    yasm_symrec **slot = symtab_find(symtab, name, symtab_hash(symtab, name));
+    return slot ? *slot : NULL;
+}
+
+int
+yasm_symtab_remove(yasm_symtab *symtab, const char *name)
+{
+    yasm_symrec **slot = symtab_find(symtab, name, symtab_hash(symtab, name));
+    yasm_symrec *rec;
+    int i;
+
+    if (!slot)
+        return 0;
+    rec = *slot;
+    symtab->ctrl[slot - symtab->slots] = SYMTAB_DELETED;
+
+    *rec->iter.prevp = rec->iter.next;
+    if (rec->iter.next)
+        rec->iter.next->prevp = rec->iter.prevp;
+    else
+        symtab->last = rec->iter.prevp;
+
+    for (i=0; i<symtab->num_sides; i++) {
+        symtab_side *side = &symtab->sides[i];
+        if (rec->id < side->size && side->data[rec->id]) {
+            side->callback->destroy(side->data[rec->id]);
+            side->data[rec->id] = NULL;
+        }
+    }
+    symrec_destroy_one(rec);
+    return 1;
 }
 
 static /*@dependent@*/ yasm_symrec *
@@ -447,7 +728,27 @@ yasm_symtab_parser_finalize(yasm_symtab *symtab, int undef_extern,
 void
 yasm_symtab_destroy(yasm_symtab *symtab)
 {
-    HAMT_destroy(symtab->sym_table, symrec_destroy_one);
+    yasm_symtab_iter *iter = symtab->first;
+    int i;
+
+    for (i=0; i<symtab->num_sides; i++) {
+        symtab_side *side = &symtab->sides[i];
+        unsigned long id;
+        for (id=0; id<side->size; id++) {
+            if (side->data[id])
+                side->callback->destroy(side->data[id]);
+        }
+        yasm_xfree(side->data);
+    }
+    yasm_xfree(symtab->sides);
+
+    while (iter) {
+        yasm_symrec *rec = iter->rec;
+        iter = iter->next;
+        symrec_destroy_one(rec);
+    }
+    yasm_xfree(symtab->ctrl);
+    yasm_xfree(symtab->slots);
 
     while (!SLIST_EMPTY(&symtab->non_table_syms)) {
         non_table_symrec *sym = SLIST_FIRST(&symtab->non_table_syms);
@@ -456,6 +757,8 @@ yasm_symtab_destroy(yasm_symtab *symtab)
         yasm_xfree(sym);
     }
 
+    if (symtab->own_strings)
+        yasm_intern_table_destroy(symtab->own_strings);
     yasm_xfree(symtab);
 }
 
@@ -628,23 +931,76 @@ yasm_symrec_get_common_size(yasm_symrec *sym)
     return (yasm_expr **)yasm_symrec_get_data(sym, &common_size_cb);
 }
 
+unsigned long
+yasm_symrec_get_id(const yasm_symrec *sym)
+{
+    return sym->id;
+}
+
 void *
 yasm_symrec_get_data(yasm_symrec *sym,
                      const yasm_assoc_data_callback *callback)
 {
-    return yasm__assoc_data_get(sym->assoc_data, callback);
+    const yasm_symtab *symtab = sym->symtab;
+    int i;
+
+    for (i=0; i<symtab->num_sides; i++) {
+        const symtab_side *side = &symtab->sides[i];
+        if (side->callback == callback)
+            return sym->id < side->size ? side->data[sym->id] : NULL;
+    }
+    return NULL;
 }
 
 void
 yasm_symrec_add_data(yasm_symrec *sym,
                      const yasm_assoc_data_callback *callback, void *data)
 {
-    sym->assoc_data = yasm__assoc_data_add(sym->assoc_data, callback, data);
+    yasm_symtab *symtab = sym->symtab;
+    symtab_side *side = NULL;
+    unsigned long n;
+    int i;
+
+    for (i=0; i<symtab->num_sides; i++) {
+        if (symtab->sides[i].callback == callback) {
+            side = &symtab->sides[i];
+            break;
+        }
+    }
+
+    /* First data for this callback: add a side array */
+    if (!side) {
+        symtab->sides = yasm__xrealloc_cat(YASM_MEM_SYMREC, symtab->sides,
+            (symtab->num_sides+1)*sizeof(symtab_side));
+        side = &symtab->sides[symtab->num_sides++];
+        side->callback = callback;
+        side->data = NULL;
+        side->size = 0;
+    }
+
+    /* Make room for all the symbols created so far */
+    if (sym->id >= side->size) {
+        unsigned long size = side->size ? side->size*2 : 64;
+        while (size <= sym->id || size < symtab->next_id)
+            size *= 2;
+        side->data = yasm__xrealloc_cat(YASM_MEM_SYMREC, side->data,
+                                        size*sizeof(void *));
+        for (n=side->size; n<size; n++)
+            side->data[n] = NULL;
+        side->size = size;
+    }
+
+    /* Delete existing data (if any) */
+    if (side->data[sym->id] && side->data[sym->id] != data)
+        callback->destroy(side->data[sym->id]);
+    side->data[sym->id] = data;
 }
 
 void
 yasm_symrec_print(const yasm_symrec *sym, FILE *f, int indent_level)
 {
+    int i;
+
     switch (sym->type) {
         case SYM_UNKNOWN:
             fprintf(f, "%*s-Unknown (Common/Extern)-\n", indent_level, "");
@@ -701,9 +1057,17 @@ yasm_symrec_print(const yasm_symrec *sym, FILE *f, int indent_level)
         fprintf(f, "\n");
     }
 
-    if (sym->assoc_data) {
-        fprintf(f, "%*sAssociated data:\n", indent_level, "");
-        yasm__assoc_data_print(sym->assoc_data, f, indent_level+1);
+    for (i=0; i<sym->symtab->num_sides; i++) {
+        const symtab_side *side = &sym->symtab->sides[i];
+        if (sym->id < side->size && side->data[sym->id]) {
+            fprintf(f, "%*sAssociated data:\n", indent_level, "");
+            break;
+        }
+    }
+    for (; i<sym->symtab->num_sides; i++) {
+        const symtab_side *side = &sym->symtab->sides[i];
+        if (sym->id < side->size && side->data[sym->id])
+            side->callback->print(side->data[sym->id], f, indent_level+1);
     }
 
     fprintf(f, "%*sLine Index (Defined)=%lu\n", indent_level, "",
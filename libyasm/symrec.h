@@ -57,9 +57,13 @@ typedef enum yasm_sym_vis {
     YASM_SYM_DLOCAL = 1 << 3    /**< If symbol is explicitly declared LOCAL */
 } yasm_sym_vis;
 
-/** Create a new symbol table. */
+/** Create a new symbol table.
+ * \param strings   table to intern symbol names in, or NULL for the symbol
+ *                  table to keep its own
+ * \return Newly allocated symbol table.
+ */
 YASM_LIB_DECL
-yasm_symtab *yasm_symtab_create(void);
+yasm_symtab *yasm_symtab_create(/*@null@*/ yasm_intern_table *strings);
 
 /** Destroy a symbol table and all internal symbols.
  * \param symtab    symbol table
@@ -110,6 +114,17 @@ YASM_LIB_DECL
 /*@null@*/ /*@dependent@*/ yasm_symrec *yasm_symtab_get
     (yasm_symtab *symtab, const char *name);
 
+/** Remove a symbol from a symbol table, destroying it and any data
+ * associated with it.  The symbol must not be referenced elsewhere (e.g.
+ * from expressions), so this is mainly useful for tables used as simple
+ * name/value maps, such as preprocessor defines.
+ * \param symtab    symbol table
+ * \param name      symbol name
+ * \return Nonzero if the symbol was found and removed.
+ */
+YASM_LIB_DECL
+int yasm_symtab_remove(yasm_symtab *symtab, const char *name);
+
 /** Define a symbol as an EQU value.
  * \param symtab    symbol table
  * \param name      symbol (EQU) name
@@ -406,7 +421,18 @@ YASM_LIB_DECL
 /*@dependent@*/ /*@null@*/ yasm_expr **yasm_symrec_get_common_size
     (yasm_symrec *sym);
 
-/** Get associated data for a symbol and data callback.
+/** Get the ID of a symbol.  IDs are small integers, unique within a symbol
+ * table, assigned in order as symbols are created starting from 0.  They
+ * can be used to index arrays of per-symbol data.
+ * \param sym       symbol
+ * \return Symbol ID.
+ */
+YASM_LIB_DECL
+unsigned long yasm_symrec_get_id(const yasm_symrec *sym);
+
+/** Get associated data for a symbol and data callback.  Associated data is
+ * kept in arrays indexed by symbol ID, one per data callback, so this is
+ * fast enough to call for every relocation or symbol during output.
  * \param sym       symbol
  * \param callback  callback used when adding data
  * \return Associated data (NULL if none).
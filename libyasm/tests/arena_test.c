@@ -0,0 +1,140 @@
+/*
+ *
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libyasm.h"
+#include "libyasm/arena.h"
+
+static char failed[1000];
+static char failmsg[100];
+
+/* Freed memory is reused for allocations of the same size. */
+static int
+test_reuse(void)
+{
+    yasm_arena *arena = yasm_arena_create();
+    void *a = yasm__arena_xmalloc(YASM_MEM_OTHER, 24);
+    void *b;
+    int fail = 0;
+
+    yasm__arena_xfree(a);
+    b = yasm__arena_xmalloc(YASM_MEM_OTHER, 24);
+    if (a != b) {
+        sprintf(failmsg, "freed memory not reused");
+        fail = 1;
+    }
+    yasm__arena_xfree(b);
+    yasm_arena_destroy(arena);
+    return fail;
+}
+
+/* Arenas can be destroyed in any order; the newest remaining arena is
+ * current, and memory from destroyed arenas stays valid until freed.
+ */
+static int
+test_order(void)
+{
+    yasm_arena *a = yasm_arena_create();
+    char *pa = yasm__arena_xmalloc(YASM_MEM_OTHER, 32);
+    yasm_arena *b = yasm_arena_create();
+    char *pb = yasm__arena_xmalloc(YASM_MEM_OTHER, 32);
+    char *pc, *pd;
+    int fail = 0;
+
+    memset(pa, 'a', 32);
+    memset(pb, 'b', 32);
+
+    yasm_arena_destroy(a);
+    pc = yasm__arena_xmalloc(YASM_MEM_OTHER, 32);   /* from b */
+    memset(pc, 'c', 32);
+    yasm_arena_destroy(b);
+    pd = yasm__arena_xmalloc(YASM_MEM_OTHER, 32);   /* from the heap */
+    memset(pd, 'd', 32);
+
+    if (pa[0] != 'a' || pa[31] != 'a' || pb[0] != 'b' || pb[31] != 'b' ||
+        pc[0] != 'c' || pc[31] != 'c') {
+        sprintf(failmsg, "memory changed after its arena was destroyed");
+        fail = 1;
+    }
+    yasm__arena_xfree(pa);
+    yasm__arena_xfree(pc);
+    yasm__arena_xfree(pb);
+    yasm__arena_xfree(pd);
+    return fail;
+}
+
+/* Large and resized allocations keep their contents. */
+static int
+test_realloc(void)
+{
+    yasm_arena *arena = yasm_arena_create();
+    char *p = yasm__arena_xmalloc(YASM_MEM_OTHER, 8);
+    int i, fail = 0;
+
+    strcpy(p, "1234567");
+    p = yasm__arena_xrealloc(YASM_MEM_OTHER, p, 100);
+    p = yasm__arena_xrealloc(YASM_MEM_OTHER, p, 10000);
+    for (i=8; i<10000; i++)
+        p[i] = 'x';
+    if (strncmp(p, "1234567", 8) != 0 || p[9999] != 'x') {
+        sprintf(failmsg, "contents lost in reallocation");
+        fail = 1;
+    }
+    yasm__arena_xfree(p);
+    yasm_arena_destroy(arena);
+    return fail;
+}
+
+static int (*tests[])(void) = {
+    test_reuse,
+    test_order,
+    test_realloc,
+};
+
+int
+main(void)
+{
+    int nf = 0;
+    int numtests = sizeof(tests)/sizeof(tests[0]);
+    int i;
+
+    failed[0] = '\0';
+    printf("Test arena_test: ");
+    for (i=0; i<numtests; i++) {
+        int fail = tests[i]();
+        printf("%c", fail>0 ? 'F':'.');
+        fflush(stdout);
+        if (fail)
+            sprintf(failed, "%s ** F: %s\n", failed, failmsg);
+        nf += fail;
+    }
+
+    printf(" +%d-%d/%d %d%%\n%s",
+           numtests-nf, nf, numtests, 100*(numtests-nf)/numtests, failed);
+    return (nf == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
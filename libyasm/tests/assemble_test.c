@@ -0,0 +1,166 @@
+/*
+ *
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "libyasm.h"
+#include "libyasm/bitvect.h"
+
+#if defined(CMAKE_BUILD) && defined(BUILD_SHARED_LIBS)
+#include "frontends/yasm/yasm-plugin.h"
+#endif
+
+#if defined(CMAKE_BUILD) && !defined(BUILD_SHARED_LIBS)
+void yasm_init_plugin(void);
+#endif
+
+typedef struct Test_Entry {
+    /* source text */
+    const char *source;
+
+    /* object format (NULL for default) */
+    const char *objfmt;
+
+    /* expected start of output (NULL if assembly should fail) */
+    const char *out;
+    size_t out_len;
+} Test_Entry;
+
+static Test_Entry tests[] = {
+    {"mov eax, 1\n", NULL, "\x66\xB8\x01\x00\x00\x00", 6},
+    {"bits 32\nmov eax, 1\n", NULL, "\xB8\x01\x00\x00\x00", 5},
+    {"bits 64\nfoo: jmp foo\n", "bin", "\xEB\xFE", 2},
+    {"mov eax, 1\nret\n", "elf64", "\x7F" "ELF\x02", 5},
+    {"%include \"nosuchfile.inc\"\n", NULL, NULL, 0},
+    {"%define X 4\ndb X, X*2\n", NULL, "\x04\x08", 2},
+    {"mov eax, [\n", NULL, NULL, 0},
+    {"db 1\n", "nosuchfmt", NULL, 0},
+};
+
+static char failed[1000];
+static char failmsg[100];
+
+static int
+run_test(Test_Entry *test)
+{
+    yasm_assemble_options options;
+    unsigned char *out;
+    size_t out_len;
+    char *messages;
+    int errors;
+
+    memset(&options, 0, sizeof(options));
+    options.objfmt = test->objfmt;
+
+    errors = yasm_assemble_memory(test->source, strlen(test->source),
+                                  &options, &out, &out_len, &messages);
+
+    if (!test->out) {
+        if (!errors) {
+            sprintf(failmsg, "expected failure, got %lu bytes",
+                    (unsigned long)out_len);
+            yasm_xfree(out);
+            yasm_xfree(messages);
+            return 1;
+        }
+        if (!messages) {
+            sprintf(failmsg, "failed without messages");
+            return 1;
+        }
+        yasm_xfree(messages);
+        return 0;
+    }
+
+    if (errors) {
+        sprintf(failmsg, "unexpected failure: %.70s",
+                messages ? messages : "");
+        yasm_xfree(messages);
+        return 1;
+    }
+    yasm_xfree(messages);
+
+    if (out_len < test->out_len ||
+        memcmp(out, test->out, test->out_len) != 0) {
+        sprintf(failmsg, "unexpected output (%lu bytes)",
+                (unsigned long)out_len);
+        yasm_xfree(out);
+        return 1;
+    }
+
+    yasm_xfree(out);
+    return 0;
+}
+
+int
+main(void)
+{
+    int nf = 0;
+    int numtests = sizeof(tests)/sizeof(Test_Entry);
+    int i;
+
+    if (BitVector_Boot() != ErrCode_Ok)
+        return EXIT_FAILURE;
+    yasm_intnum_initialize();
+    yasm_floatnum_initialize();
+    yasm_errwarn_initialize();
+
+#ifdef CMAKE_BUILD
+    /* Load standard modules */
+#ifdef BUILD_SHARED_LIBS
+    if (!load_plugin("yasmstd")) {
+        printf("Test assemble_test: could not load standard modules\n");
+        return EXIT_FAILURE;
+    }
+#else
+    yasm_init_plugin();
+#endif
+#endif
+
+    failed[0] = '\0';
+    printf("Test assemble_test: ");
+    for (i=0; i<numtests; i++) {
+        int fail = run_test(&tests[i]);
+        printf("%c", fail>0 ? 'F':'.');
+        fflush(stdout);
+        if (fail)
+            sprintf(failed, "%s ** F: %s\n", failed, failmsg);
+        nf += fail;
+    }
+
+    yasm_floatnum_cleanup();
+    yasm_intnum_cleanup();
+    yasm_errwarn_cleanup();
+    BitVector_Shutdown();
+#if defined(CMAKE_BUILD) && defined(BUILD_SHARED_LIBS)
+    unload_plugins();
+#endif
+
+    printf(" +%d-%d/%d %d%%\n%s",
+           numtests-nf, nf, numtests, 100*(numtests-nf)/numtests, failed);
+    return (nf == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -59,13 +59,13 @@ typedef struct Init_Entry_s {
 /* Values used for normalized tests */
 static Init_Entry normalized_vals[] = {
     {   "3.141592653589793",
-        {0xc6,0x0d,0xe9,0xbd,0x68,0x21,0xa2,0xda,0x0f,0xc9},0x8000,0,0,
+        {0xc6,0x0d,0xe9,0xbd,0x68,0x21,0xa2,0xda,0x0f,0xc9},0x8000,0,FLAG_INEXACT,
          0, {0xdb,0x0f,0x49,0x40},
          0, {0x18,0x2d,0x44,0x54,0xfb,0x21,0x09,0x40},
          0, {0xe9,0xbd,0x68,0x21,0xa2,0xda,0x0f,0xc9,0x00,0x40}
     },
     {   "-3.141592653589793",
-        {0xc6,0x0d,0xe9,0xbd,0x68,0x21,0xa2,0xda,0x0f,0xc9},0x8000,1,0,
+        {0xc6,0x0d,0xe9,0xbd,0x68,0x21,0xa2,0xda,0x0f,0xc9},0x8000,1,FLAG_INEXACT,
          0, {0xdb,0x0f,0x49,0xc0},
          0, {0x18,0x2d,0x44,0x54,0xfb,0x21,0x09,0xc0},
          0, {0xe9,0xbd,0x68,0x21,0xa2,0xda,0x0f,0xc9,0x00,0xc0}
@@ -77,7 +77,7 @@ static Init_Entry normalized_vals[] = {
          0, {0x00,0x00,0x00,0x04,0xbf,0xc9,0x1b,0x8e,0x34,0x40}
     },
     {   "1.6e-20",
-        {0xf6,0xd3,0xee,0x7b,0xda,0x74,0x50,0xa0,0x1d,0x97},0x7fbd,0,0,
+        {0xf6,0xd3,0xee,0x7b,0xda,0x74,0x50,0xa0,0x1d,0x97},0x7fbd,0,FLAG_INEXACT,
          0, {0xa0,0x1d,0x97,0x1e},
          0, {0x4f,0x9b,0x0e,0x0a,0xb4,0xe3,0xd2,0x3b},
          0, {0xef,0x7b,0xda,0x74,0x50,0xa0,0x1d,0x97,0xbd,0x3f}
@@ -88,15 +88,23 @@ static Init_Entry normalized_vals[] = {
          0, {0x00,0x00,0x00,0x00,0x00,0xf4,0xb6,0xc0},
          0, {0x00,0x00,0x00,0x00,0x00,0x00,0xa0,0xb7,0x0b,0xc0}
     },
-    /* Edge cases for rounding wrap. */
+    /* Trailing zeros don't change the value. */
     {   "1.00000",
-        {0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff},0x7ffe,0,0,
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x80},0x7fff,0,0,
          0, {0x00,0x00,0x80,0x3f},
          0, {0x00,0x00,0x00,0x00,0x00,0x00,0xf0,0x3f},
          0, {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x80,0xff,0x3f}
     },
     {   "1.000000",
-        {0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff},0x7ffe,0,0,
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x80},0x7fff,0,0,
+         0, {0x00,0x00,0x80,0x3f},
+         0, {0x00,0x00,0x00,0x00,0x00,0x00,0xf0,0x3f},
+         0, {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x80,0xff,0x3f}
+    },
+    /* Edge case for rounding wrap. */
+    {   "99999999999999999999999e-23",
+        {0xf2,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff},0x7ffe,0,
+         FLAG_INEXACT,
          0, {0x00,0x00,0x80,0x3f},
          0, {0x00,0x00,0x00,0x00,0x00,0x00,0xf0,0x3f},
          0, {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x80,0xff,0x3f}
@@ -109,26 +117,26 @@ static Init_Entry normalized_vals[] = {
 static Init_Entry normalized_edgecase_vals[] = {
     /* 32-bit edges */
     {   "1.1754943508222875e-38",
-        {0xd5,0xf2,0x82,0xff,0xff,0xff,0xff,0xff,0xff,0xff},0x7f80,0,0,
+        {0xd5,0xf2,0x82,0xff,0xff,0xff,0xff,0xff,0xff,0xff},0x7f80,0,FLAG_INEXACT,
          0, {0x00,0x00,0x80,0x00},
          0, {0x00,0x00,0x00,0x00,0x00,0x00,0x10,0x38},
          0, {0x83,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0x80,0x3f}
     },
     {   "3.4028234663852886e+38",
-        {0x21,0x35,0x0a,0x00,0x00,0x00,0x00,0xff,0xff,0xff},0x807e,0,0,
+        {0x21,0x35,0x0a,0x00,0x00,0x00,0x00,0xff,0xff,0xff},0x807e,0,FLAG_INEXACT,
          0, {0xff,0xff,0x7f,0x7f},
          0, {0x00,0x00,0x00,0xe0,0xff,0xff,0xef,0x47},
          0, {0x0a,0x00,0x00,0x00,0x00,0xff,0xff,0xff,0x7e,0x40}
     },
     /* 64-bit edges */
     {   "2.2250738585072014E-308",
-        {0x26,0x18,0x46,0x00,0x00,0x00,0x00,0x00,0x00,0x80},0x7c01,0,0,
+        {0x26,0x18,0x46,0x00,0x00,0x00,0x00,0x00,0x00,0x80},0x7c01,0,FLAG_INEXACT,
         -1, {0x00,0x00,0x00,0x00},
          0, {0x00,0x00,0x00,0x00,0x00,0x00,0x10,0x00},
          0, {0x46,0x00,0x00,0x00,0x00,0x00,0x00,0x80,0x01,0x3c}
     },
     {   "1.7976931348623157E+308",
-        {0x26,0x6b,0xac,0xf7,0xff,0xff,0xff,0xff,0xff,0xff},0x83fe,0,0,
+        {0x26,0x6b,0xac,0xf7,0xff,0xff,0xff,0xff,0xff,0xff},0x83fe,0,FLAG_INEXACT,
          1, {0x00,0x00,0x80,0x7f},
          0, {0xff,0xff,0xff,0xff,0xff,0xff,0xef,0x7f},
          0, {0xac,0xf7,0xff,0xff,0xff,0xff,0xff,0xff,0xfe,0x43}
@@ -153,6 +161,89 @@ static Init_Entry normalized_edgecase_vals[] = {
     },*/
 };
 
+/* Values converted directly from ASCII, including ones that must be rounded
+ * to even and ones that need the internal format.
+ */
+typedef struct Convert_Entry_s {
+    const char *ascii;
+    int ret32;
+    unsigned char result32[4];
+    int ret64;
+    unsigned char result64[8];
+} Convert_Entry;
+
+static Convert_Entry convert_vals[] = {
+    {   "0.1",
+         0, {0xcd,0xcc,0xcc,0x3d},
+         0, {0x9a,0x99,0x99,0x99,0x99,0x99,0xb9,0x3f}
+    },
+    {   "52e9",
+         0, {0x10,0xb7,0x41,0x51},
+         0, {0x00,0x00,0x00,0x10,0xe2,0x36,0x28,0x42}
+    },
+    {   "16777217",
+         0, {0x00,0x00,0x80,0x4b},
+         0, {0x00,0x00,0x00,0x10,0x00,0x00,0x70,0x41}
+    },
+    {   "9007199254740993",
+         0, {0x00,0x00,0x00,0x5a},
+         0, {0x00,0x00,0x00,0x00,0x00,0x00,0x40,0x43}
+    },
+    {   "16777217.",
+         0, {0x00,0x00,0x80,0x4b},
+         0, {0x00,0x00,0x00,0x10,0x00,0x00,0x70,0x41}
+    },
+    {   "16777217.0",
+         0, {0x00,0x00,0x80,0x4b},
+         0, {0x00,0x00,0x00,0x10,0x00,0x00,0x70,0x41}
+    },
+    {   "167772170.0e-1",
+         0, {0x00,0x00,0x80,0x4b},
+         0, {0x00,0x00,0x00,0x10,0x00,0x00,0x70,0x41}
+    },
+    {   "9007199254740993.0",
+         0, {0x00,0x00,0x00,0x5a},
+         0, {0x00,0x00,0x00,0x00,0x00,0x00,0x40,0x43}
+    },
+    {   "90071992547409930e-1",
+         0, {0x00,0x00,0x00,0x5a},
+         0, {0x00,0x00,0x00,0x00,0x00,0x00,0x40,0x43}
+    },
+    /* Half-way binary fractions */
+    {   "8388608.5",
+         0, {0x00,0x00,0x00,0x4b},
+         0, {0x00,0x00,0x00,0x10,0x00,0x00,0x60,0x41}
+    },
+    {   "8388609.5",
+         0, {0x02,0x00,0x00,0x4b},
+         0, {0x00,0x00,0x00,0x30,0x00,0x00,0x60,0x41}
+    },
+    {   "-0.0",
+         0, {0x00,0x00,0x00,0x80},
+         0, {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x80}
+    },
+    {   "1e-320",
+        -1, {0x00,0x00,0x00,0x00},
+        -1, {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}
+    },
+    {   "1e309",
+         1, {0x00,0x00,0x80,0x7f},
+         1, {0x00,0x00,0x00,0x00,0x00,0x00,0xf0,0x7f}
+    },
+    {   "1.00000000000000000000000001",
+         0, {0x00,0x00,0x80,0x3f},
+         0, {0x00,0x00,0x00,0x00,0x00,0x00,0xf0,0x3f}
+    },
+    {   "2.2250738585072014E-308",
+        -1, {0x00,0x00,0x00,0x00},
+         0, {0x00,0x00,0x00,0x00,0x00,0x00,0x10,0x00}
+    },
+    {   "1.7976931348623157E+308",
+         1, {0x00,0x00,0x80,0x7f},
+         0, {0xff,0xff,0xff,0xff,0xff,0xff,0xef,0x7f}
+    },
+};
+
 static yasm_floatnum *flt;
 
 /* failure messages */
@@ -169,29 +260,35 @@ new_setup(Init_Entry *vals, int i)
 static int
 new_check_flt(Init_Entry *val)
 {
+    yasm_floatnum tmp;
+    const yasm_floatnum *bin;
     unsigned char *mantissa;
     int i, result = 0;
     unsigned int len;
 
-    mantissa = BitVector_Block_Read(flt->mantissa, &len);
+    /* check the internal format, even if the value is kept in decimal */
+    bin = floatnum_binary(flt, &tmp);
+    mantissa = BitVector_Block_Read(bin->mantissa, &len);
     for (i=1;i<MANT_BYTES;i++)      /* don't compare first byte */
         if (mantissa[i] != val->mantissa[i])
             result = 1;
     yasm_xfree(mantissa);
+    if (bin == &tmp)
+        BitVector_Destroy(tmp.mantissa);
     if (result) {
         strcat(result_msg, "mantissa");
         return 1;
     }
 
-    if (flt->exponent != val->exponent) {
+    if (bin->exponent != val->exponent) {
         strcat(result_msg, "exponent");
         return 1;
     }
-    if (flt->sign != val->sign) {
+    if (bin->sign != val->sign) {
         strcat(result_msg, "sign");
         return 1;
     }
-    if (flt->flags != val->flags) {
+    if (bin->flags != val->flags) {
         strcat(result_msg, "flags");
         return 1;
     }
@@ -288,6 +385,33 @@ get_common_check_result(int len, const unsigned char *val,
     return result;
 }
 
+/*
+ * convert tests
+ */
+
+static int
+test_convert(void)
+{
+    unsigned char outval[8];
+    Convert_Entry *vals = convert_vals;
+    int i, num = sizeof(convert_vals)/sizeof(Convert_Entry);
+
+    for (i=0; i<num; i++) {
+        flt = yasm_floatnum_create(vals[i].ascii);
+        strcpy(result_msg, vals[i].ascii);
+        strcat(result_msg, ": incorrect result generated");
+        if (yasm_floatnum_get_sized(flt, outval, 4, 32, 0, 0, 0) !=
+            vals[i].ret32 ||
+            get_common_check_result(4, outval, vals[i].result32) != 0 ||
+            yasm_floatnum_get_sized(flt, outval, 8, 64, 0, 0, 0) !=
+            vals[i].ret64 ||
+            get_common_check_result(8, outval, vals[i].result64) != 0)
+            return 1;
+        yasm_floatnum_destroy(flt);
+    }
+    return 0;
+}
+
 /*
  * get_single tests
  */
@@ -447,7 +571,8 @@ main(void)
     nf += runtest(get_double_normalized_edgecase, get_family_setup, get_family_teardown);
     nf += runtest(get_extended_normalized, get_family_setup, get_family_teardown);
     nf += runtest(get_extended_normalized_edgecase, get_family_setup, get_family_teardown);
-    printf(" +%d-%d/8 %d%%\n%s",
-           8-nf, nf, 100*(8-nf)/8, failed);
+    nf += runtest(convert, NULL, NULL);
+    printf(" +%d-%d/9 %d%%\n%s",
+           9-nf, nf, 100*(9-nf)/9, failed);
     return (nf == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,193 @@
+/*
+ *
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libyasm.h"
+
+static char failed[1000];
+static char failmsg[100];
+
+static yasm_intern_table *table;
+
+/* Equal strings intern to the same pointer; the copy is 0-terminated. */
+static int
+test_equal(void)
+{
+    char buf[16];
+    const char *a, *b;
+
+    strcpy(buf, "label");
+    a = yasm_intern(table, buf);
+    strcpy(buf, "other");
+    b = yasm_intern(table, "label");
+    if (a != b || strcmp(a, "label") != 0) {
+        sprintf(failmsg, "equal strings interned differently");
+        return 1;
+    }
+    if (yasm_intern_len(table, "labelx", 5) != a) {
+        sprintf(failmsg, "length-limited string interned differently");
+        return 1;
+    }
+    return 0;
+}
+
+/* Prefixes and extensions of a string are distinct strings. */
+static int
+test_distinct(void)
+{
+    const char *a = yasm_intern(table, "abc");
+    const char *b = yasm_intern(table, "ab");
+    const char *c = yasm_intern(table, "abcd");
+    const char *d = yasm_intern(table, "");
+
+    if (a == b || a == c || b == c || a == d || strcmp(b, "ab") != 0 ||
+        d[0] != '\0') {
+        sprintf(failmsg, "distinct strings interned together");
+        return 1;
+    }
+    return 0;
+}
+
+/* Strings survive the table growing, and long strings are kept whole. */
+static int
+test_many(void)
+{
+    static const char *saved[5000];
+    char buf[8192];
+    const char *longstr;
+    int i;
+
+    for (i=0; i<5000; i++) {
+        sprintf(buf, "sym%d", i);
+        saved[i] = yasm_intern(table, buf);
+    }
+    memset(buf, 'x', sizeof(buf)-1);
+    buf[sizeof(buf)-1] = '\0';
+    longstr = yasm_intern(table, buf);
+    for (i=0; i<5000; i++) {
+        sprintf(buf, "sym%d", i);
+        if (yasm_intern(table, buf) != saved[i] ||
+            strcmp(saved[i], buf) != 0) {
+            sprintf(failmsg, "string %d changed after table growth", i);
+            return 1;
+        }
+    }
+    memset(buf, 'x', sizeof(buf)-1);
+    if (yasm_intern(table, buf) != longstr ||
+        strlen(longstr) != sizeof(buf)-1) {
+        sprintf(failmsg, "long string not kept whole");
+        return 1;
+    }
+    return 0;
+}
+
+/* Each table holds its own copies, which outlive other tables, whatever
+ * order they're created and destroyed in.
+ */
+static int
+test_tables(void)
+{
+    const char *a = yasm_intern(table, "shared");
+    yasm_intern_table *t1, *t2;
+    const char *b, *c;
+
+    t1 = yasm_intern_table_create();
+    t2 = yasm_intern_table_create();
+    b = yasm_intern(t1, "shared");
+    c = yasm_intern(t2, "shared");
+    if (a == b || b == c || a == c || strcmp(b, "shared") != 0) {
+        sprintf(failmsg, "tables share strings");
+        yasm_intern_table_destroy(t2);
+        yasm_intern_table_destroy(t1);
+        return 1;
+    }
+    yasm_intern_table_destroy(t2);
+    if (yasm_intern(t1, "shared") != b || strcmp(b, "shared") != 0) {
+        sprintf(failmsg, "string lost when a later table was destroyed");
+        yasm_intern_table_destroy(t1);
+        return 1;
+    }
+    yasm_intern_table_destroy(t1);
+    if (yasm_intern(table, "shared") != a) {
+        sprintf(failmsg, "string lost when another table was destroyed");
+        return 1;
+    }
+    return 0;
+}
+
+/* Lookups don't intern. */
+static int
+test_find(void)
+{
+    const char *a = yasm_intern(table, "found");
+
+    if (yasm_intern_find(table, "found") != a) {
+        sprintf(failmsg, "interned string not found");
+        return 1;
+    }
+    if (yasm_intern_find(table, "not found") != NULL ||
+        yasm_intern_find(table, "not found") != NULL) {
+        sprintf(failmsg, "lookup interned string");
+        return 1;
+    }
+    return 0;
+}
+
+static int (*tests[])(void) = {
+    test_equal,
+    test_distinct,
+    test_many,
+    test_tables,
+    test_find,
+};
+
+int
+main(void)
+{
+    int nf = 0;
+    int numtests = sizeof(tests)/sizeof(tests[0]);
+    int i;
+
+    table = yasm_intern_table_create();
+    failed[0] = '\0';
+    printf("Test intern_test: ");
+    for (i=0; i<numtests; i++) {
+        int fail = tests[i]();
+        printf("%c", fail>0 ? 'F':'.');
+        fflush(stdout);
+        if (fail)
+            sprintf(failed, "%s ** F: %s\n", failed, failmsg);
+        nf += fail;
+    }
+
+    printf(" +%d-%d/%d %d%%\n%s",
+           numtests-nf, nf, numtests, 100*(numtests-nf)/numtests, failed);
+
+    yasm_intern_table_destroy(table);
+    return (nf == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,315 @@
+/*
+ *
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libyasm/intnum.c"
+
+typedef struct Calc_Test {
+    /* operands and correct result (as hex strings, negative values with a
+     * leading '-'); operand is NULL for unary operations
+     */
+    const char *acc;
+    yasm_expr_op op;
+    /*@null@*/ const char *operand;
+    const char *result;
+
+    /* whether the result should be stored inline (fits in 64 bits) */
+    int inl;
+} Calc_Test;
+
+typedef struct Literal_Test {
+    /* radix and literal string */
+    int radix;
+    const char *input;
+
+    /* correct value (as hex string) */
+    const char *result;
+
+    /* whether the value should be stored inline (fits in 64 bits) */
+    int inl;
+} Literal_Test;
+
+typedef struct Sized_Test {
+    const char *input;
+    size_t destsize;
+    size_t valsize;
+    int shift;
+
+    /* correct output from get_sized (over destsize bytes of 0x11) */
+    const unsigned char *result;
+} Sized_Test;
+
+typedef struct Check_Test {
+    const char *input;
+    size_t size;
+    size_t rshift;
+    int rangetype;
+
+    /* correct return value from check_size */
+    int result;
+} Check_Test;
+
+static Calc_Test calc_tests[] = {
+    {"7FFFFFFFFFFFFFFF", YASM_EXPR_ADD, "1", "8000000000000000", 0},
+    {"-8000000000000000", YASM_EXPR_SUB, "1", "-8000000000000001", 0},
+    {"-7FFFFFFFFFFFFFFF", YASM_EXPR_SUB, "1", "-8000000000000000", 1},
+    {"7FFFFFFFFFFFFFFF", YASM_EXPR_SUB, "-1", "8000000000000000", 0},
+    {"8000000000000000", YASM_EXPR_SUB, "1", "7FFFFFFFFFFFFFFF", 1},
+    {"100000000", YASM_EXPR_MUL, "100000000", "10000000000000000", 0},
+    {"80000000", YASM_EXPR_MUL, "-100000000", "-8000000000000000", 1},
+    {"80000000", YASM_EXPR_MUL, "100000000", "8000000000000000", 0},
+    {"-100000000", YASM_EXPR_MUL, "-FFFFFFFF", "FFFFFFFF00000000", 0},
+    {"123456789", YASM_EXPR_MUL, "-1000", "-123456789000", 1},
+    {"-8000000000000000", YASM_EXPR_SIGNDIV, "-1", "8000000000000000", 0},
+    {"-7", YASM_EXPR_SIGNDIV, "2", "-3", 1},
+    {"7", YASM_EXPR_SIGNDIV, "-2", "-3", 1},
+    {"-7", YASM_EXPR_SIGNMOD, "2", "-1", 1},
+    {"7", YASM_EXPR_SIGNMOD, "-2", "1", 1},
+    {"10000000000000000", YASM_EXPR_SIGNDIV, "10", "1000000000000000", 1},
+    {"-8000000000000000", YASM_EXPR_SIGNMOD, "-1", "0", 1},
+    {"-8000000000000000", YASM_EXPR_NEG, NULL, "8000000000000000", 0},
+    {"8000000000000000", YASM_EXPR_NEG, NULL, "-8000000000000000", 1},
+    {"7FFFFFFF", YASM_EXPR_NOT, NULL, "-80000000", 1},
+    {"1", YASM_EXPR_SHL, "3E", "4000000000000000", 1},
+    {"1", YASM_EXPR_SHL, "3F", "8000000000000000", 0},
+    {"-1", YASM_EXPR_SHL, "3F", "-8000000000000000", 1},
+    {"3", YASM_EXPR_SHL, "3E", "C000000000000000", 0},
+    {"123", YASM_EXPR_SHL, "C8", "12300000000000000000000000000000000000000000000000000", 0},
+    {"-A", YASM_EXPR_SHR, "2", "-3", 1},
+    {"-1", YASM_EXPR_SHR, "64", "-1", 1},
+    {"8000000000000000", YASM_EXPR_SHR, "4", "800000000000000", 1},
+    {"-1", YASM_EXPR_LT, "1", "1", 1},
+    {"8000000000000000", YASM_EXPR_GT, "7FFFFFFFFFFFFFFF", "1", 1},
+    {"-8000000000000000", YASM_EXPR_LT, "-7FFFFFFFFFFFFFFF", "1", 1},
+    {"-1", YASM_EXPR_AND, "8000000000000000", "8000000000000000", 0},
+    {"-1", YASM_EXPR_XOR, "FFFFFFFFFFFFFFFF", "-10000000000000000", 0},
+};
+
+static Literal_Test literal_tests[] = {
+    {10, "0", "0", 1},
+    {10, "00012", "C", 1},
+    {10, "9223372036854775807", "7FFFFFFFFFFFFFFF", 1},
+    {10, "9223372036854775808", "8000000000000000", 0},
+    {10, "18446744073709551616", "10000000000000000", 0},
+    {16, "7fff_ffff_FFFF_ffff", "7FFFFFFFFFFFFFFF", 1},
+    {16, "8000000000000000", "8000000000000000", 0},
+    {16, "1_0000_0000_0000_0000", "10000000000000000", 0},
+    {16, "", "0", 1},
+    {8, "777", "1FF", 1},
+    {8, "777777777777777777777", "7FFFFFFFFFFFFFFF", 1},
+    {8, "1000000000000000000000", "8000000000000000", 0},
+    {2, "1_0000_0001", "101", 1},
+};
+
+static Sized_Test sized_tests[] = {
+    {"-2", 8, 64, 0, (const unsigned char *)"\xFE\xFF\xFF\xFF\xFF\xFF\xFF\xFF"},
+    {"123456789ABCDEF", 8, 64, 0,
+     (const unsigned char *)"\xEF\xCD\xAB\x89\x67\x45\x23\x01"},
+    {"ABCD", 4, 8, 8, (const unsigned char *)"\x11\xCD\x11\x11"},
+    {"-100", 2, 16, -4, (const unsigned char *)"\xF0\xFF"},
+    {"10000000000000001", 8, 64, 0,
+     (const unsigned char *)"\x01\x00\x00\x00\x00\x00\x00\x00"},
+};
+
+static Check_Test check_tests[] = {
+    {"-8000000000000000", 64, 0, 1, 1},
+    {"-8000000000000000", 63, 0, 1, 0},
+    {"7FFFFFFFFFFFFFFF", 63, 0, 0, 1},
+    {"7FFFFFFFFFFFFFFF", 63, 0, 1, 0},
+    {"-1", 8, 0, 0, 0},
+    {"-1", 8, 0, 2, 1},
+    {"FFFFFFFFFFFFFFFF", 64, 0, 0, 1},
+    {"FFFFFFFFFFFFFFFF", 64, 0, 1, 0},
+    {"100", 8, 0, 2, 0},
+    {"100", 9, 0, 2, 1},
+    {"-100", 8, 4, 1, 1},
+};
+
+static char failed[1000];
+static char failmsg[100];
+
+static yasm_intnum *
+make_intnum(const char *str)
+{
+    char *valstr = yasm__xstrdup(str[0] == '-' ? str+1 : str);
+    yasm_intnum *intn = yasm_intnum_create_hex(valstr);
+
+    yasm_xfree(valstr);
+    if (str[0] == '-')
+        yasm_intnum_calc(intn, YASM_EXPR_NEG, NULL);
+    return intn;
+}
+
+static int
+run_calc_test(Calc_Test *test)
+{
+    yasm_intnum *acc = make_intnum(test->acc);
+    yasm_intnum *operand = test->operand ? make_intnum(test->operand) : NULL;
+    yasm_intnum *result = make_intnum(test->result);
+    int fail = 0;
+
+    yasm_intnum_calc(acc, test->op, operand);
+    if (yasm_intnum_compare(acc, result) != 0) {
+        sprintf(failmsg, "%s op %d %s: bad result", test->acc, (int)test->op,
+                test->operand ? test->operand : "");
+        fail = 1;
+    } else if ((acc->type == INTNUM_L) != test->inl) {
+        sprintf(failmsg, "%s op %d %s: result %sstored inline", test->acc,
+                (int)test->op, test->operand ? test->operand : "",
+                test->inl ? "not " : "");
+        fail = 1;
+    }
+
+    yasm_intnum_destroy(result);
+    yasm_intnum_destroy(operand);
+    yasm_intnum_destroy(acc);
+    return fail;
+}
+
+static int
+run_literal_test(Literal_Test *test)
+{
+    char *valstr = yasm__xstrdup(test->input);
+    yasm_intnum *intn = NULL;
+    yasm_intnum *result = make_intnum(test->result);
+    int fail = 0;
+
+    switch (test->radix) {
+        case 2:
+            intn = yasm_intnum_create_bin(valstr);
+            break;
+        case 8:
+            intn = yasm_intnum_create_oct(valstr);
+            break;
+        case 10:
+            intn = yasm_intnum_create_dec(valstr);
+            break;
+        case 16:
+            intn = yasm_intnum_create_hex(valstr);
+            break;
+    }
+    yasm_xfree(valstr);
+
+    if (yasm_intnum_compare(intn, result) != 0) {
+        sprintf(failmsg, "radix %d `%s': bad value", test->radix,
+                test->input);
+        fail = 1;
+    } else if ((intn->type == INTNUM_L) != test->inl) {
+        sprintf(failmsg, "radix %d `%s': value %sstored inline", test->radix,
+                test->input, test->inl ? "not " : "");
+        fail = 1;
+    }
+
+    yasm_intnum_destroy(result);
+    yasm_intnum_destroy(intn);
+    return fail;
+}
+
+static int
+run_sized_test(Sized_Test *test)
+{
+    yasm_intnum *intn = make_intnum(test->input);
+    unsigned char out[8];
+    size_t i;
+
+    for (i=0; i<sizeof(out); i++)
+        out[i] = 0x11;
+    yasm_intnum_get_sized(intn, out, test->destsize, test->valsize,
+                          test->shift, 0, 0);
+    yasm_intnum_destroy(intn);
+
+    if (memcmp(out, test->result, test->destsize) != 0) {
+        sprintf(failmsg, "%s get_sized(%lu, %lu, %d): bad output",
+                test->input, (unsigned long)test->destsize,
+                (unsigned long)test->valsize, test->shift);
+        return 1;
+    }
+    return 0;
+}
+
+static int
+run_check_test(Check_Test *test)
+{
+    yasm_intnum *intn = make_intnum(test->input);
+    int result = yasm_intnum_check_size(intn, test->size, test->rshift,
+                                        test->rangetype);
+
+    yasm_intnum_destroy(intn);
+
+    if (result != test->result) {
+        sprintf(failmsg, "%s check_size(%lu, %lu, %d): expected %d, got %d",
+                test->input, (unsigned long)test->size,
+                (unsigned long)test->rshift, test->rangetype, test->result,
+                result);
+        return 1;
+    }
+    return 0;
+}
+
+static void
+report(int fail, int *nf)
+{
+    printf("%c", fail>0 ? 'F':'.');
+    fflush(stdout);
+    if (fail)
+        sprintf(failed, "%s ** F: %s\n", failed, failmsg);
+    *nf += fail;
+}
+
+int
+main(void)
+{
+    int nf = 0;
+    int numcalc = sizeof(calc_tests)/sizeof(Calc_Test);
+    int numliteral = sizeof(literal_tests)/sizeof(Literal_Test);
+    int numsized = sizeof(sized_tests)/sizeof(Sized_Test);
+    int numcheck = sizeof(check_tests)/sizeof(Check_Test);
+    int numtests = numcalc+numliteral+numsized+numcheck;
+    int i;
+
+    if (BitVector_Boot() != ErrCode_Ok)
+        return EXIT_FAILURE;
+    yasm_intnum_initialize();
+
+    failed[0] = '\0';
+    printf("Test intnum_test: ");
+    for (i=0; i<numcalc; i++)
+        report(run_calc_test(&calc_tests[i]), &nf);
+    for (i=0; i<numliteral; i++)
+        report(run_literal_test(&literal_tests[i]), &nf);
+    for (i=0; i<numsized; i++)
+        report(run_sized_test(&sized_tests[i]), &nf);
+    for (i=0; i<numcheck; i++)
+        report(run_check_test(&check_tests[i]), &nf);
+
+    yasm_intnum_cleanup();
+
+    printf(" +%d-%d/%d %d%%\n%s",
+           numtests-nf, nf, numtests, 100*(numtests-nf)/numtests, failed);
+    return (nf == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
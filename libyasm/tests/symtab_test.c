@@ -0,0 +1,326 @@
+/*
+ *
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libyasm.h"
+
+static char failed[1000];
+static char failmsg[100];
+
+/* Using a name twice finds the same symbol; unknown names aren't found. */
+static int
+test_use(void)
+{
+    yasm_symtab *symtab = yasm_symtab_create(NULL);
+    yasm_symrec *a = yasm_symtab_use(symtab, "label", 1);
+    yasm_symrec *b = yasm_symtab_use(symtab, "label", 2);
+    int fail = 0;
+
+    if (a != b || yasm_symtab_get(symtab, "label") != a) {
+        sprintf(failmsg, "same name found different symbols");
+        fail = 1;
+    } else if (yasm_symtab_get(symtab, "Label") ||
+               yasm_symtab_get(symtab, "labe") ||
+               yasm_symtab_get(symtab, "labels")) {
+        sprintf(failmsg, "unknown name found a symbol");
+        fail = 1;
+    } else if (strcmp(yasm_symrec_get_name(a), "label") != 0) {
+        sprintf(failmsg, "symbol name changed");
+        fail = 1;
+    }
+    yasm_symtab_destroy(symtab);
+    return fail;
+}
+
+/* Symbols survive the table growing, and iterate in insertion order. */
+static int
+test_many(void)
+{
+    static yasm_symrec *saved[5000];
+    yasm_symtab *symtab = yasm_symtab_create(NULL);
+    const yasm_symtab_iter *iter;
+    char buf[32];
+    int i, fail = 0;
+
+    for (i=0; i<5000; i++) {
+        sprintf(buf, "sym%d", i);
+        saved[i] = yasm_symtab_use(symtab, buf, (unsigned long)i+1);
+    }
+    for (i=0; i<5000 && !fail; i++) {
+        sprintf(buf, "sym%d", i);
+        if (yasm_symtab_get(symtab, buf) != saved[i]) {
+            sprintf(failmsg, "`%s' not found after table growth", buf);
+            fail = 1;
+        }
+    }
+    for (i=0, iter = yasm_symtab_first(symtab); iter && !fail;
+         i++, iter = yasm_symtab_next(iter)) {
+        if (i >= 5000 || yasm_symtab_iter_value(iter) != saved[i]) {
+            sprintf(failmsg, "symbol %d out of insertion order", i);
+            fail = 1;
+        }
+    }
+    if (!fail && i != 5000) {
+        sprintf(failmsg, "iterated over %d symbols", i);
+        fail = 1;
+    }
+    yasm_symtab_destroy(symtab);
+    return fail;
+}
+
+/* Case insensitive tables match names in any case, and keep them
+ * lowercase.
+ */
+static int
+test_nocase(void)
+{
+    yasm_symtab *symtab = yasm_symtab_create(NULL);
+    yasm_symrec *a;
+    int fail = 0;
+
+    yasm_symtab_set_case_sensitive(symtab, 0);
+    a = yasm_symtab_use(symtab, "MixedCase", 1);
+    if (yasm_symtab_use(symtab, "MIXEDCASE", 2) != a ||
+        yasm_symtab_get(symtab, "mixedcase") != a) {
+        sprintf(failmsg, "case variants found different symbols");
+        fail = 1;
+    } else if (strcmp(yasm_symrec_get_name(a), "mixedcase") != 0) {
+        sprintf(failmsg, "name `%s' not lowercased", yasm_symrec_get_name(a));
+        fail = 1;
+    }
+    yasm_symtab_destroy(symtab);
+    return fail;
+}
+
+static int data_destroyed;
+static int data_printed;
+
+static void
+data_destroy(void *data)
+{
+    data_destroyed++;
+    free(data);
+}
+
+static void
+data_print(void *data, FILE *f, int indent_level)
+{
+    data_printed++;
+}
+
+static const yasm_assoc_data_callback data_cb = {
+    data_destroy,
+    data_print
+};
+
+static const yasm_assoc_data_callback data_cb2 = {
+    data_destroy,
+    data_print
+};
+
+/* Symbols get consecutive IDs; associated data is kept per callback and
+ * destroyed with the table.
+ */
+static int
+test_data(void)
+{
+    yasm_symtab *symtab = yasm_symtab_create(NULL);
+    yasm_symrec *syms[300];
+    char buf[32];
+    int i, fail = 0;
+
+    for (i=0; i<300; i++) {
+        sprintf(buf, "sym%d", i);
+        syms[i] = yasm_symtab_use(symtab, buf, 1);
+        if (yasm_symrec_get_id(syms[i]) != yasm_symrec_get_id(syms[0])+i) {
+            sprintf(failmsg, "`%s' has ID %lu", buf,
+                    yasm_symrec_get_id(syms[i]));
+            fail = 1;
+        }
+    }
+    for (i=0; i<300; i+=3)
+        yasm_symrec_add_data(syms[i], &data_cb, malloc(1));
+    yasm_symrec_add_data(syms[1], &data_cb2, malloc(1));
+    yasm_symrec_add_data(syms[1], &data_cb2, malloc(1));  /* replaces */
+
+    for (i=0; i<300 && !fail; i++) {
+        if ((yasm_symrec_get_data(syms[i], &data_cb) != NULL) != (i%3 == 0)
+            || (yasm_symrec_get_data(syms[i], &data_cb2) != NULL) != (i == 1))
+        {
+            sprintf(failmsg, "wrong data for symbol %d", i);
+            fail = 1;
+        }
+    }
+    if (!fail && data_destroyed != 1) {
+        sprintf(failmsg, "replaced data not destroyed");
+        fail = 1;
+    }
+    data_destroyed = 0;
+    yasm_symtab_destroy(symtab);
+    if (!fail && data_destroyed != 101) {
+        sprintf(failmsg, "%d data items destroyed with table", data_destroyed);
+        fail = 1;
+    }
+    return fail;
+}
+
+/* Printing a symbol prints each piece of data associated with it. */
+static int
+test_print(void)
+{
+    yasm_symtab *symtab = yasm_symtab_create(NULL);
+    yasm_symrec *a, *b;
+    FILE *f = tmpfile();
+    int fail = 0;
+
+    if (!f) {
+        sprintf(failmsg, "could not create temporary file");
+        yasm_symtab_destroy(symtab);
+        return 1;
+    }
+    a = yasm_symtab_use(symtab, "a", 1);
+    b = yasm_symtab_use(symtab, "b", 1);
+    yasm_symrec_add_data(a, &data_cb, malloc(1));
+    yasm_symrec_add_data(a, &data_cb2, malloc(1));
+    yasm_symrec_add_data(b, &data_cb2, malloc(1));
+
+    data_printed = 0;
+    yasm_symrec_print(a, f, 0);
+    if (data_printed != 2) {
+        sprintf(failmsg, "%d data items printed for `a'", data_printed);
+        fail = 1;
+    }
+    data_printed = 0;
+    yasm_symrec_print(b, f, 0);
+    if (!fail && data_printed != 1) {
+        sprintf(failmsg, "%d data items printed for `b'", data_printed);
+        fail = 1;
+    }
+    fclose(f);
+    yasm_symtab_destroy(symtab);
+    return fail;
+}
+
+/* Removed symbols aren't found, their data is destroyed, and the rest keep
+ * their order; removing and re-adding names many times doesn't lose any.
+ */
+static int
+test_remove(void)
+{
+    yasm_symtab *symtab = yasm_symtab_create(NULL);
+    const yasm_symtab_iter *iter;
+    char buf[32];
+    int i, j, fail = 0;
+
+    for (i=0; i<100; i++) {
+        sprintf(buf, "sym%d", i);
+        yasm_symtab_use(symtab, buf, 1);
+    }
+    yasm_symrec_add_data(yasm_symtab_get(symtab, "sym50"), &data_cb,
+                         malloc(1));
+    data_destroyed = 0;
+    for (i=0; i<100; i+=2) {
+        sprintf(buf, "sym%d", i);
+        if (!yasm_symtab_remove(symtab, buf)) {
+            sprintf(failmsg, "`%s' not removed", buf);
+            fail = 1;
+        }
+    }
+    if (!fail && (yasm_symtab_remove(symtab, "sym0") ||
+                  yasm_symtab_get(symtab, "sym0"))) {
+        sprintf(failmsg, "removed symbol still found");
+        fail = 1;
+    }
+    if (!fail && data_destroyed != 1) {
+        sprintf(failmsg, "data not destroyed with symbol");
+        fail = 1;
+    }
+    for (i=1, iter = yasm_symtab_first(symtab); iter && !fail;
+         i+=2, iter = yasm_symtab_next(iter)) {
+        sprintf(buf, "sym%d", i);
+        if (strcmp(yasm_symrec_get_name(yasm_symtab_iter_value(iter)), buf))
+        {
+            sprintf(failmsg, "symbol %d out of order after removal", i);
+            fail = 1;
+        }
+    }
+    if (!fail && i != 101) {
+        sprintf(failmsg, "iterated to %d after removal", i);
+        fail = 1;
+    }
+
+    /* Redefinition: remove and re-add the same names over and over */
+    for (j=0; j<200 && !fail; j++) {
+        for (i=1; i<100; i+=2) {
+            sprintf(buf, "sym%d", i);
+            yasm_symtab_remove(symtab, buf);
+            yasm_symtab_use(symtab, buf, (unsigned long)j);
+        }
+    }
+    for (i=1; i<100 && !fail; i+=2) {
+        sprintf(buf, "sym%d", i);
+        if (!yasm_symtab_get(symtab, buf)) {
+            sprintf(failmsg, "`%s' lost after repeated removal", buf);
+            fail = 1;
+        }
+    }
+    yasm_symtab_destroy(symtab);
+    return fail;
+}
+
+static int (*tests[])(void) = {
+    test_use,
+    test_many,
+    test_nocase,
+    test_data,
+    test_print,
+    test_remove,
+};
+
+int
+main(void)
+{
+    int nf = 0;
+    int numtests = sizeof(tests)/sizeof(tests[0]);
+    int i;
+
+    failed[0] = '\0';
+    printf("Test symtab_test: ");
+    for (i=0; i<numtests; i++) {
+        int fail = tests[i]();
+        printf("%c", fail>0 ? 'F':'.');
+        fflush(stdout);
+        if (fail)
+            sprintf(failed, "%s ** F: %s\n", failed, failmsg);
+        nf += fail;
+    }
+
+    printf(" +%d-%d/%d %d%%\n%s",
+           numtests-nf, nf, numtests, 100*(numtests-nf)/numtests, failed);
+    return (nf == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
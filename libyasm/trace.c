@@ -0,0 +1,65 @@
+/*
+ * YASM activity tracing
+ *
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "util.h"
+
+#include "trace.h"
+
+
+static YASM_THREAD_LOCAL /*@null@*/ yasm_trace_begin_func trace_begin = NULL;
+static YASM_THREAD_LOCAL /*@null@*/ yasm_trace_end_func trace_end = NULL;
+
+void
+yasm_trace_set_funcs(yasm_trace_begin_func begin, yasm_trace_end_func end)
+{
+    if (begin && end) {
+        trace_begin = begin;
+        trace_end = end;
+    } else {
+        trace_begin = NULL;
+        trace_end = NULL;
+    }
+}
+
+int
+yasm_trace_enabled(void)
+{
+    return trace_begin != NULL;
+}
+
+void
+yasm_trace_begin(const char *category, const char *name, const char *detail)
+{
+    if (trace_begin)
+        trace_begin(category, name, detail);
+}
+
+void
+yasm_trace_end(void)
+{
+    if (trace_end)
+        trace_end();
+}
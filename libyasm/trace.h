@@ -0,0 +1,81 @@
+/**
+ * \file libyasm/trace.h
+ * \brief YASM activity tracing interface.
+ *
+ * \license
+ *  Copyright (C) 2026  agent
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND OTHER CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR OTHER CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ * \endlicense
+ */
+#ifndef YASM_TRACE_H
+#define YASM_TRACE_H
+
+#ifndef YASM_LIB_DECL
+#define YASM_LIB_DECL
+#endif
+
+/** Function called when a traced region of work begins.
+ * \param category      category of the region (e.g. "include")
+ * \param name          name of the region
+ * \param detail        additional detail (e.g. a filename); may be NULL
+ */
+typedef void (*yasm_trace_begin_func)
+    (const char *category, const char *name, /*@null@*/ const char *detail);
+
+/** Function called when the most recently begun traced region ends. */
+typedef void (*yasm_trace_end_func) (void);
+
+/** Install trace functions for the current thread.  Regions are strictly
+ * nested: each end call closes the innermost open region.
+ * \param begin         function called at the start of a region;
+ *                      NULL disables tracing
+ * \param end           function called at the end of a region
+ */
+YASM_LIB_DECL
+void yasm_trace_set_funcs(/*@null@*/ yasm_trace_begin_func begin,
+                          /*@null@*/ yasm_trace_end_func end);
+
+/** Determine if tracing is enabled in the current thread.  Useful to avoid
+ * computing region details that would go unused.
+ * \return Nonzero if trace functions are installed.
+ */
+YASM_LIB_DECL
+int yasm_trace_enabled(void);
+
+/** Mark the beginning of a traced region.  Does nothing if tracing is not
+ * enabled.
+ * \param category      category of the region
+ * \param name          name of the region
+ * \param detail        additional detail; may be NULL
+ */
+YASM_LIB_DECL
+void yasm_trace_begin(const char *category, const char *name,
+                      /*@null@*/ const char *detail);
+
+/** Mark the end of the innermost traced region.  Does nothing if tracing is
+ * not enabled.
+ */
+YASM_LIB_DECL
+void yasm_trace_end(void);
+
+#endif
@@ -58,6 +58,13 @@ YASM_LIB_DECL
 void (*yasm_xfree) (/*@only@*/ /*@out@*/ /*@null@*/ void *p)
     /*@modifies p@*/ = def_xfree;
 
+YASM_LIB_DECL
+void (*yasm_mem_suballoc) (yasm_mem_category category, size_t size,
+                           int alloc) = NULL;
+
+/* category of allocations, for allocators that account for memory use */
+static YASM_THREAD_LOCAL yasm_mem_category cur_category = YASM_MEM_OTHER;
+
 
 static void *
 def_xmalloc(size_t size)
@@ -112,3 +119,41 @@ def_xfree(void *p)
         return;
     free(p);
 }
+
+yasm_mem_category
+yasm_mem_set_category(yasm_mem_category category)
+{
+    yasm_mem_category old = cur_category;
+    cur_category = category;
+    return old;
+}
+
+yasm_mem_category
+yasm_mem_get_category(void)
+{
+    return cur_category;
+}
+
+void *
+yasm__xmalloc_cat(yasm_mem_category category, size_t size)
+{
+    yasm_mem_category old = cur_category;
+    void *newmem;
+
+    cur_category = category;
+    newmem = yasm_xmalloc(size);
+    cur_category = old;
+    return newmem;
+}
+
+void *
+yasm__xrealloc_cat(yasm_mem_category category, void *oldmem, size_t size)
+{
+    yasm_mem_category old = cur_category;
+    void *newmem;
+
+    cur_category = category;
+    newmem = yasm_xrealloc(oldmem, size);
+    cur_category = old;
+    return newmem;
+}
@@ -81,7 +81,8 @@ static const yasm_bytecode_callback x86_bc_callback_insn = {
     x86_bc_insn_calc_len,
     x86_bc_insn_expand,
     x86_bc_insn_tobytes,
-    0
+    0,
+    NULL
 };
 
 static const yasm_bytecode_callback x86_bc_callback_jmp = {
@@ -92,7 +93,8 @@ static const yasm_bytecode_callback x86_bc_callback_jmp = {
     x86_bc_jmp_calc_len,
     x86_bc_jmp_expand,
     x86_bc_jmp_tobytes,
-    0
+    0,
+    NULL
 };
 
 static const yasm_bytecode_callback x86_bc_callback_jmpfar = {
@@ -103,7 +105,8 @@ static const yasm_bytecode_callback x86_bc_callback_jmpfar = {
     x86_bc_jmpfar_calc_len,
     yasm_bc_expand_common,
     x86_bc_jmpfar_tobytes,
-    0
+    0,
+    NULL
 };
 
 int
@@ -179,7 +182,8 @@ yasm_x86__ea_set_disponly(x86_effaddr *x86_ea)
 static x86_effaddr *
 ea_create(void)
 {
-    x86_effaddr *x86_ea = yasm_xmalloc(sizeof(x86_effaddr));
+    x86_effaddr *x86_ea = yasm__arena_xmalloc(YASM_MEM_BYTECODE,
+                                              sizeof(x86_effaddr));
 
     yasm_value_initialize(&x86_ea->ea.disp, NULL, 0);
     x86_ea->ea.need_nonzero_len = 0;
@@ -388,7 +392,7 @@ void
 yasm_x86__ea_destroy(yasm_effaddr *ea)
 {
     yasm_value_delete(&ea->disp);
-    yasm_xfree(ea);
+    yasm__arena_xfree(ea);
 }
 
 void
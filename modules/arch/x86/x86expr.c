@@ -102,7 +102,7 @@ x86_expr_checkea_get_reg16(yasm_expr__item *ei, int *regnum, void *d)
     x86_checkea_reg16_data *data = d;
     /* in order: ax,cx,dx,bx,sp,bp,si,di */
     /*@-nullassign@*/
-    static int *reg16[8] = {0,0,0,0,0,0,0,0};
+    static YASM_THREAD_LOCAL int *reg16[8] = {0,0,0,0,0,0,0,0};
     /*@=nullassign@*/
 
     reg16[3] = &data->bx;
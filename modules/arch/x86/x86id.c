@@ -346,7 +346,8 @@ static const yasm_bytecode_callback x86_id_insn_callback = {
     yasm_bc_calc_len_common,
     yasm_bc_expand_common,
     yasm_bc_tobytes_common,
-    YASM_BC_SPECIAL_INSN
+    YASM_BC_SPECIAL_INSN,
+    NULL
 };
 
 #include "x86insns.c"
@@ -424,7 +425,7 @@ x86_finalize_jmpfar(yasm_bytecode *bc, yasm_bytecode *prev_bc,
     yasm_insn_operand *op;
     unsigned int i;
 
-    jmpfar = yasm_xmalloc(sizeof(x86_jmpfar));
+    jmpfar = yasm__xmalloc_cat(YASM_MEM_BYTECODE, sizeof(x86_jmpfar));
     x86_finalize_common(&jmpfar->common, info, mode_bits);
     x86_finalize_opcode(&jmpfar->opcode, info);
 
@@ -521,7 +522,7 @@ x86_finalize_jmp(yasm_bytecode *bc, yasm_bytecode *prev_bc,
     if (op->type != YASM_INSN__OPERAND_IMM)
         yasm_internal_error(N_("invalid operand conversion"));
 
-    jmp = yasm_xmalloc(sizeof(x86_jmp));
+    jmp = yasm__xmalloc_cat(YASM_MEM_BYTECODE, sizeof(x86_jmp));
     x86_finalize_common(&jmp->common, jinfo, mode_bits);
     if (yasm_value_finalize_expr(&jmp->target, op->data.val, prev_bc, 0))
         yasm_error_set(YASM_ERROR_TOO_COMPLEX,
@@ -1160,7 +1161,7 @@ x86_id_insn_finalize(yasm_bytecode *bc, yasm_bytecode *prev_bc)
     }
 
     /* Copy what we can from info */
-    insn = yasm_xmalloc(sizeof(x86_insn));
+    insn = yasm__xmalloc_cat(YASM_MEM_BYTECODE, sizeof(x86_insn));
     x86_finalize_common(&insn->common, info, mode_bits);
     x86_finalize_opcode(&insn->opcode, info);
     insn->x86_ea = NULL;
@@ -1387,7 +1388,7 @@ x86_id_insn_finalize(yasm_bytecode *bc, yasm_bytecode *prev_bc)
                             yasm_x86__set_rex_from_reg(&insn->rex, &spare,
                                 op->data.reg, mode_bits, X86_REX_R)) {
                             if (insn->x86_ea)
-                                yasm_xfree(insn->x86_ea);
+                                yasm__arena_xfree(insn->x86_ea);
                             yasm_xfree(insn);
                             return;
                         }
@@ -1525,7 +1526,7 @@ x86_id_insn_finalize(yasm_bytecode *bc, yasm_bytecode *prev_bc)
         yasm_internal_error(N_("unhandled segment prefix"));
 
     if (imm) {
-        insn->imm = yasm_xmalloc(sizeof(yasm_value));
+        insn->imm = yasm__xmalloc_cat(YASM_MEM_BYTECODE, sizeof(yasm_value));
         if (yasm_value_finalize_expr(insn->imm, imm, prev_bc, im_len))
             yasm_error_set(YASM_ERROR_TOO_COMPLEX,
                            N_("immediate expression too complex"));
@@ -1714,7 +1715,7 @@ typedef struct insnprefix_parse_data {
 static const char *
 cpu_find_reverse(unsigned int cpu0, unsigned int cpu1, unsigned int cpu2)
 {
-    static char cpuname[200];
+    static YASM_THREAD_LOCAL char cpuname[200];
     wordptr cpu = BitVector_Create(128, TRUE);
 
     if (cpu0 != CPU_Any)
@@ -1803,7 +1804,7 @@ yasm_x86__parse_check_insnprefix(yasm_arch *arch, const char *id,
     yasm_arch_x86 *arch_x86 = (yasm_arch_x86 *)arch;
     /*@null@*/ const insnprefix_parse_data *pdata;
     size_t i;
-    static char lcaseid[17];
+    static YASM_THREAD_LOCAL char lcaseid[17];
 
     *bc = (yasm_bytecode *)NULL;
     *prefix = 0;
@@ -1843,7 +1844,8 @@ yasm_x86__parse_check_insnprefix(yasm_arch *arch, const char *id,
         if (arch_x86->mode_bits == 64 && (pdata->misc_flags & NOT_64)) {
             yasm_error_set(YASM_ERROR_GENERAL,
                            N_("`%s' invalid in 64-bit mode"), id);
-            id_insn = yasm_xmalloc(sizeof(x86_id_insn));
+            id_insn = yasm__xmalloc_cat(YASM_MEM_BYTECODE,
+                                        sizeof(x86_id_insn));
             yasm_insn_initialize(&id_insn->insn);
             id_insn->group = not64_insn;
             id_insn->cpu_enabled = cpu_enabled;
@@ -1875,7 +1877,7 @@ yasm_x86__parse_check_insnprefix(yasm_arch *arch, const char *id,
             return YASM_ARCH_NOTINSNPREFIX;
         }
 
-        id_insn = yasm_xmalloc(sizeof(x86_id_insn));
+        id_insn = yasm__xmalloc_cat(YASM_MEM_BYTECODE, sizeof(x86_id_insn));
         yasm_insn_initialize(&id_insn->insn);
         id_insn->group = pdata->group;
         id_insn->cpu_enabled = cpu_enabled;
@@ -1937,7 +1939,8 @@ x86_id_insn_print(const void *contents, FILE *f, int indent_level)
 yasm_x86__create_empty_insn(yasm_arch *arch, unsigned long line)
 {
     yasm_arch_x86 *arch_x86 = (yasm_arch_x86 *)arch;
-    x86_id_insn *id_insn = yasm_xmalloc(sizeof(x86_id_insn));
+    x86_id_insn *id_insn = yasm__xmalloc_cat(YASM_MEM_BYTECODE,
+                                             sizeof(x86_id_insn));
 
     yasm_insn_initialize(&id_insn->insn);
     id_insn->group = empty_insn;
@@ -207,7 +207,8 @@ static const yasm_bytecode_callback cv8_symhead_bc_callback = {
     cv8_symhead_bc_calc_len,
     yasm_bc_expand_common,
     cv8_symhead_bc_tobytes,
-    0
+    0,
+    NULL
 };
 
 static const yasm_bytecode_callback cv8_fileinfo_bc_callback = {
@@ -218,7 +219,8 @@ static const yasm_bytecode_callback cv8_fileinfo_bc_callback = {
     cv8_fileinfo_bc_calc_len,
     yasm_bc_expand_common,
     cv8_fileinfo_bc_tobytes,
-    0
+    0,
+    NULL
 };
 
 static const yasm_bytecode_callback cv8_lineinfo_bc_callback = {
@@ -229,7 +231,8 @@ static const yasm_bytecode_callback cv8_lineinfo_bc_callback = {
     cv8_lineinfo_bc_calc_len,
     yasm_bc_expand_common,
     cv8_lineinfo_bc_tobytes,
-    0
+    0,
+    NULL
 };
 
 static const yasm_bytecode_callback cv_sym_bc_callback = {
@@ -240,7 +243,8 @@ static const yasm_bytecode_callback cv_sym_bc_callback = {
     cv_sym_bc_calc_len,
     yasm_bc_expand_common,
     cv_sym_bc_tobytes,
-    0
+    0,
+    NULL
 };
 
 static cv8_symhead *cv8_add_symhead(yasm_section *sect, unsigned long type,
@@ -445,6 +449,7 @@ cv_generate_line_bc(yasm_bytecode *bc, /*@null@*/ void *d)
     if (!info->cv8_cur_li
         || strcmp(filename, info->cv8_cur_li->fn->filename) != 0) {
         yasm_bytecode *sectbc;
+        /*@null@*/ yasm_symrec **sectsyms;
         char symname[8];
         int first_in_sect = !info->cv8_cur_li;
 
@@ -462,8 +467,9 @@ cv_generate_line_bc(yasm_bytecode *bc, /*@null@*/ void *d)
         info->cv8_cur_li->sect = sect;
         info->cv8_cur_li->first_in_sect = first_in_sect;
         sectbc = yasm_section_bcs_first(sect);
-        if (sectbc->symrecs && sectbc->symrecs[0])
-            info->cv8_cur_li->sectsym = sectbc->symrecs[0];
+        sectsyms = yasm_bc_get_symrecs(sectbc);
+        if (sectsyms)
+            info->cv8_cur_li->sectsym = sectsyms[0];
         else {
             sprintf(symname, ".%06u", info->num_lineinfos++);
             info->cv8_cur_li->sectsym =
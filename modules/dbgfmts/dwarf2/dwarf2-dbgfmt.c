@@ -58,7 +58,8 @@ static const yasm_bytecode_callback dwarf2_head_bc_callback = {
     dwarf2_head_bc_calc_len,
     yasm_bc_expand_common,
     dwarf2_head_bc_tobytes,
-    0
+    0,
+    NULL
 };
 
 /* Section data callback function prototypes */
@@ -178,8 +179,9 @@ yasm_symrec *
 yasm_dwarf2__bc_sym(yasm_symtab *symtab, yasm_bytecode *bc)
 {
     /*@dependent@*/ yasm_symrec *sym;
-    if (bc->symrecs && bc->symrecs[0])
-        sym = bc->symrecs[0];
+    /*@null@*/ yasm_symrec **symrecs = yasm_bc_get_symrecs(bc);
+    if (symrecs)
+        sym = symrecs[0];
     else
         sym = yasm_symtab_define_label(symtab, ".bcsym", bc, 0, 0);
     return sym;
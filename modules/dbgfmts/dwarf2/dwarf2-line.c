@@ -154,7 +154,8 @@ static const yasm_bytecode_callback dwarf2_spp_bc_callback = {
     dwarf2_spp_bc_calc_len,
     yasm_bc_expand_common,
     dwarf2_spp_bc_tobytes,
-    0
+    0,
+    NULL
 };
 
 static const yasm_bytecode_callback dwarf2_line_op_bc_callback = {
@@ -165,7 +166,8 @@ static const yasm_bytecode_callback dwarf2_line_op_bc_callback = {
     dwarf2_line_op_bc_calc_len,
     yasm_bc_expand_common,
     dwarf2_line_op_bc_tobytes,
-    0
+    0,
+    NULL
 };
 
 
@@ -337,10 +339,11 @@ dwarf2_dbgfmt_finalize_locs(yasm_section *sect, dwarf2_section_data *dsd)
          * Keep track of last symbol seen prior to the loc.
          */
         while (bc && bc->line <= loc->vline) {
-            if (bc->symrecs) {
+            /*@null@*/ yasm_symrec **symrecs = yasm_bc_get_symrecs(bc);
+            if (symrecs) {
                 int i = 0;
-                while (bc->symrecs[i]) {
-                    lastsym = bc->symrecs[i];
+                while (symrecs[i]) {
+                    lastsym = symrecs[i];
                     i++;
                 }
             }
@@ -514,6 +517,7 @@ dwarf2_generate_line_bc(yasm_bytecode *bc, /*@null@*/ void *d)
     size_t dirlen;
     const char *pathname, *filename;
     /*@null@*/ yasm_bytecode *nextbc = yasm_bc__next(bc);
+    /*@null@*/ yasm_symrec **symrecs;
 
     if (nextbc && bc->offset == nextbc->offset)
         return 0;
@@ -522,10 +526,11 @@ dwarf2_generate_line_bc(yasm_bytecode *bc, /*@null@*/ void *d)
     info->loc.bc = bc;
 
     /* Keep track of last symbol seen */
-    if (bc->symrecs) {
+    symrecs = yasm_bc_get_symrecs(bc);
+    if (symrecs) {
         i = 0;
-        while (bc->symrecs[i]) {
-            info->loc.sym = bc->symrecs[i];
+        while (symrecs[i]) {
+            info->loc.sym = symrecs[i];
             i++;
         }
     }
@@ -611,6 +616,7 @@ dwarf2_generate_line_section(yasm_section *sect, /*@null@*/ void *d)
 
     if (info->asm_source) {
         dwarf2_line_bc_info bcinfo;
+        /*@null@*/ yasm_symrec **symrecs;
 
         bcinfo.debug_line = info->debug_line;
         bcinfo.object = info->object;
@@ -631,10 +637,11 @@ dwarf2_generate_line_section(yasm_section *sect, /*@null@*/ void *d)
          * separately to determine the initial symrec.
          */
         bc = yasm_section_bcs_first(sect);
-        if (bc->symrecs) {
+        symrecs = yasm_bc_get_symrecs(bc);
+        if (symrecs) {
             size_t i = 0;
-            while (bc->symrecs[i]) {
-                bcinfo.loc.sym = bc->symrecs[i];
+            while (symrecs[i]) {
+                bcinfo.loc.sym = symrecs[i];
                 i++;
             }
         }
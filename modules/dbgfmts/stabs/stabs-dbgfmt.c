@@ -142,7 +142,8 @@ static const yasm_bytecode_callback stabs_bc_str_callback = {
     stabs_bc_str_calc_len,
     yasm_bc_expand_common,
     stabs_bc_str_tobytes,
-    0
+    0,
+    NULL
 };
 
 static const yasm_bytecode_callback stabs_bc_stab_callback = {
@@ -153,7 +154,8 @@ static const yasm_bytecode_callback stabs_bc_stab_callback = {
     stabs_bc_stab_calc_len,
     yasm_bc_expand_common,
     stabs_bc_stab_tobytes,
-    0
+    0,
+    NULL
 };
 
 yasm_dbgfmt_module yasm_stabs_LTX_dbgfmt;
@@ -226,10 +228,11 @@ stabs_dbgfmt_generate_n_fun(stabs_info *info, yasm_bytecode *bc)
 {
     /* check all syms at this bc for potential function syms */
     int bcsym;
-    for (bcsym=0; bc->symrecs && bc->symrecs[bcsym]; bcsym++)
+    /*@null@*/ yasm_symrec **symrecs = yasm_bc_get_symrecs(bc);
+    for (bcsym=0; symrecs && symrecs[bcsym]; bcsym++)
     {
         char *str;
-        yasm_symrec *sym = bc->symrecs[bcsym];
+        yasm_symrec *sym = symrecs[bcsym];
         const char *name = yasm_symrec_get_name(sym);
 
         /* best guess algorithm - ignore labels containing a . or $ */
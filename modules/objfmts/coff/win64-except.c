@@ -75,7 +75,8 @@ static const yasm_bytecode_callback win64_uwinfo_bc_callback = {
     win64_uwinfo_bc_calc_len,
     win64_uwinfo_bc_expand,
     win64_uwinfo_bc_tobytes,
-    0
+    0,
+    NULL
 };
 
 static const yasm_bytecode_callback win64_uwcode_bc_callback = {
@@ -86,7 +87,8 @@ static const yasm_bytecode_callback win64_uwcode_bc_callback = {
     win64_uwcode_bc_calc_len,
     win64_uwcode_bc_expand,
     win64_uwcode_bc_tobytes,
-    0
+    0,
+    NULL
 };
 
 
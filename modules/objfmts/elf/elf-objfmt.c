@@ -95,7 +95,8 @@ elf_objfmt_symtab_append(yasm_objfmt_elf *objfmt_elf, yasm_symrec *sym,
     if (!entry) {
         /*@only@*/ char *symname = yasm_symrec_get_global_name(sym, object);
         elf_strtab_entry *name =
-            elf_strtab_append_str(objfmt_elf->strtab, symname);
+            elf_strtab_append_str(objfmt_elf->strtab, symname,
+                                  object->strings);
         yasm_xfree(symname);
         entry = elf_symtab_entry_create(name, sym);
         yasm_symrec_add_data(sym, &elf_symrec_data, entry);
@@ -322,7 +323,8 @@ elf_objfmt_build_symtab(yasm_symrec *sym, /*@null@*/ void *d)
             /*@only@*/ char *symname =
                 yasm_symrec_get_global_name(sym, info->object);
             elf_strtab_entry *name = !info->local_names || is_sect ? NULL :
-                elf_strtab_append_str(info->objfmt_elf->strtab, symname);
+                elf_strtab_append_str(info->objfmt_elf->strtab, symname,
+                                      info->object->strings);
             yasm_xfree(symname);
             entry = elf_symtab_entry_create(name, sym);
             yasm_symrec_add_data(sym, &elf_symrec_data, entry);
@@ -364,15 +366,16 @@ elf_objfmt_create_common(yasm_object *object, yasm_objfmt_module *module,
     if (elf_march_out)
         *elf_march_out = elf_march;
 
-    objfmt_elf->shstrtab = elf_strtab_create();
-    objfmt_elf->strtab = elf_strtab_create();
+    objfmt_elf->shstrtab = elf_strtab_create(object->strings);
+    objfmt_elf->strtab = elf_strtab_create(object->strings);
     objfmt_elf->elf_symtab = elf_symtab_create();
 
     /* FIXME: misuse of NULL bytecode here; it works, but only barely. */
     filesym = yasm_symtab_define_label(object->symtab, ".file", NULL, 0, 0);
     /* Put in current input filename; we'll replace it in output() */
     objfmt_elf->file_strtab_entry =
-        elf_strtab_append_str(objfmt_elf->strtab, object->src_filename);
+        elf_strtab_append_str(objfmt_elf->strtab, object->src_filename,
+                              object->strings);
     entry = elf_symtab_entry_create(objfmt_elf->file_strtab_entry, filesym);
     yasm_symrec_add_data(filesym, &elf_symrec_data, entry);
     elf_symtab_set_nonzero(entry, NULL, SHN_ABS, STB_LOCAL, STT_FILE, NULL,
@@ -701,7 +704,8 @@ elf_objfmt_output_section(yasm_section *sect, /*@null@*/ void *d)
     sectname = yasm_section_get_name(sect);
     relname = elf_secthead_name_reloc_section(sectname);
     elf_secthead_set_rel_name(shead,
-        elf_strtab_append_str(info->objfmt_elf->shstrtab, relname));
+        elf_strtab_append_str(info->objfmt_elf->shstrtab, relname,
+                              info->object->strings));
     yasm_xfree(relname);
 
     return 0;
@@ -755,7 +759,7 @@ elf_objfmt_output(yasm_object *object, FILE *f, int all_syms,
 
     /* Update filename strtab */
     elf_strtab_entry_set_str(objfmt_elf->file_strtab_entry,
-                             object->src_filename);
+                             object->src_filename, object->strings);
 
     /* Allocate space for Ehdr by seeking forward */
     if (fseek(f, (long)(elf_proghead_get_size()), SEEK_SET) < 0) {
@@ -782,10 +786,12 @@ elf_objfmt_output(yasm_object *object, FILE *f, int all_syms,
         return;
 
     /* add final sections to the shstrtab */
-    elf_strtab_name = elf_strtab_append_str(objfmt_elf->shstrtab, ".strtab");
-    elf_symtab_name = elf_strtab_append_str(objfmt_elf->shstrtab, ".symtab");
+    elf_strtab_name = elf_strtab_append_str(objfmt_elf->shstrtab, ".strtab",
+                                            object->strings);
+    elf_symtab_name = elf_strtab_append_str(objfmt_elf->shstrtab, ".symtab",
+                                            object->strings);
     elf_shstrtab_name = elf_strtab_append_str(objfmt_elf->shstrtab,
-                                              ".shstrtab");
+                                              ".shstrtab", object->strings);
 
     /* output .shstrtab */
     if ((pos = elf_objfmt_output_align(f, 4)) == -1) {
@@ -898,7 +904,7 @@ elf_objfmt_init_new_section(yasm_section *sect, unsigned long line)
     elf_secthead *esd;
     yasm_symrec *sym;
     elf_strtab_entry *name = elf_strtab_append_str(objfmt_elf->shstrtab,
-                                                   sectname);
+                                                   sectname, object->strings);
 
     elf_section_type type=SHT_PROGBITS;
     elf_size entsize=0;
@@ -1166,7 +1172,8 @@ dir_type(yasm_object *object, yasm_valparamhead *valparams,
     /* Create entry if necessary */
     if (!entry) {
         entry = elf_symtab_entry_create(
-            elf_strtab_append_str(objfmt_elf->strtab, symname), sym);
+            elf_strtab_append_str(objfmt_elf->strtab, symname,
+                                  object->strings), sym);
         yasm_symrec_add_data(sym, &elf_symrec_data, entry);
     }
 
@@ -1203,7 +1210,8 @@ dir_size(yasm_object *object, yasm_valparamhead *valparams,
     /* Create entry if necessary */
     if (!entry) {
         entry = elf_symtab_entry_create(
-            elf_strtab_append_str(objfmt_elf->strtab, symname), sym);
+            elf_strtab_append_str(objfmt_elf->strtab, symname,
+                                  object->strings), sym);
         yasm_symrec_add_data(sym, &elf_symrec_data, entry);
     }
 
@@ -69,8 +69,9 @@ static const elf_machine_handler *elf_machine_handlers[] =
 static const elf_machine_handler elf_null_machine = {0, 0, 0, 0, 0, 0, 0, 0,
                                                      0, 0, 0, 0, 0, 0, 0, 0,
                                                      0, 0, 0};
-static elf_machine_handler const *elf_march = &elf_null_machine;
-static yasm_symrec **elf_ssyms;
+static YASM_THREAD_LOCAL elf_machine_handler const *elf_march =
+    &elf_null_machine;
+static YASM_THREAD_LOCAL yasm_symrec **elf_ssyms;
 
 const elf_machine_handler *
 elf_set_arch(yasm_arch *arch, yasm_symtab *symtab, int bits_pref)
@@ -195,21 +196,20 @@ elf_reloc_entry_destroy(void *entry)
 
 /* strtab functions */
 elf_strtab_entry *
-elf_strtab_entry_create(const char *str)
+elf_strtab_entry_create(const char *str, yasm_intern_table *strings)
 {
     elf_strtab_entry *entry = yasm_xmalloc(sizeof(elf_strtab_entry));
-    entry->str = yasm__xstrdup(str);
+    entry->str = yasm_intern(strings, str);
     entry->index = 0;
     return entry;
 }
 
 void
-elf_strtab_entry_set_str(elf_strtab_entry *entry, const char *str)
+elf_strtab_entry_set_str(elf_strtab_entry *entry, const char *str,
+                         yasm_intern_table *strings)
 {
     elf_strtab_entry *last;
-    if (entry->str)
-        yasm_xfree(entry->str);
-    entry->str = yasm__xstrdup(str);
+    entry->str = yasm_intern(strings, str);
 
     /* Update all following indices since string length probably changes */
     last = entry;
@@ -222,21 +222,22 @@ elf_strtab_entry_set_str(elf_strtab_entry *entry, const char *str)
 }
 
 elf_strtab_head *
-elf_strtab_create(void)
+elf_strtab_create(yasm_intern_table *strings)
 {
     elf_strtab_head *strtab = yasm_xmalloc(sizeof(elf_strtab_head));
     elf_strtab_entry *entry = yasm_xmalloc(sizeof(elf_strtab_entry));
 
     STAILQ_INIT(strtab);
     entry->index = 0;
-    entry->str = yasm__xstrdup("");
+    entry->str = yasm_intern(strings, "");
 
     STAILQ_INSERT_TAIL(strtab, entry, qlink);
     return strtab;
 }
 
 elf_strtab_entry *
-elf_strtab_append_str(elf_strtab_head *strtab, const char *str)
+elf_strtab_append_str(elf_strtab_head *strtab, const char *str,
+                      yasm_intern_table *strings)
 {
     elf_strtab_entry *last, *entry;
 
@@ -247,7 +248,7 @@ elf_strtab_append_str(elf_strtab_head *strtab, const char *str)
 
     last = STAILQ_LAST(strtab, elf_strtab_entry, qlink);
 
-    entry = elf_strtab_entry_create(str);
+    entry = elf_strtab_entry_create(str, strings);
     entry->index = last->index + (unsigned long)strlen(last->str) + 1;
 
     STAILQ_INSERT_TAIL(strtab, entry, qlink);
@@ -267,7 +268,6 @@ elf_strtab_destroy(elf_strtab_head *strtab)
     s1 = STAILQ_FIRST(strtab);
     while (s1 != NULL) {
         s2 = STAILQ_NEXT(s1, qlink);
-        yasm_xfree(s1->str);
         yasm_xfree(s1);
         s1 = s2;
     }
@@ -399,7 +399,7 @@ STAILQ_HEAD(elf_strtab_head, elf_strtab_entry);
 struct elf_strtab_entry {
     STAILQ_ENTRY(elf_strtab_entry) qlink;
     unsigned long        index;
-    char                *str;
+    const char          *str;   /* interned */
 };
 
 STAILQ_HEAD(elf_symtab_head, elf_symtab_entry);
@@ -444,10 +444,13 @@ elf_reloc_entry *elf_reloc_entry_create(yasm_symrec *sym,
 void elf_reloc_entry_destroy(void *entry);
 
 /* strtab functions */
-elf_strtab_entry *elf_strtab_entry_create(const char *str);
-void elf_strtab_entry_set_str(elf_strtab_entry *entry, const char *str);
-elf_strtab_head *elf_strtab_create(void);
-elf_strtab_entry *elf_strtab_append_str(elf_strtab_head *head, const char *str);
+elf_strtab_entry *elf_strtab_entry_create(const char *str,
+                                          yasm_intern_table *strings);
+void elf_strtab_entry_set_str(elf_strtab_entry *entry, const char *str,
+                              yasm_intern_table *strings);
+elf_strtab_head *elf_strtab_create(yasm_intern_table *strings);
+elf_strtab_entry *elf_strtab_append_str(elf_strtab_head *head, const char *str,
+                                        yasm_intern_table *strings);
 void elf_strtab_destroy(elf_strtab_head *head);
 unsigned long elf_strtab_output_to_file(FILE *f, elf_strtab_head *head);
 
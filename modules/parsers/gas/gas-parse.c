@@ -141,7 +141,7 @@ demand_eol_(yasm_parser_gas *parser_gas)
 static int
 expect_(yasm_parser_gas *parser_gas, int token)
 {
-    static char strch[] = "` '";
+    static YASM_THREAD_LOCAL char strch[] = "` '";
     const char *str;
 
     if (curtok == token)
@@ -1732,6 +1732,7 @@ gas_parser_parse(yasm_parser_gas *parser_gas)
 
     /* Create directive lookup */
     parser_gas->dirs = HAMT_create(1, yasm_internal_error_);
+    HAMT_reserve(parser_gas->dirs, NELEMS(dirs_static)+1);
     HAMT_insert(parser_gas->dirs, word.name, &word, &replace, no_delete);
     for (i=0; i<NELEMS(dirs_static); i++) {
         replace = 1;
@@ -27,6 +27,7 @@
 #include <util.h>
 
 #include <libyasm.h>
+#include <libyasm/phash.h>
 
 #include <math.h>
 
@@ -62,6 +63,10 @@ static void nasm_parser_directive
      /*@null@*/ yasm_valparamhead *valparams,
      /*@null@*/ yasm_valparamhead *objext_valparams);
 static void set_nonlocal_label(yasm_parser_nasm *parser_nasm, const char *name);
+static /*@only@*/ char *local_label_name(yasm_parser_nasm *parser_nasm,
+                                         /*@only@*/ char *local);
+static /*@dependent@*/ yasm_symrec *local_label_use
+    (yasm_parser_nasm *parser_nasm, /*@only@*/ char *local);
 static void define_label(yasm_parser_nasm *parser_nasm, /*@only@*/ char *name,
                          unsigned int size);
 
@@ -154,7 +159,7 @@ demand_eol_(yasm_parser_nasm *parser_nasm)
 static const char *
 describe_token(int token)
 {
-    static char strch[] = "` '";
+    static YASM_THREAD_LOCAL char strch[] = "` '";
     const char *str;
 
     switch (token) {
@@ -396,6 +401,9 @@ parse_line(yasm_parser_nasm *parser_nasm)
                 : (curtok != ID);
             unsigned int size = 0;
 
+            if (curtok == LOCAL_ID)
+                name = local_label_name(parser_nasm, name);
+
             get_next_token();
             if (is_eol()) {
                 /* label alone on the line */
@@ -1012,11 +1020,16 @@ parse_operand(yasm_parser_nasm *parser_nasm)
             if (parser_nasm->tasm) {
                 get_peek_token(parser_nasm);
                 if (parser_nasm->peek_token == '[') {
-                    yasm_symrec *sym = yasm_symtab_use(p_symtab, ID_val,
-                                                       cur_line);
-                    yasm_expr *e = p_expr_new_ident(yasm_expr_sym(sym)), *f;
+                    yasm_symrec *sym;
+                    yasm_expr *e, *f;
                     yasm_effaddr *ea;
-                    yasm_xfree(ID_val);
+                    if (curtok == LOCAL_ID)
+                        sym = local_label_use(parser_nasm, ID_val);
+                    else {
+                        sym = yasm_symtab_use(p_symtab, ID_val, cur_line);
+                        yasm_xfree(ID_val);
+                    }
+                    e = p_expr_new_ident(yasm_expr_sym(sym));
                     get_next_token();
                     get_next_token();
                     f = parse_bexpr(parser_nasm, NORM_EXPR);
@@ -1461,12 +1474,15 @@ parse_expr6(yasm_parser_nasm *parser_nasm, expr_type type)
             }
             /*@fallthrough@*/
         case ID:
-        case LOCAL_ID:
         case NONLOCAL_ID:
             sym = yasm_symtab_use(p_symtab, ID_val, cur_line);
             e = p_expr_new_ident(yasm_expr_sym(sym));
             yasm_xfree(ID_val);
             break;
+        case LOCAL_ID:
+            sym = local_label_use(parser_nasm, ID_val);
+            e = p_expr_new_ident(yasm_expr_sym(sym));
+            break;
         case '$':
             /* "$" references the current assembly position */
             if (parser_nasm->abspos)
@@ -1499,13 +1515,122 @@ static void
 set_nonlocal_label(yasm_parser_nasm *parser_nasm, const char *name)
 {
     if (!parser_nasm->tasm || tasm_locals) {
-        if (parser_nasm->locallabel_base)
-            yasm_xfree(parser_nasm->locallabel_base);
         parser_nasm->locallabel_base_len = strlen(name);
-        parser_nasm->locallabel_base =
-            yasm_xmalloc(parser_nasm->locallabel_base_len+1);
+        if (parser_nasm->locallabel_base_len+1 >
+            parser_nasm->locallabel_base_size) {
+            parser_nasm->locallabel_base_size =
+                parser_nasm->locallabel_base_len+1;
+            parser_nasm->locallabel_base =
+                yasm_xrealloc(parser_nasm->locallabel_base,
+                              parser_nasm->locallabel_base_size);
+        }
         strcpy(parser_nasm->locallabel_base, name);
+        parser_nasm->locallabels_scope++;
+        parser_nasm->locallabels_count = 0;
+    }
+}
+
+/* Prefixes a local label name with the current base label. */
+static char *
+local_label_name(yasm_parser_nasm *parser_nasm, char *local)
+{
+    char *name;
+    size_t len;
+
+    if (!parser_nasm->locallabel_base)
+        return local;
+    len = strlen(local);
+    name = yasm_xmalloc(parser_nasm->locallabel_base_len + len + 1);
+    memcpy(name, parser_nasm->locallabel_base,
+           parser_nasm->locallabel_base_len);
+    memcpy(name+parser_nasm->locallabel_base_len, local, len+1);
+    yasm_xfree(local);
+    return name;
+}
+
+static void
+local_label_grow(yasm_parser_nasm *parser_nasm)
+{
+    nasm_locallabel *old = parser_nasm->locallabels;
+    unsigned long oldsize = parser_nasm->locallabels_size;
+    unsigned long mask, i;
+
+    parser_nasm->locallabels_size *= 2;
+    mask = parser_nasm->locallabels_size-1;
+    parser_nasm->locallabels =
+        yasm_xcalloc(parser_nasm->locallabels_size, sizeof(nasm_locallabel));
+
+    for (i=0; i<oldsize; i++) {
+        unsigned long j;
+        if (old[i].scope != parser_nasm->locallabels_scope)
+            continue;
+        j = old[i].hash & mask;
+        while (parser_nasm->locallabels[j].scope ==
+               parser_nasm->locallabels_scope)
+            j = (j+1) & mask;
+        parser_nasm->locallabels[j] = old[i];   /* structure copy */
     }
+    yasm_xfree(old);
+}
+
+/* Gets the symbol for a reference to a local label.  Symbols already used
+ * in the current scope are found by the local name alone; the full name is
+ * only built the first time.
+ */
+static yasm_symrec *
+local_label_use(yasm_parser_nasm *parser_nasm, char *local)
+{
+    unsigned long hash, mask, i;
+    nasm_locallabel *entry;
+    yasm_symrec *sym;
+    char *name;
+
+    /* Tasm symbols are case insensitive, so the names can't be compared */
+    if (parser_nasm->tasm) {
+        name = local_label_name(parser_nasm, local);
+        sym = yasm_symtab_use(p_symtab, name, cur_line);
+        yasm_xfree(name);
+        return sym;
+    }
+
+    hash = phash_lookup(local, strlen(local), 0);
+    mask = parser_nasm->locallabels_size-1;
+    for (i = hash & mask;
+         (entry = &parser_nasm->locallabels[i])->scope ==
+            parser_nasm->locallabels_scope;
+         i = (i+1) & mask) {
+        if (entry->hash == hash &&
+            strcmp(yasm_symrec_get_name(entry->sym) +
+                   parser_nasm->locallabel_base_len, local) == 0) {
+            yasm_xfree(local);
+            return entry->sym;
+        }
+    }
+
+    /* Build the full name in place after the base */
+    if (parser_nasm->locallabel_base) {
+        size_t base_len = parser_nasm->locallabel_base_len;
+        size_t len = strlen(local);
+        if (base_len+len+1 > parser_nasm->locallabel_base_size) {
+            parser_nasm->locallabel_base_size = base_len+len+1;
+            parser_nasm->locallabel_base =
+                yasm_xrealloc(parser_nasm->locallabel_base,
+                              parser_nasm->locallabel_base_size);
+        }
+        memcpy(parser_nasm->locallabel_base+base_len, local, len+1);
+        sym = yasm_symtab_use(p_symtab, parser_nasm->locallabel_base,
+                              cur_line);
+        parser_nasm->locallabel_base[base_len] = '\0';
+    } else
+        sym = yasm_symtab_use(p_symtab, local, cur_line);
+    yasm_xfree(local);
+
+    entry->sym = sym;
+    entry->scope = parser_nasm->locallabels_scope;
+    entry->hash = hash;
+    if (++parser_nasm->locallabels_count > parser_nasm->locallabels_size/4*3)
+        local_label_grow(parser_nasm);
+    return sym;
 }
 
 static void
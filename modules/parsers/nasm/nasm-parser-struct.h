@@ -40,6 +40,13 @@ typedef union {
     } str;
 } nasm_yystype;
 
+/* Entry in the table of local labels used in the current scope */
+typedef struct nasm_locallabel {
+    /*@dependent@*/ yasm_symrec *sym;
+    unsigned long scope;        /* entry is stale unless current scope */
+    unsigned long hash;         /* hash of name without the base */
+} nasm_locallabel;
+
 typedef struct yasm_parser_nasm {
     int tasm;
     int masm;
@@ -49,6 +56,16 @@ typedef struct yasm_parser_nasm {
     /* last "base" label for local (.) labels */
     /*@null@*/ char *locallabel_base;
     size_t locallabel_base_len;
+    size_t locallabel_base_size;        /* allocated size */
+
+    /* Symbols of local labels used since the last base label, keyed by
+     * their name without the base (so references needn't build and look
+     * up the full name).  Changing the base just bumps the scope.
+     */
+    /*@only@*/ nasm_locallabel *locallabels;
+    unsigned long locallabels_size;     /* power of 2 */
+    unsigned long locallabels_count;    /* entries in current scope */
+    unsigned long locallabels_scope;
 
     /*@dependent@*/ yasm_preproc *preproc;
     /*@dependent@*/ yasm_errwarns *errwarns;
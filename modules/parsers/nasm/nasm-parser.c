@@ -45,6 +45,13 @@ nasm_do_parse(yasm_object *object, yasm_preproc *pp, int save_input,
 
     parser_nasm.locallabel_base = (char *)NULL;
     parser_nasm.locallabel_base_len = 0;
+    parser_nasm.locallabel_base_size = 0;
+
+    parser_nasm.locallabels_size = 64;
+    parser_nasm.locallabels = yasm_xcalloc(parser_nasm.locallabels_size,
+                                           sizeof(nasm_locallabel));
+    parser_nasm.locallabels_count = 0;
+    parser_nasm.locallabels_scope = 1;
 
     parser_nasm.preproc = pp;
     parser_nasm.errwarns = errwarns;
@@ -70,6 +77,7 @@ nasm_do_parse(yasm_object *object, yasm_preproc *pp, int save_input,
     /* Free locallabel base if necessary */
     if (parser_nasm.locallabel_base)
         yasm_xfree(parser_nasm.locallabel_base);
+    yasm_xfree(parser_nasm.locallabels);
 
     /* Check for undefined symbols */
     yasm_symtab_parser_finalize(object->symtab, 0, errwarns);
@@ -703,29 +703,13 @@ static int remove_define(yasm_preproc_gas *pp, const char *name, int allow_redef
 {
     yasm_symrec *rec = yasm_symtab_get(pp->defines, name);
     if (rec) {
-        const yasm_symtab_iter *entry;
-        yasm_symtab *new_defines;
-
         if (!allow_redefine) {
             yasm_error_set(YASM_ERROR_SYNTAX, N_("symbol \"%s\" is already defined"), name);
             yasm_errwarn_propagate(pp->errwarns, pp->current_line_number);
             return 0;
         }
 
-        new_defines = yasm_symtab_create();
-
-        for (entry = yasm_symtab_first(pp->defines); entry; entry = yasm_symtab_next(entry)) {
-            yasm_symrec *entry_rec = yasm_symtab_iter_value(entry);
-            const char *rec_name = yasm_symrec_get_name(entry_rec);
-            if (strcmp(rec_name, name)) {
-                yasm_intnum *num = yasm_intnum_create_int(eval_expr(pp, rec_name));
-                yasm_expr *expr = yasm_expr_create_ident(yasm_expr_int(num), 0);
-                yasm_symtab_define_equ(new_defines, rec_name, expr, 0);
-            } 
-        }
-
-        yasm_symtab_destroy(pp->defines);
-        pp->defines = new_defines;
+        yasm_symtab_remove(pp->defines, name);
     }
     return (rec != NULL);
 }
@@ -1267,19 +1251,15 @@ gas_preproc_create(const char *in_filename, yasm_symtab *symtab,
     FILE *f;
     yasm_preproc_gas *pp = yasm_xmalloc(sizeof(yasm_preproc_gas));
 
-    if (strcmp(in_filename, "-") != 0) {
-        f = fopen(in_filename, "r");
-        if (!f) {
-            yasm__fatal(N_("Could not open input file"));
-        }
-    } else {
-        f = stdin;
+    f = yasm_fopen_source(in_filename);
+    if (!f) {
+        yasm__fatal(N_("Could not open input file"));
     }
 
     pp->preproc.module = &yasm_gas_LTX_preproc;
     pp->in = f;
     pp->in_filename = yasm__xstrdup(in_filename);
-    pp->defines = yasm_symtab_create();
+    pp->defines = yasm_symtab_create(NULL);
     SLIST_INIT(&pp->deferred_defines);
     yasm_symtab_set_case_sensitive(pp->defines, 1);
     pp->depth = 0;
@@ -1303,6 +1283,8 @@ static void
 gas_preproc_destroy(yasm_preproc *preproc)
 {
     yasm_preproc_gas *pp = (yasm_preproc_gas *) preproc;
+    if (pp->in != stdin)
+        fclose(pp->in);
     yasm_xfree(pp->in_filename);
     yasm_symtab_destroy(pp->defines);
     while (!SLIST_EMPTY(&pp->deferred_defines)) {
@@ -1440,5 +1422,6 @@ yasm_preproc_module yasm_gas_LTX_preproc = {
     gas_preproc_predefine_macro,
     gas_preproc_undefine_macro,
     gas_preproc_define_builtin,
-    gas_preproc_add_standard
+    gas_preproc_add_standard,
+    NULL
 };
@@ -20,15 +20,15 @@
 #include "nasm-eval.h"
 
 /* The assembler symbol table. */
-extern yasm_symtab *nasm_symtab;
+extern YASM_THREAD_LOCAL yasm_symtab *nasm_symtab;
 
-static scanner scan;    /* Address of scanner routine */
-static efunc error;     /* Address of error reporting routine */
+static YASM_THREAD_LOCAL scanner scan;    /* Address of scanner routine */
+static YASM_THREAD_LOCAL efunc error;     /* Address of error reporting routine */
 
-static struct tokenval *tokval;   /* The current token */
-static int i;                     /* The t_type of tokval */
+static YASM_THREAD_LOCAL struct tokenval *tokval;   /* The current token */
+static YASM_THREAD_LOCAL int i;                     /* The t_type of tokval */
 
-static void *scpriv;
+static YASM_THREAD_LOCAL void *scpriv;
 
 /*
  * Recursive-descent parser. Called with a single boolean operand,
@@ -39,6 +39,7 @@
 #include <libyasm/intnum.h>
 #include <libyasm/expr.h>
 #include <libyasm/file.h>
+#include <libyasm/trace.h>
 #include <stdarg.h>
 #include <ctype.h>
 #include <limits.h>
@@ -335,31 +336,57 @@ static const char *tasm_directives[] = {
     "ifndef", "include", "local"
 };
 
-static int StackSize = 4;
-static const char *StackPointer = "ebp";
-static int ArgOffset = 8;
-static int LocalOffset = 4;
-static int Level = 0;
+static YASM_THREAD_LOCAL int StackSize = 4;
+static YASM_THREAD_LOCAL const char *StackPointer = "ebp";
+static YASM_THREAD_LOCAL int ArgOffset = 8;
+static YASM_THREAD_LOCAL int LocalOffset = 4;
+static YASM_THREAD_LOCAL int Level = 0;
 
 
-static Context *cstk;
-static Include *istk;
+static YASM_THREAD_LOCAL Context *cstk;
+static YASM_THREAD_LOCAL Include *istk;
 
-static FILE *first_fp = NULL;
+static YASM_THREAD_LOCAL FILE *first_fp = NULL;
 
-static efunc _error;            /* Pointer to client-provided error reporting function */
-static evalfunc evaluate;
+static YASM_THREAD_LOCAL efunc _error;            /* Pointer to client-provided error reporting function */
+static YASM_THREAD_LOCAL evalfunc evaluate;
 
-static int pass;                /* HACK: pass 0 = generate dependencies only */
+static YASM_THREAD_LOCAL int pass;                /* HACK: pass 0 = generate dependencies only */
 
-static unsigned long unique;    /* unique identifier numbers */
+static YASM_THREAD_LOCAL unsigned long unique;    /* unique identifier numbers */
 
-static Line *builtindef = NULL;
-static Line *stddef = NULL;
-static Line *predef = NULL;
-static int first_line = 1;
+/*
+ * Standard macro sets are tokenised the first time they are used and
+ * kept until pp_stdmac_cleanup(), so later runs in the same process
+ * (batch and server jobs, in-memory assembly) don't tokenise them
+ * again.  Their tokens are allocated individually rather than from the
+ * token Blocks, which pp_cleanup() throws away.
+ */
+typedef struct StdMacSet StdMacSet;
+struct StdMacSet
+{
+    StdMacSet *next;
+    const char **macros;        /* source text; identifies the set */
+    Line *lines;                /* tokenised lines, in reverse order */
+};
+static YASM_THREAD_LOCAL StdMacSet *stdmac_cache = NULL;
+
+/*
+ * Standard macro sets used in this run, most recently added first.
+ */
+typedef struct StdMacRef StdMacRef;
+struct StdMacRef
+{
+    StdMacRef *next;
+    StdMacSet *set;
+};
 
-static ListGen *list;
+static YASM_THREAD_LOCAL Line *builtindef = NULL;
+static YASM_THREAD_LOCAL StdMacRef *stddef = NULL;
+static YASM_THREAD_LOCAL Line *predef = NULL;
+static YASM_THREAD_LOCAL int first_line = 1;
+
+static YASM_THREAD_LOCAL ListGen *list;
 
 /*
  * The number of hash values we use for the macro lookup tables.
@@ -371,18 +398,18 @@ static ListGen *list;
 /*
  * The current set of multi-line macros we have defined.
  */
-static MMacro *mmacros[NHASH];
+static YASM_THREAD_LOCAL MMacro *mmacros[NHASH];
 
 /*
  * The current set of single-line macros we have defined.
  */
-static SMacro *smacros[NHASH];
+static YASM_THREAD_LOCAL SMacro *smacros[NHASH];
 
 /*
  * The multi-line macro we are currently defining, or the %rep
  * block we are currently reading, if any.
  */
-static MMacro *defining;
+static YASM_THREAD_LOCAL MMacro *defining;
 
 /*
  * The number of macro parameters to allocate space for at a time.
@@ -447,19 +474,19 @@ static const char *tasm_compat_macros[] =
     NULL
 };
 
-static int nested_mac_count, nested_rep_count;
+static YASM_THREAD_LOCAL int nested_mac_count, nested_rep_count;
 
 /*
  * Tokens are allocated in blocks to improve speed
  */
 #define TOKEN_BLOCKSIZE 4096
-static Token *freeTokens = NULL;
+static YASM_THREAD_LOCAL Token *freeTokens = NULL;
 struct Blocks {
         Blocks *next;
         void *chunk;
 };
 
-static Blocks blocks = { NULL, NULL };
+static YASM_THREAD_LOCAL Blocks blocks = { NULL, NULL };
 
 /*
  * Forward declarations.
@@ -497,9 +524,9 @@ typedef struct TMEndItem {
     struct TMEndItem *next;
 } TMEndItem;
 
-static TMEndItem *EndmStack = NULL, *EndsStack = NULL;
+static YASM_THREAD_LOCAL TMEndItem *EndmStack = NULL, *EndsStack = NULL;
 
-char **TMParameters;
+YASM_THREAD_LOCAL char **TMParameters;
 
 struct TStrucField {
     char *name;
@@ -511,14 +538,14 @@ struct TStruc {
     struct TStrucField *fields, *lastField;
     struct TStruc *next;
 };
-static struct TStruc *TStrucs = NULL;
-static int inTstruc = 0;
+static YASM_THREAD_LOCAL struct TStruc *TStrucs = NULL;
+static YASM_THREAD_LOCAL int inTstruc = 0;
 
 struct TSegmentAssume {
     char *segreg;
     char *segment;
 };
-struct TSegmentAssume *TAssumes;
+YASM_THREAD_LOCAL struct TSegmentAssume *TAssumes;
 
 const char *tasm_get_segment_register(const char *segment)
 {
@@ -2736,6 +2763,7 @@ do_directive(Token * tline)
             inc->conds = NULL;
             inc->fp = inc_fopen(p, &newname);
             nasm_free(p);
+            yasm_trace_begin("include", newname, NULL);
             inc->fname = nasm_src_set_fname(newname);
             inc->lineno = nasm_src_set_linnum(0);
             inc->lineinc = 1;
@@ -4820,6 +4848,7 @@ expand_mmacro(Token * tline)
     }
 
     list->uplevel(m->nolist ? LIST_MACRO_NOLIST : LIST_MACRO);
+    yasm_trace_begin("macro", m->name, NULL);
 
     return 1;
 }
@@ -4937,9 +4966,12 @@ pp_getline(void)
 
         if (first_line)
         {
+            StdMacRef *ref;
+
             /* Reverse order */
             poke_predef(predef);
-            poke_predef(stddef);
+            for (ref = stddef; ref; ref = ref->next)
+                poke_predef(ref->set->lines);
             poke_predef(builtindef);
             first_line = 0;
         }
@@ -5025,6 +5057,7 @@ pp_getline(void)
                         free_tlist(m->iline);
                         nasm_free(m->paramlen);
                         l->finishes->in_progress = FALSE;
+                        yasm_trace_end();
                     }
                     else
                         free_mmacro(m);
@@ -5071,6 +5104,7 @@ pp_getline(void)
                 /* only set line and file name if there's a next node */
                 if (i->next) 
                 {
+                    yasm_trace_end();
                     nasm_src_set_linnum(i->lineno);
                     nasm_free(nasm_src_set_fname(nasm_strdup(i->fname)));
                 }
@@ -5180,9 +5214,16 @@ pp_cleanup(int pass_)
             error(ERR_NONFATAL, "end of file while still defining macro `%s'",
                     defining->name);
             free_mmacro(defining);
+            defining = NULL;
         }
         return;
     }
+    /* A run cut short (by a fatal error) can stop inside a definition */
+    if (defining)
+    {
+        free_mmacro(defining);
+        defining = NULL;
+    }
     while (cstk)
         ctx_pop();
     for (h = 0; h < NHASH; h++)
@@ -5216,7 +5257,12 @@ pp_cleanup(int pass_)
     if (pass_ == 0)
         {
                 free_llist(builtindef);
-                free_llist(stddef);
+                while (stddef)
+                {
+                    StdMacRef *ref = stddef;
+                    stddef = ref->next;
+                    nasm_free(ref);
+                }
                 free_llist(predef);
                 builtindef = NULL;
                 stddef = NULL;
@@ -5311,23 +5357,85 @@ pp_builtin_define(char *definition)
 void
 pp_extra_stdmac(const char **macros)
 {
-    const char **lp;
+    StdMacSet *set;
+    StdMacRef *ref;
+
+    for (set = stdmac_cache; set; set = set->next)
+        if (set->macros == macros)
+            break;
 
-    for (lp=macros; *lp; lp++)
+    if (!set)
     {
-        char *macro;
-        Token *t;
-        Line *l;
+        const char **lp;
 
-        macro = nasm_strdup(*lp);
-        t = tokenise(macro);
-        nasm_free(macro);
+        set = nasm_malloc(sizeof(StdMacSet));
+        set->macros = macros;
+        set->lines = NULL;
 
-        l = nasm_malloc(sizeof(Line));
-        l->next = stddef;
-        l->first = t;
-        l->finishes = FALSE;
-        stddef = l;
+        for (lp=macros; *lp; lp++)
+        {
+            char *macro;
+            Token *t, *head = NULL, **tail = &head;
+            Line *l;
+
+            macro = nasm_strdup(*lp);
+            t = tokenise(macro);
+            nasm_free(macro);
+
+            /* Move the token text over to tokens outside the Blocks */
+            while (t)
+            {
+                *tail = nasm_malloc(sizeof(Token));
+                (*tail)->next = NULL;
+                (*tail)->text = t->text;
+                (*tail)->mac = NULL;
+                (*tail)->type = t->type;
+                tail = &(*tail)->next;
+                t->text = NULL;
+                t = delete_Token(t);
+            }
+
+            l = nasm_malloc(sizeof(Line));
+            l->next = set->lines;
+            l->first = head;
+            l->finishes = FALSE;
+            set->lines = l;
+        }
+
+        set->next = stdmac_cache;
+        stdmac_cache = set;
+    }
+
+    ref = nasm_malloc(sizeof(StdMacRef));
+    ref->next = stddef;
+    ref->set = set;
+    stddef = ref;
+}
+
+/*
+ * Free the cached standard macro sets.  Only valid between runs.
+ */
+void
+pp_stdmac_cleanup(void)
+{
+    while (stdmac_cache)
+    {
+        StdMacSet *set = stdmac_cache;
+        stdmac_cache = set->next;
+        while (set->lines)
+        {
+            Line *l = set->lines;
+            set->lines = l->next;
+            while (l->first)
+            {
+                Token *t = l->first;
+                l->first = t->next;
+                nasm_free(t->text);
+                nasm_free(t);
+            }
+            nasm_free(l);
+        }
+        nasm_free(set);
     }
 }
 
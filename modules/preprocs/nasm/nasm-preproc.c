@@ -42,12 +42,12 @@ typedef struct yasm_preproc_nasm {
     long prior_linnum;
     int lineinc;
 } yasm_preproc_nasm;
-yasm_symtab *nasm_symtab;
-static yasm_linemap *cur_lm;
-static yasm_errwarns *cur_errwarns;
-int tasm_compatible_mode = 0;
-int tasm_locals;
-const char *tasm_segment;
+YASM_THREAD_LOCAL yasm_symtab *nasm_symtab;
+static YASM_THREAD_LOCAL yasm_linemap *cur_lm;
+static YASM_THREAD_LOCAL yasm_errwarns *cur_errwarns;
+YASM_THREAD_LOCAL int tasm_compatible_mode = 0;
+YASM_THREAD_LOCAL int tasm_locals;
+YASM_THREAD_LOCAL const char *tasm_segment;
 
 #include "nasm-version.c"
 
@@ -56,8 +56,8 @@ typedef struct preproc_dep {
     char *name;
 } preproc_dep;
 
-static STAILQ_HEAD(preproc_dep_head, preproc_dep) *preproc_deps;
-static int done_dep_preproc;
+static YASM_THREAD_LOCAL STAILQ_HEAD(preproc_dep_head, preproc_dep) *preproc_deps;
+static YASM_THREAD_LOCAL int done_dep_preproc;
 
 yasm_preproc_module yasm_nasm_LTX_preproc;
 
@@ -139,13 +139,9 @@ nasm_preproc_create(const char *in_filename, yasm_symtab *symtab,
 
     preproc_nasm->preproc.module = &yasm_nasm_LTX_preproc;
 
-    if (strcmp(in_filename, "-") != 0) {
-        f = fopen(in_filename, "r");
-        if (!f)
-            yasm__fatal( N_("Could not open input file") );
-    }
-    else
-        f = stdin;
+    f = yasm_fopen_source(in_filename);
+    if (!f)
+        yasm__fatal( N_("Could not open input file") );
 
     preproc_nasm->in = f;
     nasm_symtab = symtab;
@@ -183,6 +179,8 @@ nasm_preproc_destroy(yasm_preproc *preproc)
         yasm_xfree(dep->name);
         yasm_xfree(dep);
     }
+    yasm_xfree(preproc_deps);
+    preproc_deps = NULL;
     yasm_xfree(nasm_src_set_fname(NULL));
 }
 
@@ -193,6 +191,7 @@ nasm_preproc_get_line(yasm_preproc *preproc)
     long linnum;
     int altline;
     char *line;
+    yasm_mem_category oldcat;
 
     if (preproc_nasm->line) {
         char *retval = preproc_nasm->line;
@@ -200,7 +199,10 @@ nasm_preproc_get_line(yasm_preproc *preproc)
         return retval;
     }
 
+    /* Account everything the preprocessor allocates to it */
+    oldcat = yasm_mem_set_category(YASM_MEM_PREPROC);
     line = nasmpp.getline();
+    yasm_mem_set_category(oldcat);
     if (!line)
     {
         nasmpp.cleanup(1);
@@ -303,6 +305,12 @@ nasm_preproc_add_standard(yasm_preproc *preproc, const char **macros)
     pp_extra_stdmac(macros);
 }
 
+static void
+nasm_preproc_cleanup(void)
+{
+    pp_stdmac_cleanup();
+}
+
 /* Define preproc structure -- see preproc.h for details */
 yasm_preproc_module yasm_nasm_LTX_preproc = {
     "Real NASM Preprocessor",
@@ -315,7 +323,8 @@ yasm_preproc_module yasm_nasm_LTX_preproc = {
     nasm_preproc_predefine_macro,
     nasm_preproc_undefine_macro,
     nasm_preproc_define_builtin,
-    nasm_preproc_add_standard
+    nasm_preproc_add_standard,
+    nasm_preproc_cleanup
 };
 
 static yasm_preproc *
@@ -337,5 +346,6 @@ yasm_preproc_module yasm_tasm_LTX_preproc = {
     nasm_preproc_predefine_macro,
     nasm_preproc_undefine_macro,
     nasm_preproc_define_builtin,
-    nasm_preproc_add_standard
+    nasm_preproc_add_standard,
+    nasm_preproc_cleanup
 };
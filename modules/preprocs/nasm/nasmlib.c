@@ -127,8 +127,8 @@ yasm_intnum *nasm_readstrnum (char *str, size_t length, int *warn)
     return intn;
 }
 
-static char *file_name = NULL;
-static long line_number = 0;
+static YASM_THREAD_LOCAL char *file_name = NULL;
+static YASM_THREAD_LOCAL long line_number = 0;
 
 char *nasm_src_set_fname(char *newname) 
 {
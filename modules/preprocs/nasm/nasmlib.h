@@ -14,10 +14,10 @@
  * fatal-error and die rather than return NULL; nasm_realloc will
  * do likewise, and will also guarantee to work right on being
  * passed a NULL pointer; nasm_free will do nothing if it is passed
- * a NULL pointer.
+ * a NULL pointer.  Memory is accounted to YASM_MEM_PREPROC.
  */
-#define nasm_malloc yasm_xmalloc
-#define nasm_realloc yasm_xrealloc
+#define nasm_malloc(size) yasm__xmalloc_cat(YASM_MEM_PREPROC, size)
+#define nasm_realloc(p, size) yasm__xrealloc_cat(YASM_MEM_PREPROC, p, size)
 #ifdef WITH_DMALLOC
 #define nasm_free(p) do { if (p) yasm_xfree(p); } while(0)
 #else
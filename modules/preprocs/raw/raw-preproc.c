@@ -48,13 +48,9 @@ raw_preproc_create(const char *in_filename, yasm_symtab *symtab,
     FILE *f;
     yasm_preproc_raw *preproc_raw = yasm_xmalloc(sizeof(yasm_preproc_raw));
 
-    if (strcmp(in_filename, "-") != 0) {
-        f = fopen(in_filename, "r");
-        if (!f)
-            yasm__fatal( N_("Could not open input file") );
-    }
-    else
-        f = stdin;
+    f = yasm_fopen_source(in_filename);
+    if (!f)
+        yasm__fatal( N_("Could not open input file") );
 
     preproc_raw->preproc.module = &yasm_raw_LTX_preproc;
     preproc_raw->in = f;
@@ -67,6 +63,9 @@ raw_preproc_create(const char *in_filename, yasm_symtab *symtab,
 static void
 raw_preproc_destroy(yasm_preproc *preproc)
 {
+    yasm_preproc_raw *preproc_raw = (yasm_preproc_raw *)preproc;
+    if (preproc_raw->in != stdin)
+        fclose(preproc_raw->in);
     yasm_xfree(preproc);
 }
 
@@ -165,5 +164,6 @@ yasm_preproc_module yasm_raw_LTX_preproc = {
     raw_preproc_predefine_macro,
     raw_preproc_undefine_macro,
     raw_preproc_define_builtin,
-    raw_preproc_add_standard
+    raw_preproc_add_standard,
+    NULL
 };
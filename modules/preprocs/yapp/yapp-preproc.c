@@ -39,26 +39,26 @@ typedef struct yasm_preproc_yapp {
 
 yasm_preproc_module yasm_yapp_LTX_preproc;
 
-static int saved_length;
+static YASM_THREAD_LOCAL int saved_length;
 
-static HAMT *macro_table;
+static YASM_THREAD_LOCAL HAMT *macro_table;
 
-static YAPP_Output current_output;
-YYSTYPE yapp_preproc_lval;
+static YASM_THREAD_LOCAL YAPP_Output current_output;
+YASM_THREAD_LOCAL YYSTYPE yapp_preproc_lval;
 
-/*@dependent@*/ yasm_linemap *yapp_preproc_linemap;
+YASM_THREAD_LOCAL /*@dependent@*/ yasm_linemap *yapp_preproc_linemap;
 
 /* Build source and macro representations */
-static SLIST_HEAD(source_head, source_s) source_head, macro_head, param_head;
-static struct source_s {
+static YASM_THREAD_LOCAL SLIST_HEAD(source_head, source_s) source_head, macro_head, param_head;
+static YASM_THREAD_LOCAL struct source_s {
     SLIST_ENTRY(source_s) next;
     YAPP_Token token;
 } *src, *source_tail, *macro_tail, *param_tail;
 typedef struct source_s source;
 
 /* don't forget what the nesting level says */
-static SLIST_HEAD(output_head, output_s) output_head;
-static struct output_s {
+static YASM_THREAD_LOCAL SLIST_HEAD(output_head, output_s) output_head;
+static YASM_THREAD_LOCAL struct output_s {
     SLIST_ENTRY(output_s) next;
     YAPP_Output out;
 } output, *out;
@@ -1016,5 +1016,6 @@ yasm_preproc_module yasm_yapp_LTX_preproc = {
     yapp_preproc_predefine_macro,
     yapp_preproc_undefine_macro,
     yapp_preproc_define_builtin,
-    yapp_preproc_add_standard
+    yapp_preproc_add_standard,
+    NULL
 };
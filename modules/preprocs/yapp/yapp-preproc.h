@@ -57,6 +57,6 @@ typedef enum {
 void yapp_lex_initialize(FILE *f);
 void set_inhibit(void);
 
-extern /*@dependent@*/ yasm_linemap *yapp_preproc_linemap;
+extern YASM_THREAD_LOCAL /*@dependent@*/ yasm_linemap *yapp_preproc_linemap;
 #define cur_lindex      yasm_linemap_get_current(yapp_preproc_linemap)
 
@@ -57,8 +57,8 @@ typedef union {
 #define WHITESPACE      302
 
 
-extern YYSTYPE yapp_preproc_lval;
-extern char *yapp_preproc_current_file;
-extern int yapp_preproc_line_number;
+extern YASM_THREAD_LOCAL YYSTYPE yapp_preproc_lval;
+extern YASM_THREAD_LOCAL char *yapp_preproc_current_file;
+extern YASM_THREAD_LOCAL int yapp_preproc_line_number;
 
 int yapp_preproc_lex(void);
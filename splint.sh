@@ -23,6 +23,8 @@ splint \
  frontends/yasm/yasm-options.c \
  frontends/yasm/yasm.c \
  libyasm/arch.c \
+ libyasm/arena.c \
+ libyasm/assemble.c \
  libyasm/assocdat.c \
  libyasm/bc-align.c \
  libyasm/bc-data.c \
@@ -36,6 +38,7 @@ splint \
  libyasm/file.c \
  libyasm/floatnum.c \
  libyasm/hamt.c \
+ libyasm/intern.c \
  libyasm/intnum.c \
  libyasm/inttree.c \
  libyasm/linemap.c \
@@ -46,6 +49,7 @@ splint \
  libyasm/strcasecmp.c \
  libyasm/strsep.c \
  libyasm/symrec.c \
+ libyasm/trace.c \
  libyasm/valparam.c \
  libyasm/value.c \
  libyasm/xmalloc.c \
@@ -60,17 +60,19 @@ cdef class Bytecode:
         # Someday extend this to do something modifiable, e.g. return a
         # list-like object.
         def __get__(self):
+            cdef yasm_symrec **symrecs
             cdef yasm_symrec *sym
             cdef int i
-            if self.bc.symrecs == NULL:
+            symrecs = yasm_bc_get_symrecs(self.bc)
+            if symrecs == NULL:
                 return []
             s = []
             i = 0
-            sym = self.bc.symrecs[i]
+            sym = symrecs[i]
             while sym != NULL:
                 s.append(__make_symbol(sym))
                 i = i+1
-                sym = self.bc.symrecs[i]
+                sym = symrecs[i]
             return s
 
 #
@@ -191,7 +191,7 @@ cdef class SymbolTable:
     cdef yasm_symtab *symtab
 
     def __cinit__(self):
-        self.symtab = yasm_symtab_create()
+        self.symtab = yasm_symtab_create(NULL)
 
     def __dealloc__(self):
         if self.symtab != NULL: yasm_symtab_destroy(self.symtab)
@@ -128,6 +128,14 @@
 # define yasm_xfree(ptr)                xfree(ptr)
 #endif
 
+/* Storage class for the per-thread state in libyasm and the modules.  If the
+ * compiler has no thread-local storage, this is empty and only one thread at
+ * a time may use libyasm.
+ */
+#ifndef YASM_THREAD_LOCAL
+#define YASM_THREAD_LOCAL
+#endif
+
 /* Bit-counting: used primarily by HAMT but also in a few other places. */
 #define BC_TWO(c)       (0x1ul << (c))
 #define BC_MSK(c)       (((unsigned long)(-1)) / (BC_TWO(BC_TWO(c)) + 1ul))